@@ -0,0 +1,75 @@
+#ifndef MEC_CAMERA_MANAGER_H
+#define MEC_CAMERA_MANAGER_H
+
+#include "mec_video.h"
+#include "mec_video_source.h"
+
+/**
+ * @file mec_camera_manager.h
+ * @brief 多路相机解码管理
+ *
+ * N 路视频流共享一个固定大小的解码工作线程池。每路流按自己的帧率排定下一次
+ * 读帧时刻，空闲工作线程总是处理最早到期的流；落后时先丢弃过期帧追上节拍。
+ * 打开或读取失败的流关闭后按指数退避重连。解码结果写入对应视频处理器的帧缓冲环。
+ */
+
+#define CAMERA_MAX_STREAMS 16
+#define CAMERA_MAX_WORKERS 8
+#define CAMERA_DEFAULT_FPS 25.0
+#define CAMERA_RECONNECT_MIN_MS 1000
+#define CAMERA_RECONNECT_MAX_MS 30000
+#define CAMERA_MAX_CATCHUP 10      // 单次最多丢弃的过期帧数
+
+typedef struct {
+    char url[256];
+    int camera_id;
+    double fps;                    // 读帧节拍，<=0 时使用源帧率
+    int width;
+    int height;
+    video_processor_t *processor;  // 解码帧的去向
+} camera_stream_config_t;
+
+typedef struct {
+    int camera_id;
+    int connected;
+    double decode_fps;             // 最近一个报告周期内的解码帧率
+    long frames_decoded;
+    long frames_late;              // 为追节拍丢弃的帧
+    long frames_overwritten;       // 检测来不及处理、在帧缓冲环中被覆盖的帧
+    long reconnects;
+    video_rate_metrics_t rate;     // 检测帧率控制的当前决策
+} camera_stream_stats_t;
+
+/**
+ * @brief 相机管理器句柄（不透明结构体）
+ */
+typedef struct mec_camera_manager_t mec_camera_manager_t;
+
+/**
+ * @param workers 解码工作线程数（超过流数时按流数创建）
+ */
+mec_camera_manager_t* camera_manager_create(int workers);
+void camera_manager_destroy(mec_camera_manager_t *manager);
+
+/**
+ * @brief 添加一路流（须在 start 之前调用）
+ * @return 流下标，失败返回 -1
+ */
+int camera_manager_add_stream(mec_camera_manager_t *manager, const camera_stream_config_t *config);
+
+int camera_manager_start(mec_camera_manager_t *manager);
+void camera_manager_stop(mec_camera_manager_t *manager);
+
+int camera_manager_stream_count(mec_camera_manager_t *manager);
+
+/**
+ * @brief 读取一路流的统计（decode_fps 按两次调用之间的间隔计算）
+ */
+int camera_manager_get_stats(mec_camera_manager_t *manager, int index, camera_stream_stats_t *stats);
+
+/**
+ * @brief 输出所有流的解码帧率、丢帧与重连计数
+ */
+void camera_manager_report(mec_camera_manager_t *manager);
+
+#endif // MEC_CAMERA_MANAGER_H
@@ -0,0 +1,114 @@
+#ifndef MEC_CAPTURE_H
+#define MEC_CAPTURE_H
+
+#include "mec_common.h"
+#include "mec_thread.h"
+#include "mec_clock.h"
+
+/**
+ * @file mec_capture.h
+ * @brief 原始传感器数据抓包与回放
+ *
+ * 抓包文件为只追加的二进制日志：文件头之后是连续的记录，每条记录由定长记录头
+ * 和原始负载组成（主机字节序）。写入采用双缓冲：采集线程只向内存缓冲追加，
+ * 后台线程负责落盘，采集线程永不因磁盘 IO 阻塞；两个缓冲都满时丢弃并计数。
+ * 回放端以 mmap 方式映射整个文件，按 1x、Nx 或最大速度顺序返回记录；节拍走
+ * 系统时钟 (mec_clock)，虚拟时钟模式下随回放驱动者推进，不受真实时间限制。
+ */
+
+#define MEC_CAPTURE_MAGIC   "MECCAP01"
+#define MEC_CAPTURE_VERSION 1
+#define MEC_CAPTURE_DEFAULT_BUFFER (1024 * 1024)
+
+// 记录类型
+typedef enum {
+    CAPTURE_REC_STREAM = 1,   // 字节流片段 (串口 read 返回的数据)
+    CAPTURE_REC_DATAGRAM = 2, // 完整数据报 (UDP)
+    CAPTURE_REC_CAN = 3       // 单个 struct can_frame
+} capture_record_type_t;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+} mec_capture_file_header_t;
+
+/**
+ * @brief 记录头 (16 字节，负载紧随其后，下一条记录按 8 字节对齐)
+ */
+typedef struct {
+    uint64_t timestamp_ns;  // 接收时间 (Unix 纪元纳秒)
+    uint32_t length;        // 负载字节数
+    uint16_t source_id;     // 传感器 ID
+    uint8_t type;           // capture_record_type_t
+    uint8_t reserved;
+} mec_capture_record_t;
+
+#define MEC_CAPTURE_ALIGN(n) (((n) + 7u) & ~7u)
+
+/**
+ * @brief 抓包写入器（不透明结构体）
+ */
+typedef struct mec_capture_t mec_capture_t;
+
+/**
+ * @brief 创建抓包文件并启动后台落盘线程
+ * @param path 输出文件路径（追加写入；新文件会写入文件头）
+ * @param buffer_size 单个缓冲区大小，0 使用默认值
+ * @return 句柄，失败返回 NULL
+ */
+mec_capture_t* mec_capture_open(const char *path, size_t buffer_size);
+
+/**
+ * @brief 追加一条记录（非阻塞）
+ * @return 0:成功, -1:缓冲区均已满，记录被丢弃
+ */
+int mec_capture_write(mec_capture_t *cap, capture_record_type_t type, int source_id,
+                      const struct timeval *timestamp, const void *data, size_t len);
+
+/**
+ * @brief 刷新剩余数据、停止落盘线程并关闭文件
+ */
+void mec_capture_close(mec_capture_t *cap);
+
+/**
+ * @brief 获取因缓冲区满而丢弃的记录数
+ */
+long mec_capture_dropped(mec_capture_t *cap);
+
+/**
+ * @brief 回放源：mmap 映射的抓包文件
+ */
+typedef struct {
+    const uint8_t *base;
+    size_t size;
+    size_t offset;           // 下一条记录的偏移
+    double speed;            // 1.0: 实时, N: N 倍速, <=0: 最大速度
+    uint64_t first_ts_ns;    // 第一条记录的时间
+    mec_time_ns_t start;     // 回放开始时刻 (mec_clock_now 时间轴)
+    mec_time_ns_t start_wall; // 回放开始时的数据时间戳 (mec_clock_wall)
+    long records;
+} mec_replay_t;
+
+mec_replay_t* mec_replay_open(const char *path, double speed);
+void mec_replay_close(mec_replay_t *replay);
+
+/**
+ * @brief 回到文件起点，重新计时
+ */
+void mec_replay_rewind(mec_replay_t *replay);
+
+/**
+ * @brief 取下一条记录（负载直接指向映射内存，不做拷贝）
+ * @return 1:成功, 0:已到文件末尾, -1:文件损坏
+ */
+int mec_replay_next(mec_replay_t *replay, const mec_capture_record_t **record, const uint8_t **payload);
+
+/**
+ * @brief 按回放速度等待到该记录的发布时刻，并给出回放时间轴上的时间戳
+ * @param ctx 回放线程的上下文，在其 cond 上等待；running 置 false 并广播时提前返回
+ */
+void mec_replay_pace(mec_replay_t *replay, const mec_capture_record_t *record,
+                     thread_context_t *ctx, struct timeval *out_timestamp);
+
+#endif // MEC_CAPTURE_H
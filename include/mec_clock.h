@@ -0,0 +1,91 @@
+#ifndef MEC_CLOCK_H
+#define MEC_CLOCK_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+/**
+ * @file mec_clock.h
+ * @brief 系统时钟：单调纳秒时间与虚拟时钟
+ *
+ * 各模块不再直接调用 gettimeofday，统一经由本模块取时：
+ *   mec_clock_now()       单调纳秒时间，用于间隔、超时与融合 dt
+ *   mec_clock_wall()      数据时间戳 (target_track_t / mec_msg_t 的 timeval)
+ *   mec_clock_real_ns()   始终为真实单调时间，只用于测量处理耗时
+ *
+ * 虚拟时钟模式下时间不再流逝，由驱动者（场景模拟器）调用 mec_clock_advance_to
+ * 推进。经 mec_clock_cond_timedwait 等待的线程登记自己的截止时间，推进时时钟
+ * 按截止时间先后逐个唤醒，并在每一步等系统静止（所有登记过的线程重新进入等待）
+ * 后再继续，因此回放不受真实时间限制，各线程看到的时间序列也是确定的。
+ *
+ * 虚拟与真实模式切换时两种时间都保持连续，不会回退。
+ */
+
+typedef int64_t mec_time_ns_t;
+
+#define MEC_NS_PER_US 1000LL
+#define MEC_NS_PER_MS 1000000LL
+#define MEC_NS_PER_SEC 1000000000LL
+
+#define MEC_CLOCK_MAX_THREADS 64        // 同时参与虚拟时钟同步的线程上限（线程退出时释放），超出的线程不参与静止判定
+#define MEC_CLOCK_SETTLE_MS 50          // 线程持续运行超过此真实时长即不再等它进入等待
+
+/**
+ * @brief 当前单调时间（虚拟模式下为虚拟时间）
+ */
+mec_time_ns_t mec_clock_now(void);
+
+/**
+ * @brief 当前数据时间戳：真实模式为系统墙钟，虚拟模式随虚拟时间前进
+ */
+void mec_clock_wall(struct timeval *tv);
+
+/**
+ * @brief 真实单调时间，不受虚拟时钟影响
+ */
+mec_time_ns_t mec_clock_real_ns(void);
+
+/**
+ * @brief 切换虚拟时钟模式
+ * @param enabled 1:冻结时间，改由 mec_clock_advance_to 推进; 0:恢复真实时间流逝
+ */
+void mec_clock_set_virtual(int enabled);
+int mec_clock_is_virtual(void);
+
+/**
+ * @brief 虚拟模式下把时间推进到 t
+ *
+ * 按截止时间顺序唤醒其间到期的等待者，每一步都等系统静止后再前进。
+ * @return 0:成功, -1:非虚拟模式或 t 早于当前时间
+ */
+int mec_clock_advance_to(mec_time_ns_t t);
+
+/**
+ * @brief 与 pthread_cond_timedwait 相同的语义，截止时间为 mec_clock_now 时间轴上的绝对值
+ *
+ * cond 须使用默认 (CLOCK_REALTIME) 属性。虚拟模式下返回 0 不代表条件成立，
+ * 调用方应照常循环检查条件与返回值。
+ * @return 0:被唤醒, ETIMEDOUT:已到截止时间
+ */
+int mec_clock_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex, mec_time_ns_t deadline);
+
+static inline mec_time_ns_t mec_time_from_timeval(const struct timeval *tv) {
+    return (mec_time_ns_t)tv->tv_sec * MEC_NS_PER_SEC + (mec_time_ns_t)tv->tv_usec * MEC_NS_PER_US;
+}
+
+static inline void mec_time_to_timeval(mec_time_ns_t t, struct timeval *tv) {
+    tv->tv_sec = (time_t)(t / MEC_NS_PER_SEC);
+    tv->tv_usec = (suseconds_t)((t % MEC_NS_PER_SEC) / MEC_NS_PER_US);
+}
+
+static inline double mec_time_to_ms(mec_time_ns_t t) {
+    return (double)t / (double)MEC_NS_PER_MS;
+}
+
+// 两个 timeval 时间戳之差 (to - from)，单位毫秒
+static inline double mec_timeval_elapsed_ms(const struct timeval *from, const struct timeval *to) {
+    return mec_time_to_ms(mec_time_from_timeval(to) - mec_time_from_timeval(from));
+}
+
+#endif // MEC_CLOCK_H
@@ -25,6 +25,13 @@ typedef struct {
     double altitude;
 } wgs84_coord_t;
 
+// 站点局部东北天坐标 (单位: 米)，融合内部统一使用，见 mec_geo.h
+typedef struct {
+    double east;
+    double north;
+    double up;
+} enu_coord_t;
+
 typedef struct {
     int x;
     int y;
@@ -40,7 +47,8 @@ typedef enum {
 typedef struct {
     int id;
     target_type_t type;
-    wgs84_coord_t position;
+    wgs84_coord_t position;   // WGS84 坐标，仅在系统边界（输入/输出）使用
+    enu_coord_t local;        // 站点 ENU 坐标，关联与滤波使用
     double velocity;
     double heading;
     double confidence;
@@ -54,6 +62,8 @@ typedef struct {
     int capacity;
     int ref_count;            // 引用计数
     pthread_mutex_t ref_lock; // 保護計数のロック
+    void (*release_fn)(void *ctx); // 非 NULL 时 tracks 为外部缓冲（如共享内存槽），释放时回调而非 mec_free
+    void *release_ctx;
 } track_list_t;
 
 // 性能監視統計
@@ -75,6 +85,8 @@ void mec_free(void *ptr);
 track_list_t* track_list_create(int initial_capacity);
 void track_list_retain(track_list_t *list);  // 引用カウンタを増やす
 void track_list_release(track_list_t *list); // 引用カウンタを減らす（0になったら解放）
+// 外部缓冲を包む（コピーなし、容量固定）。最後の参照が解放されたとき release_fn(ctx) を呼ぶ
+track_list_t* track_list_wrap(target_track_t *tracks, int count, void (*release_fn)(void *ctx), void *ctx);
 int track_list_add(track_list_t *list, const target_track_t *track);
 void track_list_clear(track_list_t *list);
 
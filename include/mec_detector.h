@@ -0,0 +1,99 @@
+#ifndef MEC_DETECTOR_H
+#define MEC_DETECTOR_H
+
+#include "mec_common.h"
+#include "mec_thread.h"
+#include "mec_video_roi.h"
+
+/**
+ * @file mec_detector.h
+ * @brief 目标检测后端插件接口与跨相机批处理
+ *
+ * 检测后端以函数表形式注册，按名称选择（配置项 detector.backend）。所有相机
+ * 共享一个批处理器：各路相机的检测级提交请求后阻塞等待，批处理线程在第一个
+ * 请求到达后最多再等待一个很短的窗口，把这期间到齐的图像（含各 ROI 裁剪窗口）
+ * 合成一次推理调用。CPU 推理时批量越大，单帧摊到的调度与内存开销越小。
+ *
+ * 批处理器可以带多个推理工作线程（detector.workers），每个线程持有一份独立的
+ * 后端实例。一次提交的窗口多于一批时（高分辨率画面切块后），按批拆给空闲的
+ * 工作线程并行推理，全部完成后提交方才返回。
+ */
+
+#define DETECTOR_MAX_BATCH 16
+#define DETECTOR_DEFAULT_BATCH 8
+#define DETECTOR_DEFAULT_WINDOW_MS 5
+#define DETECTOR_MAX_WORKERS 8
+
+typedef struct {
+    char backend[32];          // 后端名称: mock | opencv_dnn
+    char model_path[256];      // 模型文件 (ONNX)
+    int input_width;           // 网络输入尺寸
+    int input_height;
+    float conf_threshold;
+    float nms_threshold;
+    int num_threads;           // 推理线程数，0 由后端决定
+    int max_batch;             // 单次推理最多图像数 (1 表示不批处理)
+    int batch_window_ms;       // 凑批等待窗口
+    int workers;               // 推理工作线程数（各持一份后端实例）
+} detector_config_t;
+
+/**
+ * @brief 一次检测的输入：整帧图像上的一个窗口（不拷贝像素）
+ */
+typedef struct {
+    const uint8_t *data;       // 整帧 BGR24 像素
+    int width;
+    int height;
+    int stride;
+    roi_rect_t crop;           // 检测窗口（覆盖整帧时等于画面大小）
+    int camera_id;
+} detector_image_t;
+
+/**
+ * @brief 检测后端函数表
+ *
+ * infer 的输出坐标为窗口内归一化坐标 (position.longitude = x, latitude = y，
+ * 取目标接地点即检测框底边中点)，批处理器负责换算回整帧坐标。
+ */
+typedef struct {
+    const char *name;
+    int (*init)(void **state, const detector_config_t *config);
+    void (*destroy)(void *state);
+    int (*infer)(void *state, const detector_image_t *images, int count, track_list_t **outputs);
+} detector_backend_t;
+
+/**
+ * @brief 按名称查找内置后端
+ * @return 后端函数表，未找到返回 NULL
+ */
+const detector_backend_t* detector_find_backend(const char *name);
+
+// 内置后端
+extern const detector_backend_t detector_backend_mock;
+#ifdef MEC_WITH_OPENCV
+extern const detector_backend_t detector_backend_opencv_dnn;
+#endif
+
+/**
+ * @brief 跨相机检测批处理器（不透明结构体）
+ */
+typedef struct mec_detect_batcher_t mec_detect_batcher_t;
+
+mec_detect_batcher_t* detect_batcher_create(const detector_config_t *config);
+void detect_batcher_destroy(mec_detect_batcher_t *batcher);
+
+/**
+ * @brief 提交一帧的若干检测窗口并等待结果（可被多个相机线程并发调用）
+ * @param images 检测窗口数组（通常是同一帧的各 ROI 裁剪窗口）
+ * @param output 检测结果追加到该列表，坐标为整帧归一化坐标
+ * @return 0:成功, -1:失败或批处理器已停止
+ */
+int detect_batcher_submit(mec_detect_batcher_t *batcher, const detector_image_t *images, int count,
+                          track_list_t *output);
+
+/**
+ * @brief 统计：推理调用次数与处理的图像数（平均批大小 = images / batches）
+ */
+void detect_batcher_stats(mec_detect_batcher_t *batcher, long *batches, long *images);
+
+#endif // MEC_DETECTOR_H
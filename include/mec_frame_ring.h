@@ -0,0 +1,80 @@
+#ifndef MEC_FRAME_RING_H
+#define MEC_FRAME_RING_H
+
+#include "mec_common.h"
+
+/**
+ * @file mec_frame_ring.h
+ * @brief 预分配帧缓冲环（最新帧优先）
+ *
+ * 连接视频流水线的解码级与检测级。所有帧缓冲在创建时一次性分配，运行期不再
+ * 申请内存。生产者发布新帧时，尚未被取走的旧帧直接回收（计为丢帧），消费者
+ * 总是拿到最新的一帧：检测慢时丢的是过期帧，解码永远不会被拖离实时流。
+ */
+
+typedef struct {
+    uint8_t *data;              // 像素数据（预分配）
+    size_t capacity;            // 缓冲区字节数
+    int width;
+    int height;
+    int stride;                 // 每行字节数
+    int channels;
+    uint64_t seq;               // 解码序号（单调递增）
+    struct timeval capture_time;// 开始抓取该帧的时刻（grab 之前），流水线时延以此为起点
+} video_frame_t;
+
+/**
+ * @brief 帧缓冲环句柄（不透明结构体）
+ */
+typedef struct mec_frame_ring_t mec_frame_ring_t;
+
+/**
+ * @brief 创建帧缓冲环
+ * @param slots 槽位数（至少 3：写入中、待取、处理中各一个）
+ * @param frame_bytes 单帧缓冲区大小
+ * @return 句柄，失败返回 NULL
+ */
+mec_frame_ring_t* frame_ring_create(int slots, size_t frame_bytes);
+void frame_ring_destroy(mec_frame_ring_t *ring);
+
+/**
+ * @brief 生产者：取一个可写槽位（不阻塞）
+ *
+ * 没有空闲槽位时回收尚未被取走的待取帧。
+ * @return 槽位，所有槽位都被消费者占用时返回 NULL
+ */
+video_frame_t* frame_ring_acquire_write(mec_frame_ring_t *ring);
+
+/**
+ * @brief 生产者：发布写好的帧，替换掉尚未被取走的旧帧
+ */
+void frame_ring_publish(mec_frame_ring_t *ring, video_frame_t *frame);
+
+/**
+ * @brief 生产者：放弃已取得的槽位（解码失败时）
+ */
+void frame_ring_cancel(mec_frame_ring_t *ring, video_frame_t *frame);
+
+/**
+ * @brief 消费者：取最新一帧
+ * @param timeout_ms 超时时间（毫秒），-1 表示无限等待
+ * @return 帧，超时或环已关闭返回 NULL
+ */
+video_frame_t* frame_ring_acquire_read(mec_frame_ring_t *ring, int timeout_ms);
+
+/**
+ * @brief 消费者：处理完毕，归还槽位
+ */
+void frame_ring_release(mec_frame_ring_t *ring, video_frame_t *frame);
+
+/**
+ * @brief 关闭帧环，唤醒所有等待中的消费者（停止流水线时调用）
+ */
+void frame_ring_close(mec_frame_ring_t *ring);
+
+/**
+ * @brief 被新帧覆盖而未处理的帧数
+ */
+long frame_ring_dropped(mec_frame_ring_t *ring);
+
+#endif // MEC_FRAME_RING_H
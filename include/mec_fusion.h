@@ -11,8 +11,12 @@ typedef struct {
     double velocity_weight;
     double confidence_threshold;
     int max_track_age;
+    int max_tracks;         // 融合航迹容量，0 取 FUSION_DEFAULT_MAX_TRACKS
 } fusion_config_t;
 
+#define FUSION_DEFAULT_MAX_TRACKS 100
+#define FUSION_TICK_MS 50           // 融合输出周期 (20Hz)
+
 // Kalman filter state
 typedef struct {
     double state[6];      // [x, y, vx, vy, ax, ay]
@@ -32,6 +36,22 @@ typedef struct {
     struct timeval last_update;
 } fused_track_t;
 
+/**
+ * @brief 上游航迹 ID 缓存项
+ *
+ * 雷达和视频跟踪器输出稳定的航迹 ID。(传感器, 上游 ID) 命中缓存时只需校验
+ * 对应融合航迹的距离，跳过对全部融合航迹的关联搜索。
+ */
+#define FUSION_ID_CACHE_SIZE 1024   // 必须为 2 的幂
+#define FUSION_ID_CACHE_PROBES 8
+#define FUSION_ID_CACHE_GATE_SCALE 2.0  // 命中时的放宽门限倍数
+
+typedef struct {
+    uint64_t key;       // (sensor_id << 32) | 上游航迹 ID
+    int global_id;      // 0 表示空槽
+    int index;          // 融合航迹数组下标（航迹删除后可能失效，以 global_id 校验）
+} fusion_id_entry_t;
+
 // Fusion processor context
 typedef struct {
     fusion_config_t config;
@@ -41,8 +61,18 @@ typedef struct {
     int track_capacity;
     int next_global_id;
     track_list_t *output_tracks;
+    fusion_id_entry_t *id_cache;
+    long cache_hits;
+    long cache_misses;
 } fusion_processor_t;
 
+// 融合统计快照（供心跳日志等其他线程读取）
+typedef struct {
+    int track_count;
+    long cache_hits;
+    long cache_misses;
+} fusion_stats_t;
+
 // Fusion module functions
 fusion_processor_t* fusion_processor_create(const fusion_config_t *config);
 void fusion_processor_destroy(fusion_processor_t *processor);
@@ -53,6 +83,25 @@ int fusion_processor_add_tracks(fusion_processor_t *processor,
                                int sensor_id);
 track_list_t* fusion_processor_get_tracks(fusion_processor_t *processor);
 
+/**
+ * @brief 执行一拍融合：预测、航迹管理并刷新输出列表
+ *
+ * 融合线程按 20Hz 调用；未启动线程时（如基准测试）可由调用方直接驱动。
+ */
+int fusion_processor_step(fusion_processor_t *processor);
+
+/**
+ * @brief 在锁内把当前融合输出拷贝到 out，避免读到融合线程写了一半的列表
+ * @return 拷贝的航迹数，-1 表示出错
+ */
+int fusion_processor_snapshot(fusion_processor_t *processor, track_list_t *out);
+
+/**
+ * @brief 在锁内拷贝航迹数与 ID 缓存命中统计
+ * @return 0:成功, -1:参数错误
+ */
+int fusion_processor_get_stats(fusion_processor_t *processor, fusion_stats_t *stats);
+
 // Internal fusion functions
 void* fusion_processing_thread(void *arg);
 int associate_tracks(const track_list_t *sensor_tracks, 
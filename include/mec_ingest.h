@@ -0,0 +1,55 @@
+#ifndef MEC_INGEST_H
+#define MEC_INGEST_H
+
+#include "mec_common.h"
+#include "mec_queue.h"
+#include "mec_thread.h"
+#include "mec_shm_ring.h"
+
+/**
+ * @file mec_ingest.h
+ * @brief 进程外生产者接入桥
+ *
+ * 在 Unix 域套接字上监听，每接入一个生产者进程就为它创建一条共享内存目标环
+ * (见 mec_shm_ring.h) 并把描述符发给对方。桥接线程等待各环的 eventfd，把已
+ * 提交的槽原地包装成 track_list_t 推入目标队列：目标数据不拷贝，融合线程释放
+ * 消息后槽自动归还生产者。生产者断开后，环在最后一条在途消息释放时才解除映射。
+ *
+ * 坐标约定：生产者只需填写 WGS84 position；local（站点 ENU）由桥按 mec_system
+ * 的 [site] 原点在入队前就地计算，生产者写入的 local 会被覆盖。
+ */
+
+#define INGEST_MAX_PRODUCERS 8
+
+typedef struct {
+    char socket_path[108];      // 接入套接字路径
+    int slot_count;             // 每条环的槽数，<=0 使用默认值
+    int slot_tracks;            // 每槽最多目标数，<=0 使用默认值
+    mec_queue_t *target_queue;  // 目标消息队列
+} ingest_config_t;
+
+typedef struct {
+    int producers;              // 当前连接的生产者数
+    long connections;           // 累计接入次数
+    long messages;              // 已入队的消息数
+    long queue_full;            // 目标队列满而丢弃的消息数
+    long invalid;               // 槽头非法（目标数或传感器 ID 越界）而丢弃的消息数
+} ingest_stats_t;
+
+typedef struct mec_ingest_bridge_t mec_ingest_bridge_t;
+
+/**
+ * @brief 绑定接入套接字并启动桥接线程
+ * @return 句柄，失败返回 NULL
+ */
+mec_ingest_bridge_t* ingest_bridge_start(const ingest_config_t *config);
+
+/**
+ * @brief 停止桥接线程、断开所有生产者（在途消息仍然有效）
+ */
+void ingest_bridge_stop(mec_ingest_bridge_t *bridge);
+
+void ingest_bridge_get_stats(mec_ingest_bridge_t *bridge, ingest_stats_t *stats);
+void ingest_bridge_report(mec_ingest_bridge_t *bridge);
+
+#endif // MEC_INGEST_H
@@ -10,11 +10,15 @@ typedef struct {
     long frame_count;
     struct timeval start_time;
     double total_latency_ms;
+    long age_count;           // 本报告周期内的传感器数据龄（采集时刻到融合取出）
+    double total_age_ms;
+    double max_age_ms;
     pthread_mutex_t lock;
 } mec_perf_stats_t;
 
 void metrics_init();
 void metrics_record_frame(double latency_ms);
+void metrics_record_age(double age_ms);   // 消息时间戳到融合取出的时长，即端到端时延
 void metrics_report(); // 输出当前的 FPS 和平均时延
 
 #endif
@@ -12,6 +12,8 @@ typedef struct {
     int sensor_id;            // 传感器ID (1: Video, 2: Radar)
     track_list_t *tracks;     // 目标航迹列表数据（指针所有权由队列管理）
     struct timeval timestamp; // 数据接收到的系统时间戳
+    int frame_width;          // 视频检测消息：该帧实际解码尺寸（像素），其他消息为 0
+    int frame_height;
 } mec_msg_t;
 
 /**
@@ -56,6 +58,16 @@ int mec_queue_push(mec_queue_t *queue, const mec_msg_t *msg);
  */
 int mec_queue_pop(mec_queue_t *queue, mec_msg_t *out_msg, int timeout_ms);
 
+/**
+ * @brief 阻塞到队列被取空或超时
+ *
+ * 供虚拟时钟的驱动者（场景模拟器）在推进时间前等待消费者取走已发布的帧。
+ * 超时按真实时间计：驱动者自身不能作为虚拟时钟的等待者。
+ * @param timeout_ms 最长等待的真实时间（毫秒）
+ * @return 0:队列已空, -1:超时仍有积压
+ */
+int mec_queue_wait_empty(mec_queue_t *queue, int timeout_ms);
+
 /**
  * @brief 获取当前队列中积压的消息数量
  * 
@@ -4,15 +4,59 @@
 #include "mec_common.h"
 #include "mec_queue.h"
 #include "mec_thread.h"
+#include "mec_capture.h"
+
+// 雷达串口帧格式: 0xAA 0x55 + 14 字节数据段 + 1 字节异或校验
+// 数据段 [10..13] 可携带发送端时间戳（墙钟微秒的低 32 位，大端），0 表示不携带
+#define RADAR_FRAME_HEAD1     0xAA
+#define RADAR_FRAME_HEAD2     0x55
+#define RADAR_FRAME_DATA_LEN  14
+#define RADAR_FRAME_LEN       (2 + RADAR_FRAME_DATA_LEN + 1)
+
+#define RADAR_RX_BUF_SIZE     2048
+
+// 发送端时间戳与接收时刻相差超过此值时视为不可信（时钟未同步、回放旧抓包），沿用接收时刻
+#define RADAR_SENSOR_TIME_WINDOW_US 10000000LL
+
+#define RADAR_UDP_BATCH        32    // 单次 recvmmsg 最多接收的数据报数
+#define RADAR_UDP_MAX_DATAGRAM 1500
+
+// 雷达接入方式
+typedef enum {
+    RADAR_TRANSPORT_SERIAL = 0,
+    RADAR_TRANSPORT_UDP = 1,
+    RADAR_TRANSPORT_CAN = 2,
+    RADAR_TRANSPORT_REPLAY = 3   // 从抓包文件回放
+} radar_transport_t;
+
+#define RADAR_CAN_BATCH        64    // 单次 recvmmsg 最多接收的 CAN 帧数
+#define RADAR_CAN_DEFAULT_BASE 0x60A // 目标列表头帧 ID，目标帧 ID 为 base + 1
 
 // Radar configuration
 typedef struct {
+    radar_transport_t transport;
     char device_path[256];
-    int baud_rate;
+    int baud_rate;      // 任意波特率 (通过 termios2/BOTHER 设置)
     int radar_id;
     double range_resolution;
     double angle_resolution;
     double max_range;
+    double mount_east;  // 安装位置: 站点 ENU 东向坐标 (米)
+    double mount_north; // 安装位置: 站点 ENU 北向坐标 (米)
+    double mount_yaw;   // 雷达视轴方位角 (度，自东向逆时针)
+    int vmin;           // 串口 VMIN：一次 read 至少返回的字节数 (0-255)，<0 使用默认值
+    int vtime;          // 串口 VTIME：字节间超时 (单位 0.1s, 0-255)，<0 使用默认值
+    int low_latency;    // 是否尝试开启 ASYNC_LOW_LATENCY
+    char bind_addr[64]; // UDP 监听地址 (如 0.0.0.0)
+    int udp_port;       // UDP 监听端口
+    int rcvbuf_bytes;   // UDP/CAN 套接字接收缓冲区大小 (0 表示系统默认)
+    char can_ifname[16];// SocketCAN 接口名 (如 can0、vcan0)
+    int can_base_id;    // 目标列表头帧 ID (11 位标准帧)
+    char capture_path[256]; // 非空时将原始接收数据写入抓包文件
+    char replay_path[256];  // 回放模式的抓包文件
+    double replay_speed;    // 1.0: 实时, N: N 倍速, 0: 最大速度
+    int replay_loop;        // 回放结束后是否从头循环
+    int sensor_timestamps;  // 1: 采用帧内发送端时间戳 (mec_loadgen 约定)，默认 0 忽略这些字节
     mec_queue_t *target_queue; // 目标消息队列
 } radar_config_t;
 
@@ -24,14 +68,52 @@ typedef struct {
     double velocity;
     double rcs;  // Radar Cross Section
     struct timeval timestamp;
+    uint32_t sensor_stamp_us;   // 帧内携带的发送端时间戳，0 表示无或未启用 sensor_timestamps
 } radar_detection_t;
 
+/**
+ * @brief 串口字节流解析器状态（每个雷达实例独立一份）
+ */
+typedef enum {
+    RADAR_PARSE_IDLE = 0,
+    RADAR_PARSE_HEAD,
+    RADAR_PARSE_DATA,
+    RADAR_PARSE_CHECK
+} radar_parse_state_t;
+
+typedef struct {
+    radar_parse_state_t state;
+    unsigned char frame_buf[RADAR_FRAME_DATA_LEN];
+    int frame_idx;
+    long checksum_errors;
+    int sensor_timestamps;  // 是否解码数据段 [10..13] 的发送端时间戳
+} radar_parser_t;
+
+// UDP 批量接收上下文（定义见 radar_udp.c）
+typedef struct radar_udp_rx_t radar_udp_rx_t;
+
+// CAN 批量接收与周期组包上下文（定义见 radar_can.c）
+typedef struct radar_can_rx_t radar_can_rx_t;
+
 // Radar processing context
 typedef struct {
     radar_config_t config;
     thread_context_t thread_ctx;
     track_list_t *output_tracks;
     int fd;  // File descriptor for radar device
+
+    radar_parser_t parser;
+    unsigned char rx_buf[RADAR_RX_BUF_SIZE]; // 批量读取缓冲区
+    int rx_pos;
+    int rx_len;
+    int rx_ready;               // poll 判定可读后置位，避免 read 在空闲线路上阻塞
+    struct timeval rx_time;     // 本批字节 read 返回的时刻
+    double byte_time_us;        // 单字节线路时间 (8N1 = 10 bit)
+
+    radar_udp_rx_t *udp_rx;     // 仅 UDP 接入时有效
+    radar_can_rx_t *can_rx;     // 仅 CAN 接入（或回放 CAN 记录）时有效
+    mec_capture_t *capture;     // 抓包写入器 (可选)
+    mec_replay_t *replay;       // 仅回放模式有效
 } radar_processor_t;
 
 // Radar module functions
@@ -41,12 +123,49 @@ int radar_processor_start(radar_processor_t *processor);
 void radar_processor_stop(radar_processor_t *processor);
 track_list_t* radar_processor_get_tracks(radar_processor_t *processor);
 
+// Serial port (radar_serial.c)
+int radar_serial_open(const radar_config_t *config);
+
+// UDP transport (radar_udp.c)
+int radar_udp_open(const radar_config_t *config);
+radar_udp_rx_t* radar_udp_rx_create(void);
+void radar_udp_rx_destroy(radar_udp_rx_t *rx);
+int radar_udp_receive(radar_processor_t *processor, track_list_t *batch);
+int radar_decode_datagram(const unsigned char *data, int len, const radar_config_t *config,
+                          const struct timeval *timestamp, track_list_t *batch);
+
+// Capture replay (radar_replay.c)
+int radar_replay_run(radar_processor_t *processor);
+
+// SocketCAN transport (radar_can.c)
+struct can_frame;
+int radar_can_open(const radar_config_t *config);
+radar_can_rx_t* radar_can_rx_create(void);
+void radar_can_rx_destroy(radar_can_rx_t *rx);
+int radar_can_receive(radar_processor_t *processor);
+int radar_can_handle_frame(radar_processor_t *processor, const struct can_frame *frame,
+                           const struct timeval *timestamp);
+
+// Frame parsing
+void radar_parser_reset(radar_parser_t *parser);
+int radar_parser_feed(radar_parser_t *parser, const unsigned char *data, int len,
+                      int *consumed, radar_detection_t *detection);
+int radar_decode_frame(const unsigned char *payload, int with_stamp, radar_detection_t *detection);
+
+/**
+ * @brief 以接收时刻为参照，把 32 位发送端时间戳恢复成完整时间
+ * @return 0:成功, -1:无时间戳或超出 RADAR_SENSOR_TIME_WINDOW_US
+ */
+int radar_sensor_time(uint32_t stamp_us, const struct timeval *reference, struct timeval *out);
+
 // Internal processing functions
 void* radar_processing_thread(void *arg);
+void radar_publish_batch(radar_processor_t *processor, track_list_t *batch);
 int radar_read_data(radar_processor_t *processor, radar_detection_t *detection);
 int radar_convert_to_track(const radar_detection_t *detection, 
                           const radar_config_t *config, 
                           target_track_t *track);
 int radar_polar_to_cartesian(double range, double angle, double *x, double *y);
+radar_transport_t radar_transport_from_string(const char *name);
 
-#endif // MEC_RADAR_H
\ No newline at end of file
+#endif // MEC_RADAR_H
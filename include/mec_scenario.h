@@ -0,0 +1,138 @@
+#ifndef MEC_SCENARIO_H
+#define MEC_SCENARIO_H
+
+#include "mec_common.h"
+
+/**
+ * @file mec_scenario.h
+ * @brief 列式二进制场景文件与回放源
+ *
+ * 文本场景每行一条记录：
+ *   rel_time_ms sensor_id id type latitude longitude velocity heading confidence
+ * 转换后按 (时间, 传感器) 稳定排序，同一时间戳的记录组成一组。文件布局：
+ *   scenario_file_header_t                          128 字节
+ *   scenario_group_index_t[group_count]             按时间升序，用于二分查找定位
+ *   各列数组 (每列 record_count 个元素，起始 64 字节对齐)：
+ *     sensor_id / id / type                         int32
+ *     latitude / longitude / velocity / heading / confidence   double
+ * 多字节字段均为小端。回放时整个文件只读映射，一组记录就是各列上的一段
+ * 连续切片，取组不解析、不分配内存。
+ */
+
+#define SCENARIO_MAGIC "MECSCN\0\0"
+#define SCENARIO_VERSION 1
+#define SCENARIO_FILE_EXT ".msc"
+
+typedef enum {
+    SCENARIO_COL_SENSOR_ID = 0,
+    SCENARIO_COL_ID,
+    SCENARIO_COL_TYPE,
+    SCENARIO_COL_LATITUDE,
+    SCENARIO_COL_LONGITUDE,
+    SCENARIO_COL_VELOCITY,
+    SCENARIO_COL_HEADING,
+    SCENARIO_COL_CONFIDENCE,
+    SCENARIO_COLUMN_COUNT
+} scenario_column_t;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t record_count;
+    uint64_t group_count;
+    uint64_t groups_offset;
+    uint64_t column_offset[SCENARIO_COLUMN_COUNT];
+    uint64_t file_size;
+    uint8_t reserved[16];
+} scenario_file_header_t;
+
+typedef struct {
+    int64_t time_ms;            // 相对场景起点的时间
+    uint32_t first;             // 组内第一条记录的下标
+    uint32_t count;
+} scenario_group_index_t;
+
+/**
+ * @brief 一条待写入场景的记录（文本解析与场景生成共用）
+ */
+typedef struct {
+    int64_t time_ms;
+    int32_t sensor_id;
+    int32_t id;
+    int32_t type;
+    double latitude;
+    double longitude;
+    double velocity;
+    double heading;
+    double confidence;
+    size_t order;               // 输入中的先后，排序时保持稳定
+} scenario_record_t;
+
+/**
+ * @brief 一个时间戳组：各列上的只读切片，指向映射的文件内容
+ */
+typedef struct {
+    int64_t time_ms;
+    int count;
+    const int32_t *sensor_id;
+    const int32_t *id;
+    const int32_t *type;
+    const double *latitude;
+    const double *longitude;
+    const double *velocity;
+    const double *heading;
+    const double *confidence;
+} scenario_group_t;
+
+typedef struct {
+    uint8_t *base;              // 映射的文件或文本转换得到的内存镜像
+    size_t size;
+    int mapped;                 // 1: mmap, 0: malloc
+    const scenario_file_header_t *header;
+    const scenario_group_index_t *groups;
+    uint64_t group_count;
+    uint64_t record_count;
+    uint64_t cursor;            // 下一个要取的组
+} mec_scenario_t;
+
+/**
+ * @brief 打开场景：二进制文件直接只读映射，其他文件按文本格式解析成同样的内存镜像
+ * @return 0:成功, -1:无法打开或格式错误
+ */
+int scenario_open(mec_scenario_t *sc, const char *path);
+void scenario_close(mec_scenario_t *sc);
+
+/**
+ * @brief 由记录数组构建场景镜像（会就地排序 records）
+ * @return 0:成功, -1:内存不足或记录过多
+ */
+int scenario_build(mec_scenario_t *sc, scenario_record_t *records, size_t count);
+
+/**
+ * @brief 按文本格式解析场景（转换工具与文本回放共用）
+ */
+int scenario_load_text(mec_scenario_t *sc, const char *path);
+
+/**
+ * @brief 把场景镜像原样写成二进制文件
+ */
+int scenario_write(const mec_scenario_t *sc, const char *path);
+
+/**
+ * @brief 定位到第一个时间不早于 time_ms 的组
+ */
+void scenario_seek(mec_scenario_t *sc, int64_t time_ms);
+
+/**
+ * @brief 取下一组
+ * @return 0:成功, -1:已到末尾
+ */
+int scenario_next(mec_scenario_t *sc, scenario_group_t *group);
+
+/**
+ * @brief 最后一组的时间（场景时长）
+ */
+int64_t scenario_duration_ms(const mec_scenario_t *sc);
+
+#endif // MEC_SCENARIO_H
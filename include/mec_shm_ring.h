@@ -0,0 +1,116 @@
+#ifndef MEC_SHM_RING_H
+#define MEC_SHM_RING_H
+
+#include "mec_common.h"
+
+/**
+ * @file mec_shm_ring.h
+ * @brief 进程间共享内存目标环
+ *
+ * 神经网络检测器、厂商传感器 SDK 等独立进程通过共享内存把目标写给融合进程。
+ * 每个生产者进程一条环：融合侧用 memfd 创建环、用 eventfd 作通知，经 Unix
+ * 域套接字 (SCM_RIGHTS) 把两个描述符交给生产者。
+ *
+ * 内存布局（全部 64 字节对齐）：
+ *   shm_ring_header_t                       64 字节
+ *   slot[0 .. slot_count-1]，每槽 slot_size 字节：
+ *     shm_slot_header_t                     64 字节
+ *     target_track_t[slot_tracks]           每条 record_size 字节
+ *
+ * 目标记录直接使用 target_track_t 的内存布局（x86_64 / aarch64 Linux 上固定为
+ * 104 字节，各字段偏移在 shm_ring.c 中静态断言），融合侧把槽内记录原地包装成
+ * track_list_t 入队，不拷贝目标数据；消费者释放最后一个引用时槽才归还生产者。
+ *
+ * 每个槽带一个序号，生产者与消费者各自维护单调递增的位置 pos：
+ *   seq == pos          槽空闲，生产者可以写入
+ *   seq == pos + 1      生产者已提交，消费者可以读取
+ *   seq == pos + slots  消费者已归还，进入下一圈
+ * 序号以 release/acquire 语义读写，槽可以乱序归还。环满时生产者丢弃新数据，
+ * 不会阻塞。
+ */
+
+#define SHM_RING_MAGIC 0x4D454352u      // "MECR"
+#define SHM_RING_VERSION 1
+#define SHM_RING_MAX_SLOTS 256
+#define SHM_RING_MAX_SLOT_TRACKS 1024
+#define SHM_RING_DEFAULT_SLOTS 16
+#define SHM_RING_DEFAULT_SLOT_TRACKS 128
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_tracks;       // 每槽最多目标数
+    uint32_t record_size;       // sizeof(target_track_t)，附加时校验双方 ABI 一致
+    uint32_t slot_size;         // 每槽字节数（含槽头）
+    uint8_t reserved[40];
+} shm_ring_header_t;
+
+typedef struct {
+    uint64_t seq;               // 槽序号，见文件说明
+    int32_t sensor_id;          // 入队消息的传感器 ID (1..31)
+    int32_t count;              // 本槽目标数
+    int64_t tv_sec;             // 数据采集时间
+    int64_t tv_usec;
+    uint8_t reserved[32];
+} shm_slot_header_t;
+
+/**
+ * @brief 一端（生产者或消费者）对环的映射与本地状态
+ */
+typedef struct {
+    int mem_fd;
+    int event_fd;
+    int sock_fd;                // 生产者与融合进程之间的连接，断开即表示生产者退出
+    uint8_t *base;
+    size_t size;
+    shm_ring_header_t *header;
+    uint32_t slot_count;        // 布局参数的本地副本：对端改写共享头部不影响本进程的寻址
+    uint32_t slot_tracks;
+    uint32_t slot_size;
+    uint64_t position;          // 生产者：下一个写入位置；消费者：下一个读取位置
+    long dropped;               // 生产者：环满丢弃的次数
+} shm_ring_t;
+
+/**
+ * @brief 融合侧：创建环 (memfd + eventfd)
+ * @param slot_count 槽数，<=0 使用默认值
+ * @param slot_tracks 每槽最多目标数，<=0 使用默认值
+ * @return 0:成功, -1:失败
+ */
+int shm_ring_create(shm_ring_t *ring, int slot_count, int slot_tracks);
+
+/**
+ * @brief 生产者侧：连接融合进程的接入套接字，接收并映射一条新环
+ * @return 0:成功, -1:连接失败或环布局不兼容
+ */
+int shm_ring_connect(shm_ring_t *ring, const char *socket_path);
+
+/**
+ * @brief 解除映射并关闭描述符
+ */
+void shm_ring_close(shm_ring_t *ring);
+
+static inline shm_slot_header_t* shm_ring_slot(const shm_ring_t *ring, uint64_t position) {
+    size_t index = (size_t)(position % ring->slot_count);
+    return (shm_slot_header_t*)(ring->base + sizeof(shm_ring_header_t) + index * ring->slot_size);
+}
+
+static inline target_track_t* shm_slot_tracks(shm_slot_header_t *slot) {
+    return (target_track_t*)((uint8_t*)slot + sizeof(shm_slot_header_t));
+}
+
+/**
+ * @brief 生产者：取得下一个空闲槽的目标数组，直接在其中填写目标
+ * @param capacity 输出本槽最多可写的目标数
+ * @return 目标数组，环满时返回 NULL（计入 dropped）
+ */
+target_track_t* shm_ring_begin(shm_ring_t *ring, int *capacity);
+
+/**
+ * @brief 生产者：提交 shm_ring_begin 取得的槽并通知消费者
+ * @return 0:成功, -1:参数错误
+ */
+int shm_ring_commit(shm_ring_t *ring, int sensor_id, int count, const struct timeval *timestamp);
+
+#endif // MEC_SHM_RING_H
@@ -2,19 +2,34 @@
 #define MEC_SIMULATOR_H
 
 #include "mec_common.h"
+#include "mec_queue.h"
 #include "mec_thread.h"
 
+/**
+ * @brief 场景回放模拟器
+ *
+ * 与真实传感器一样作为消息队列的生产者：场景中同一时间戳、同一传感器的记录
+ * 合成一帧，按场景时间（乘以回放倍速）推送为一条消息，融合侧走的是与生产
+ * 环境完全相同的路径。
+ *
+ * virtual_clock 打开时模拟器驱动系统时钟（见 mec_clock.h）：不再按真实时间等待，
+ * 每组先等上一组被消费完，再把虚拟时间推进到该组的场景时间，长场景可以远快于
+ * 实时且确定地回放。
+ */
+
 typedef struct {
     char data_path[256];
     double playback_speed;
     int loop;
+    int virtual_clock;         // 1: 以场景时间驱动虚拟时钟，忽略 playback_speed
+    mec_queue_t *target_queue; // 目标消息队列
 } simulator_config_t;
 
 typedef struct {
     simulator_config_t config;
     thread_context_t thread_ctx;
-    track_list_t *video_tracks;
-    track_list_t *radar_tracks;
+    long frames_published;     // 已入队的帧数
+    long frames_dropped;       // 队列满或传感器 ID 越界而丢弃的帧数
 } mec_simulator_t;
 
 mec_simulator_t* simulator_create(const simulator_config_t *config);
@@ -22,10 +37,6 @@ void simulator_destroy(mec_simulator_t *sim);
 int simulator_start(mec_simulator_t *sim);
 void simulator_stop(mec_simulator_t *sim);
 
-// Get the current simulated tracks
-track_list_t* simulator_get_video_tracks(mec_simulator_t *sim);
-track_list_t* simulator_get_radar_tracks(mec_simulator_t *sim);
-
 // Internal thread function
 void* simulator_thread(void *arg);
 
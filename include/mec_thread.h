@@ -13,6 +13,12 @@ typedef struct {
 } thread_context_t;
 
 // 线程相关函数声明
+// thread_create = thread_context_init + thread_start，thread_destroy = thread_stop + thread_context_cleanup；
+// 需要在线程启动前/停止后仍使用锁的模块分开调用
+int thread_context_init(thread_context_t *ctx);
+void thread_context_cleanup(thread_context_t *ctx);
+int thread_start(thread_context_t *ctx, void *(*start_routine)(void*), void *arg);
+void thread_stop(thread_context_t *ctx);
 int thread_create(thread_context_t *ctx, void *(*start_routine)(void*), void *arg);
 void thread_destroy(thread_context_t *ctx);
 void thread_lock(thread_context_t *ctx);
@@ -2,6 +2,7 @@
 #define MEC_V2X_H
 
 #include <stdint.h>  // 添加标准整数类型定义
+#include <sys/uio.h>
 #include "mec_common.h"
 
 /**
@@ -9,24 +10,46 @@
  * @brief V2X 标准消息封装（参考 GB/T 31024 / J2735）
  * 
  * 本模块负责将融合后的目标航迹转换为标准的路侧安全消息 (RSM)。
+ * 线格式一律大端逐字节写出，不依赖结构体布局与对齐；一条 RSM 按 MTU
+ * 切分为若干分段，每段自带分段头，接收端按 (device_id, msg_seq) 重组。
  */
 
+#define V2X_MAGIC 0x56
 #define V2X_MSG_RSM 0x01
-#define V2X_PROTOCOL_VER 0x01
+#define V2X_PROTOCOL_VER 0x02
+
+#define V2X_SEGMENT_HEADER_LEN 26   // 分段头线格式长度（字节）
+#define V2X_PARTICIPANT_LEN 16      // 单个目标线格式长度（字节）
+#define V2X_DEFAULT_MTU 1400        // 单个数据报载荷上限，留出 IP/UDP 头余量
+#define V2X_MAX_PARTICIPANTS 65535  // 计数字段为 16 位
+
+#define V2X_FLAG_LAST_SEGMENT 0x01
 
 /**
- * @brief V2X 消息头部 (简化的标准头)
+ * @brief V2X 分段头（解码后的主机序视图）
+ *
+ * 线格式: magic(1) version(1) msg_type(1) flags(1) device_id(4) timestamp(8)
+ *         msg_seq(2) seg_index(2) seg_count(2) total(2) count(2)
  */
 typedef struct {
     uint8_t magic;      // 魔数，标识 V2X 包
     uint8_t version;    // 协议版本
     uint8_t msg_type;   // 消息类型 (例如 RSM)
+    uint8_t flags;      // V2X_FLAG_*
     uint32_t device_id; // RSU 设备 ID
     uint64_t timestamp; // 毫秒级时间戳
-} v2x_header_t;
+    uint16_t msg_seq;   // 消息序号，同一条 RSM 的各分段相同
+    uint16_t seg_index; // 分段序号，从 0 开始
+    uint16_t seg_count; // 本消息分段总数
+    uint16_t total;     // 本消息目标总数
+    uint16_t count;     // 本分段目标数
+} v2x_segment_header_t;
 
 /**
- * @brief 标准目标描述 (用于 RSM 消息体)
+ * @brief 标准目标描述 (RSM 消息体，解码后的主机序视图)
+ *
+ * 线格式: target_id(2) type(1) lat(4) lon(4) speed(2) heading(2) confidence(1)
+ * target_id 取航迹 ID 的低 16 位（超出时回绕并告警一次）
  */
 typedef struct {
     uint16_t target_id;
@@ -34,19 +57,78 @@ typedef struct {
     int32_t lat;        // 纬度 (单位: 1e-7 度)
     int32_t lon;        // 经度 (单位: 1e-7 度)
     uint16_t speed;     // 速度 (单位: 0.02 m/s)
-    uint16_t heading;   // 航向 (单位: 0.0125 度)
+    uint16_t heading;   // 航向 (单位: 0.0125 度, 0-360)
     uint8_t confidence; // 置信度 (0-200, 映射到 0-100%)
 } v2x_rsm_participant_t;
 
 /**
- * @brief 序列化函数：将航迹列表转换为二进制 V2X 包
+ * @brief 分段 RSM 编码器
+ *
+ * 目标体一次性编码进连续区，分段头各占一小块；第 i 段由 iov[2i]（分段头）
+ * 与 iov[2i+1]（连续区中的一段切片）组成，可直接交给 sendmsg/sendmmsg，
+ * 分段时不再拷贝目标数据。缓冲按容量预分配，超出时按需扩容。
+ */
+typedef struct {
+    uint32_t rsu_id;
+    int mtu;                   // 单个分段（分段头 + 目标体）字节上限
+    int per_segment;           // 每段可容纳的目标数
+    uint16_t msg_seq;          // 下一条消息的序号
+    uint8_t *body;             // 目标体连续区
+    int body_capacity;         // 连续区可容纳的目标数
+    uint8_t *headers;          // 分段头区，每段 V2X_SEGMENT_HEADER_LEN 字节
+    struct iovec *iov;         // 每段两个 iovec
+    int segment_capacity;
+} v2x_encoder_t;
+
+/**
+ * @brief 创建分段编码器
+ *
+ * @param rsu_id 本机 RSU 标识
+ * @param mtu 单个分段字节上限，<= 0 时取 V2X_DEFAULT_MTU；至少能容纳一个目标
+ * @param max_participants 预分配的目标容量
+ * @return 编码器指针，失败返回 NULL
+ */
+v2x_encoder_t* v2x_encoder_create(uint32_t rsu_id, int mtu, int max_participants);
+
+/**
+ * @brief 销毁分段编码器
+ */
+void v2x_encoder_destroy(v2x_encoder_t *enc);
+
+/**
+ * @brief 将航迹快照编码为按 MTU 切分的 RSM 分段
+ *
+ * 空列表也输出一个只含分段头的分段，作为心跳。返回的 iovec 指向编码器
+ * 内部缓冲，在下一次编码或销毁前有效。
+ *
+ * @param enc 编码器
+ * @param tracks 融合后的航迹快照
+ * @param iov_out 输出 iovec 数组（2 * 分段数 个元素）
+ * @return 分段数，-1:出错或目标数超过 V2X_MAX_PARTICIPANTS
+ */
+int v2x_encode_rsm_segments(v2x_encoder_t *enc, const track_list_t *tracks, const struct iovec **iov_out);
+
+/**
+ * @brief 序列化函数：将航迹列表编码为单个 V2X 分段（不切分）
  * 
  * @param tracks 融合后的航迹列表
  * @param rsu_id 本机 RSU 标识
  * @param out_buf 输出缓冲区
  * @param out_len 输入为缓冲区大小，输出为实际写入长度
- * @return 0:成功, -1:空间不足或出错
+ * @return 0:成功, -1:空间不足或出错（不做截断）
  */
 int v2x_encode_rsm(const track_list_t *tracks, uint32_t rsu_id, uint8_t *out_buf, int *out_len);
 
+/**
+ * @brief 解析分段头
+ *
+ * @return 0:成功, -1:长度不足、魔数或版本不符、目标数与长度不一致
+ */
+int v2x_decode_segment_header(const uint8_t *buf, int len, v2x_segment_header_t *hdr);
+
+/**
+ * @brief 解析分段中的第 index 个目标（调用前须先通过 v2x_decode_segment_header 校验）
+ */
+void v2x_decode_participant(const uint8_t *segment, int index, v2x_rsm_participant_t *p);
+
 #endif // MEC_V2X_H
@@ -4,6 +4,19 @@
 #include "mec_common.h"
 #include "mec_queue.h"
 #include "mec_thread.h"
+#include "mec_frame_ring.h"
+#include "mec_video_transform.h"
+#include "mec_video_roi.h"
+#include "mec_video_tracker.h"
+#include "mec_video_rate.h"
+#include "mec_video_propagate.h"
+#include "mec_video_motion.h"
+#include "mec_video_tiles.h"
+#include "mec_detector.h"
+
+#define VIDEO_RING_SLOTS 4        // 帧缓冲环槽位数
+#define VIDEO_DETECT_QUEUE_SIZE 4 // 检测级 -> 后处理级的航迹队列容量
+#define VIDEO_STATS_REPORT_FRAMES 300
 
 // Video stream configuration
 typedef struct {
@@ -13,11 +26,24 @@ typedef struct {
     int fps;
     int camera_id;
     mec_queue_t *target_queue; // 目标消息队列
+    mec_detect_batcher_t *detector; // 共享的检测批处理器
+    int latency_budget_ms;     // 端到端时延预算，<=0 使用默认值
+    int max_detect_interval_ms; // 降频时检测间隔上限，<=0 使用默认值
+    double keyframe_hz;        // 完整检测频率，<=0 表示每帧都完整检测
+    int propagate_patch_px;    // 传播模板像素边长，<=0 使用默认值
+    double propagate_min_score; // 匹配分数低于此值时提前重新检测
+    int motion_gate;           // 1: 静止画面跳过检测、局部运动只检测运动区域
+    int motion_threshold;      // 灰度变化阈值 (1..255)，<=0 使用默认值
+    int motion_refresh_ms;     // 最长多久强制整帧检测一次
+    int tile_size;             // 检测区域切块边长 (像素)，<=0 不切块
+    int tile_overlap;          // 相邻块重叠宽度 (像素)
+    int tile_merge_px;         // 块间重复检测的合并半径 (像素)
 } video_config_t;
 
 // Perspective transformation parameters
 typedef struct {
-    double matrix[9];  // 3x3 transformation matrix
+    double matrix[9];  // 3x3 transformation matrix (去畸变像素 -> 站点 ENU)
+    lens_distortion_t lens;  // 镜头畸变，未启用时直接对原始像素应用单应矩阵
     int calibrated;
 } perspective_transform_t;
 
@@ -28,13 +54,57 @@ typedef struct {
     image_coord_t points[10];  // Max 10 points for polygon
 } detection_region_t;
 
+// Pipeline stages: 时延均从开始读取该帧（grab 之前）的时刻算起
+typedef enum {
+    VIDEO_STAGE_DECODE = 0,   // 抓取、解码完成并写入缓冲环
+    VIDEO_STAGE_DETECT,       // 检测完成
+    VIDEO_STAGE_PUBLISH,      // 跟踪、坐标变换后推入目标队列
+    VIDEO_STAGE_COUNT
+} video_stage_t;
+
+typedef struct {
+    long frames;
+    double total_ms;
+    double max_ms;
+} video_stage_stat_t;
+
+typedef struct {
+    video_stage_stat_t stages[VIDEO_STAGE_COUNT];
+    long frames_decoded;
+    long frames_dropped;      // 被更新的帧覆盖、未经检测的帧
+    long keyframes;           // 完整检测的帧
+    long frames_propagated;   // 由关键帧结果传播的帧
+    long early_redetects;     // 因匹配变差提前进行的完整检测
+    long frames_static;       // 画面静止、沿用上次结果的帧
+    long frames_partial;      // 只检测运动区域的帧
+    pthread_mutex_t lock;
+} video_pipeline_stats_t;
+
 // Video processing context
 typedef struct {
     video_config_t config;
     perspective_transform_t transform;
-    detection_region_t regions[4];  // Max 4 regions
+    detection_region_t regions[VIDEO_MAX_REGIONS];
     int region_count;
-    thread_context_t thread_ctx;
+    roi_set_t roi;                   // 区域掩码与检测裁剪窗口（添加区域时光栅化）
+    int tile_size_warned;            // 最近一次告警的自动放大块边长，-1 表示未告警（仅检测级访问）
+    pthread_mutex_t config_lock;     // 保护 transform/undistort/regions/roi，随处理器创建与销毁，与线程启停无关
+    thread_context_t detect_ctx;     // 检测级
+    thread_context_t publish_ctx;    // 后处理级（跟踪、坐标变换、推送）
+    mec_frame_ring_t *frame_ring;    // 解码（相机管理器的工作线程） -> 检测
+    uint64_t frame_seq;              // 仅由当前持有本路流的解码线程递增
+    mec_queue_t *detect_queue;       // 检测 -> 后处理
+    video_pipeline_stats_t stats;
+    undistort_map_t *undistort;      // 去畸变查找表（设置标定参数时构建）
+    video_tracker_t tracker;         // 本路相机的跟踪状态与 ID 分配（仅后处理级访问）
+    video_rate_controller_t rate;    // 按时延预算决定检测哪些帧
+    frame_propagator_t propagator;   // 关键帧之间的结果传播（仅检测级访问）
+    struct timeval last_keyframe;
+    int has_keyframe;
+    motion_gate_t motion;            // 运动门控（仅检测级访问）
+    track_list_t *last_detections;   // 最近一次检测结果，静止区域沿用
+    struct timeval last_full_detect;
+    int has_full_detect;
     track_list_t *output_tracks;
 } video_processor_t;
 
@@ -47,15 +117,46 @@ int video_processor_set_transform(video_processor_t *processor, const perspectiv
 int video_processor_add_region(video_processor_t *processor, const detection_region_t *region);
 track_list_t* video_processor_get_tracks(video_processor_t *processor);
 
+// Frame ingest: 解码由相机管理器的共享线程池完成，帧经以下接口写入处理器
+/**
+ * @brief 取一个空闲槽位供解码写入，无可用槽位时返回 NULL
+ */
+video_frame_t* video_processor_acquire_frame(video_processor_t *processor);
+/**
+ * @brief 编号并发布给检测级，同时记录解码统计
+ *
+ * frame->capture_time 须由调用方在抓取前写入；发布后帧归检测级所有，调用方不得再访问。
+ */
+void video_processor_submit_frame(video_processor_t *processor, video_frame_t *frame);
+void video_processor_cancel_frame(video_processor_t *processor, video_frame_t *frame);
+long video_processor_frames_dropped(video_processor_t *processor);
+
 // Coordinate transformation
+// 标定矩阵将像素映射到站点 ENU 平面 (米)；WGS84 版本仅用于边界输出
+int transform_image_to_enu(const perspective_transform_t *transform,
+                           const image_coord_t *image_coord,
+                           enu_coord_t *enu_coord);
 int transform_image_to_wgs84(const perspective_transform_t *transform, 
                            const image_coord_t *image_coord, 
                            wgs84_coord_t *wgs84_coord);
+/**
+ * @brief 一次变换整帧检测结果：归一化坐标 -> 浮点像素 -> 去畸变 -> 站点 ENU
+ * @param undistort 去畸变查找表，可为 NULL；须按 width x height 构建
+ * @param width/height 该帧实际解码尺寸（像素），与标定所用像素空间一致
+ * @return 成功变换的航迹数，未标定返回 -1；变换失败的航迹从列表中剔除，count 随之减小
+ */
+int transform_tracks_to_enu(const perspective_transform_t *transform, const undistort_map_t *undistort,
+                            track_list_t *tracks, int width, int height);
+
+// Pipeline statistics
+void video_stats_init(video_pipeline_stats_t *stats);
+void video_stats_destroy(video_pipeline_stats_t *stats);
+void video_stats_record(video_pipeline_stats_t *stats, video_stage_t stage, const struct timeval *capture_time);
+void video_stats_report(video_pipeline_stats_t *stats, int camera_id);
 
 // Internal processing functions
-void* video_processing_thread(void *arg);
+void* video_detect_thread(void *arg);
+void* video_publish_thread(void *arg);
 int process_video_frame(video_processor_t *processor, const void *frame_data);
-int detect_targets(const void *frame_data, int width, int height, track_list_t *tracks);
-int track_targets(track_list_t *previous_tracks, track_list_t *current_tracks);
 
 #endif // MEC_VIDEO_H
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef MEC_VIDEO_MOTION_H
+#define MEC_VIDEO_MOTION_H
+
+#include "mec_common.h"
+#include "mec_frame_ring.h"
+#include "mec_video_roi.h"
+
+/**
+ * @file mec_video_motion.h
+ * @brief 检测前的运动门控
+ *
+ * 每帧按 MOTION_SAMPLE_STEP 抽稀成灰度图，与滑动平均背景逐点求差（SSE2 每次
+ * 16 点），按 16x16 采样点（即 64x64 像素）分块统计变化点数。没有活动块时
+ * 检测级可以跳过检测、沿用上一次结果；只有少数活动块时只检测这些块
+ * （外扩一块后按连通域合并成矩形）；大面积变化（光照突变、镜头抖动）
+ * 和背景建立期间要求整帧检测。
+ */
+
+#define MOTION_SAMPLE_STEP 4            // 抽稀步长 (像素)
+#define MOTION_TILE_SAMPLES 16          // 每块边长 (采样点)
+#define MOTION_TILE_PX (MOTION_SAMPLE_STEP * MOTION_TILE_SAMPLES)
+#define MOTION_DEFAULT_THRESHOLD 20     // 灰度变化阈值
+#define MOTION_MIN_CHANGED 8            // 块内变化点数达到此值视为活动块 (共 256 点)
+#define MOTION_FULL_RATIO 0.5           // 活动块占比超过此值时整帧检测
+#define MOTION_WARMUP_FRAMES 8          // 背景建立所需帧数
+
+typedef enum {
+    MOTION_NONE = 0,        // 画面静止
+    MOTION_PARTIAL,         // 只有 regions 中的区域有运动
+    MOTION_FULL             // 需要整帧检测
+} motion_result_t;
+
+typedef struct {
+    int frame_width;
+    int frame_height;
+    int gray_width;         // 抽稀后宽度，补齐到整块
+    int gray_height;
+    int tiles_x;
+    int tiles_y;
+    uint8_t *gray;          // 当前帧灰度 (gray_height * gray_width)
+    uint8_t *background;
+    uint8_t *active;        // tiles_y * tiles_x
+    uint8_t *visited;       // 连通域标记暂存
+    int *stack;             // 连通域搜索栈
+    int threshold;
+    int warmup;             // 剩余背景建立帧数
+    int active_tiles;
+    roi_rect_t regions[VIDEO_MAX_REGIONS];  // MOTION_PARTIAL 时的待检测区域 (像素)
+    int region_count;
+} motion_gate_t;
+
+/**
+ * @param threshold 灰度变化阈值 (1..255)，<=0 使用默认值，超过 255 按 255
+ */
+void motion_gate_init(motion_gate_t *gate, int threshold);
+void motion_gate_destroy(motion_gate_t *gate);
+
+/**
+ * @brief 用新帧更新背景并判断运动情况（画面尺寸变化时自动重建）
+ */
+motion_result_t motion_gate_update(motion_gate_t *gate, const video_frame_t *frame);
+
+/**
+ * @brief 归一化画面坐标点是否落在活动块内
+ */
+int motion_gate_point_active(const motion_gate_t *gate, double x, double y);
+
+#endif // MEC_VIDEO_MOTION_H
@@ -0,0 +1,58 @@
+#ifndef MEC_VIDEO_PROPAGATE_H
+#define MEC_VIDEO_PROPAGATE_H
+
+#include "mec_common.h"
+#include "mec_frame_ring.h"
+
+/**
+ * @file mec_video_propagate.h
+ * @brief 关键帧之间的检测结果传播
+ *
+ * 关键帧上完整检测后，为每个目标在接地点上方取一块灰度模板（按采样步长
+ * 抽稀到 PROPAGATE_TEMPLATE x PROPAGATE_TEMPLATE）。后续帧在上一位置周围
+ * ±PROPAGATE_SEARCH 个采样步长内做 SAD 匹配（SSE2 每行一条 psadbw），
+ * 把接地点平移到最佳匹配处。匹配质量按平均灰度差折算为分数，
+ * 任一目标低于阈值时由调用方提前重新检测。
+ */
+
+#define PROPAGATE_MAX_TARGETS 64
+#define PROPAGATE_TEMPLATE 16           // 模板边长 (采样点，SSE2 一行正好 16 字节)
+#define PROPAGATE_SEARCH 8              // 搜索半径 (采样步长)
+#define PROPAGATE_DEFAULT_PATCH 48      // 模板覆盖的像素边长
+#define PROPAGATE_DEFAULT_MIN_SCORE 0.5
+#define PROPAGATE_MAD_LIMIT 40.0        // 平均灰度差达到此值时分数为 0
+
+typedef struct {
+    target_track_t track;               // 最近一次传播后的目标（归一化接地点）
+    uint8_t tmpl[PROPAGATE_TEMPLATE * PROPAGATE_TEMPLATE];
+    double key_confidence;              // 关键帧上的检测置信度
+} propagate_target_t;
+
+typedef struct {
+    propagate_target_t targets[PROPAGATE_MAX_TARGETS];
+    int count;
+    int patch_px;
+    double min_score;
+    int step;                           // 当前关键帧使用的采样步长 (像素)
+    int frame_width;
+    int frame_height;
+} frame_propagator_t;
+
+/**
+ * @param patch_px 模板覆盖的像素边长，<=0 使用默认值
+ * @param min_score 低于此匹配分数时要求重新检测，<=0 使用默认值
+ */
+void propagator_init(frame_propagator_t *prop, int patch_px, double min_score);
+
+/**
+ * @brief 关键帧：记录检测结果并抽取模板
+ */
+void propagator_reset(frame_propagator_t *prop, const video_frame_t *frame, const track_list_t *detections);
+
+/**
+ * @brief 非关键帧：把关键帧目标传播到本帧，写入 output
+ * @return 0:成功, -1:无关键帧、画面尺寸变化或有目标匹配分数过低（应重新检测）
+ */
+int propagator_track(frame_propagator_t *prop, const video_frame_t *frame, track_list_t *output);
+
+#endif // MEC_VIDEO_PROPAGATE_H
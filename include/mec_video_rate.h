@@ -0,0 +1,88 @@
+#ifndef MEC_VIDEO_RATE_H
+#define MEC_VIDEO_RATE_H
+
+#include "mec_common.h"
+
+/**
+ * @file mec_video_rate.h
+ * @brief 检测帧率自适应控制
+ *
+ * 以端到端时延预算（帧解码 -> 推送目标队列）为目标，决定检测级处理哪些帧：
+ *   1. 过期帧：帧龄加上预计检测耗时已超出预算，直接丢弃；
+ *   2. 限速：两次检测的帧间隔小于当前检测间隔时跳过；
+ *   3. 间隔按 AIMD 调整：时延均值超出预算或后处理队列积压时乘性放大，
+ *      时延低于预算的 VIDEO_RATE_RECOVER_RATIO 时逐步缩小，负载下降后恢复满帧率。
+ */
+
+#define VIDEO_RATE_DEFAULT_BUDGET_MS 200
+#define VIDEO_RATE_DEFAULT_MAX_INTERVAL_MS 1000  // 最低检测频率 1Hz
+#define VIDEO_RATE_EWMA_ALPHA 0.2
+#define VIDEO_RATE_BACKOFF 1.5                   // 超预算时间隔放大倍数
+#define VIDEO_RATE_RECOVER_FACTOR 0.8            // 恢复时每帧间隔缩小比例
+#define VIDEO_RATE_RECOVER_FLOOR_MS 5.0          // 间隔低于此值时恢复为逐帧检测
+#define VIDEO_RATE_RECOVER_RATIO 0.6
+#define VIDEO_RATE_QUEUE_HIGH 2                  // 后处理队列积压阈值
+
+typedef enum {
+    VIDEO_RATE_PROCESS = 0,
+    VIDEO_RATE_SKIP_STALE,      // 已超出时延预算
+    VIDEO_RATE_SKIP_RATE        // 按当前检测间隔限速
+} video_rate_decision_t;
+
+typedef struct {
+    double interval_ms;         // 当前检测间隔（0 表示每帧都检测）
+    double latency_ms;          // 端到端时延 EWMA
+    double detect_ms;           // 检测耗时 EWMA
+    double budget_ms;
+    long frames_processed;
+    long frames_skipped_stale;
+    long frames_skipped_rate;
+    long backoffs;              // 间隔放大次数
+} video_rate_metrics_t;
+
+typedef struct {
+    double budget_ms;
+    double max_interval_ms;
+    double interval_ms;
+    double latency_ms;
+    double detect_ms;
+    int has_detect;
+    int has_latency;
+    struct timeval last_processed;  // 上一个检测帧的解码时刻
+    int has_processed;
+    long frames_processed;
+    long frames_skipped_stale;
+    long frames_skipped_rate;
+    long backoffs;
+    int cooldown;               // 距下一次允许放大还需的反馈帧数
+    pthread_mutex_t lock;       // 检测级决策、后处理级反馈、统计读取并发访问
+} video_rate_controller_t;
+
+/**
+ * @param budget_ms 端到端时延预算，<=0 使用默认值
+ * @param max_interval_ms 检测间隔上限，<=0 使用默认值
+ */
+void video_rate_init(video_rate_controller_t *rc, int budget_ms, int max_interval_ms);
+void video_rate_destroy(video_rate_controller_t *rc);
+
+/**
+ * @brief 检测级取到一帧后决定是否处理
+ * @param capture_time 帧抓取时刻
+ * @param queue_depth 后处理队列当前深度
+ */
+video_rate_decision_t video_rate_decide(video_rate_controller_t *rc, const struct timeval *capture_time,
+                                        int queue_depth);
+
+/**
+ * @brief 检测级反馈单帧检测耗时（用于预判帧是否会超出预算）
+ */
+void video_rate_record_detect(video_rate_controller_t *rc, double detect_ms);
+
+/**
+ * @brief 后处理级反馈单帧端到端时延，调整检测间隔
+ */
+void video_rate_feedback(video_rate_controller_t *rc, double latency_ms);
+
+void video_rate_get_metrics(video_rate_controller_t *rc, video_rate_metrics_t *metrics);
+
+#endif // MEC_VIDEO_RATE_H
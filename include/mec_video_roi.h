@@ -0,0 +1,80 @@
+#ifndef MEC_VIDEO_ROI_H
+#define MEC_VIDEO_ROI_H
+
+#include "mec_common.h"
+
+/**
+ * @file mec_video_roi.h
+ * @brief 检测区域 (ROI) 掩码
+ *
+ * 每个多边形区域在添加时光栅化一次：只在其外接矩形范围内保存逐像素位图，
+ * 运行期判断一个检测点是否在道路区域内只需一次位测试。各区域外接矩形合并后
+ * 作为检测器的裁剪窗口，检测器只处理 ROI 覆盖的像素。
+ */
+
+#define VIDEO_MAX_REGIONS 4
+
+typedef struct {
+    int x;
+    int y;
+    int width;
+    int height;
+} roi_rect_t;
+
+/**
+ * @brief 单个区域的位图掩码（仅覆盖外接矩形）
+ */
+typedef struct {
+    roi_rect_t bbox;
+    int row_bytes;      // 每行字节数 (bbox.width 向上取整到 8 的倍数 / 8)
+    uint8_t *bits;      // 1 位/像素，行优先
+} roi_mask_t;
+
+/**
+ * @brief 一路相机的全部区域及检测裁剪窗口
+ */
+typedef struct {
+    int frame_width;    // 掩码对应的画面尺寸
+    int frame_height;
+    roi_mask_t masks[VIDEO_MAX_REGIONS];
+    int mask_count;
+    roi_rect_t crops[VIDEO_MAX_REGIONS];   // 合并后互不重叠的外接矩形
+    int crop_count;
+} roi_set_t;
+
+void roi_set_init(roi_set_t *set, int frame_width, int frame_height);
+void roi_set_clear(roi_set_t *set);
+
+/**
+ * @brief 光栅化一个多边形区域并加入集合，同时更新裁剪窗口
+ * @return 0:成功, -1:区域已满/多边形无效/与画面无交集
+ */
+int roi_set_add_polygon(roi_set_t *set, const image_coord_t *points, int point_count);
+
+/**
+ * @brief 像素点是否落在任一区域内（未配置区域时视为全画面有效）
+ */
+static inline int roi_set_contains(const roi_set_t *set, int x, int y) {
+    if (set->mask_count == 0) return 1;
+    for (int i = 0; i < set->mask_count; i++) {
+        const roi_mask_t *m = &set->masks[i];
+        int lx = x - m->bbox.x;
+        int ly = y - m->bbox.y;
+        if ((unsigned)lx >= (unsigned)m->bbox.width || (unsigned)ly >= (unsigned)m->bbox.height) continue;
+        if (m->bits[ly * m->row_bytes + (lx >> 3)] & (1u << (lx & 7))) return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 就地剔除区域外的检测（检测坐标为归一化画面坐标）
+ * @return 剔除的数量
+ */
+int roi_filter_tracks(const roi_set_t *set, track_list_t *tracks);
+
+/**
+ * @brief 裁剪窗口覆盖的像素占整幅画面的比例
+ */
+double roi_set_coverage(const roi_set_t *set);
+
+#endif // MEC_VIDEO_ROI_H
@@ -0,0 +1,58 @@
+#ifndef MEC_VIDEO_SOURCE_H
+#define MEC_VIDEO_SOURCE_H
+
+#include "mec_common.h"
+#include "mec_frame_ring.h"
+
+/**
+ * @file mec_video_source.h
+ * @brief 视频源抽象
+ *
+ * 按 URL 选择实现：
+ *   test://WxH          合成测试图案（无需任何外部依赖，用于联调与压测）
+ *   rtsp://... / 文件路径 OpenCV VideoCapture（需 MEC_WITH_OPENCV）
+ * read 直接解码到帧缓冲环的槽位中；skip 只解复用不输出，用于落后时追帧。
+ */
+
+typedef struct video_source_t video_source_t;
+
+typedef struct {
+    const char *name;
+    int (*read)(video_source_t *src, video_frame_t *frame);  // 0:成功, -1:出错或流结束
+    int (*skip)(video_source_t *src);                         // 丢弃一帧
+    void (*close)(video_source_t *src);
+} video_source_ops_t;
+
+/**
+ * @brief 视频源基类（各实现把它作为结构体第一个成员）
+ */
+struct video_source_t {
+    const video_source_ops_t *ops;
+    int live;               // 1:实时流 (RTSP 等，读取阻塞到下一帧，不另行节拍), 0:文件/合成源（由调用方按帧率节拍读取）
+    double native_fps;      // 源自身报告的帧率，未知为 0
+};
+
+/**
+ * @brief 打开视频源
+ * @param width/height 期望输出尺寸（合成源按此生成；其他源仅作为预分配参考）
+ * @return 句柄，失败返回 NULL
+ */
+video_source_t* video_source_open(const char *url, int width, int height);
+
+static inline int video_source_read(video_source_t *src, video_frame_t *frame) {
+    return src->ops->read(src, frame);
+}
+
+static inline int video_source_skip(video_source_t *src) {
+    return src->ops->skip(src);
+}
+
+static inline void video_source_close(video_source_t *src) {
+    if (src) src->ops->close(src);
+}
+
+#ifdef MEC_WITH_OPENCV
+video_source_t* video_source_opencv_open(const char *url);
+#endif
+
+#endif // MEC_VIDEO_SOURCE_H
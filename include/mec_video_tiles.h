@@ -0,0 +1,42 @@
+#ifndef MEC_VIDEO_TILES_H
+#define MEC_VIDEO_TILES_H
+
+#include "mec_common.h"
+#include "mec_video_roi.h"
+
+/**
+ * @file mec_video_tiles.h
+ * @brief 高分辨率画面的切块检测
+ *
+ * 检测网络输入尺寸固定，整幅 4K 画面缩放后远处小目标只剩几个像素。切块时
+ * 每个待检测区域（ROI 裁剪窗口或运动区域）不超过块边长的保持原样，更大的
+ * 区域均匀切成相互重叠 overlap 像素的方块，不含任何 ROI 掩码像素的块直接
+ * 丢弃，块的排布因此跟随道路走向。各块交给检测批处理器并行推理，结果换算回
+ * 整帧坐标后，跨接缝的重复检测按接地点距离做一次非极大值抑制合并。
+ */
+
+#define VIDEO_MAX_TILES 64
+#define VIDEO_TILE_DEFAULT_OVERLAP 64
+#define VIDEO_TILE_DEFAULT_MERGE_PX 32
+
+/**
+ * @brief 把待检测区域切成重叠块
+ * @param areas 待检测区域（像素）
+ * @param roi 检测区域掩码，用于丢弃路外的块；NULL 或未配置区域时不丢弃
+ * @param tile_size 块边长 (像素)，<=0 时原样输出 areas
+ * @param overlap 相邻块重叠宽度 (像素)
+ * @param tile_used 输出实际使用的块边长（可为 NULL）：块数超过 max_tiles 时逐步放大块边长
+ *                  直到区域全部覆盖，放大到不必切块时为 0
+ * @return 输出的块数
+ */
+int video_tiles_layout(const roi_rect_t *areas, int area_count, const roi_set_t *roi,
+                       int tile_size, int overlap, roi_rect_t *tiles, int max_tiles, int *tile_used);
+
+/**
+ * @brief 合并块间重复检测：同类型、接地点相距不超过 radius_px 的目标只保留置信度最高的一个
+ * @param tracks 整帧归一化坐标的检测结果，就地压缩
+ * @return 合并掉的数量
+ */
+int video_tiles_merge(track_list_t *tracks, double radius_px, int width, int height);
+
+#endif // MEC_VIDEO_TILES_H
@@ -0,0 +1,62 @@
+#ifndef MEC_VIDEO_TRACKER_H
+#define MEC_VIDEO_TRACKER_H
+
+#include "mec_common.h"
+
+/**
+ * @file mec_video_tracker.h
+ * @brief 单相机多目标跟踪器
+ *
+ * 在图像归一化坐标下按质心关联：已有航迹先按匀速模型外推到本帧时刻，
+ * 放入均匀网格索引，每个检测只与相邻 3x3 网格内的航迹比较，再按距离
+ * 由近到远贪心分配。航迹 ID 由跟踪器实例分配（相机 ID 决定号段），
+ * 在目标持续可见期间保持不变，下游融合可据此缓存关联结果。
+ */
+
+#define VIDEO_TRACKER_MAX_TRACKS 128
+#define VIDEO_TRACKER_MAX_GRID   32      // 网格每边最多格数
+#define VIDEO_TRACKER_ID_SPAN    100000  // 每路相机的 ID 号段长度
+#define VIDEO_TRACKER_DEFAULT_GATE 0.05  // 关联门限 (归一化画面坐标)
+#define VIDEO_TRACKER_DEFAULT_MAX_MISSES 5
+
+typedef struct {
+    int id;
+    double x, y;        // 最近一次观测位置 (归一化)
+    double vx, vy;      // 速度 (归一化单位/秒)
+    double px, py;      // 本帧预测位置
+    int hits;
+    int misses;
+} video_track_state_t;
+
+typedef struct {
+    video_track_state_t tracks[VIDEO_TRACKER_MAX_TRACKS];
+    int count;
+    int id_base;
+    int next_id;
+    double gate;
+    int max_misses;
+    struct timeval last_time;
+    int has_time;
+
+    // 网格索引（每帧重建）：cell_head[cell] -> 航迹下标链表
+    int grid_dim;
+    int16_t cell_head[VIDEO_TRACKER_MAX_GRID * VIDEO_TRACKER_MAX_GRID];
+    int16_t cell_next[VIDEO_TRACKER_MAX_TRACKS];
+} video_tracker_t;
+
+/**
+ * @brief 初始化跟踪器
+ * @param gate 关联门限，<=0 使用默认值
+ * @param max_misses 连续丢失多少帧后删除航迹，<=0 使用默认值
+ */
+void video_tracker_init(video_tracker_t *tracker, int camera_id, double gate, int max_misses);
+
+/**
+ * @brief 用一帧检测结果更新跟踪器，并就地写回稳定的航迹 ID
+ * @param detections 检测结果（position.longitude/latitude 为归一化 x/y）
+ * @param timestamp 帧时刻
+ * @return 新建航迹数
+ */
+int video_tracker_update(video_tracker_t *tracker, track_list_t *detections, const struct timeval *timestamp);
+
+#endif // MEC_VIDEO_TRACKER_H
@@ -0,0 +1,65 @@
+#ifndef MEC_VIDEO_TRANSFORM_H
+#define MEC_VIDEO_TRANSFORM_H
+
+#include "mec_common.h"
+
+/**
+ * @file mec_video_transform.h
+ * @brief 检测点批量去畸变与单应变换
+ *
+ * 一帧内所有检测点以浮点像素坐标（结构体数组分量形式）一次性处理：
+ * 先经稀疏查找表去畸变，再用 SIMD 批量应用单应矩阵映射到站点 ENU 平面。
+ */
+
+#define UNDISTORT_DEFAULT_STEP 16   // 查找表网格间距 (像素)
+#define VIDEO_TRANSFORM_CHUNK 64    // 批量变换每次处理的点数（栈上暂存）
+
+/**
+ * @brief 镜头内参与 Brown-Conrady 畸变系数
+ */
+typedef struct {
+    double fx, fy;      // 焦距 (像素)
+    double cx, cy;      // 主点 (像素)
+    double k1, k2, k3;  // 径向畸变
+    double p1, p2;      // 切向畸变
+    int enabled;
+} lens_distortion_t;
+
+/**
+ * @brief 稀疏去畸变查找表
+ *
+ * 每隔 step 像素存一个网格节点处"畸变像素 -> 去畸变像素"的精确解，
+ * 节点之间双线性插值。畸变场很平滑，16 像素间距的插值误差远小于检测框精度。
+ */
+typedef struct {
+    int width;
+    int height;
+    int step;
+    int grid_w;         // 节点列数
+    int grid_h;         // 节点行数
+    float *map_x;       // grid_h * grid_w
+    float *map_y;
+} undistort_map_t;
+
+/**
+ * @brief 按镜头参数构建查找表（仅在标定时调用一次）
+ * @param step 网格间距，<=0 使用默认值
+ * @return 查找表，失败返回 NULL
+ */
+undistort_map_t* undistort_map_create(const lens_distortion_t *lens, int width, int height, int step);
+void undistort_map_destroy(undistort_map_t *map);
+
+/**
+ * @brief 就地去畸变一批像素坐标
+ */
+void undistort_map_apply(const undistort_map_t *map, float *x, float *y, int count);
+
+/**
+ * @brief 对一批点应用 3x3 单应矩阵（SSE2 每次处理两个点）
+ *
+ * 分母接近 0（地平线以上）的点输出 NAN。
+ */
+void homography_apply_batch(const double matrix[9], const float *x, const float *y,
+                            double *east, double *north, int count);
+
+#endif // MEC_VIDEO_TRANSFORM_H
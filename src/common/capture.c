@@ -0,0 +1,315 @@
+#include "mec_capture.h"
+#include "mec_logging.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @file capture.c
+ * @brief 双缓冲抓包写入与 mmap 回放实现
+ */
+
+typedef struct {
+    uint8_t *data;
+    size_t used;
+} capture_buffer_t;
+
+struct mec_capture_t {
+    int fd;
+    char path[256];
+    size_t buffer_size;
+    capture_buffer_t buffers[2];
+    int active;             // 采集线程正在追加的缓冲区
+    int pending;            // 待落盘的缓冲区 (-1 表示无)
+    long dropped;
+    thread_context_t thread_ctx;
+};
+
+static void* capture_writer_thread(void *arg);
+
+mec_capture_t* mec_capture_open(const char *path, size_t buffer_size) {
+    if (!path) return NULL;
+
+    mec_capture_t *cap = mec_calloc(1, sizeof(mec_capture_t));
+    if (!cap) return NULL;
+
+    cap->buffer_size = buffer_size > 0 ? buffer_size : MEC_CAPTURE_DEFAULT_BUFFER;
+    cap->pending = -1;
+    strncpy(cap->path, path, sizeof(cap->path) - 1);
+
+    for (int i = 0; i < 2; i++) {
+        cap->buffers[i].data = malloc(cap->buffer_size);
+        if (!cap->buffers[i].data) {
+            free(cap->buffers[0].data);
+            mec_free(cap);
+            return NULL;
+        }
+    }
+
+    cap->fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (cap->fd < 0) {
+        LOG_ERROR("Capture: Failed to open %s (errno %d)", path, errno);
+        free(cap->buffers[0].data);
+        free(cap->buffers[1].data);
+        mec_free(cap);
+        return NULL;
+    }
+
+    // 新文件写入文件头；已有文件继续追加记录
+    struct stat st;
+    if (fstat(cap->fd, &st) == 0 && st.st_size == 0) {
+        mec_capture_file_header_t hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic, MEC_CAPTURE_MAGIC, sizeof(hdr.magic));
+        hdr.version = MEC_CAPTURE_VERSION;
+        if (write(cap->fd, &hdr, sizeof(hdr)) != (ssize_t)sizeof(hdr)) {
+            LOG_ERROR("Capture: Failed to write header to %s", path);
+        }
+    }
+
+    if (thread_create(&cap->thread_ctx, capture_writer_thread, cap) != 0) {
+        LOG_ERROR("Capture: Failed to start writer thread");
+        close(cap->fd);
+        free(cap->buffers[0].data);
+        free(cap->buffers[1].data);
+        mec_free(cap);
+        return NULL;
+    }
+
+    LOG_INFO("Capture: Recording raw sensor data to %s", path);
+    return cap;
+}
+
+// 调用时需持有锁：把当前缓冲区交给落盘线程
+static int capture_swap_locked(mec_capture_t *cap) {
+    if (cap->pending >= 0) return -1;   // 落盘线程尚未处理完上一个缓冲区
+    cap->pending = cap->active;
+    cap->active ^= 1;
+    cap->buffers[cap->active].used = 0;
+    pthread_cond_signal(&cap->thread_ctx.cond);
+    return 0;
+}
+
+int mec_capture_write(mec_capture_t *cap, capture_record_type_t type, int source_id,
+                      const struct timeval *timestamp, const void *data, size_t len) {
+    if (!cap || !timestamp || (!data && len > 0)) return -1;
+
+    size_t need = sizeof(mec_capture_record_t) + MEC_CAPTURE_ALIGN(len);
+    if (need > cap->buffer_size) return -1;
+
+    thread_lock(&cap->thread_ctx);
+    capture_buffer_t *buf = &cap->buffers[cap->active];
+    if (buf->used + need > cap->buffer_size) {
+        if (capture_swap_locked(cap) != 0) {
+            cap->dropped++;
+            thread_unlock(&cap->thread_ctx);
+            return -1;
+        }
+        buf = &cap->buffers[cap->active];
+    }
+
+    mec_capture_record_t rec;
+    rec.timestamp_ns = (uint64_t)timestamp->tv_sec * 1000000000ull + (uint64_t)timestamp->tv_usec * 1000ull;
+    rec.length = (uint32_t)len;
+    rec.source_id = (uint16_t)source_id;
+    rec.type = (uint8_t)type;
+    rec.reserved = 0;
+
+    uint8_t *dst = buf->data + buf->used;
+    memcpy(dst, &rec, sizeof(rec));
+    memcpy(dst + sizeof(rec), data, len);
+    memset(dst + sizeof(rec) + len, 0, MEC_CAPTURE_ALIGN(len) - len);
+    buf->used += need;
+    thread_unlock(&cap->thread_ctx);
+    return 0;
+}
+
+static void capture_flush(mec_capture_t *cap, capture_buffer_t *buf) {
+    size_t off = 0;
+    while (off < buf->used) {
+        ssize_t n = write(cap->fd, buf->data + off, buf->used - off);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("Capture: Write to %s failed (errno %d)", cap->path, errno);
+            break;
+        }
+        off += (size_t)n;
+    }
+    buf->used = 0;
+}
+
+/**
+ * @brief 落盘线程：等待满缓冲区，空闲 200ms 时也会主动交换部分填充的缓冲区
+ */
+static void* capture_writer_thread(void *arg) {
+    mec_capture_t *cap = (mec_capture_t*)arg;
+
+    thread_lock(&cap->thread_ctx);
+    while (1) {
+        if (cap->pending < 0) {
+            if (!cap->thread_ctx.running) break;
+
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_nsec += 200 * 1000000L;
+            if (ts.tv_nsec >= 1000000000L) {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&cap->thread_ctx.cond, &cap->thread_ctx.mutex, &ts);
+
+            if (cap->pending < 0 && cap->buffers[cap->active].used > 0) {
+                capture_swap_locked(cap);
+            }
+            if (cap->pending < 0) continue;
+        }
+
+        capture_buffer_t *buf = &cap->buffers[cap->pending];
+        thread_unlock(&cap->thread_ctx);
+        capture_flush(cap, buf);      // 磁盘 IO 在锁外进行
+        thread_lock(&cap->thread_ctx);
+        cap->pending = -1;
+    }
+
+    // 退出前写完剩余数据
+    capture_flush(cap, &cap->buffers[cap->active]);
+    thread_unlock(&cap->thread_ctx);
+    return NULL;
+}
+
+void mec_capture_close(mec_capture_t *cap) {
+    if (!cap) return;
+
+    thread_destroy(&cap->thread_ctx);
+    if (cap->dropped > 0) {
+        LOG_WARN("Capture: %ld records dropped (writer could not keep up)", cap->dropped);
+    }
+    fsync(cap->fd);
+    close(cap->fd);
+    free(cap->buffers[0].data);
+    free(cap->buffers[1].data);
+    LOG_INFO("Capture: Closed %s", cap->path);
+    mec_free(cap);
+}
+
+long mec_capture_dropped(mec_capture_t *cap) {
+    if (!cap) return 0;
+    thread_lock(&cap->thread_ctx);
+    long dropped = cap->dropped;
+    thread_unlock(&cap->thread_ctx);
+    return dropped;
+}
+
+/* --- 回放 --- */
+
+mec_replay_t* mec_replay_open(const char *path, double speed) {
+    if (!path) return NULL;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR("Replay: Failed to open %s", path);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(mec_capture_file_header_t)) {
+        LOG_ERROR("Replay: %s is not a capture file", path);
+        close(fd);
+        return NULL;
+    }
+
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        LOG_ERROR("Replay: mmap of %s failed (errno %d)", path, errno);
+        return NULL;
+    }
+    madvise(base, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    const mec_capture_file_header_t *hdr = (const mec_capture_file_header_t*)base;
+    if (memcmp(hdr->magic, MEC_CAPTURE_MAGIC, sizeof(hdr->magic)) != 0 || hdr->version != MEC_CAPTURE_VERSION) {
+        LOG_ERROR("Replay: %s has an unknown format", path);
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+
+    mec_replay_t *replay = mec_calloc(1, sizeof(mec_replay_t));
+    if (!replay) {
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+    replay->base = (const uint8_t*)base;
+    replay->size = (size_t)st.st_size;
+    replay->speed = speed;
+    mec_replay_rewind(replay);
+
+    LOG_INFO("Replay: Mapped %s (%zu bytes, speed %s%.1f)", path, replay->size,
+             speed > 0 ? "x" : "max ", speed > 0 ? speed : 0.0);
+    return replay;
+}
+
+void mec_replay_close(mec_replay_t *replay) {
+    if (!replay) return;
+    munmap((void*)replay->base, replay->size);
+    mec_free(replay);
+}
+
+void mec_replay_rewind(mec_replay_t *replay) {
+    if (!replay) return;
+    replay->offset = sizeof(mec_capture_file_header_t);
+    replay->records = 0;
+    replay->first_ts_ns = 0;
+    if (replay->offset + sizeof(mec_capture_record_t) <= replay->size) {
+        const mec_capture_record_t *first = (const mec_capture_record_t*)(replay->base + replay->offset);
+        replay->first_ts_ns = first->timestamp_ns;
+    }
+    struct timeval wall;
+    mec_clock_wall(&wall);
+    replay->start = mec_clock_now();
+    replay->start_wall = mec_time_from_timeval(&wall);
+}
+
+int mec_replay_next(mec_replay_t *replay, const mec_capture_record_t **record, const uint8_t **payload) {
+    if (!replay || !record || !payload) return -1;
+    if (replay->offset + sizeof(mec_capture_record_t) > replay->size) return 0;
+
+    const mec_capture_record_t *rec = (const mec_capture_record_t*)(replay->base + replay->offset);
+    size_t total = sizeof(mec_capture_record_t) + MEC_CAPTURE_ALIGN((size_t)rec->length);
+    if (replay->offset + total > replay->size) {
+        LOG_WARN("Replay: Truncated record at offset %zu", replay->offset);
+        return -1;
+    }
+
+    *record = rec;
+    *payload = (const uint8_t*)(rec + 1);
+    replay->offset += total;
+    replay->records++;
+    return 1;
+}
+
+void mec_replay_pace(mec_replay_t *replay, const mec_capture_record_t *record,
+                     thread_context_t *ctx, struct timeval *out_timestamp) {
+    if (!replay || !record) return;
+
+    // 记录在回放时间轴上的偏移
+    int64_t rel_ns = (int64_t)(record->timestamp_ns - replay->first_ts_ns);
+    if (rel_ns < 0) rel_ns = 0;
+    mec_time_ns_t due_ns = replay->speed > 0 ? (mec_time_ns_t)(rel_ns / replay->speed) : 0;
+
+    // 按系统时钟等到发布时刻；停止时被 thread_destroy 的广播唤醒
+    if (replay->speed > 0 && ctx) {
+        thread_lock(ctx);
+        while (ctx->running) {
+            if (mec_clock_cond_timedwait(&ctx->cond, &ctx->mutex, replay->start + due_ns) == ETIMEDOUT) break;
+        }
+        thread_unlock(ctx);
+    }
+
+    if (out_timestamp) {
+        if (replay->speed > 0) {
+            mec_time_to_timeval(replay->start_wall + due_ns, out_timestamp);
+        } else {
+            mec_clock_wall(out_timestamp);
+        }
+    }
+}
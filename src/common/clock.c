@@ -0,0 +1,216 @@
+#include "mec_clock.h"
+#include <time.h>
+#include <errno.h>
+
+/**
+ * @file clock.c
+ * @brief 单调纳秒时钟与虚拟时钟的推进、等待者同步
+ */
+
+// 虚拟模式下等待者每隔这段真实时间醒来复查一次，兜住推进时丢失的唤醒
+#define CLOCK_VIRTUAL_SLICE_NS (2 * MEC_NS_PER_MS)
+
+typedef struct {
+    int used;
+    int waiting;                    // 1: 阻塞在 mec_clock_cond_timedwait 中
+    mec_time_ns_t deadline;         // 虚拟截止时间
+    pthread_cond_t *cond;           // 仅在 waiting 期间有效
+    mec_time_ns_t running_since;    // 最近一次离开等待的真实时间
+} clock_waiter_t;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;         // 等待者状态变化，推进者据此判断系统是否静止
+    int virtual_mode;
+    mec_time_ns_t virtual_now;
+    mec_time_ns_t virtual_wall;     // 虚拟模式下墙钟与 virtual_now 之差
+    mec_time_ns_t mono_offset;      // 真实模式下相对系统时钟的偏移，保证切换后时间连续
+    mec_time_ns_t wall_offset;
+    clock_waiter_t waiters[MEC_CLOCK_MAX_THREADS];
+} g_clock = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, 0, 0, 0, 0, {{0}} };
+
+static __thread int t_waiter = -1;
+static pthread_once_t g_waiter_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t g_waiter_key;      // 线程退出时释放其等待者槽
+
+static mec_time_ns_t raw_ns(clockid_t id) {
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (mec_time_ns_t)ts.tv_sec * MEC_NS_PER_SEC + ts.tv_nsec;
+}
+
+// 距今 ns 之后的 CLOCK_REALTIME 绝对时刻，供默认属性的条件变量使用
+static struct timespec realtime_after(mec_time_ns_t ns) {
+    if (ns < 0) ns = 0;
+    mec_time_ns_t t = raw_ns(CLOCK_REALTIME) + ns;
+    struct timespec ts = { (time_t)(t / MEC_NS_PER_SEC), (long)(t % MEC_NS_PER_SEC) };
+    return ts;
+}
+
+static mec_time_ns_t now_locked(void) {
+    if (g_clock.virtual_mode) return g_clock.virtual_now;
+    return raw_ns(CLOCK_MONOTONIC) + g_clock.mono_offset;
+}
+
+static mec_time_ns_t wall_locked(void) {
+    if (g_clock.virtual_mode) return g_clock.virtual_now + g_clock.virtual_wall;
+    return raw_ns(CLOCK_REALTIME) + g_clock.wall_offset;
+}
+
+mec_time_ns_t mec_clock_now(void) {
+    pthread_mutex_lock(&g_clock.lock);
+    mec_time_ns_t now = now_locked();
+    pthread_mutex_unlock(&g_clock.lock);
+    return now;
+}
+
+void mec_clock_wall(struct timeval *tv) {
+    if (!tv) return;
+    pthread_mutex_lock(&g_clock.lock);
+    mec_time_ns_t wall = wall_locked();
+    pthread_mutex_unlock(&g_clock.lock);
+    mec_time_to_timeval(wall, tv);
+}
+
+mec_time_ns_t mec_clock_real_ns(void) {
+    return raw_ns(CLOCK_MONOTONIC);
+}
+
+int mec_clock_is_virtual(void) {
+    pthread_mutex_lock(&g_clock.lock);
+    int v = g_clock.virtual_mode;
+    pthread_mutex_unlock(&g_clock.lock);
+    return v;
+}
+
+static void wake_waiters_locked(int due_only) {
+    for (int i = 0; i < MEC_CLOCK_MAX_THREADS; i++) {
+        clock_waiter_t *w = &g_clock.waiters[i];
+        if (w->waiting && (!due_only || w->deadline <= g_clock.virtual_now)) {
+            pthread_cond_broadcast(w->cond);
+        }
+    }
+}
+
+void mec_clock_set_virtual(int enabled) {
+    pthread_mutex_lock(&g_clock.lock);
+    if (enabled && !g_clock.virtual_mode) {
+        g_clock.virtual_now = now_locked();
+        g_clock.virtual_wall = wall_locked() - g_clock.virtual_now;
+        g_clock.virtual_mode = 1;
+    } else if (!enabled && g_clock.virtual_mode) {
+        g_clock.mono_offset = g_clock.virtual_now - raw_ns(CLOCK_MONOTONIC);
+        g_clock.wall_offset = g_clock.virtual_now + g_clock.virtual_wall - raw_ns(CLOCK_REALTIME);
+        g_clock.virtual_mode = 0;
+        wake_waiters_locked(0);   // 让等待者按真实时间重新计算超时
+        pthread_cond_broadcast(&g_clock.changed);
+    }
+    pthread_mutex_unlock(&g_clock.lock);
+}
+
+// 等到所有登记过的线程都在等待且没有到期未醒的等待者；持续运行过久的线程不再等
+static void wait_quiescent_locked(void) {
+    while (g_clock.virtual_mode) {
+        mec_time_ns_t real = raw_ns(CLOCK_MONOTONIC);
+        int busy = 0;
+        for (int i = 0; i < MEC_CLOCK_MAX_THREADS && !busy; i++) {
+            const clock_waiter_t *w = &g_clock.waiters[i];
+            if (!w->used) continue;
+            if (w->waiting) busy = w->deadline <= g_clock.virtual_now;
+            else busy = real - w->running_since < MEC_CLOCK_SETTLE_MS * MEC_NS_PER_MS;
+        }
+        if (!busy) return;
+        struct timespec ts = realtime_after(MEC_NS_PER_MS);
+        pthread_cond_timedwait(&g_clock.changed, &g_clock.lock, &ts);
+    }
+}
+
+int mec_clock_advance_to(mec_time_ns_t t) {
+    pthread_mutex_lock(&g_clock.lock);
+    if (!g_clock.virtual_mode || t < g_clock.virtual_now) {
+        pthread_mutex_unlock(&g_clock.lock);
+        return -1;
+    }
+    for (;;) {
+        wait_quiescent_locked();
+        if (!g_clock.virtual_mode || g_clock.virtual_now >= t) break;
+
+        // 逐个截止时间前进：每个等待者都在自己的截止时刻醒来，而不是一次跳到 t
+        mec_time_ns_t next = t;
+        for (int i = 0; i < MEC_CLOCK_MAX_THREADS; i++) {
+            const clock_waiter_t *w = &g_clock.waiters[i];
+            if (w->waiting && w->deadline < next) next = w->deadline;
+        }
+        if (next > g_clock.virtual_now) g_clock.virtual_now = next;
+        wake_waiters_locked(1);
+    }
+    pthread_mutex_unlock(&g_clock.lock);
+    return 0;
+}
+
+static void waiter_release(void *slot) {
+    clock_waiter_t *w = (clock_waiter_t*)slot;
+    pthread_mutex_lock(&g_clock.lock);
+    w->used = 0;
+    w->waiting = 0;
+    w->cond = NULL;
+    pthread_cond_broadcast(&g_clock.changed);
+    pthread_mutex_unlock(&g_clock.lock);
+}
+
+static void waiter_key_create(void) {
+    pthread_key_create(&g_waiter_key, waiter_release);
+}
+
+// 当前线程的等待者槽，首次使用时分配、线程退出时释放；槽满返回 NULL（不参与静止判定）
+static clock_waiter_t* waiter_locked(void) {
+    if (t_waiter < 0) {
+        pthread_once(&g_waiter_key_once, waiter_key_create);
+        for (int i = 0; i < MEC_CLOCK_MAX_THREADS; i++) {
+            if (!g_clock.waiters[i].used) {
+                g_clock.waiters[i].used = 1;
+                t_waiter = i;
+                pthread_setspecific(g_waiter_key, &g_clock.waiters[i]);
+                break;
+            }
+        }
+        if (t_waiter < 0) return NULL;
+    }
+    return &g_clock.waiters[t_waiter];
+}
+
+int mec_clock_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex, mec_time_ns_t deadline) {
+    pthread_mutex_lock(&g_clock.lock);
+    if (!g_clock.virtual_mode) {
+        mec_time_ns_t remaining = deadline - now_locked();
+        pthread_mutex_unlock(&g_clock.lock);
+        if (remaining <= 0) return ETIMEDOUT;
+        struct timespec ts = realtime_after(remaining);
+        return pthread_cond_timedwait(cond, mutex, &ts);
+    }
+    if (g_clock.virtual_now >= deadline) {
+        pthread_mutex_unlock(&g_clock.lock);
+        return ETIMEDOUT;
+    }
+    clock_waiter_t *w = waiter_locked();
+    if (w) {
+        w->deadline = deadline;
+        w->cond = cond;
+        w->waiting = 1;
+        pthread_cond_broadcast(&g_clock.changed);
+    }
+    pthread_mutex_unlock(&g_clock.lock);
+
+    struct timespec ts = realtime_after(CLOCK_VIRTUAL_SLICE_NS);
+    pthread_cond_timedwait(cond, mutex, &ts);
+
+    pthread_mutex_lock(&g_clock.lock);
+    if (w) {
+        w->waiting = 0;
+        w->running_since = raw_ns(CLOCK_MONOTONIC);
+        pthread_cond_broadcast(&g_clock.changed);
+    }
+    int expired = now_locked() >= deadline;
+    pthread_mutex_unlock(&g_clock.lock);
+    return expired ? ETIMEDOUT : 0;
+}
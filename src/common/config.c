@@ -35,6 +35,7 @@ mec_error_code_t config_load(config_t **config, const char *filename) {
     }
 
     char line[512];
+    char section[MEC_CONFIG_KEY_LEN] = "";
 
     while (fgets(line, sizeof(line), file) && (*config)->count < MEC_MAX_CONFIGS) {
         // Skip comments and empty lines
@@ -42,6 +43,17 @@ mec_error_code_t config_load(config_t **config, const char *filename) {
             continue;
         }
 
+        // [section] 头：其后的键以 "section." 为前缀，例如 [radar] 下的 baud_rate -> radar.baud_rate
+        if (line[0] == '[') {
+            char *end = strchr(line, ']');
+            if (end) {
+                *end = '\0';
+                strncpy(section, line + 1, sizeof(section) - 1);
+                section[sizeof(section) - 1] = '\0';
+            }
+            continue;
+        }
+
         // Parse key=value pairs
         char *delimiter = strchr(line, '=');
         if (delimiter) {
@@ -51,6 +63,10 @@ mec_error_code_t config_load(config_t **config, const char *filename) {
 
             // Trim whitespace
             while (*key == ' ' || *key == '\t') key++;
+            int key_end = strlen(key);
+            while (key_end > 0 && (key[key_end-1] == ' ' || key[key_end-1] == '\t')) {
+                key[--key_end] = '\0';
+            }
             int len = strlen(value);
             while (len > 0 && (value[len-1] == ' ' || value[len-1] == '\t' || 
                    value[len-1] == '\n' || value[len-1] == '\r')) {
@@ -58,6 +74,12 @@ mec_error_code_t config_load(config_t **config, const char *filename) {
             }
             while (*value == ' ' || *value == '\t') value++;
 
+            char full_key[MEC_CONFIG_KEY_LEN * 2];
+            if (section[0] != '\0') {
+                snprintf(full_key, sizeof(full_key), "%s.%s", section, key);
+                key = full_key;
+            }
+
             // 确保key和value长度不会导致缓冲区溢出
             size_t key_len = strlen(key);
             size_t val_len = strlen(value);
@@ -0,0 +1,147 @@
+#include "mec_geo.h"
+#include "mec_logging.h"
+
+/**
+ * @file geo.c
+ * @brief WGS84 <-> 站点 ENU 转换实现
+ *
+ * 正算 (Δφ、Δλ 以度为单位):
+ *   north = m_lat·Δφ + m_lat2·Δφ² + k_lon2·Δλ²
+ *   east  = m_lon·Δλ + m_lon_lat·Δλ·Δφ
+ *   up    = Δh - east²/(2N0) - north²/(2M0)
+ * 反算用两次定点迭代求解上式，收敛到亚毫米级。
+ */
+
+#define WGS84_A  6378137.0
+#define WGS84_E2 6.69437999014e-3
+#define DEG2RAD  (M_PI / 180.0)
+
+static geo_site_t g_site = {0};
+static pthread_once_t g_site_once = PTHREAD_ONCE_INIT;
+
+int geo_site_init(geo_site_t *site, double lat, double lon, double alt) {
+    if (!site || lat < -89.0 || lat > 89.0 || lon < -180.0 || lon > 180.0) return -1;
+
+    double phi = lat * DEG2RAD;
+    double s = sin(phi);
+    double c = cos(phi);
+    double w2 = 1.0 - WGS84_E2 * s * s;
+    double w = sqrt(w2);
+
+    double n0 = WGS84_A / w;                          // 卯酉圈曲率半径
+    double m0 = WGS84_A * (1.0 - WGS84_E2) / (w2 * w); // 子午圈曲率半径
+    double dm = 3.0 * m0 * WGS84_E2 * s * c / w2;       // dM/dφ
+
+    site->lat0 = lat;
+    site->lon0 = lon;
+    site->alt0 = alt;
+    site->m_lat = m0 * DEG2RAD;
+    site->m_lat2 = 0.5 * dm * DEG2RAD * DEG2RAD;
+    site->k_lon2 = 0.5 * n0 * s * c * DEG2RAD * DEG2RAD;
+    site->m_lon = n0 * c * DEG2RAD;
+    site->m_lon_lat = -m0 * s * DEG2RAD * DEG2RAD;     // d(N cosφ)/dφ = -M sinφ
+    site->inv_2m = 0.5 / m0;
+    site->inv_2n = 0.5 / n0;
+    site->initialized = 1;
+    return 0;
+}
+
+void geo_set_site(const geo_site_t *site) {
+    if (!site) return;
+    g_site = *site;
+    LOG_INFO("Geo: Site origin set to (%.7f, %.7f, %.1f m)", site->lat0, site->lon0, site->alt0);
+}
+
+// 未配置站点时退化为以 (0, 0) 为原点，保证转换常量有效
+static void site_default_init(void) {
+    if (!g_site.initialized) geo_site_init(&g_site, 0.0, 0.0, 0.0);
+}
+
+const geo_site_t* geo_get_site(void) {
+    // 视频、雷达、接入桥等线程都会调用，默认值只初始化一次
+    pthread_once(&g_site_once, site_default_init);
+    return &g_site;
+}
+
+static inline void wgs84_to_en(const geo_site_t *site, double lat, double lon, double *east, double *north) {
+    double dphi = lat - site->lat0;
+    double dlam = lon - site->lon0;
+    *north = dphi * (site->m_lat + site->m_lat2 * dphi) + site->k_lon2 * dlam * dlam;
+    *east = dlam * (site->m_lon + site->m_lon_lat * dphi);
+}
+
+static inline void en_to_wgs84(const geo_site_t *site, double east, double north, double *lat, double *lon) {
+    double dphi = north / site->m_lat;
+    double dlam = east / (site->m_lon + site->m_lon_lat * dphi);
+    for (int k = 0; k < 2; k++) {
+        dphi = (north - site->k_lon2 * dlam * dlam) / (site->m_lat + site->m_lat2 * dphi);
+        dlam = east / (site->m_lon + site->m_lon_lat * dphi);
+    }
+    *lat = site->lat0 + dphi;
+    *lon = site->lon0 + dlam;
+}
+
+void geo_wgs84_to_enu(const geo_site_t *site, const wgs84_coord_t *in, enu_coord_t *out) {
+    if (!site || !in || !out) return;
+    wgs84_to_en(site, in->latitude, in->longitude, &out->east, &out->north);
+    out->up = (in->altitude - site->alt0)
+            - out->east * out->east * site->inv_2n
+            - out->north * out->north * site->inv_2m;
+}
+
+void geo_enu_to_wgs84(const geo_site_t *site, const enu_coord_t *in, wgs84_coord_t *out) {
+    if (!site || !in || !out) return;
+    en_to_wgs84(site, in->east, in->north, &out->latitude, &out->longitude);
+    out->altitude = site->alt0 + in->up
+                  + in->east * in->east * site->inv_2n
+                  + in->north * in->north * site->inv_2m;
+}
+
+void geo_wgs84_to_enu_batch(const geo_site_t *site, const double *restrict lat, const double *restrict lon,
+                            double *restrict east, double *restrict north, int count) {
+    if (!site || !lat || !lon || !east || !north) return;
+    const double lat0 = site->lat0, lon0 = site->lon0;
+    const double m_lat = site->m_lat, m_lat2 = site->m_lat2, k_lon2 = site->k_lon2;
+    const double m_lon = site->m_lon, m_lon_lat = site->m_lon_lat;
+
+    for (int i = 0; i < count; i++) {
+        double dphi = lat[i] - lat0;
+        double dlam = lon[i] - lon0;
+        north[i] = dphi * (m_lat + m_lat2 * dphi) + k_lon2 * dlam * dlam;
+        east[i] = dlam * (m_lon + m_lon_lat * dphi);
+    }
+}
+
+void geo_enu_to_wgs84_batch(const geo_site_t *site, const double *restrict east, const double *restrict north,
+                            double *restrict lat, double *restrict lon, int count) {
+    if (!site || !east || !north || !lat || !lon) return;
+    const double lat0 = site->lat0, lon0 = site->lon0;
+    const double m_lat = site->m_lat, m_lat2 = site->m_lat2, k_lon2 = site->k_lon2;
+    const double m_lon = site->m_lon, m_lon_lat = site->m_lon_lat;
+
+    for (int i = 0; i < count; i++) {
+        double e = east[i], n = north[i];
+        double dphi = n / m_lat;
+        double dlam = e / (m_lon + m_lon_lat * dphi);
+        dphi = (n - k_lon2 * dlam * dlam) / (m_lat + m_lat2 * dphi);
+        dlam = e / (m_lon + m_lon_lat * dphi);
+        dphi = (n - k_lon2 * dlam * dlam) / (m_lat + m_lat2 * dphi);
+        dlam = e / (m_lon + m_lon_lat * dphi);
+        lat[i] = lat0 + dphi;
+        lon[i] = lon0 + dlam;
+    }
+}
+
+void geo_tracks_to_wgs84(const geo_site_t *site, target_track_t *tracks, int count) {
+    if (!site || !tracks) return;
+    for (int i = 0; i < count; i++) {
+        geo_enu_to_wgs84(site, &tracks[i].local, &tracks[i].position);
+    }
+}
+
+void geo_tracks_to_enu(const geo_site_t *site, target_track_t *tracks, int count) {
+    if (!site || !tracks) return;
+    for (int i = 0; i < count; i++) {
+        geo_wgs84_to_enu(site, &tracks[i].position, &tracks[i].local);
+    }
+}
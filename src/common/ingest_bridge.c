@@ -0,0 +1,336 @@
+#define _GNU_SOURCE  // accept4
+#include "mec_ingest.h"
+#include "mec_logging.h"
+#include "mec_geo.h"
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/**
+ * @file ingest_bridge.c
+ * @brief 共享内存环 -> 目标队列的桥接线程
+ */
+
+#define INGEST_POLL_MS 500
+#define INGEST_MAX_SENSOR_ID 31     // 融合用 1 << (sensor_id - 1) 作传感器掩码
+
+typedef struct ingest_ring ingest_ring_t;
+
+// 一个在途槽：包装出的 track_list_t 释放时据此归还
+typedef struct {
+    ingest_ring_t *owner;
+    uint64_t position;
+} ingest_slot_ref_t;
+
+/**
+ * @brief 消费侧的一条环：桥接线程持有一个引用，每条在途消息再持有一个
+ */
+struct ingest_ring {
+    shm_ring_t ring;
+    ingest_slot_ref_t refs[SHM_RING_MAX_SLOTS];
+    int ref_count;
+    pthread_mutex_t ref_lock;
+    int producer_id;
+};
+
+struct mec_ingest_bridge_t {
+    ingest_config_t config;
+    thread_context_t thread_ctx;    // mutex 保护统计
+    int server_fd;
+    ingest_ring_t *producers[INGEST_MAX_PRODUCERS];
+    int producer_count;
+    int next_producer_id;
+    ingest_stats_t stats;
+};
+
+static void* ingest_bridge_thread(void *arg);
+
+static void ingest_ring_retain(ingest_ring_t *ir) {
+    pthread_mutex_lock(&ir->ref_lock);
+    ir->ref_count++;
+    pthread_mutex_unlock(&ir->ref_lock);
+}
+
+static void ingest_ring_release(ingest_ring_t *ir) {
+    pthread_mutex_lock(&ir->ref_lock);
+    int destroy = --ir->ref_count <= 0;
+    pthread_mutex_unlock(&ir->ref_lock);
+
+    if (destroy) {
+        shm_ring_close(&ir->ring);
+        pthread_mutex_destroy(&ir->ref_lock);
+        mec_free(ir);
+    }
+}
+
+// 把槽归还生产者：序号推进到下一圈
+static void ingest_slot_free(ingest_ring_t *ir, uint64_t position) {
+    shm_slot_header_t *slot = shm_ring_slot(&ir->ring, position);
+    __atomic_store_n(&slot->seq, position + ir->ring.slot_count, __ATOMIC_RELEASE);
+}
+
+// track_list_t 的释放回调（可能在融合线程或队列销毁时调用）
+static void ingest_slot_release(void *ctx) {
+    ingest_slot_ref_t *ref = (ingest_slot_ref_t*)ctx;
+    ingest_ring_t *ir = ref->owner;
+    ingest_slot_free(ir, ref->position);
+    ingest_ring_release(ir);
+}
+
+static int send_fds(int sock, int mem_fd, int event_fd) {
+    char byte = 0;
+    struct iovec iov = { &byte, 1 };
+    union {
+        char buf[CMSG_SPACE(2 * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    memset(&control, 0, sizeof(control));
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+    int fds[2] = { mem_fd, event_fd };
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    return sendmsg(sock, &msg, MSG_NOSIGNAL) == 1 ? 0 : -1;
+}
+
+mec_ingest_bridge_t* ingest_bridge_start(const ingest_config_t *config) {
+    if (!config || !config->target_queue || config->socket_path[0] == '\0') return NULL;
+
+    mec_ingest_bridge_t *bridge = mec_calloc(1, sizeof(mec_ingest_bridge_t));
+    if (!bridge) return NULL;
+    bridge->config = *config;
+
+    bridge->server_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (bridge->server_fd < 0) {
+        LOG_ERROR("Ingest: Socket creation failed");
+        mec_free(bridge);
+        return NULL;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, config->socket_path, sizeof(addr.sun_path) - 1);
+    unlink(config->socket_path);
+
+    if (bind(bridge->server_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(bridge->server_fd, INGEST_MAX_PRODUCERS) < 0) {
+        LOG_ERROR("Ingest: Cannot listen on %s: %s", config->socket_path, strerror(errno));
+        close(bridge->server_fd);
+        mec_free(bridge);
+        return NULL;
+    }
+
+    if (thread_create(&bridge->thread_ctx, ingest_bridge_thread, bridge) != 0) {
+        LOG_ERROR("Ingest: Failed to create bridge thread");
+        close(bridge->server_fd);
+        unlink(config->socket_path);
+        mec_free(bridge);
+        return NULL;
+    }
+
+    LOG_INFO("Ingest: Listening on %s", config->socket_path);
+    return bridge;
+}
+
+void ingest_bridge_stop(mec_ingest_bridge_t *bridge) {
+    if (!bridge) return;
+
+    // 桥接线程每 INGEST_POLL_MS 检查一次运行标志
+    thread_destroy(&bridge->thread_ctx);
+
+    for (int i = 0; i < bridge->producer_count; i++) {
+        ingest_ring_release(bridge->producers[i]);
+    }
+    close(bridge->server_fd);
+    unlink(bridge->config.socket_path);
+
+    LOG_INFO("Ingest: Stopped (%ld messages, %ld queue-full, %ld invalid)",
+             bridge->stats.messages, bridge->stats.queue_full, bridge->stats.invalid);
+    mec_free(bridge);
+}
+
+void ingest_bridge_get_stats(mec_ingest_bridge_t *bridge, ingest_stats_t *stats) {
+    if (!bridge || !stats) return;
+    thread_lock(&bridge->thread_ctx);
+    *stats = bridge->stats;
+    thread_unlock(&bridge->thread_ctx);
+}
+
+void ingest_bridge_report(mec_ingest_bridge_t *bridge) {
+    if (!bridge) return;
+    ingest_stats_t st;
+    ingest_bridge_get_stats(bridge, &st);
+    LOG_INFO("Ingest: %d producers | connections %ld | messages %ld | queue-full %ld | invalid %ld",
+             st.producers, st.connections, st.messages, st.queue_full, st.invalid);
+}
+
+static void ingest_accept(mec_ingest_bridge_t *bridge) {
+    int client_fd = accept4(bridge->server_fd, NULL, NULL, SOCK_CLOEXEC);
+    if (client_fd < 0) return;
+
+    if (bridge->producer_count >= INGEST_MAX_PRODUCERS) {
+        LOG_WARN("Ingest: Producer limit (%d) reached, rejecting connection", INGEST_MAX_PRODUCERS);
+        close(client_fd);
+        return;
+    }
+
+    ingest_ring_t *ir = mec_calloc(1, sizeof(ingest_ring_t));
+    if (!ir) {
+        close(client_fd);
+        return;
+    }
+    if (shm_ring_create(&ir->ring, bridge->config.slot_count, bridge->config.slot_tracks) != 0) {
+        close(client_fd);
+        mec_free(ir);
+        return;
+    }
+    ir->ring.sock_fd = client_fd;
+    ir->ref_count = 1;
+    pthread_mutex_init(&ir->ref_lock, NULL);
+    ir->producer_id = ++bridge->next_producer_id;
+
+    if (send_fds(client_fd, ir->ring.mem_fd, ir->ring.event_fd) != 0) {
+        LOG_WARN("Ingest: Failed to hand ring to producer %d", ir->producer_id);
+        ingest_ring_release(ir);
+        return;
+    }
+
+    bridge->producers[bridge->producer_count++] = ir;
+    thread_lock(&bridge->thread_ctx);
+    bridge->stats.producers = bridge->producer_count;
+    bridge->stats.connections++;
+    thread_unlock(&bridge->thread_ctx);
+    LOG_INFO("Ingest: Producer %d connected (%u slots x %u tracks)", ir->producer_id,
+             ir->ring.slot_count, ir->ring.slot_tracks);
+}
+
+/**
+ * @brief 把一条环上所有已提交的槽推入目标队列
+ */
+static void ingest_drain(mec_ingest_bridge_t *bridge, ingest_ring_t *ir) {
+    shm_ring_t *ring = &ir->ring;
+    const uint32_t slot_count = ring->slot_count;
+    long messages = 0, queue_full = 0, invalid = 0;
+
+    for (;;) {
+        uint64_t position = ring->position;
+        shm_slot_header_t *slot = shm_ring_slot(ring, position);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != position + 1) break;
+        ring->position++;
+
+        // 槽头只读一次：生产者之后再改也不影响已入队的消息
+        int count = slot->count;
+        int sensor_id = slot->sensor_id;
+        if (count < 0 || count > (int)ring->slot_tracks ||
+            sensor_id < 1 || sensor_id > INGEST_MAX_SENSOR_ID) {
+            invalid++;
+            ingest_slot_free(ir, position);
+            continue;
+        }
+
+        // 生产者不知道站点原点，只填 WGS84；站点 ENU 在这里就地补算（槽此时归桥所有）
+        geo_tracks_to_enu(geo_get_site(), shm_slot_tracks(slot), count);
+
+        ingest_slot_ref_t *ref = &ir->refs[position % slot_count];
+        ref->owner = ir;
+        ref->position = position;
+        ingest_ring_retain(ir);
+        track_list_t *list = track_list_wrap(shm_slot_tracks(slot), count, ingest_slot_release, ref);
+        if (!list) {
+            ingest_slot_release(ref);
+            continue;
+        }
+
+        mec_msg_t msg;
+        msg.sensor_id = sensor_id;
+        msg.tracks = list;
+        msg.timestamp.tv_sec = (time_t)slot->tv_sec;
+        msg.timestamp.tv_usec = (suseconds_t)slot->tv_usec;
+        if (mec_queue_push(bridge->config.target_queue, &msg) == 0) messages++;
+        else queue_full++;
+        track_list_release(list);   // 队列持有自己的引用；入队失败时槽在这里归还
+    }
+
+    if (messages || queue_full || invalid) {
+        thread_lock(&bridge->thread_ctx);
+        bridge->stats.messages += messages;
+        bridge->stats.queue_full += queue_full;
+        bridge->stats.invalid += invalid;
+        thread_unlock(&bridge->thread_ctx);
+    }
+}
+
+// 套接字可读：生产者不发送数据，读到 EOF 或错误即视为断开
+static int producer_disconnected(ingest_ring_t *ir) {
+    char buf[64];
+    ssize_t n = recv(ir->ring.sock_fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (n > 0) return 0;
+    return n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR);
+}
+
+static void* ingest_bridge_thread(void *arg) {
+    mec_ingest_bridge_t *bridge = (mec_ingest_bridge_t*)arg;
+    struct pollfd fds[1 + 2 * INGEST_MAX_PRODUCERS];
+
+    while (bridge->thread_ctx.running) {
+        int nfds = 0;
+        fds[nfds].fd = bridge->server_fd;
+        fds[nfds++].events = POLLIN;
+        for (int i = 0; i < bridge->producer_count; i++) {
+            fds[nfds].fd = bridge->producers[i]->ring.event_fd;
+            fds[nfds++].events = POLLIN;
+            fds[nfds].fd = bridge->producers[i]->ring.sock_fd;
+            fds[nfds++].events = POLLIN;
+        }
+
+        if (poll(fds, (nfds_t)nfds, INGEST_POLL_MS) < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("Ingest: poll failed: %s", strerror(errno));
+            break;
+        }
+
+        // 先处理已有生产者（下标与 fds 对应），再接入新连接
+        for (int i = 0; i < bridge->producer_count; ) {
+            ingest_ring_t *ir = bridge->producers[i];
+            const struct pollfd *ev = &fds[1 + 2 * i];
+            const struct pollfd *sock = &fds[2 + 2 * i];
+
+            if (ev->revents & POLLIN) {
+                uint64_t counter;
+                if (read(ir->ring.event_fd, &counter, sizeof(counter)) < 0 && errno != EAGAIN) {
+                    LOG_WARN("Ingest: eventfd read failed for producer %d", ir->producer_id);
+                }
+            }
+            // 即使错过通知，每轮也会把已提交的槽取完
+            ingest_drain(bridge, ir);
+
+            if ((sock->revents & (POLLIN | POLLHUP | POLLERR)) && producer_disconnected(ir)) {
+                LOG_INFO("Ingest: Producer %d disconnected", ir->producer_id);
+                bridge->producers[i] = bridge->producers[--bridge->producer_count];
+                // fds 同步交换，下标继续与 producers 对应
+                fds[1 + 2 * i] = fds[1 + 2 * bridge->producer_count];
+                fds[2 + 2 * i] = fds[2 + 2 * bridge->producer_count];
+                ingest_ring_release(ir);
+                thread_lock(&bridge->thread_ctx);
+                bridge->stats.producers = bridge->producer_count;
+                thread_unlock(&bridge->thread_ctx);
+                continue;
+            }
+            i++;
+        }
+
+        if (fds[0].revents & POLLIN) ingest_accept(bridge);
+    }
+    return NULL;
+}
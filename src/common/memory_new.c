@@ -118,10 +118,10 @@ void* mec_malloc(size_t size) {
         pthread_mutex_unlock(&medium_pool.lock);
     }
     
-    // 如果内存池分配失败，使用系统malloc
+    // 如果内存池分配失败，使用系统malloc（超过中块大小的请求本就走系统堆，不告警）
     if (!ptr) {
         ptr = malloc(size);
-        if (ptr) {
+        if (ptr && size <= MEC_MEM_POOL_MEDIUM_SIZE) {
             LOG_WARN("Memory pool exhausted, falling back to system malloc for size %zu", size);
         }
     }
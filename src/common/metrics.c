@@ -17,6 +17,14 @@ void metrics_record_frame(double latency_ms) {
     pthread_mutex_unlock(&g_stats.lock);
 }
 
+void metrics_record_age(double age_ms) {
+    pthread_mutex_lock(&g_stats.lock);
+    g_stats.age_count++;
+    g_stats.total_age_ms += age_ms;
+    if (age_ms > g_stats.max_age_ms) g_stats.max_age_ms = age_ms;
+    pthread_mutex_unlock(&g_stats.lock);
+}
+
 void metrics_report() {
     struct timeval now;
     gettimeofday(&now, NULL);
@@ -32,5 +40,12 @@ void metrics_report() {
         LOG_INFO("PERF: FPS: %.2f | Avg Latency: %.3f ms | Frames: %ld", 
                  fps, avg_lat, (long)g_stats.frame_count);
     }
+    if (g_stats.age_count > 0) {
+        LOG_INFO("PERF: Sensor Age: avg %.3f ms | max %.3f ms | Messages: %ld",
+                 g_stats.total_age_ms / g_stats.age_count, g_stats.max_age_ms, g_stats.age_count);
+        g_stats.age_count = 0;
+        g_stats.total_age_ms = 0;
+        g_stats.max_age_ms = 0;
+    }
     pthread_mutex_unlock(&g_stats.lock);
 }
\ No newline at end of file
@@ -116,7 +116,9 @@ void* monitor_server_thread(void *arg) {
         
         // 此处需要获取 metrics。由于 metrics 是静态全局的，直接获取上一次的报文数据。
         // 为了演示，我们生成一个状态 JSON
-        int active_tracks = (mon->config.fusion_proc) ? mon->config.fusion_proc->track_count : 0;
+        fusion_stats_t fstats = { 0, 0, 0 };
+        if (mon->config.fusion_proc) fusion_processor_get_stats(mon->config.fusion_proc, &fstats);
+        int active_tracks = fstats.track_count;
         
         int len = snprintf(buffer, sizeof(buffer), 
             "{\n"
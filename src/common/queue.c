@@ -1,6 +1,8 @@
 #include "mec_queue.h"
 #include "mec_logging.h"
+#include "mec_clock.h"
 #include <errno.h>
+#include <time.h>
 
 /**
  * @brief 循环队列的内部实现结构
@@ -15,6 +17,7 @@ struct mec_queue_t {
     pthread_mutex_t mutex;    // 互斥锁：保护整个结构体的并发访问
     pthread_cond_t not_empty; // 消费者同步信号：队列非空时触发
     pthread_cond_t not_full;  // 生产者同步信号：队列有空间时触发
+    pthread_cond_t drained;   // 队列被取空时广播（单调时钟，超时按真实时间计）
 };
 
 mec_queue_t* mec_queue_create(int capacity) {
@@ -38,6 +41,11 @@ mec_queue_t* mec_queue_create(int capacity) {
     pthread_mutex_init(&queue->mutex, NULL);
     pthread_cond_init(&queue->not_empty, NULL);
     pthread_cond_init(&queue->not_full, NULL);
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&queue->drained, &attr);
+    pthread_condattr_destroy(&attr);
 
     LOG_INFO("MEC Queue: Initialized with capacity %d", capacity);
     return queue;
@@ -59,6 +67,7 @@ void mec_queue_destroy(mec_queue_t *queue) {
     pthread_mutex_destroy(&queue->mutex);
     pthread_cond_destroy(&queue->not_empty);
     pthread_cond_destroy(&queue->not_full);
+    pthread_cond_destroy(&queue->drained);
     mec_free(queue->buffer);
     mec_free(queue);
     
@@ -100,6 +109,8 @@ int mec_queue_pop(mec_queue_t *queue, mec_msg_t *out_msg, int timeout_ms) {
 
     pthread_mutex_lock(&queue->mutex);
 
+    // 截止时间取自系统时钟，虚拟时钟模式下随回放时间到期
+    mec_time_ns_t deadline = timeout_ms > 0 ? mec_clock_now() + (mec_time_ns_t)timeout_ms * MEC_NS_PER_MS : 0;
     // 若队列为空，根据超时配置进行等待
     while (queue->count == 0) {
         if (timeout_ms < 0) {
@@ -111,15 +122,7 @@ int mec_queue_pop(mec_queue_t *queue, mec_msg_t *out_msg, int timeout_ms) {
             return -1;
         } else {
             // 计时等待
-            struct timespec ts;
-            struct timeval now;
-            gettimeofday(&now, NULL);
-            
-            long nsec = (now.tv_usec + (timeout_ms % 1000) * 1000) * 1000;
-            ts.tv_sec = now.tv_sec + (timeout_ms / 1000) + (nsec / 1000000000);
-            ts.tv_nsec = nsec % 1000000000;
-
-            if (pthread_cond_timedwait(&queue->not_empty, &queue->mutex, &ts) != 0) {
+            if (mec_clock_cond_timedwait(&queue->not_empty, &queue->mutex, deadline) == ETIMEDOUT) {
                 pthread_mutex_unlock(&queue->mutex);
                 return -1; // 超时触发
             }
@@ -135,11 +138,33 @@ int mec_queue_pop(mec_queue_t *queue, mec_msg_t *out_msg, int timeout_ms) {
 
     // 通知生产者（如有由于队列满而阻塞的生产者）
     pthread_cond_signal(&queue->not_full);
+    if (queue->count == 0) pthread_cond_broadcast(&queue->drained);
     pthread_mutex_unlock(&queue->mutex);
 
     return 0;
 }
 
+int mec_queue_wait_empty(mec_queue_t *queue, int timeout_ms) {
+    if (!queue) return -1;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->count > 0) {
+        if (pthread_cond_timedwait(&queue->drained, &queue->mutex, &ts) == ETIMEDOUT) break;
+    }
+    int empty = queue->count == 0;
+    pthread_mutex_unlock(&queue->mutex);
+    return empty ? 0 : -1;
+}
+
 int mec_queue_size(mec_queue_t *queue) {
     if (!queue) return 0;
     pthread_mutex_lock(&queue->mutex);
@@ -0,0 +1,316 @@
+#include "mec_scenario.h"
+#include "mec_logging.h"
+#include <stddef.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @file scenario.c
+ * @brief 列式场景文件：文本解析、写出、映射与按组回放
+ */
+
+_Static_assert(sizeof(scenario_file_header_t) == 128, "scenario header must be 128 bytes");
+_Static_assert(sizeof(scenario_group_index_t) == 16, "scenario group index must be 16 bytes");
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "scenario files are little-endian; add byte swapping for big-endian hosts"
+#endif
+
+#define SCENARIO_ALIGN 64
+
+static const size_t column_width[SCENARIO_COLUMN_COUNT] = {
+    sizeof(int32_t), sizeof(int32_t), sizeof(int32_t),
+    sizeof(double), sizeof(double), sizeof(double), sizeof(double), sizeof(double)
+};
+
+static size_t align_up(size_t v) {
+    return (v + SCENARIO_ALIGN - 1) & ~(size_t)(SCENARIO_ALIGN - 1);
+}
+
+static inline const void* column_base(const mec_scenario_t *sc, scenario_column_t col) {
+    return sc->base + sc->header->column_offset[col];
+}
+
+// [offset, offset + count * width) 落在文件内；按除法比较，构造的大偏移/计数不会溢出
+static int range_in_file(uint64_t offset, uint64_t count, size_t width, size_t size) {
+    return offset <= size && count <= (size - offset) / width;
+}
+
+// 校验头部与索引，全部通过后回放期间不再检查边界
+static int scenario_attach(mec_scenario_t *sc) {
+    if (sc->size < sizeof(scenario_file_header_t)) return -1;
+    const scenario_file_header_t *h = (const scenario_file_header_t*)sc->base;
+    if (memcmp(h->magic, SCENARIO_MAGIC, sizeof(h->magic)) != 0 || h->version != SCENARIO_VERSION ||
+        h->header_size != sizeof(scenario_file_header_t) || h->file_size != sc->size) {
+        return -1;
+    }
+    if (h->record_count > UINT32_MAX || h->group_count > h->record_count) return -1;
+    if (h->groups_offset % 8 != 0 ||
+        !range_in_file(h->groups_offset, h->group_count, sizeof(scenario_group_index_t), sc->size)) {
+        return -1;
+    }
+    for (int c = 0; c < SCENARIO_COLUMN_COUNT; c++) {
+        if (h->column_offset[c] % 8 != 0 ||
+            !range_in_file(h->column_offset[c], h->record_count, column_width[c], sc->size)) {
+            return -1;
+        }
+    }
+
+    const scenario_group_index_t *groups = (const scenario_group_index_t*)(sc->base + h->groups_offset);
+    uint64_t next_first = 0;
+    for (uint64_t g = 0; g < h->group_count; g++) {
+        if (groups[g].first != next_first || groups[g].count == 0) return -1;
+        if (g > 0 && groups[g].time_ms <= groups[g - 1].time_ms) return -1;
+        next_first += groups[g].count;
+    }
+    if (next_first != h->record_count) return -1;
+
+    sc->header = h;
+    sc->groups = groups;
+    sc->group_count = h->group_count;
+    sc->record_count = h->record_count;
+    sc->cursor = 0;
+    return 0;
+}
+
+int scenario_open(mec_scenario_t *sc, const char *path) {
+    if (!sc || !path) return -1;
+    memset(sc, 0, sizeof(*sc));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR("Scenario: Cannot open %s: %s", path, strerror(errno));
+        return -1;
+    }
+    char magic[8] = {0};
+    struct stat st;
+    if (fstat(fd, &st) != 0 || read(fd, magic, sizeof(magic)) != (ssize_t)sizeof(magic) ||
+        memcmp(magic, SCENARIO_MAGIC, sizeof(magic)) != 0) {
+        close(fd);
+        return scenario_load_text(sc, path);
+    }
+
+    sc->size = (size_t)st.st_size;
+    void *base = mmap(NULL, sc->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        LOG_ERROR("Scenario: mmap failed for %s: %s", path, strerror(errno));
+        memset(sc, 0, sizeof(*sc));
+        return -1;
+    }
+    sc->base = base;
+    sc->mapped = 1;
+    // 回放按时间顺序读取，提示内核预读
+    madvise(sc->base, sc->size, MADV_SEQUENTIAL);
+
+    if (scenario_attach(sc) != 0) {
+        LOG_ERROR("Scenario: %s is corrupt or from an incompatible version", path);
+        scenario_close(sc);
+        return -1;
+    }
+    LOG_INFO("Scenario: Mapped %s (%llu records, %llu groups, %.1f s)", path,
+             (unsigned long long)sc->record_count, (unsigned long long)sc->group_count,
+             scenario_duration_ms(sc) / 1000.0);
+    return 0;
+}
+
+void scenario_close(mec_scenario_t *sc) {
+    if (!sc) return;
+    if (sc->base) {
+        if (sc->mapped) munmap(sc->base, sc->size);
+        else mec_free(sc->base);
+    }
+    memset(sc, 0, sizeof(*sc));
+}
+
+/* --- 由记录构建镜像 --- */
+
+static int compare_record(const void *a, const void *b) {
+    const scenario_record_t *x = (const scenario_record_t*)a;
+    const scenario_record_t *y = (const scenario_record_t*)b;
+    if (x->time_ms != y->time_ms) return x->time_ms < y->time_ms ? -1 : 1;
+    if (x->sensor_id != y->sensor_id) return x->sensor_id < y->sensor_id ? -1 : 1;
+    return x->order < y->order ? -1 : (x->order > y->order);
+}
+
+int scenario_build(mec_scenario_t *sc, scenario_record_t *records, size_t count) {
+    if (!sc || (!records && count > 0)) return -1;
+    memset(sc, 0, sizeof(*sc));
+
+    if (count > UINT32_MAX) return -1;
+    // 记录只要求大致有序；按 (时间, 传感器) 排序后同一时间戳的记录连续
+    qsort(records, count, sizeof(scenario_record_t), compare_record);
+
+    size_t groups = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (i == 0 || records[i].time_ms != records[i - 1].time_ms) groups++;
+    }
+
+    // 按文件布局一次分配：写出时整块写入即可
+    size_t offset = align_up(sizeof(scenario_file_header_t));
+    size_t groups_offset = offset;
+    offset = align_up(offset + groups * sizeof(scenario_group_index_t));
+    uint64_t column_offset[SCENARIO_COLUMN_COUNT];
+    for (int c = 0; c < SCENARIO_COLUMN_COUNT; c++) {
+        column_offset[c] = offset;
+        offset = align_up(offset + count * column_width[c]);
+    }
+
+    sc->base = mec_calloc(1, offset);
+    if (!sc->base) return -1;
+    sc->size = offset;
+
+    scenario_file_header_t *h = (scenario_file_header_t*)sc->base;
+    memcpy(h->magic, SCENARIO_MAGIC, sizeof(h->magic));
+    h->version = SCENARIO_VERSION;
+    h->header_size = sizeof(scenario_file_header_t);
+    h->record_count = count;
+    h->group_count = groups;
+    h->groups_offset = groups_offset;
+    memcpy(h->column_offset, column_offset, sizeof(column_offset));
+    h->file_size = offset;
+
+    scenario_group_index_t *index = (scenario_group_index_t*)(sc->base + groups_offset);
+    int32_t *sensor_id = (int32_t*)(sc->base + column_offset[SCENARIO_COL_SENSOR_ID]);
+    int32_t *id = (int32_t*)(sc->base + column_offset[SCENARIO_COL_ID]);
+    int32_t *type = (int32_t*)(sc->base + column_offset[SCENARIO_COL_TYPE]);
+    double *latitude = (double*)(sc->base + column_offset[SCENARIO_COL_LATITUDE]);
+    double *longitude = (double*)(sc->base + column_offset[SCENARIO_COL_LONGITUDE]);
+    double *velocity = (double*)(sc->base + column_offset[SCENARIO_COL_VELOCITY]);
+    double *heading = (double*)(sc->base + column_offset[SCENARIO_COL_HEADING]);
+    double *confidence = (double*)(sc->base + column_offset[SCENARIO_COL_CONFIDENCE]);
+
+    size_t g = 0;
+    for (size_t i = 0; i < count; i++) {
+        const scenario_record_t *r = &records[i];
+        if (i == 0 || r->time_ms != records[i - 1].time_ms) {
+            index[g].time_ms = r->time_ms;
+            index[g].first = (uint32_t)i;
+            index[g].count = 0;
+            g++;
+        }
+        index[g - 1].count++;
+        sensor_id[i] = r->sensor_id;
+        id[i] = r->id;
+        type[i] = r->type;
+        latitude[i] = r->latitude;
+        longitude[i] = r->longitude;
+        velocity[i] = r->velocity;
+        heading[i] = r->heading;
+        confidence[i] = r->confidence;
+    }
+
+    if (scenario_attach(sc) != 0) {
+        scenario_close(sc);
+        return -1;
+    }
+    return 0;
+}
+
+/* --- 文本解析 --- */
+
+int scenario_load_text(mec_scenario_t *sc, const char *path) {
+    if (!sc || !path) return -1;
+    memset(sc, 0, sizeof(*sc));
+
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        LOG_ERROR("Scenario: Cannot open %s", path);
+        return -1;
+    }
+
+    scenario_record_t *records = NULL;
+    size_t count = 0, capacity = 0;
+    long skipped = 0;
+    char line[512];
+    while (fgets(line, sizeof(line), fp)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+
+        scenario_record_t r;
+        long rel_time_ms;
+        if (sscanf(line, "%ld %d %d %d %lf %lf %lf %lf %lf", &rel_time_ms, &r.sensor_id, &r.id, &r.type,
+                   &r.latitude, &r.longitude, &r.velocity, &r.heading, &r.confidence) != 9) {
+            skipped++;
+            continue;
+        }
+        r.time_ms = rel_time_ms;
+        r.order = count;
+
+        if (count == capacity) {
+            size_t next = capacity ? capacity * 2 : 1024;
+            scenario_record_t *grown = mec_realloc(records, next * sizeof(scenario_record_t));
+            if (!grown) {
+                mec_free(records);
+                fclose(fp);
+                return -1;
+            }
+            records = grown;
+            capacity = next;
+        }
+        records[count++] = r;
+    }
+    fclose(fp);
+
+    int ret = scenario_build(sc, records, count);
+    mec_free(records);
+    if (ret != 0) return -1;
+    if (skipped > 0) LOG_WARN("Scenario: Skipped %ld malformed lines in %s", skipped, path);
+    LOG_INFO("Scenario: Parsed %s (%llu records, %llu groups)", path,
+             (unsigned long long)sc->record_count, (unsigned long long)sc->group_count);
+    return 0;
+}
+
+int scenario_write(const mec_scenario_t *sc, const char *path) {
+    if (!sc || !sc->base || !path) return -1;
+
+    // 先写临时文件再改名，回放中的映射不会读到写了一半的文件
+    char tmp_path[512];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    FILE *fp = fopen(tmp_path, "wb");
+    if (!fp) {
+        LOG_ERROR("Scenario: Cannot create %s", tmp_path);
+        return -1;
+    }
+    int ok = fwrite(sc->base, 1, sc->size, fp) == sc->size;
+    if (fclose(fp) != 0) ok = 0;
+    if (!ok || rename(tmp_path, path) != 0) {
+        LOG_ERROR("Scenario: Failed to write %s", path);
+        unlink(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+void scenario_seek(mec_scenario_t *sc, int64_t time_ms) {
+    if (!sc || !sc->groups) return;
+    uint64_t lo = 0, hi = sc->group_count;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (sc->groups[mid].time_ms < time_ms) lo = mid + 1;
+        else hi = mid;
+    }
+    sc->cursor = lo;
+}
+
+int scenario_next(mec_scenario_t *sc, scenario_group_t *group) {
+    if (!sc || !group || !sc->groups || sc->cursor >= sc->group_count) return -1;
+
+    const scenario_group_index_t *g = &sc->groups[sc->cursor++];
+    group->time_ms = g->time_ms;
+    group->count = (int)g->count;
+    group->sensor_id = (const int32_t*)column_base(sc, SCENARIO_COL_SENSOR_ID) + g->first;
+    group->id = (const int32_t*)column_base(sc, SCENARIO_COL_ID) + g->first;
+    group->type = (const int32_t*)column_base(sc, SCENARIO_COL_TYPE) + g->first;
+    group->latitude = (const double*)column_base(sc, SCENARIO_COL_LATITUDE) + g->first;
+    group->longitude = (const double*)column_base(sc, SCENARIO_COL_LONGITUDE) + g->first;
+    group->velocity = (const double*)column_base(sc, SCENARIO_COL_VELOCITY) + g->first;
+    group->heading = (const double*)column_base(sc, SCENARIO_COL_HEADING) + g->first;
+    group->confidence = (const double*)column_base(sc, SCENARIO_COL_CONFIDENCE) + g->first;
+    return 0;
+}
+
+int64_t scenario_duration_ms(const mec_scenario_t *sc) {
+    if (!sc || !sc->groups || sc->group_count == 0) return 0;
+    return sc->groups[sc->group_count - 1].time_ms;
+}
@@ -0,0 +1,220 @@
+#define _GNU_SOURCE  // memfd_create
+#include "mec_shm_ring.h"
+#include "mec_logging.h"
+#include "mec_clock.h"
+#include <stddef.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
+
+/**
+ * @file shm_ring.c
+ * @brief 共享内存目标环：创建、连接与生产者写入
+ */
+
+// 目标记录布局即跨进程协议，任何字段变动都必须同时升级 SHM_RING_VERSION
+_Static_assert(sizeof(shm_ring_header_t) == 64, "shm ring header must be 64 bytes");
+_Static_assert(sizeof(shm_slot_header_t) == 64, "shm slot header must be 64 bytes");
+#if defined(__x86_64__) || defined(__aarch64__)
+_Static_assert(sizeof(target_track_t) == 104, "target_track_t layout changed");
+_Static_assert(offsetof(target_track_t, position) == 8, "target_track_t layout changed");
+_Static_assert(offsetof(target_track_t, local) == 32, "target_track_t layout changed");
+_Static_assert(offsetof(target_track_t, confidence) == 72, "target_track_t layout changed");
+_Static_assert(offsetof(target_track_t, timestamp) == 80, "target_track_t layout changed");
+_Static_assert(offsetof(target_track_t, sensor_id) == 96, "target_track_t layout changed");
+#endif
+
+static size_t slot_size_for(int slot_tracks) {
+    size_t size = sizeof(shm_slot_header_t) + (size_t)slot_tracks * sizeof(target_track_t);
+    return (size + 63) & ~(size_t)63;
+}
+
+static void ring_reset(shm_ring_t *ring) {
+    memset(ring, 0, sizeof(*ring));
+    ring->mem_fd = -1;
+    ring->event_fd = -1;
+    ring->sock_fd = -1;
+}
+
+int shm_ring_create(shm_ring_t *ring, int slot_count, int slot_tracks) {
+    if (!ring) return -1;
+    ring_reset(ring);
+
+    if (slot_count <= 0) slot_count = SHM_RING_DEFAULT_SLOTS;
+    if (slot_count > SHM_RING_MAX_SLOTS) slot_count = SHM_RING_MAX_SLOTS;
+    if (slot_tracks <= 0) slot_tracks = SHM_RING_DEFAULT_SLOT_TRACKS;
+    if (slot_tracks > SHM_RING_MAX_SLOT_TRACKS) slot_tracks = SHM_RING_MAX_SLOT_TRACKS;
+
+    size_t slot_size = slot_size_for(slot_tracks);
+    ring->size = sizeof(shm_ring_header_t) + (size_t)slot_count * slot_size;
+
+    ring->mem_fd = memfd_create("mec_ingest", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (ring->mem_fd < 0) {
+        LOG_ERROR("ShmRing: memfd_create failed: %s", strerror(errno));
+        shm_ring_close(ring);
+        return -1;
+    }
+    if (ftruncate(ring->mem_fd, (off_t)ring->size) != 0) {
+        LOG_ERROR("ShmRing: ftruncate failed: %s", strerror(errno));
+        shm_ring_close(ring);
+        return -1;
+    }
+    // 封住尺寸：生产者无法截断文件，映射期间不会因 SIGBUS 拖垮融合进程
+    fcntl(ring->mem_fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+
+    ring->base = mmap(NULL, ring->size, PROT_READ | PROT_WRITE, MAP_SHARED, ring->mem_fd, 0);
+    if (ring->base == MAP_FAILED) {
+        ring->base = NULL;
+        LOG_ERROR("ShmRing: mmap failed: %s", strerror(errno));
+        shm_ring_close(ring);
+        return -1;
+    }
+
+    ring->event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (ring->event_fd < 0) {
+        LOG_ERROR("ShmRing: eventfd failed: %s", strerror(errno));
+        shm_ring_close(ring);
+        return -1;
+    }
+
+    ring->header = (shm_ring_header_t*)ring->base;
+    ring->header->magic = SHM_RING_MAGIC;
+    ring->header->version = SHM_RING_VERSION;
+    ring->header->slot_count = (uint32_t)slot_count;
+    ring->header->slot_tracks = (uint32_t)slot_tracks;
+    ring->header->record_size = (uint32_t)sizeof(target_track_t);
+    ring->header->slot_size = (uint32_t)slot_size;
+    ring->slot_count = ring->header->slot_count;
+    ring->slot_tracks = ring->header->slot_tracks;
+    ring->slot_size = ring->header->slot_size;
+    for (int i = 0; i < slot_count; i++) {
+        shm_ring_slot(ring, (uint64_t)i)->seq = (uint64_t)i;
+    }
+    return 0;
+}
+
+// 从套接字接收 memfd 与 eventfd
+static int recv_fds(int sock, int *mem_fd, int *event_fd) {
+    char byte;
+    struct iovec iov = { &byte, 1 };
+    union {
+        char buf[CMSG_SPACE(2 * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    if (recvmsg(sock, &msg, MSG_CMSG_CLOEXEC) <= 0) return -1;
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS ||
+        cmsg->cmsg_len != CMSG_LEN(2 * sizeof(int))) {
+        return -1;
+    }
+    int fds[2];
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    *mem_fd = fds[0];
+    *event_fd = fds[1];
+    return 0;
+}
+
+int shm_ring_connect(shm_ring_t *ring, const char *socket_path) {
+    if (!ring || !socket_path) return -1;
+    ring_reset(ring);
+
+    ring->sock_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (ring->sock_fd < 0) return -1;
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", socket_path);
+    if (connect(ring->sock_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        LOG_ERROR("ShmRing: Cannot connect to %s: %s", socket_path, strerror(errno));
+        shm_ring_close(ring);
+        return -1;
+    }
+    if (recv_fds(ring->sock_fd, &ring->mem_fd, &ring->event_fd) != 0) {
+        LOG_ERROR("ShmRing: No ring received from %s", socket_path);
+        shm_ring_close(ring);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(ring->mem_fd, &st) != 0 || (size_t)st.st_size < sizeof(shm_ring_header_t)) {
+        shm_ring_close(ring);
+        return -1;
+    }
+    ring->size = (size_t)st.st_size;
+    ring->base = mmap(NULL, ring->size, PROT_READ | PROT_WRITE, MAP_SHARED, ring->mem_fd, 0);
+    if (ring->base == MAP_FAILED) {
+        ring->base = NULL;
+        shm_ring_close(ring);
+        return -1;
+    }
+
+    ring->header = (shm_ring_header_t*)ring->base;
+    const shm_ring_header_t *h = ring->header;
+    if (h->magic != SHM_RING_MAGIC || h->version != SHM_RING_VERSION ||
+        h->record_size != sizeof(target_track_t) || h->slot_count == 0 || h->slot_count > SHM_RING_MAX_SLOTS ||
+        h->slot_tracks > SHM_RING_MAX_SLOT_TRACKS || h->slot_size != slot_size_for((int)h->slot_tracks) ||
+        sizeof(shm_ring_header_t) + (size_t)h->slot_count * h->slot_size > ring->size) {
+        LOG_ERROR("ShmRing: Incompatible ring layout (version %u, record %u bytes)", h->version, h->record_size);
+        shm_ring_close(ring);
+        return -1;
+    }
+    ring->slot_count = h->slot_count;
+    ring->slot_tracks = h->slot_tracks;
+    ring->slot_size = h->slot_size;
+    return 0;
+}
+
+void shm_ring_close(shm_ring_t *ring) {
+    if (!ring) return;
+    if (ring->base) munmap(ring->base, ring->size);
+    if (ring->mem_fd >= 0) close(ring->mem_fd);
+    if (ring->event_fd >= 0) close(ring->event_fd);
+    if (ring->sock_fd >= 0) close(ring->sock_fd);
+    ring_reset(ring);
+}
+
+target_track_t* shm_ring_begin(shm_ring_t *ring, int *capacity) {
+    if (!ring || !ring->header) return NULL;
+
+    shm_slot_header_t *slot = shm_ring_slot(ring, ring->position);
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != ring->position) {
+        ring->dropped++;    // 消费者还没归还这一槽：环满
+        return NULL;
+    }
+    if (capacity) *capacity = (int)ring->slot_tracks;
+    return shm_slot_tracks(slot);
+}
+
+int shm_ring_commit(shm_ring_t *ring, int sensor_id, int count, const struct timeval *timestamp) {
+    if (!ring || !ring->header || count < 0 || count > (int)ring->slot_tracks) return -1;
+
+    shm_slot_header_t *slot = shm_ring_slot(ring, ring->position);
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != ring->position) return -1;
+
+    struct timeval now;
+    if (!timestamp) {
+        mec_clock_wall(&now);
+        timestamp = &now;
+    }
+    slot->sensor_id = sensor_id;
+    slot->count = count;
+    slot->tv_sec = timestamp->tv_sec;
+    slot->tv_usec = timestamp->tv_usec;
+    __atomic_store_n(&slot->seq, ring->position + 1, __ATOMIC_RELEASE);
+    ring->position++;
+
+    uint64_t one = 1;
+    if (write(ring->event_fd, &one, sizeof(one)) != sizeof(one) && errno != EAGAIN) return -1;
+    return 0;
+}
@@ -1,21 +1,20 @@
 #include "mec_simulator.h"
 #include "mec_logging.h"
-#include <time.h>
+#include "mec_geo.h"
+#include "mec_scenario.h"
+#include "mec_clock.h"
 
 mec_simulator_t* simulator_create(const simulator_config_t *config) {
     if (!config) return NULL;
+    if (!config->target_queue) {
+        LOG_ERROR("Simulator: No target queue configured");
+        return NULL;
+    }
     
-    mec_simulator_t *sim = mec_malloc(sizeof(mec_simulator_t));
+    mec_simulator_t *sim = mec_calloc(1, sizeof(mec_simulator_t));
     if (!sim) return NULL;
     
     sim->config = *config;
-    sim->video_tracks = track_list_create(100);
-    sim->radar_tracks = track_list_create(100);
-    
-    if (!sim->video_tracks || !sim->radar_tracks) {
-        simulator_destroy(sim);
-        return NULL;
-    }
     
     LOG_INFO("Created simulator with data: %s", config->data_path);
     return sim;
@@ -24,8 +23,6 @@ mec_simulator_t* simulator_create(const simulator_config_t *config) {
 void simulator_destroy(mec_simulator_t *sim) {
     if (!sim) return;
     simulator_stop(sim);
-    track_list_release(sim->video_tracks);
-    track_list_release(sim->radar_tracks);
     mec_free(sim);
 }
 
@@ -39,87 +36,129 @@ int simulator_start(mec_simulator_t *sim) {
 }
 
 void simulator_stop(mec_simulator_t *sim) {
-    if (!sim) return;
+    if (!sim || sim->thread_ctx.thread == 0) return;
     thread_destroy(&sim->thread_ctx);
+    sim->thread_ctx.thread = 0;   // stop 与 destroy 可以先后调用
+    LOG_INFO("Simulator: Stopped (%ld frames published, %ld dropped)", sim->frames_published, sim->frames_dropped);
 }
 
-track_list_t* simulator_get_video_tracks(mec_simulator_t *sim) {
-    return sim->video_tracks;
+/**
+ * @brief 把组内 [first, first+count) 的记录（同一传感器）作为一帧推入队列
+ */
+static void publish_frame(mec_simulator_t *sim, const scenario_group_t *group, int first, int count,
+                          const struct timeval *now) {
+    int sensor_id = group->sensor_id[first];
+    // 融合以 1 << (sensor_id - 1) 记录来源
+    if (sensor_id < 1 || sensor_id > 31) {
+        sim->frames_dropped++;
+        return;
+    }
+    
+    track_list_t *frame = track_list_create(count);
+    if (!frame) {
+        sim->frames_dropped++;
+        return;
+    }
+    for (int i = first; i < first + count; i++) {
+        target_track_t track;
+        memset(&track, 0, sizeof(track));
+        track.id = group->id[i];
+        track.type = (target_type_t)group->type[i];
+        track.position.latitude = group->latitude[i];
+        track.position.longitude = group->longitude[i];
+        track.position.altitude = 0;
+        track.velocity = group->velocity[i];
+        track.heading = group->heading[i];
+        track.confidence = group->confidence[i];
+        track.sensor_id = sensor_id;
+        track.timestamp = *now;
+        track_list_add(frame, &track);
+    }
+    // 场景文件给出 WGS84 坐标，在输入边界换算到站点 ENU
+    geo_tracks_to_enu(geo_get_site(), frame->tracks, frame->count);
+    
+    mec_msg_t msg;
+    msg.sensor_id = sensor_id;
+    msg.tracks = frame;
+    msg.timestamp = *now;
+    if (mec_queue_push(sim->config.target_queue, &msg) == 0) sim->frames_published++;
+    else sim->frames_dropped++;
+    track_list_release(frame);   // 队列持有自己的引用
 }
 
-track_list_t* simulator_get_radar_tracks(mec_simulator_t *sim) {
-    return sim->radar_tracks;
+// 虚拟时钟下等队列中的帧被取走（阻塞在队列的取空信号上）；消费者取走后即进入处理，
+// 推进时钟时会等它重新进入等待。分段等待以便及时响应停止
+static void wait_drained(mec_simulator_t *sim) {
+    while (sim->thread_ctx.running) {
+        if (mec_queue_wait_empty(sim->config.target_queue, 50) == 0) break;
+    }
+}
+
+// 真实时钟下等到 deadline；停止时被 thread_destroy 的广播唤醒
+static void wait_until(mec_simulator_t *sim, mec_time_ns_t deadline) {
+    thread_lock(&sim->thread_ctx);
+    while (sim->thread_ctx.running) {
+        if (mec_clock_cond_timedwait(&sim->thread_ctx.cond, &sim->thread_ctx.mutex, deadline) == ETIMEDOUT) break;
+    }
+    thread_unlock(&sim->thread_ctx);
 }
 
 void* simulator_thread(void *arg) {
     mec_simulator_t *sim = (mec_simulator_t*)arg;
-    FILE *fp = NULL;
-    char line[512];
     
+    // 场景只打开一次：二进制文件直接映射，文本文件解析一次后按同样的列式镜像回放
+    mec_scenario_t scenario;
+    if (scenario_open(&scenario, sim->config.data_path) != 0 || scenario.group_count == 0) {
+        LOG_ERROR("Failed to open simulation data: %s", sim->config.data_path);
+        scenario_close(&scenario);
+        return NULL;
+    }
+    double speed = sim->config.playback_speed > 0.0 ? sim->config.playback_speed : 1.0;
+    int virtual_clock = sim->config.virtual_clock;
+    if (virtual_clock) {
+        mec_clock_set_virtual(1);
+        LOG_INFO("Simulator: Driving the virtual clock (playback_speed ignored)");
+    }
+    
+    mec_time_ns_t real_start = mec_clock_real_ns();
     while (sim->thread_ctx.running) {
-        fp = fopen(sim->config.data_path, "r");
-        if (!fp) {
-            LOG_ERROR("Failed to open simulation data: %s", sim->config.data_path);
-            break;
-        }
+        scenario_seek(&scenario, 0);
+        mec_time_ns_t start = mec_clock_now();
 
-        struct timeval start_time;
-        gettimeofday(&start_time, NULL);
-        long start_ms = start_time.tv_sec * 1000 + start_time.tv_usec / 1000;
-
-        while (sim->thread_ctx.running && fgets(line, sizeof(line), fp)) {
-            if (line[0] == '#' || line[0] == '\n') continue;
-
-            long rel_time_ms;
-            int sensor_id, id, type;
-            double lat, lon, vel, heading, conf;
-
-            if (sscanf(line, "%ld %d %d %d %lf %lf %lf %lf %lf", 
-                       &rel_time_ms, &sensor_id, &id, &type, &lat, &lon, &vel, &heading, &conf) != 9) {
-                continue;
+        scenario_group_t group;
+        while (sim->thread_ctx.running && scenario_next(&scenario, &group) == 0) {
+            if (virtual_clock) {
+                // 上一组已被消费、各线程都回到等待后才推进时间，回放速度只受处理能力限制
+                wait_drained(sim);
+                mec_clock_advance_to(start + group.time_ms * MEC_NS_PER_MS);
+            } else {
+                wait_until(sim, start + (mec_time_ns_t)(group.time_ms * MEC_NS_PER_MS / speed));
             }
+            if (!sim->thread_ctx.running) break;
 
-            // Wait until it's time to inject this data
             struct timeval now;
-            while (sim->thread_ctx.running) {
-                gettimeofday(&now, NULL);
-                long current_ms = now.tv_sec * 1000 + now.tv_usec / 1000;
-                if ((current_ms - start_ms) >= (rel_time_ms / sim->config.playback_speed)) {
-                    break;
-                }
-                usleep(5000); 
-            }
-
-            // Inject into appropriate list
-            thread_lock(&sim->thread_ctx);
-            target_track_t track;
-            track.id = id;
-            track.type = (target_type_t)type;
-            track.position.latitude = lat;
-            track.position.longitude = lon;
-            track.position.altitude = 0;
-            track.velocity = vel;
-            track.heading = heading;
-            track.confidence = conf;
-            track.sensor_id = sensor_id;
-            track.timestamp = now;
+            mec_clock_wall(&now);
 
-            if (sensor_id == 1) { // Video
-                // In a real simulator, we'd clear per frame, but here we just append or manage
-                // Simplified: clear if this is a new "burst" of same-timestamp data
-                track_list_add(sim->video_tracks, &track);
-            } else if (sensor_id == 2) { // Radar
-                track_list_add(sim->radar_tracks, &track);
+            // 组内记录已按传感器排序：每个传感器的连续一段即一帧
+            int first = 0;
+            for (int i = 1; i <= group.count; i++) {
+                if (i == group.count || group.sensor_id[i] != group.sensor_id[first]) {
+                    publish_frame(sim, &group, first, i - first, &now);
+                    first = i;
+                }
             }
-            thread_unlock(&sim->thread_ctx);
         }
 
-        fclose(fp);
+        if (!sim->thread_ctx.running) break;
+        LOG_INFO("Simulator: Played %.1f s of scenario in %.1f s", scenario_duration_ms(&scenario) / 1000.0,
+                 mec_time_to_ms(mec_clock_real_ns() - real_start) / 1000.0);
         if (!sim->config.loop) break;
         LOG_INFO("Simulation loop restart");
-        track_list_clear(sim->video_tracks);
-        track_list_clear(sim->radar_tracks);
+        real_start = mec_clock_real_ns();
     }
     
+    // 回放结束后时间恢复流逝，否则各线程的超时永远不会到期
+    if (virtual_clock) mec_clock_set_virtual(0);
+    scenario_close(&scenario);
     return NULL;
 }
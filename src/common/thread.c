@@ -2,8 +2,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-int thread_create(thread_context_t *ctx, void *(*start_routine)(void*), void *arg) {
-    ctx->running = true;
+int thread_context_init(thread_context_t *ctx) {
+    ctx->thread = 0;
+    ctx->running = false;
     if (pthread_mutex_init(&ctx->mutex, NULL) != 0) {
         return -1;
     }
@@ -11,11 +12,27 @@ int thread_create(thread_context_t *ctx, void *(*start_routine)(void*), void *ar
         pthread_mutex_destroy(&ctx->mutex);
         return -1;
     }
-    
-    return pthread_create(&ctx->thread, NULL, start_routine, arg);
+    return 0;
 }
 
-void thread_destroy(thread_context_t *ctx) {
+void thread_context_cleanup(thread_context_t *ctx) {
+    if (ctx) {
+        pthread_mutex_destroy(&ctx->mutex);
+        pthread_cond_destroy(&ctx->cond);
+    }
+}
+
+int thread_start(thread_context_t *ctx, void *(*start_routine)(void*), void *arg) {
+    ctx->running = true;
+    if (pthread_create(&ctx->thread, NULL, start_routine, arg) != 0) {
+        ctx->running = false;
+        ctx->thread = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void thread_stop(thread_context_t *ctx) {
     if (ctx) {
         // 确保线程处于非运行状态
         ctx->running = false;
@@ -30,11 +47,23 @@ void thread_destroy(thread_context_t *ctx) {
             if (pthread_join(ctx->thread, NULL) != 0) {
                 // LOG_WARN("Thread: Failed to join thread");
             }
+            ctx->thread = 0;
         }
-        
+    }
+}
+
+int thread_create(thread_context_t *ctx, void *(*start_routine)(void*), void *arg) {
+    if (thread_context_init(ctx) != 0) {
+        return -1;
+    }
+    return thread_start(ctx, start_routine, arg);
+}
+
+void thread_destroy(thread_context_t *ctx) {
+    if (ctx) {
+        thread_stop(ctx);
         // 销毁同步原语
-        pthread_mutex_destroy(&ctx->mutex);
-        pthread_cond_destroy(&ctx->cond);
+        thread_context_cleanup(ctx);
     }
 }
 
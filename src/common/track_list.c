@@ -15,6 +15,25 @@ track_list_t* track_list_create(int initial_capacity) {
     list->capacity = initial_capacity;
     list->ref_count = 1; // 初始引用为 1
     pthread_mutex_init(&list->ref_lock, NULL);
+    list->release_fn = NULL;
+    list->release_ctx = NULL;
+    
+    return list;
+}
+
+track_list_t* track_list_wrap(target_track_t *tracks, int count, void (*release_fn)(void *ctx), void *ctx) {
+    if (!tracks || count < 0 || !release_fn) return NULL;
+    
+    track_list_t *list = mec_malloc(sizeof(track_list_t));
+    if (!list) return NULL;
+    
+    list->tracks = tracks;
+    list->count = count;
+    list->capacity = count;
+    list->ref_count = 1;
+    pthread_mutex_init(&list->ref_lock, NULL);
+    list->release_fn = release_fn;
+    list->release_ctx = ctx;
     
     return list;
 }
@@ -39,7 +58,8 @@ void track_list_release(track_list_t *list) {
     
     if (destroy) {
         pthread_mutex_destroy(&list->ref_lock);
-        mec_free(list->tracks);
+        if (list->release_fn) list->release_fn(list->release_ctx);  // 外部缓冲归还给所有者
+        else mec_free(list->tracks);
         mec_free(list);
     }
 }
@@ -48,6 +68,7 @@ int track_list_add(track_list_t *list, const target_track_t *track) {
     if (!list || !track) return -1;
     
     if (list->count >= list->capacity) {
+        if (list->release_fn) return -1;   // 外部缓冲不能扩容
         int new_capacity = list->capacity * 2;
         target_track_t *new_tracks = mec_realloc(list->tracks, 
                                                 new_capacity * sizeof(target_track_t));
@@ -1,66 +1,261 @@
 #include "mec_v2x.h"
-#include <arpa/inet.h>
+#include "mec_clock.h"
+#include "mec_logging.h"
+#include <stdatomic.h>
 
 /**
  * @file v2x_codec.c
  * @brief V2X 协议编解码实现
  * 
- * 采用大端字节序 (Network Byte Order) 进行序列化，确保跨平台兼容性。
+ * 采用大端字节序 (Network Byte Order) 逐字节读写，不经结构体强转，
+ * 任意偏移均对齐安全，64 位时间戳同样按大端写出。
  */
 
-int v2x_encode_rsm(const track_list_t *tracks, uint32_t rsu_id, uint8_t *out_buf, int *out_len) {
-    if (!tracks || !out_buf || !out_len) return -1;
+static inline void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static inline void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static inline void put_u64(uint8_t *p, uint64_t v) {
+    put_u32(p, (uint32_t)(v >> 32));
+    put_u32(p + 4, (uint32_t)v);
+}
+
+static inline uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t get_u32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline uint64_t get_u64(const uint8_t *p) {
+    return ((uint64_t)get_u32(p) << 32) | get_u32(p + 4);
+}
+
+// 按范围钳位后取整，避免越界值在无符号字段里回绕
+static inline long clamp_round(double v, long lo, long hi) {
+    if (!(v > lo)) return lo;   // 同时处理 NaN
+    if (v >= hi) return hi;
+    return lround(v);
+}
 
-    int max_len = *out_len;
-    int current_pos = 0;
-
-    // 1. 填充头部 (Header)
-    if (max_len < (int)sizeof(v2x_header_t)) return -1;
-    
-    v2x_header_t *hdr = (v2x_header_t *)out_buf;
-    hdr->magic = 0x56; // 'V'
-    hdr->version = V2X_PROTOCOL_VER;
-    hdr->msg_type = V2X_MSG_RSM;
-    hdr->device_id = htonl(rsu_id);
-    
+static uint64_t wall_ms(void) {
     struct timeval tv;
-    gettimeofday(&tv, NULL);
-    uint64_t ms = (uint64_t)tv.tv_sec * 1000 + (tv.tv_usec / 1000);
-    // 这里简单处理字节序，实际复杂场景建议使用专用 64位转换函数
-    memcpy(&hdr->timestamp, &ms, 8); 
+    mec_clock_wall(&tv);
+    return (uint64_t)tv.tv_sec * 1000 + (tv.tv_usec / 1000);
+}
 
-    current_pos += sizeof(v2x_header_t);
+static void write_header(uint8_t *p, const v2x_segment_header_t *h) {
+    p[0] = h->magic;
+    p[1] = h->version;
+    p[2] = h->msg_type;
+    p[3] = h->flags;
+    put_u32(p + 4, h->device_id);
+    put_u64(p + 8, h->timestamp);
+    put_u16(p + 16, h->msg_seq);
+    put_u16(p + 18, h->seg_index);
+    put_u16(p + 20, h->seg_count);
+    put_u16(p + 22, h->total);
+    put_u16(p + 24, h->count);
+}
+
+static atomic_flag g_id_wrap_warned = ATOMIC_FLAG_INIT;
+
+// 线格式 ID 只有 16 位：融合全局 ID 持续递增，超出后按低 16 位回绕（钳位会让所有
+// 超限航迹共用同一 ID），首次发生时告警一次
+static uint16_t participant_id(int id) {
+    if ((id < 0 || id > UINT16_MAX) && !atomic_flag_test_and_set(&g_id_wrap_warned)) {
+        LOG_WARN("V2X: Track id %d exceeds the 16-bit participant id, sending low 16 bits", id);
+    }
+    return (uint16_t)((unsigned int)id & 0xFFFFu);
+}
+
+static void write_participant(uint8_t *p, const target_track_t *t) {
+    put_u16(p, participant_id(t->id));
+    p[2] = (uint8_t)t->type;
+
+    // 坐标转换为国标要求的 1e-7 度格式
+    put_u32(p + 3, (uint32_t)(int32_t)clamp_round(t->position.latitude * 10000000.0, -900000000L, 900000000L));
+    put_u32(p + 7, (uint32_t)(int32_t)clamp_round(t->position.longitude * 10000000.0, -1800000000L, 1800000000L));
+
+    // 速度转换 (单位: 0.02 m/s)
+    put_u16(p + 11, (uint16_t)clamp_round(t->velocity / 0.02, 0, UINT16_MAX));
 
-    // 2. 写入目标数量
-    if (current_pos + 1 > max_len) return -1;
-    out_buf[current_pos++] = (uint8_t)tracks->count;
+    // 航向转换 (单位: 0.0125 度)，先归一化到 [0, 360)
+    double heading = fmod(t->heading, 360.0);
+    if (heading < 0) heading += 360.0;
+    put_u16(p + 13, (uint16_t)(clamp_round(heading / 0.0125, 0, 28800) % 28800));
 
-    // 3. 序列化每一个目标
+    // 置信度转换 (0-200)
+    p[15] = (uint8_t)clamp_round(t->confidence * 200.0, 0, 200);
+}
+
+v2x_encoder_t* v2x_encoder_create(uint32_t rsu_id, int mtu, int max_participants) {
+    if (mtu <= 0) mtu = V2X_DEFAULT_MTU;
+    if (mtu < V2X_SEGMENT_HEADER_LEN + V2X_PARTICIPANT_LEN) {
+        LOG_ERROR("V2X MTU %d too small for a single participant", mtu);
+        return NULL;
+    }
+    if (max_participants < 1) max_participants = 1;
+    if (max_participants > V2X_MAX_PARTICIPANTS) max_participants = V2X_MAX_PARTICIPANTS;
+
+    v2x_encoder_t *enc = mec_calloc(1, sizeof(v2x_encoder_t));
+    if (!enc) return NULL;
+    enc->rsu_id = rsu_id;
+    enc->mtu = mtu;
+    enc->per_segment = (mtu - V2X_SEGMENT_HEADER_LEN) / V2X_PARTICIPANT_LEN;
+    if (enc->per_segment > V2X_MAX_PARTICIPANTS) enc->per_segment = V2X_MAX_PARTICIPANTS;
+
+    int segments = (max_participants + enc->per_segment - 1) / enc->per_segment;
+    enc->body = mec_malloc((size_t)max_participants * V2X_PARTICIPANT_LEN);
+    enc->headers = mec_malloc((size_t)segments * V2X_SEGMENT_HEADER_LEN);
+    enc->iov = mec_malloc((size_t)segments * 2 * sizeof(struct iovec));
+    if (!enc->body || !enc->headers || !enc->iov) {
+        v2x_encoder_destroy(enc);
+        return NULL;
+    }
+    enc->body_capacity = max_participants;
+    enc->segment_capacity = segments;
+    return enc;
+}
+
+void v2x_encoder_destroy(v2x_encoder_t *enc) {
+    if (!enc) return;
+    mec_free(enc->body);
+    mec_free(enc->headers);
+    mec_free(enc->iov);
+    mec_free(enc);
+}
+
+// 容量不足时扩容；稳态下容量已覆盖峰值目标数，不会触发
+static int encoder_reserve(v2x_encoder_t *enc, int participants, int segments) {
+    if (participants > enc->body_capacity) {
+        uint8_t *body = mec_realloc(enc->body, (size_t)participants * V2X_PARTICIPANT_LEN);
+        if (!body) return -1;
+        enc->body = body;
+        enc->body_capacity = participants;
+    }
+    if (segments > enc->segment_capacity) {
+        uint8_t *headers = mec_realloc(enc->headers, (size_t)segments * V2X_SEGMENT_HEADER_LEN);
+        if (!headers) return -1;
+        enc->headers = headers;
+        struct iovec *iov = mec_realloc(enc->iov, (size_t)segments * 2 * sizeof(struct iovec));
+        if (!iov) return -1;
+        enc->iov = iov;
+        enc->segment_capacity = segments;
+    }
+    return 0;
+}
+
+int v2x_encode_rsm_segments(v2x_encoder_t *enc, const track_list_t *tracks, const struct iovec **iov_out) {
+    if (!enc || !tracks || !iov_out) return -1;
+
+    int total = tracks->count;
+    if (total > V2X_MAX_PARTICIPANTS) {
+        LOG_ERROR("V2X RSM cannot carry %d participants (limit %d)", total, V2X_MAX_PARTICIPANTS);
+        return -1;
+    }
+    int segments = total > 0 ? (total + enc->per_segment - 1) / enc->per_segment : 1;
+    if (encoder_reserve(enc, total, segments) != 0) return -1;
+
+    // 目标体直接从快照写入连续区，各分段只引用其中的切片
+    for (int i = 0; i < total; i++) {
+        write_participant(enc->body + (size_t)i * V2X_PARTICIPANT_LEN, &tracks->tracks[i]);
+    }
+
+    v2x_segment_header_t h = {
+        .magic = V2X_MAGIC,
+        .version = V2X_PROTOCOL_VER,
+        .msg_type = V2X_MSG_RSM,
+        .device_id = enc->rsu_id,
+        .timestamp = wall_ms(),
+        .msg_seq = enc->msg_seq++,
+        .seg_count = (uint16_t)segments,
+        .total = (uint16_t)total,
+    };
+    for (int s = 0; s < segments; s++) {
+        int first = s * enc->per_segment;
+        int count = total - first < enc->per_segment ? total - first : enc->per_segment;
+        uint8_t *hdr = enc->headers + (size_t)s * V2X_SEGMENT_HEADER_LEN;
+
+        h.seg_index = (uint16_t)s;
+        h.count = (uint16_t)count;
+        h.flags = (s == segments - 1) ? V2X_FLAG_LAST_SEGMENT : 0;
+        write_header(hdr, &h);
+
+        enc->iov[2 * s].iov_base = hdr;
+        enc->iov[2 * s].iov_len = V2X_SEGMENT_HEADER_LEN;
+        enc->iov[2 * s + 1].iov_base = enc->body + (size_t)first * V2X_PARTICIPANT_LEN;
+        enc->iov[2 * s + 1].iov_len = (size_t)count * V2X_PARTICIPANT_LEN;
+    }
+
+    *iov_out = enc->iov;
+    return segments;
+}
+
+int v2x_encode_rsm(const track_list_t *tracks, uint32_t rsu_id, uint8_t *out_buf, int *out_len) {
+    if (!tracks || !out_buf || !out_len) return -1;
+    if (tracks->count > V2X_MAX_PARTICIPANTS) return -1;
+
+    long need = V2X_SEGMENT_HEADER_LEN + (long)tracks->count * V2X_PARTICIPANT_LEN;
+    if (need > *out_len) return -1;
+
+    v2x_segment_header_t h = {
+        .magic = V2X_MAGIC,
+        .version = V2X_PROTOCOL_VER,
+        .msg_type = V2X_MSG_RSM,
+        .flags = V2X_FLAG_LAST_SEGMENT,
+        .device_id = rsu_id,
+        .timestamp = wall_ms(),
+        .seg_count = 1,
+        .total = (uint16_t)tracks->count,
+        .count = (uint16_t)tracks->count,
+    };
+    write_header(out_buf, &h);
     for (int i = 0; i < tracks->count; i++) {
-        if (current_pos + (int)sizeof(v2x_rsm_participant_t) > max_len) break;
-
-        const target_track_t *t = &tracks->tracks[i];
-        v2x_rsm_participant_t *p = (v2x_rsm_participant_t *)(out_buf + current_pos);
-
-        p->target_id = htons((uint16_t)t->id);
-        p->type = (uint8_t)t->type;
-        
-        // 坐标转换为国标要求的 1e-7 度格式
-        p->lat = htonl((int32_t)(t->position.latitude * 10000000.0));
-        p->lon = htonl((int32_t)(t->position.longitude * 10000000.0));
-        
-        // 速度转换 (单位: 0.02 m/s)
-        p->speed = htons((uint16_t)(t->velocity / 0.02));
-        
-        // 航向转换 (单位: 0.0125 度)
-        p->heading = htons((uint16_t)(t->heading / 0.0125));
-        
-        // 置信度转换 (0-200)
-        p->confidence = (uint8_t)(t->confidence * 200.0);
-
-        current_pos += sizeof(v2x_rsm_participant_t);
+        write_participant(out_buf + V2X_SEGMENT_HEADER_LEN + (size_t)i * V2X_PARTICIPANT_LEN, &tracks->tracks[i]);
     }
 
-    *out_len = current_pos;
+    *out_len = (int)need;
     return 0;
 }
+
+int v2x_decode_segment_header(const uint8_t *buf, int len, v2x_segment_header_t *hdr) {
+    if (!buf || !hdr || len < V2X_SEGMENT_HEADER_LEN) return -1;
+
+    hdr->magic = buf[0];
+    hdr->version = buf[1];
+    hdr->msg_type = buf[2];
+    hdr->flags = buf[3];
+    hdr->device_id = get_u32(buf + 4);
+    hdr->timestamp = get_u64(buf + 8);
+    hdr->msg_seq = get_u16(buf + 16);
+    hdr->seg_index = get_u16(buf + 18);
+    hdr->seg_count = get_u16(buf + 20);
+    hdr->total = get_u16(buf + 22);
+    hdr->count = get_u16(buf + 24);
+
+    if (hdr->magic != V2X_MAGIC || hdr->version != V2X_PROTOCOL_VER) return -1;
+    if (hdr->seg_index >= hdr->seg_count || hdr->count > hdr->total) return -1;
+    if (len < V2X_SEGMENT_HEADER_LEN + hdr->count * V2X_PARTICIPANT_LEN) return -1;
+    return 0;
+}
+
+void v2x_decode_participant(const uint8_t *segment, int index, v2x_rsm_participant_t *p) {
+    const uint8_t *q = segment + V2X_SEGMENT_HEADER_LEN + (size_t)index * V2X_PARTICIPANT_LEN;
+    p->target_id = get_u16(q);
+    p->type = q[2];
+    p->lat = (int32_t)get_u32(q + 3);
+    p->lon = (int32_t)get_u32(q + 7);
+    p->speed = get_u16(q + 11);
+    p->heading = get_u16(q + 13);
+    p->confidence = q[15];
+}
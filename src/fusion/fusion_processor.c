@@ -1,7 +1,10 @@
 #include "mec_fusion.h"
 #include "mec_logging.h"
+#include "mec_geo.h"
+#include "mec_clock.h"
 #include <math.h>
-#include <math.h>
+
+#define FUSION_TICK_NS (FUSION_TICK_MS * MEC_NS_PER_MS)
 
 /**
  * @file fusion_processor.c
@@ -47,19 +50,35 @@ static int mat_inv_2x2(const double *A, double *B) {
 fusion_processor_t* fusion_processor_create(const fusion_config_t *config) {
     if (!config) return NULL;
     
-    fusion_processor_t *processor = mec_malloc(sizeof(fusion_processor_t));
+    fusion_processor_t *processor = mec_calloc(1, sizeof(fusion_processor_t));
     if (!processor) return NULL;
     
+    // 锁随处理器创建：未启动融合线程时（基准测试直接调用 add_tracks/step）同样可用
+    if (thread_context_init(&processor->thread_ctx) != 0) {
+        mec_free(processor);
+        return NULL;
+    }
     processor->config = *config;
-    processor->track_capacity = 100;
+    processor->track_capacity = config->max_tracks > 0 ? config->max_tracks : FUSION_DEFAULT_MAX_TRACKS;
     processor->tracks = mec_calloc(processor->track_capacity, sizeof(fused_track_t));
     if (!processor->tracks) {
+        thread_context_cleanup(&processor->thread_ctx);
+        mec_free(processor);
+        return NULL;
+    }
+    
+    processor->id_cache = mec_calloc(FUSION_ID_CACHE_SIZE, sizeof(fusion_id_entry_t));
+    if (!processor->id_cache) {
+        mec_free(processor->tracks);
+        thread_context_cleanup(&processor->thread_ctx);
         mec_free(processor);
         return NULL;
     }
     
     processor->track_count = 0;
     processor->next_global_id = 1;
+    processor->cache_hits = 0;
+    processor->cache_misses = 0;
     processor->output_tracks = track_list_create(processor->track_capacity);
     
     LOG_INFO("Fusion: Processor created (Assoc Threshold: %.2f)", config->association_threshold);
@@ -69,14 +88,16 @@ fusion_processor_t* fusion_processor_create(const fusion_config_t *config) {
 void fusion_processor_destroy(fusion_processor_t *processor) {
     if (!processor) return;
     fusion_processor_stop(processor);
+    thread_context_cleanup(&processor->thread_ctx);
     track_list_release(processor->output_tracks);
+    mec_free(processor->id_cache);
     mec_free(processor->tracks);
     mec_free(processor);
 }
 
 int fusion_processor_start(fusion_processor_t *processor) {
     if (!processor) return -1;
-    if (thread_create(&processor->thread_ctx, fusion_processing_thread, processor) != 0) {
+    if (thread_start(&processor->thread_ctx, fusion_processing_thread, processor) != 0) {
         LOG_ERROR("Fusion: Failed to start thread");
         return -1;
     }
@@ -84,7 +105,7 @@ int fusion_processor_start(fusion_processor_t *processor) {
 }
 
 void fusion_processor_stop(fusion_processor_t *processor) {
-    if (processor) thread_destroy(&processor->thread_ctx);
+    if (processor) thread_stop(&processor->thread_ctx);
 }
 
 /* --- 卡尔曼滤波核心算法改进 --- */
@@ -100,8 +121,8 @@ int initialize_kalman_filter(kalman_state_t *state, const target_track_t *track)
     memset(state->covariance, 0, sizeof(state->covariance));
 
     // 初始位置
-    state->state[0] = track->position.longitude;
-    state->state[1] = track->position.latitude;
+    state->state[0] = track->local.east;
+    state->state[1] = track->local.north;
     
     // 初始速度 (根据航向和速率换算)
     double angle = track->heading * M_PI / 180.0;
@@ -176,7 +197,7 @@ int update_kalman_filter(kalman_state_t *state, const target_track_t *meas) {
     double R[4] = {0.1, 0, 0, 0.1};
 
     // 3. 计算创新值 (Innovation) y = z - H*X
-    double z[2] = {meas->position.longitude, meas->position.latitude};
+    double z[2] = {meas->local.east, meas->local.north};
     double y[2] = {z[0] - state->state[0], z[1] - state->state[1]};
 
     // 4. 计算创新协方差 S = H * P * H^T + R
@@ -224,6 +245,7 @@ int update_kalman_filter(kalman_state_t *state, const target_track_t *meas) {
 /**
  * @brief 数据关联算法：使用马氏距离 (Mahalanobis Distance)
  * 比简单的欧式距离更科学，因为它考虑了目标当前的运动不确定性。
+ * 所有坐标均为站点 ENU 米制坐标，无需任何大地坐标换算。
  */
 double calculate_track_distance(const fused_track_t *track, const target_track_t *meas) {
     if (!track || !meas) return 1e10;
@@ -232,8 +254,8 @@ double calculate_track_distance(const fused_track_t *track, const target_track_t
     
     // 残差 y = z - H*X
     double dy[2] = {
-        meas->position.longitude - st->state[0],
-        meas->position.latitude - st->state[1]
+        meas->local.east - st->state[0],
+        meas->local.north - st->state[1]
     };
 
     // 简化版马氏距离：使用协方差矩阵的位置分量作为权重
@@ -246,6 +268,47 @@ double calculate_track_distance(const fused_track_t *track, const target_track_t
     return sqrt(dist_sq);
 }
 
+/* --- 上游航迹 ID 缓存 --- */
+
+static inline uint64_t id_cache_key(int sensor_id, int track_id) {
+    return ((uint64_t)(uint32_t)sensor_id << 32) | (uint32_t)track_id;
+}
+
+static inline unsigned id_cache_slot(uint64_t key) {
+    return (unsigned)((key * 0x9E3779B97F4A7C15ull) >> 32) & (FUSION_ID_CACHE_SIZE - 1);
+}
+
+// 返回缓存中仍然有效的融合航迹下标，未命中返回 -1
+static int id_cache_lookup(fusion_processor_t *processor, uint64_t key) {
+    unsigned slot = id_cache_slot(key);
+    for (int p = 0; p < FUSION_ID_CACHE_PROBES; p++) {
+        const fusion_id_entry_t *e = &processor->id_cache[(slot + p) & (FUSION_ID_CACHE_SIZE - 1)];
+        if (e->global_id == 0) return -1;
+        if (e->key != key) continue;
+        if (e->index < processor->track_count && processor->tracks[e->index].global_id == e->global_id) {
+            return e->index;
+        }
+        return -1;
+    }
+    return -1;
+}
+
+static void id_cache_store(fusion_processor_t *processor, uint64_t key, int index) {
+    unsigned slot = id_cache_slot(key);
+    fusion_id_entry_t *victim = &processor->id_cache[slot];
+    for (int p = 0; p < FUSION_ID_CACHE_PROBES; p++) {
+        fusion_id_entry_t *e = &processor->id_cache[(slot + p) & (FUSION_ID_CACHE_SIZE - 1)];
+        if (e->global_id == 0 || e->key == key) {
+            victim = e;
+            break;
+        }
+    }
+    // 探测窗口已满时覆盖首槽（被覆盖的条目下次未命中后会重新写入）
+    victim->key = key;
+    victim->global_id = processor->tracks[index].global_id;
+    victim->index = index;
+}
+
 /* --- 融合线程逻辑 (保持异步架构) --- */
 
 int fusion_processor_add_tracks(fusion_processor_t *processor, const track_list_t *tracks, int sensor_id) {
@@ -254,21 +317,32 @@ int fusion_processor_add_tracks(fusion_processor_t *processor, const track_list_
     thread_lock(&processor->thread_ctx);
     for (int i = 0; i < tracks->count; i++) {
         const target_track_t *s_track = &tracks->tracks[i];
+        uint64_t key = id_cache_key(sensor_id, s_track->id);
         
-        int best_idx = -1;
-        double min_dist = processor->config.association_threshold;
-        
-        for (int j = 0; j < processor->track_count; j++) {
-            double dist = calculate_track_distance(&processor->tracks[j], s_track);
-            if (dist < min_dist) {
-                min_dist = dist;
-                best_idx = j;
+        // 已知的 (传感器, 上游 ID) 配对只做一次距离校验
+        int best_idx = id_cache_lookup(processor, key);
+        if (best_idx >= 0 &&
+            calculate_track_distance(&processor->tracks[best_idx], s_track) <
+                processor->config.association_threshold * FUSION_ID_CACHE_GATE_SCALE) {
+            processor->cache_hits++;
+        } else {
+            processor->cache_misses++;
+            best_idx = -1;
+            double min_dist = processor->config.association_threshold;
+            
+            for (int j = 0; j < processor->track_count; j++) {
+                double dist = calculate_track_distance(&processor->tracks[j], s_track);
+                if (dist < min_dist) {
+                    min_dist = dist;
+                    best_idx = j;
+                }
             }
         }
         
         if (best_idx >= 0) {
             update_fused_track(&processor->tracks[best_idx], s_track);
             processor->tracks[best_idx].sensor_mask |= (1 << (sensor_id - 1));
+            id_cache_store(processor, key, best_idx);
         } else if (processor->track_count < processor->track_capacity) {
             // 创建新航迹
             fused_track_t *new_t = &processor->tracks[processor->track_count++];
@@ -277,7 +351,9 @@ int fusion_processor_add_tracks(fusion_processor_t *processor, const track_list_
             new_t->confidence = s_track->confidence;
             new_t->age = 0;
             new_t->sensor_mask = (1 << (sensor_id - 1));
+            new_t->last_update = s_track->timestamp;   // 否则首拍预测的 dt 从纪元起算
             initialize_kalman_filter(&new_t->filter_state, s_track);
+            id_cache_store(processor, key, processor->track_count - 1);
         }
     }
     thread_unlock(&processor->thread_ctx);
@@ -292,42 +368,65 @@ int update_fused_track(fused_track_t *fused_track, const target_track_t *sensor_
     return 0;
 }
 
+int fusion_processor_step(fusion_processor_t *proc) {
+    if (!proc) return -1;
+
+    thread_lock(&proc->thread_ctx);
+    struct timeval now;
+    mec_clock_wall(&now);
+    mec_time_ns_t now_ns = mec_time_from_timeval(&now);
+    
+    track_list_clear(proc->output_tracks);
+    for (int i = 0; i < proc->track_count; i++) {
+        fused_track_t *t = &proc->tracks[i];
+        double dt = (double)(now_ns - mec_time_from_timeval(&t->last_update)) / MEC_NS_PER_SEC;
+        
+        predict_track_state(t, dt);
+        t->age++;
+
+        // 航迹管理：超时或置信度过低则删除
+        if (t->age > proc->config.max_track_age || t->confidence < proc->config.confidence_threshold) {
+            if (i < proc->track_count - 1) proc->tracks[i] = proc->tracks[proc->track_count - 1];
+            proc->track_count--; i--;
+            continue;
+        }
+
+        // 转换输出格式
+        target_track_t out;
+        out.id = t->global_id;
+        out.type = t->type;
+        out.local.east = t->filter_state.state[0];
+        out.local.north = t->filter_state.state[1];
+        out.local.up = 0.0;
+        out.velocity = sqrt(t->filter_state.state[2]*t->filter_state.state[2] + t->filter_state.state[3]*t->filter_state.state[3]);
+        out.heading = atan2(t->filter_state.state[3], t->filter_state.state[2]) * 180.0 / M_PI;
+        out.confidence = t->confidence;
+        out.timestamp = now;
+        out.sensor_id = 0;
+        track_list_add(proc->output_tracks, &out);
+    }
+    
+    // 融合在 ENU 米制坐标下完成，只在输出边界整体换算一次 WGS84
+    geo_tracks_to_wgs84(geo_get_site(), proc->output_tracks->tracks, proc->output_tracks->count);
+    thread_unlock(&proc->thread_ctx);
+    return 0;
+}
+
 void* fusion_processing_thread(void *arg) {
     fusion_processor_t *proc = (fusion_processor_t*)arg;
+    mec_time_ns_t next_tick = mec_clock_now();
     while (proc->thread_ctx.running) {
-        thread_lock(&proc->thread_ctx);
-        struct timeval now;
-        gettimeofday(&now, NULL);
-        
-        track_list_clear(proc->output_tracks);
-        for (int i = 0; i < proc->track_count; i++) {
-            fused_track_t *t = &proc->tracks[i];
-            double dt = (now.tv_sec - t->last_update.tv_sec) + (now.tv_usec - t->last_update.tv_usec)/1000000.0;
-            
-            predict_track_state(t, dt);
-            t->age++;
-
-            // 航迹管理：超时或置信度过低则删除
-            if (t->age > proc->config.max_track_age || t->confidence < proc->config.confidence_threshold) {
-                if (i < proc->track_count - 1) proc->tracks[i] = proc->tracks[proc->track_count - 1];
-                proc->track_count--; i--;
-                continue;
-            }
+        fusion_processor_step(proc);
 
-            // 转换输出格式
-            target_track_t out;
-            out.id = t->global_id;
-            out.type = t->type;
-            out.position.longitude = t->filter_state.state[0];
-            out.position.latitude = t->filter_state.state[1];
-            out.velocity = sqrt(t->filter_state.state[2]*t->filter_state.state[2] + t->filter_state.state[3]*t->filter_state.state[3]);
-            out.heading = atan2(t->filter_state.state[3], t->filter_state.state[2]) * 180.0 / M_PI;
-            out.confidence = t->confidence;
-            out.timestamp = now;
-            track_list_add(proc->output_tracks, &out);
+        // 20Hz 融合频率：按系统时钟等到下一拍（虚拟时钟下由回放推进），停止时被 thread_destroy 唤醒
+        thread_lock(&proc->thread_ctx);
+        next_tick += FUSION_TICK_NS;
+        mec_time_ns_t mono = mec_clock_now();
+        if (next_tick < mono) next_tick = mono + FUSION_TICK_NS;   // 处理超时不补拍
+        while (proc->thread_ctx.running &&
+               mec_clock_cond_timedwait(&proc->thread_ctx.cond, &proc->thread_ctx.mutex, next_tick) != ETIMEDOUT) {
         }
         thread_unlock(&proc->thread_ctx);
-        usleep(50000); // 20Hz 融合频率
     }
     return NULL;
 }
@@ -335,3 +434,26 @@ void* fusion_processing_thread(void *arg) {
 track_list_t* fusion_processor_get_tracks(fusion_processor_t *processor) {
     return (processor) ? processor->output_tracks : NULL;
 }
+
+int fusion_processor_snapshot(fusion_processor_t *processor, track_list_t *out) {
+    if (!processor || !out) return -1;
+    thread_lock(&processor->thread_ctx);
+    track_list_clear(out);
+    const track_list_t *src = processor->output_tracks;
+    for (int i = 0; i < src->count; i++) {
+        if (track_list_add(out, &src->tracks[i]) != 0) break;
+    }
+    int count = out->count;
+    thread_unlock(&processor->thread_ctx);
+    return count;
+}
+
+int fusion_processor_get_stats(fusion_processor_t *processor, fusion_stats_t *stats) {
+    if (!processor || !stats) return -1;
+    thread_lock(&processor->thread_ctx);
+    stats->track_count = processor->track_count;
+    stats->cache_hits = processor->cache_hits;
+    stats->cache_misses = processor->cache_misses;
+    thread_unlock(&processor->thread_ctx);
+    return 0;
+}
@@ -1,15 +1,21 @@
 #include "mec_common.h"
 #include "mec_video.h"
+#include "mec_camera_manager.h"
 #include "mec_radar.h"
 #include "mec_fusion.h"
 #include "mec_simulator.h"
 #include "mec_queue.h"
 #include "mec_v2x.h"
+#include "mec_clock.h"
 #include "mec_metrics.h"
 #include "mec_monitor.h"
+#include "mec_ingest.h"
+#include "mec_geo.h"
 #include <signal.h>
 #include <stdint.h>
 
+#define MEC_MAX_RADARS 8
+
 static int running = 1;
 static int reload_config = 0;
 
@@ -24,8 +30,136 @@ void signal_handler(int sig) {
     }
 }
 
+/**
+ * @brief 读取多实例传感器（雷达、相机）的单个配置项
+ *
+ * 优先查找 [section.N] 段中的键，找不到时回退到公共 [section] 段。
+ */
+static void indexed_key(char *out, size_t size, const char *section, int index, const char *key) {
+    snprintf(out, size, "%s.%d.%s", section, index, key);
+}
+
+static void indexed_cfg_string(config_t *config, const char *section, int index, const char *key,
+                               char *out, size_t size, const char *default_value) {
+    char full_key[MEC_CONFIG_KEY_LEN];
+    char fallback[MEC_CONFIG_VALUE_LEN];
+    snprintf(full_key, sizeof(full_key), "%s.%s", section, key);
+    MEC_LOG_ERROR_IF_ERROR(config_get_string(config, full_key, fallback, sizeof(fallback), default_value));
+    indexed_key(full_key, sizeof(full_key), section, index, key);
+    MEC_LOG_ERROR_IF_ERROR(config_get_string(config, full_key, out, size, fallback));
+}
+
+static void indexed_cfg_int(config_t *config, const char *section, int index, const char *key,
+                            int *out, int default_value) {
+    char full_key[MEC_CONFIG_KEY_LEN];
+    int fallback;
+    snprintf(full_key, sizeof(full_key), "%s.%s", section, key);
+    MEC_LOG_ERROR_IF_ERROR(config_get_int(config, full_key, &fallback, default_value));
+    indexed_key(full_key, sizeof(full_key), section, index, key);
+    MEC_LOG_ERROR_IF_ERROR(config_get_int(config, full_key, out, fallback));
+}
+
+static void indexed_cfg_double(config_t *config, const char *section, int index, const char *key,
+                               double *out, double default_value) {
+    char full_key[MEC_CONFIG_KEY_LEN];
+    double fallback;
+    snprintf(full_key, sizeof(full_key), "%s.%s", section, key);
+    MEC_LOG_ERROR_IF_ERROR(config_get_double(config, full_key, &fallback, default_value));
+    indexed_key(full_key, sizeof(full_key), section, index, key);
+    MEC_LOG_ERROR_IF_ERROR(config_get_double(config, full_key, out, fallback));
+}
+
+static void load_radar_config(config_t *config, int index, radar_config_t *cfg) {
+    char value[256];
+    
+    memset(cfg, 0, sizeof(*cfg));
+    indexed_cfg_string(config, "radar", index, "transport", value, sizeof(value), "serial");
+    cfg->transport = radar_transport_from_string(value);
+    indexed_cfg_string(config, "radar", index, "device_path", cfg->device_path, sizeof(cfg->device_path), "/dev/ttyUSB0");
+    indexed_cfg_int(config, "radar", index, "radar_id", &cfg->radar_id, index + 1);
+    indexed_cfg_int(config, "radar", index, "baud_rate", &cfg->baud_rate, 115200);
+    // -1 表示未配置，由串口驱动取默认值；显式的 0 保留（仅超时 / 非阻塞读取）
+    indexed_cfg_int(config, "radar", index, "vmin", &cfg->vmin, -1);
+    indexed_cfg_int(config, "radar", index, "vtime", &cfg->vtime, -1);
+    indexed_cfg_int(config, "radar", index, "low_latency", &cfg->low_latency, 1);
+    indexed_cfg_string(config, "radar", index, "bind_addr", cfg->bind_addr, sizeof(cfg->bind_addr), "0.0.0.0");
+    indexed_cfg_int(config, "radar", index, "udp_port", &cfg->udp_port, 5000 + index);
+    indexed_cfg_int(config, "radar", index, "rcvbuf_bytes", &cfg->rcvbuf_bytes, 0);
+    indexed_cfg_string(config, "radar", index, "can_ifname", cfg->can_ifname, sizeof(cfg->can_ifname), "can0");
+    indexed_cfg_string(config, "radar", index, "can_base_id", value, sizeof(value), "0x60A");
+    cfg->can_base_id = (int)strtol(value, NULL, 0); // 支持十六进制写法
+    indexed_cfg_double(config, "radar", index, "mount_east", &cfg->mount_east, 0.0);
+    indexed_cfg_double(config, "radar", index, "mount_north", &cfg->mount_north, 0.0);
+    indexed_cfg_double(config, "radar", index, "mount_yaw", &cfg->mount_yaw, 0.0);
+    indexed_cfg_string(config, "radar", index, "capture_path", cfg->capture_path, sizeof(cfg->capture_path), "");
+    indexed_cfg_string(config, "radar", index, "replay_path", cfg->replay_path, sizeof(cfg->replay_path), "");
+    indexed_cfg_double(config, "radar", index, "replay_speed", &cfg->replay_speed, 1.0);
+    indexed_cfg_int(config, "radar", index, "replay_loop", &cfg->replay_loop, 0);
+    indexed_cfg_int(config, "radar", index, "sensor_timestamps", &cfg->sensor_timestamps, 0);
+}
+
+/**
+ * @brief 读取第 index 路相机：[video.N] 覆盖 [video]，url 未配置时沿用旧的 rtsp_url
+ */
+static void load_camera_config(config_t *config, int index, camera_stream_config_t *cfg) {
+    char legacy_url[256];
+    
+    memset(cfg, 0, sizeof(*cfg));
+    indexed_cfg_string(config, "video", index, "rtsp_url", legacy_url, sizeof(legacy_url), "rtsp://192.168.1.100:554/stream");
+    indexed_cfg_string(config, "video", index, "url", cfg->url, sizeof(cfg->url), legacy_url);
+    indexed_cfg_int(config, "video", index, "camera_id", &cfg->camera_id, index);
+    indexed_cfg_double(config, "video", index, "fps", &cfg->fps, 0.0);
+    indexed_cfg_int(config, "video", index, "width", &cfg->width, 1920);
+    indexed_cfg_int(config, "video", index, "height", &cfg->height, 1080);
+}
+
+static void load_video_rate_config(config_t *config, int index, video_config_t *cfg) {
+    indexed_cfg_int(config, "video", index, "latency_budget_ms", &cfg->latency_budget_ms, VIDEO_RATE_DEFAULT_BUDGET_MS);
+    indexed_cfg_int(config, "video", index, "max_detect_interval_ms", &cfg->max_detect_interval_ms,
+                    VIDEO_RATE_DEFAULT_MAX_INTERVAL_MS);
+    indexed_cfg_double(config, "video", index, "keyframe_hz", &cfg->keyframe_hz, 0.0);
+    indexed_cfg_int(config, "video", index, "propagate_patch_px", &cfg->propagate_patch_px, PROPAGATE_DEFAULT_PATCH);
+    indexed_cfg_double(config, "video", index, "propagate_min_score", &cfg->propagate_min_score,
+                       PROPAGATE_DEFAULT_MIN_SCORE);
+    indexed_cfg_int(config, "video", index, "motion_gate", &cfg->motion_gate, 0);
+    indexed_cfg_int(config, "video", index, "motion_threshold", &cfg->motion_threshold, MOTION_DEFAULT_THRESHOLD);
+    if (cfg->motion_threshold > 255) {
+        LOG_WARN("Config: video motion_threshold %d exceeds 8-bit gray range, using 255", cfg->motion_threshold);
+        cfg->motion_threshold = 255;  // 灰度差为 8 位，SIMD 比较按字节进行
+    }
+    indexed_cfg_int(config, "video", index, "motion_refresh_ms", &cfg->motion_refresh_ms, 2000);
+    indexed_cfg_int(config, "video", index, "tile_size", &cfg->tile_size, 0);
+    indexed_cfg_int(config, "video", index, "tile_overlap", &cfg->tile_overlap, VIDEO_TILE_DEFAULT_OVERLAP);
+    indexed_cfg_int(config, "video", index, "tile_merge_px", &cfg->tile_merge_px, VIDEO_TILE_DEFAULT_MERGE_PX);
+}
+
+static void load_detector_config(config_t *config, detector_config_t *cfg) {
+    double value;
+    
+    memset(cfg, 0, sizeof(*cfg));
+    MEC_LOG_ERROR_IF_ERROR(config_get_string(config, "detector.backend", cfg->backend, sizeof(cfg->backend), "mock"));
+    MEC_LOG_ERROR_IF_ERROR(config_get_string(config, "detector.model_path", cfg->model_path, sizeof(cfg->model_path), ""));
+    MEC_LOG_ERROR_IF_ERROR(config_get_int(config, "detector.input_width", &cfg->input_width, 640));
+    MEC_LOG_ERROR_IF_ERROR(config_get_int(config, "detector.input_height", &cfg->input_height, 640));
+    MEC_LOG_ERROR_IF_ERROR(config_get_double(config, "detector.conf_threshold", &value, 0.4));
+    cfg->conf_threshold = (float)value;
+    MEC_LOG_ERROR_IF_ERROR(config_get_double(config, "detector.nms_threshold", &value, 0.45));
+    cfg->nms_threshold = (float)value;
+    MEC_LOG_ERROR_IF_ERROR(config_get_int(config, "detector.num_threads", &cfg->num_threads, 0));
+    MEC_LOG_ERROR_IF_ERROR(config_get_int(config, "detector.max_batch", &cfg->max_batch, DETECTOR_DEFAULT_BATCH));
+    MEC_LOG_ERROR_IF_ERROR(config_get_int(config, "detector.batch_window_ms", &cfg->batch_window_ms, DETECTOR_DEFAULT_WINDOW_MS));
+    MEC_LOG_ERROR_IF_ERROR(config_get_int(config, "detector.workers", &cfg->workers, 1));
+}
+
 int main(int argc, char *argv[]) {
     int sim_mode = 0;
+    radar_processor_t *radar_procs[MEC_MAX_RADARS] = {0};
+    int radar_count = 0;
+    video_processor_t *video_procs[CAMERA_MAX_STREAMS] = {0};
+    int video_count = 0;
+    mec_camera_manager_t *camera_mgr = NULL;
+    mec_ingest_bridge_t *ingest_bridge = NULL;
+    mec_detect_batcher_t *detector = NULL;
     char *config_path = "/etc/mec/mec.conf";
 
     // 1. 命令行参数解析
@@ -60,6 +194,22 @@ int main(int argc, char *argv[]) {
         }
     }
     
+    // 站点原点：所有传感器数据统一换算到该点的 ENU 坐标系下融合
+    {
+        double site_lat = GEO_DEFAULT_SITE_LAT, site_lon = GEO_DEFAULT_SITE_LON, site_alt = 0.0;
+        if (config) {
+            MEC_LOG_ERROR_IF_ERROR(config_get_double(config, "site.latitude", &site_lat, site_lat));
+            MEC_LOG_ERROR_IF_ERROR(config_get_double(config, "site.longitude", &site_lon, site_lon));
+            MEC_LOG_ERROR_IF_ERROR(config_get_double(config, "site.altitude", &site_alt, site_alt));
+        }
+        geo_site_t site;
+        if (geo_site_init(&site, site_lat, site_lon, site_alt) == 0) {
+            geo_set_site(&site);
+        } else {
+            LOG_ERROR("Invalid site origin (%.6f, %.6f)", site_lat, site_lon);
+        }
+    }
+    
     // 5. 创建全局异步消息队列 (容量设为 50)
     mec_queue_t *msg_queue = mec_queue_create(50);
     if (!msg_queue) {
@@ -88,6 +238,9 @@ int main(int argc, char *argv[]) {
         
         MEC_LOG_ERROR_IF_ERROR(config_get_int(config, "fusion.max_track_age", &temp_int, 50));
         fusion_cfg.max_track_age = temp_int;
+        
+        MEC_LOG_ERROR_IF_ERROR(config_get_int(config, "fusion.max_tracks", &temp_int, FUSION_DEFAULT_MAX_TRACKS));
+        fusion_cfg.max_tracks = temp_int;
     } else {
         fusion_cfg.association_threshold = 5.0;
         fusion_cfg.confidence_threshold = 0.3;
@@ -101,21 +254,24 @@ int main(int argc, char *argv[]) {
         goto cleanup;
     }
     
-    video_processor_t *video_proc = NULL;
-    radar_processor_t *radar_proc = NULL;
     mec_simulator_t *simulator = NULL;
     mec_monitor_t *monitor_service = NULL;  // 确保初始化为NULL
 
     // 7. 启动数据源（模拟器或真实传感器）
     if (sim_mode) {
+        // 模拟器与真实传感器一样向消息队列发布
         simulator_config_t sim_cfg = {
             .playback_speed = 1.0,
-            .loop = 1
+            .loop = 1,
+            .target_queue = msg_queue
         };
         
         char sim_data[256];
         MEC_LOG_ERROR_IF_ERROR(config_get_string(config, "sim.data_path", sim_data, sizeof(sim_data), "config/scenario_test.txt"));
         strncpy(sim_cfg.data_path, sim_data, sizeof(sim_cfg.data_path) - 1);
+        MEC_LOG_ERROR_IF_ERROR(config_get_double(config, "sim.playback_speed", &sim_cfg.playback_speed, 1.0));
+        MEC_LOG_ERROR_IF_ERROR(config_get_int(config, "sim.loop", &sim_cfg.loop, 1));
+        MEC_LOG_ERROR_IF_ERROR(config_get_int(config, "sim.virtual_clock", &sim_cfg.virtual_clock, 0));
         
         simulator = simulator_create(&sim_cfg);
         if (!simulator) {
@@ -131,47 +287,97 @@ int main(int argc, char *argv[]) {
         }
     } else {
         // 真实传感器模式：将队列句柄传入配置，实现生产者模式
-        video_config_t video_cfg = {0};
-        
-        char rtsp_url[256];
-        MEC_LOG_ERROR_IF_ERROR(config_get_string(config, "video.rtsp_url", rtsp_url, sizeof(rtsp_url), "rtsp://192.168.1.100:554/stream"));
-        strncpy(video_cfg.rtsp_url, rtsp_url, sizeof(video_cfg.rtsp_url) - 1);
-        video_cfg.camera_id = 1;
-        video_cfg.target_queue = msg_queue; // 绑定异步队列
-        
-        radar_config_t radar_cfg = {0};
-        
-        char device_path[256];
-        MEC_LOG_ERROR_IF_ERROR(config_get_string(config, "radar.device_path", device_path, sizeof(device_path), "/dev/ttyUSB0"));
-        strncpy(radar_cfg.device_path, device_path, sizeof(radar_cfg.device_path) - 1);
-        radar_cfg.radar_id = 2;
-        radar_cfg.target_queue = msg_queue; // 绑定异步队列
-        
-        video_proc = video_processor_create(&video_cfg);
-        if (!video_proc) {
-            LOG_ERROR("Failed to create video processor");
+        // 检测后端：所有相机共享一个批处理器
+        detector_config_t det_cfg;
+        load_detector_config(config, &det_cfg);
+        detector = detect_batcher_create(&det_cfg);
+        if (!detector) {
+            LOG_ERROR("Failed to create detector backend '%s'", det_cfg.backend);
             ret = MEC_ERROR_INIT_FAILED;
             goto cleanup;
         }
         
-        radar_proc = radar_processor_create(&radar_cfg);
-        if (!radar_proc) {
-            LOG_ERROR("Failed to create radar processor");
+        // 相机：video.count 路流共享 video.decode_workers 个解码线程
+        int decode_workers;
+        MEC_LOG_ERROR_IF_ERROR(config_get_int(config, "video.count", &video_count, 1));
+        MEC_LOG_ERROR_IF_ERROR(config_get_int(config, "video.decode_workers", &decode_workers, 2));
+        if (video_count < 0) video_count = 0;
+        if (video_count > CAMERA_MAX_STREAMS) video_count = CAMERA_MAX_STREAMS;
+        
+        camera_mgr = camera_manager_create(decode_workers);
+        if (!camera_mgr) {
+            LOG_ERROR("Failed to create camera manager");
             ret = MEC_ERROR_INIT_FAILED;
             goto cleanup;
         }
         
-        if (video_processor_start(video_proc) != 0) {
-            LOG_ERROR("Failed to start video processor");
-            ret = MEC_ERROR_START_FAILED;
-            goto cleanup;
+        for (int i = 0; i < video_count; i++) {
+            camera_stream_config_t stream_cfg;
+            load_camera_config(config, i + 1, &stream_cfg);
+            
+            video_config_t video_cfg = {0};
+            snprintf(video_cfg.rtsp_url, sizeof(video_cfg.rtsp_url), "%s", stream_cfg.url);
+            video_cfg.width = stream_cfg.width;
+            video_cfg.height = stream_cfg.height;
+            video_cfg.fps = (int)stream_cfg.fps;
+            video_cfg.camera_id = stream_cfg.camera_id;
+            video_cfg.target_queue = msg_queue; // 绑定异步队列
+            video_cfg.detector = detector;
+            load_video_rate_config(config, i + 1, &video_cfg);
+            
+            video_procs[i] = video_processor_create(&video_cfg);
+            if (!video_procs[i]) {
+                LOG_ERROR("Failed to create video processor %d", i + 1);
+                ret = MEC_ERROR_INIT_FAILED;
+                goto cleanup;
+            }
+            stream_cfg.processor = video_procs[i];
+            if (camera_manager_add_stream(camera_mgr, &stream_cfg) < 0) {
+                LOG_ERROR("Failed to add camera stream %d", i + 1);
+                ret = MEC_ERROR_INIT_FAILED;
+                goto cleanup;
+            }
         }
         
-        if (radar_processor_start(radar_proc) != 0) {
-            LOG_ERROR("Failed to start radar processor");
+        // 雷达：radar.count 个实例，每个实例可独立选择串口或 UDP 接入
+        MEC_LOG_ERROR_IF_ERROR(config_get_int(config, "radar.count", &radar_count, 1));
+        if (radar_count < 0) radar_count = 0;
+        if (radar_count > MEC_MAX_RADARS) radar_count = MEC_MAX_RADARS;
+        
+        for (int i = 0; i < radar_count; i++) {
+            radar_config_t radar_cfg;
+            load_radar_config(config, i + 1, &radar_cfg);
+            radar_cfg.target_queue = msg_queue; // 绑定异步队列
+            
+            radar_procs[i] = radar_processor_create(&radar_cfg);
+            if (!radar_procs[i]) {
+                LOG_ERROR("Failed to create radar processor %d", i + 1);
+                ret = MEC_ERROR_INIT_FAILED;
+                goto cleanup;
+            }
+        }
+        
+        // 处理器（检测、后处理）先启动，解码最后开始
+        for (int i = 0; i < video_count; i++) {
+            if (video_processor_start(video_procs[i]) != 0) {
+                LOG_ERROR("Failed to start video processor %d", i + 1);
+                ret = MEC_ERROR_START_FAILED;
+                goto cleanup;
+            }
+        }
+        if (video_count > 0 && camera_manager_start(camera_mgr) != 0) {
+            LOG_ERROR("Failed to start camera manager");
             ret = MEC_ERROR_START_FAILED;
             goto cleanup;
         }
+        
+        for (int i = 0; i < radar_count; i++) {
+            if (radar_processor_start(radar_procs[i]) != 0) {
+                LOG_ERROR("Failed to start radar processor %d", i + 1);
+                ret = MEC_ERROR_START_FAILED;
+                goto cleanup;
+            }
+        }
     }
 
     // 8. 启动融合处理器线程
@@ -190,9 +396,33 @@ int main(int argc, char *argv[]) {
         LOG_WARN("Failed to start monitor service, continuing without monitoring");
     }
     
+    // 进程外生产者（独立检测进程、厂商 SDK）经共享内存环接入目标队列
+    int ingest_enabled = 0;
+    if (config) MEC_LOG_ERROR_IF_ERROR(config_get_int(config, "ingest.enabled", &ingest_enabled, 0));
+    if (ingest_enabled) {
+        ingest_config_t ingest_cfg = {0};
+        MEC_LOG_ERROR_IF_ERROR(config_get_string(config, "ingest.socket_path", ingest_cfg.socket_path,
+                                                 sizeof(ingest_cfg.socket_path), "/tmp/mec_ingest.sock"));
+        MEC_LOG_ERROR_IF_ERROR(config_get_int(config, "ingest.slots", &ingest_cfg.slot_count, SHM_RING_DEFAULT_SLOTS));
+        MEC_LOG_ERROR_IF_ERROR(config_get_int(config, "ingest.slot_tracks", &ingest_cfg.slot_tracks,
+                                              SHM_RING_DEFAULT_SLOT_TRACKS));
+        ingest_cfg.target_queue = msg_queue;
+        ingest_bridge = ingest_bridge_start(&ingest_cfg);
+        if (!ingest_bridge) {
+            LOG_WARN("Failed to start ingest bridge, continuing without external producers");
+        }
+    }
+    
     LOG_INFO("MEC System Running in Asynchronous Mode (Queue: %d msgs limit)", 50);
     
     // 9. 核心消息循环 (消费者模式)
+    track_list_t *fused = track_list_create(fusion_cfg.max_tracks > 0 ? fusion_cfg.max_tracks : FUSION_DEFAULT_MAX_TRACKS);
+    int v2x_mtu = V2X_DEFAULT_MTU;
+    if (config) MEC_LOG_ERROR_IF_ERROR(config_get_int(config, "v2x.mtu", &v2x_mtu, V2X_DEFAULT_MTU));
+    v2x_encoder_t *v2x_enc = v2x_encoder_create(0xABCD, v2x_mtu, fused ? fused->capacity : FUSION_DEFAULT_MAX_TRACKS);
+    if (!v2x_enc) {
+        LOG_WARN("Failed to create V2X encoder (MTU %d), RSM broadcast disabled", v2x_mtu);
+    }
     while (running) {
         // --- 检查并处理配置重载 ---
         if (reload_config) {
@@ -222,8 +452,11 @@ int main(int argc, char *argv[]) {
         
         // 从队列中弹出数据，设置 500ms 超时，避免死等
         if (mec_queue_pop(msg_queue, &incoming_msg, 500) == 0) {
-            struct timeval t1, t2;
-            gettimeofday(&t1, NULL);
+            mec_time_ns_t t1 = mec_clock_real_ns();   // 处理耗时按真实时间计，不随虚拟时钟
+            struct timeval popped;
+            mec_clock_wall(&popped);
+            metrics_record_age(mec_time_to_ms(mec_time_from_timeval(&popped) -
+                                              mec_time_from_timeval(&incoming_msg.timestamp)));
 
             // 拿到数据，立刻投喂给融合引擎
             MEC_LOG_ERROR_IF_ERROR(fusion_processor_add_tracks(fusion_proc, incoming_msg.tracks, incoming_msg.sensor_id));
@@ -231,45 +464,44 @@ int main(int argc, char *argv[]) {
             // 重要：队列 pop 出来的 tracks 所有权转移给了主循环，处理完需释放引用
             track_list_release(incoming_msg.tracks);
             
-            gettimeofday(&t2, NULL);
-            double lat = (t2.tv_sec - t1.tv_sec) * 1000.0 + (t2.tv_usec - t1.tv_usec) / 1000.0;
+            double lat = mec_time_to_ms(mec_clock_real_ns() - t1);
             metrics_record_frame(lat);
 
-            // 实时输出结果
-            track_list_t *fused = fusion_processor_get_tracks(fusion_proc);
-            if (fused && fused->count > 0) {
+            // 实时输出结果：取融合输出的快照，不与融合线程争用同一列表
+            if (fused && fusion_processor_snapshot(fusion_proc, fused) > 0) {
                 printf("\r[LIVE] Fused Targets: %d | Last Source: %d   ", fused->count, incoming_msg.sensor_id);
                 fflush(stdout);
 
-                // --- 新增：V2X 标准消息编码 ---
-                uint8_t v2x_buffer[2048];
-                int v2x_len = sizeof(v2x_buffer);
-                if (v2x_encode_rsm(fused, 0xABCD, v2x_buffer, &v2x_len) == 0) {
-                    LOG_DEBUG("V2X: Encoded RSM packet (%d bytes) ready for broadcast", v2x_len);
+                // --- V2X 标准消息编码：按 MTU 分段，iovec 可直接交给 sendmmsg ---
+                const struct iovec *v2x_iov = NULL;
+                int segments = v2x_enc ? v2x_encode_rsm_segments(v2x_enc, fused, &v2x_iov) : -1;
+                if (segments > 0) {
+                    size_t v2x_len = 0;
+                    for (int s = 0; s < 2 * segments; s++) v2x_len += v2x_iov[s].iov_len;
+                    LOG_DEBUG("V2X: Encoded RSM (%d targets, %d segments, %zu bytes) ready for broadcast",
+                              fused->count, segments, v2x_len);
                 }
             }
-        } else {
-            // 队列空，打印心跳状态
-            static time_t last_hb = 0;
-            time_t now = time(NULL);
-            if (now - last_hb >= 5) {
-                LOG_INFO("System Heartbeat: [Queue Size: %d] [Active Tracks: %d]", 
-                         mec_queue_size(msg_queue), fusion_proc->track_count);
-                metrics_report();
-                last_hb = now;
-            }
+        }
 
-            if (sim_mode) {
-                // 模拟器特殊处理：主动拉取
-                track_list_t *vt = simulator_get_video_tracks(simulator);
-                if (vt && vt->count > 0) {
-                    MEC_LOG_ERROR_IF_ERROR(fusion_processor_add_tracks(fusion_proc, vt, 1));
-                    track_list_clear(vt);
-                }
-            }
+        // 心跳状态：持续满载时队列从不为空，因此每轮都检查
+        static time_t last_hb = 0;
+        time_t now = time(NULL);
+        if (now - last_hb >= 5) {
+            fusion_stats_t fstats;
+            fusion_processor_get_stats(fusion_proc, &fstats);
+            LOG_INFO("System Heartbeat: [Queue Size: %d] [Active Tracks: %d] [ID Cache: %ld hit / %ld miss]", 
+                     mec_queue_size(msg_queue), fstats.track_count,
+                     fstats.cache_hits, fstats.cache_misses);
+            metrics_report();
+            camera_manager_report(camera_mgr);
+            ingest_bridge_report(ingest_bridge);
+            last_hb = now;
         }
     }
     
+    v2x_encoder_destroy(v2x_enc);
+    track_list_release(fused);
     ret = MEC_OK; // 正常退出
     
 cleanup:
@@ -278,17 +510,24 @@ cleanup:
         monitor_stop_service(monitor_service);
         monitor_service = NULL;
     }
+    ingest_bridge_stop(ingest_bridge); // 在途消息持有环的引用，随队列销毁释放
     if (simulator) {
         simulator_stop(simulator);
         simulator_destroy(simulator);
     }
-    if (video_proc) { 
-        video_processor_stop(video_proc); 
-        video_processor_destroy(video_proc); 
+    camera_manager_destroy(camera_mgr); // 先停解码，再停各路处理器
+    for (int i = 0; i < video_count; i++) {
+        if (video_procs[i]) {
+            video_processor_stop(video_procs[i]);
+            video_processor_destroy(video_procs[i]);
+        }
     }
-    if (radar_proc) { 
-        radar_processor_stop(radar_proc); 
-        radar_processor_destroy(radar_proc); 
+    detect_batcher_destroy(detector); // 在所有相机停止之后
+    for (int i = 0; i < radar_count; i++) {
+        if (radar_procs[i]) {
+            radar_processor_stop(radar_procs[i]);
+            radar_processor_destroy(radar_procs[i]);
+        }
     }
     if (fusion_proc) { 
         fusion_processor_stop(fusion_proc); 
@@ -0,0 +1,227 @@
+#define _GNU_SOURCE  // recvmmsg
+#include "mec_radar.h"
+#include "mec_logging.h"
+#include "mec_clock.h"
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+/**
+ * @file radar_can.c
+ * @brief SocketCAN 雷达接入
+ *
+ * 目标列表按扫描周期分多帧发送（与 ARS408 类雷达的报文组织一致）：
+ *   - 头帧   ID = base     : [0] 目标数, [1..2] 周期计数 (大端),
+ *                            [3..6] 可选的发送端时间戳 (墙钟微秒低 32 位, 大端; DLC >= 7)
+ *   - 目标帧 ID = base + 1 : [0] 目标 ID, [1..2] 距离 (0.1m), [3..4] 角度 (0.1°, 偏移 180°),
+ *                            [5..6] 速度 (0.1m/s), [7] RCS (0.5dBsm, 偏移 -64)
+ * 通过 CAN_RAW_FILTER 在内核中只放行这两个 ID，其余总线流量不会唤醒接收线程。
+ * 收到头帧时开启新周期；目标数收齐或下一个头帧到达时发布该周期。
+ */
+
+struct radar_can_rx_t {
+    struct mmsghdr msgs[RADAR_CAN_BATCH];
+    struct iovec iovs[RADAR_CAN_BATCH];
+    struct can_frame frames[RADAR_CAN_BATCH];
+    char ctrl[RADAR_CAN_BATCH][CMSG_SPACE(sizeof(struct timespec))];
+
+    track_list_t *cycle;     // 正在组装的周期
+    int expected;            // 头帧声明的目标数
+    int cycle_counter;
+    uint32_t cycle_stamp_us; // 头帧携带的发送端时间戳，0 表示无
+};
+
+static int can_base_id(const radar_config_t *config) {
+    return config->can_base_id > 0 ? config->can_base_id : RADAR_CAN_DEFAULT_BASE;
+}
+
+int radar_can_open(const radar_config_t *config) {
+    if (!config || config->can_ifname[0] == '\0') {
+        LOG_ERROR("Radar CAN: No interface configured");
+        return -1;
+    }
+
+    int fd = socket(PF_CAN, SOCK_RAW | SOCK_CLOEXEC, CAN_RAW);
+    if (fd < 0) {
+        LOG_ERROR("Radar CAN: Socket creation failed (errno %d)", errno);
+        return -1;
+    }
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    snprintf(ifr.ifr_name, IFNAMSIZ, "%s", config->can_ifname);
+    if (ioctl(fd, SIOCGIFINDEX, &ifr) != 0) {
+        LOG_ERROR("Radar CAN: Interface %s not found", config->can_ifname);
+        close(fd);
+        return -1;
+    }
+
+    // 内核过滤：只接收头帧与目标帧
+    int base = can_base_id(config);
+    struct can_filter filters[2] = {
+        { .can_id = (canid_t)base,       .can_mask = CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG },
+        { .can_id = (canid_t)(base + 1), .can_mask = CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG }
+    };
+    if (setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FILTER, filters, sizeof(filters)) != 0) {
+        LOG_ERROR("Radar CAN: Failed to install CAN_RAW_FILTER (errno %d)", errno);
+        close(fd);
+        return -1;
+    }
+
+    int on = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) != 0) {
+        LOG_WARN("Radar CAN: SO_TIMESTAMPNS not available, using user-space timestamps");
+    }
+    if (config->rcvbuf_bytes > 0) {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &config->rcvbuf_bytes, sizeof(config->rcvbuf_bytes));
+    }
+
+    struct sockaddr_can addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        LOG_ERROR("Radar CAN: Bind to %s failed (errno %d)", config->can_ifname, errno);
+        close(fd);
+        return -1;
+    }
+
+    LOG_INFO("Radar CAN: Listening on %s (IDs 0x%03X/0x%03X)", config->can_ifname, base, base + 1);
+    return fd;
+}
+
+radar_can_rx_t* radar_can_rx_create(void) {
+    radar_can_rx_t *rx = mec_calloc(1, sizeof(radar_can_rx_t));
+    if (!rx) return NULL;
+
+    for (int i = 0; i < RADAR_CAN_BATCH; i++) {
+        rx->iovs[i].iov_base = &rx->frames[i];
+        rx->iovs[i].iov_len = sizeof(struct can_frame);
+        rx->msgs[i].msg_hdr.msg_iov = &rx->iovs[i];
+        rx->msgs[i].msg_hdr.msg_iovlen = 1;
+        rx->msgs[i].msg_hdr.msg_control = rx->ctrl[i];
+    }
+    rx->expected = -1;
+    return rx;
+}
+
+void radar_can_rx_destroy(radar_can_rx_t *rx) {
+    if (!rx) return;
+    if (rx->cycle) track_list_release(rx->cycle);
+    mec_free(rx);
+}
+
+// 发布当前周期并重置组包状态
+static void can_flush_cycle(radar_processor_t *processor) {
+    radar_can_rx_t *rx = processor->can_rx;
+    if (rx->cycle) {
+        if (rx->expected >= 0 && rx->cycle->count != rx->expected) {
+            LOG_WARN("Radar CAN: Cycle %d incomplete (%d/%d objects)",
+                     rx->cycle_counter, rx->cycle->count, rx->expected);
+        }
+        radar_publish_batch(processor, rx->cycle);
+        track_list_release(rx->cycle);
+        rx->cycle = NULL;
+    }
+    rx->expected = -1;
+}
+
+/**
+ * @brief 处理单个 CAN 帧并推进周期组包
+ * @return 1:完成并发布了一个周期, 0:继续组包, -1:帧无效
+ */
+int radar_can_handle_frame(radar_processor_t *processor, const struct can_frame *frame,
+                           const struct timeval *timestamp) {
+    if (!processor || !processor->can_rx || !frame || !timestamp) return -1;
+    radar_can_rx_t *rx = processor->can_rx;
+    int base = can_base_id(&processor->config);
+    canid_t id = frame->can_id & CAN_SFF_MASK;
+    const unsigned char *d = frame->data;
+
+    if (id == (canid_t)base) {
+        if (frame->can_dlc < 3) return -1;
+        can_flush_cycle(processor);
+        rx->expected = d[0];
+        rx->cycle_counter = (d[1] << 8) | d[2];
+        rx->cycle_stamp_us = processor->config.sensor_timestamps && frame->can_dlc >= 7 ?
+            ((uint32_t)d[3] << 24) | ((uint32_t)d[4] << 16) | ((uint32_t)d[5] << 8) | d[6] : 0;
+        if (rx->expected == 0) return 0;
+        rx->cycle = track_list_create(rx->expected);
+        return rx->cycle ? 0 : -1;
+    }
+
+    if (id != (canid_t)(base + 1) || frame->can_dlc < 8) return -1;
+    if (!rx->cycle) return 0; // 尚未收到头帧（启动时的半个周期），丢弃
+
+    radar_detection_t detection;
+    target_track_t track;
+    detection.target_id = d[0];
+    detection.range = ((d[1] << 8) | d[2]) * 0.1;
+    detection.angle = ((d[3] << 8) | d[4]) * 0.1 - 180.0;
+    detection.velocity = ((d[5] << 8) | d[6]) * 0.1;
+    detection.rcs = d[7] * 0.5 - 64.0;
+    detection.timestamp = *timestamp;
+    detection.sensor_stamp_us = rx->cycle_stamp_us;
+    if (radar_convert_to_track(&detection, &processor->config, &track) == 0) {
+        track_list_add(rx->cycle, &track);
+    }
+
+    if (rx->cycle->count >= rx->expected) {
+        can_flush_cycle(processor);
+        return 1;
+    }
+    return 0;
+}
+
+static void can_message_timestamp(struct msghdr *hdr, struct timeval *tv) {
+    for (struct cmsghdr *c = CMSG_FIRSTHDR(hdr); c; c = CMSG_NXTHDR(hdr, c)) {
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+            struct timespec ts;
+            memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+            tv->tv_sec = ts.tv_sec;
+            tv->tv_usec = ts.tv_nsec / 1000;
+            return;
+        }
+    }
+    mec_clock_wall(tv);
+}
+
+/**
+ * @brief 批量读取排队的 CAN 帧并组包
+ * @return 本次完成的周期数, -1:接收出错
+ */
+int radar_can_receive(radar_processor_t *processor) {
+    if (!processor || !processor->can_rx || processor->fd < 0) return -1;
+    radar_can_rx_t *rx = processor->can_rx;
+
+    int cycles = 0;
+    while (1) {
+        for (int i = 0; i < RADAR_CAN_BATCH; i++) {
+            rx->msgs[i].msg_hdr.msg_controllen = sizeof(rx->ctrl[i]);
+            rx->msgs[i].msg_hdr.msg_flags = 0;
+        }
+
+        int n = recvmmsg(processor->fd, rx->msgs, RADAR_CAN_BATCH, MSG_DONTWAIT, NULL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) break;
+            LOG_ERROR("Radar CAN: recvmmsg failed (errno %d)", errno);
+            return -1;
+        }
+
+        for (int i = 0; i < n; i++) {
+            if (rx->msgs[i].msg_len < sizeof(struct can_frame)) continue;
+            struct timeval ts;
+            can_message_timestamp(&rx->msgs[i].msg_hdr, &ts);
+            if (processor->capture) {
+                mec_capture_write(processor->capture, CAPTURE_REC_CAN, processor->config.radar_id,
+                                  &ts, &rx->frames[i], sizeof(struct can_frame));
+            }
+            if (radar_can_handle_frame(processor, &rx->frames[i], &ts) == 1) cycles++;
+        }
+
+        if (n < RADAR_CAN_BATCH) break;
+    }
+    return cycles;
+}
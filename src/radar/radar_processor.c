@@ -1,25 +1,43 @@
 #include "mec_radar.h"
 #include "mec_logging.h"
+#include "mec_clock.h"
 #include <math.h>
-#include <fcntl.h>
-#include <termios.h>
-#include <sys/select.h>
+#include <poll.h>
+#include <strings.h>
 
 radar_processor_t* radar_processor_create(const radar_config_t *config) {
     if (!config) return NULL;
     
-    radar_processor_t *processor = mec_malloc(sizeof(radar_processor_t));
+    radar_processor_t *processor = mec_calloc(1, sizeof(radar_processor_t));
     if (!processor) return NULL;
     
     processor->config = *config;
     processor->output_tracks = track_list_create(50);
     processor->fd = -1;
+    radar_parser_reset(&processor->parser);
+    processor->parser.sensor_timestamps = config->sensor_timestamps;
+    processor->rx_pos = 0;
+    processor->rx_len = 0;
+    processor->rx_ready = 0;
+    int baud = config->baud_rate > 0 ? config->baud_rate : 115200;
+    processor->byte_time_us = 10.0 * 1000000.0 / baud;
     
     if (!processor->output_tracks) {
         mec_free(processor);
         return NULL;
     }
     
+    if (config->transport != RADAR_TRANSPORT_SERIAL) {
+        // 回放文件中可能包含 CAN 记录，同样需要组包上下文
+        processor->udp_rx = (config->transport == RADAR_TRANSPORT_UDP) ? radar_udp_rx_create() : NULL;
+        processor->can_rx = (config->transport != RADAR_TRANSPORT_UDP) ? radar_can_rx_create() : NULL;
+        if (!processor->udp_rx && !processor->can_rx) {
+            track_list_release(processor->output_tracks);
+            mec_free(processor);
+            return NULL;
+        }
+    }
+    
     LOG_INFO("Created radar processor for radar %d", config->radar_id);
     return processor;
 }
@@ -31,85 +49,46 @@ void radar_processor_destroy(radar_processor_t *processor) {
     if (processor->fd >= 0) {
         close(processor->fd);
     }
+    radar_udp_rx_destroy(processor->udp_rx);
+    radar_can_rx_destroy(processor->can_rx);
     track_list_release(processor->output_tracks);
     mec_free(processor);
 }
 
-static int setup_serial_port(const char *device_path, int baud_rate) {
-    int fd = open(device_path, O_RDWR | O_NOCTTY | O_NONBLOCK);
-    if (fd < 0) {
-        LOG_ERROR("Failed to open radar device: %s", device_path);
-        return -1;
-    }
-    
-    struct termios tty;
-    if (tcgetattr(fd, &tty) != 0) {
-        LOG_ERROR("Failed to get terminal attributes");
-        close(fd);
-        return -1;
-    }
-    
-    // Configure serial port
-    tty.c_cflag &= ~PARENB;   // No parity
-    tty.c_cflag &= ~CSTOPB;   // One stop bit
-    tty.c_cflag &= ~CSIZE;
-    tty.c_cflag |= CS8;       // 8 data bits
-    tty.c_cflag &= ~CRTSCTS;  // No flow control
-    tty.c_cflag |= CREAD | CLOCAL;
-    
-    tty.c_lflag &= ~ICANON;   // Non-canonical mode
-    tty.c_lflag &= ~ECHO;     // No echo
-    tty.c_lflag &= ~ECHOE;
-    tty.c_lflag &= ~ECHONL;
-    tty.c_lflag &= ~ISIG;
-    
-    tty.c_iflag &= ~(IXON | IXOFF | IXANY);
-    tty.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL);
-    
-    tty.c_oflag &= ~OPOST;
-    tty.c_oflag &= ~ONLCR;
-    
-    tty.c_cc[VTIME] = 1;
-    tty.c_cc[VMIN] = 0;
+int radar_processor_start(radar_processor_t *processor) {
+    if (!processor) return -1;
     
-    // Set baud rate
-    speed_t speed;
-    switch (baud_rate) {
-        case 9600: speed = B9600; break;
-        case 19200: speed = B19200; break;
-        case 38400: speed = B38400; break;
-        case 57600: speed = B57600; break;
-        case 115200: speed = B115200; break;
+    switch (processor->config.transport) {
+        case RADAR_TRANSPORT_UDP:
+            processor->fd = radar_udp_open(&processor->config);
+            break;
+        case RADAR_TRANSPORT_CAN:
+            processor->fd = radar_can_open(&processor->config);
+            break;
+        case RADAR_TRANSPORT_REPLAY:
+            processor->replay = mec_replay_open(processor->config.replay_path, processor->config.replay_speed);
+            if (!processor->replay) return -1;
+            processor->fd = -1;
+            break;
+        case RADAR_TRANSPORT_SERIAL:
         default:
-            LOG_ERROR("Unsupported baud rate: %d", baud_rate);
-            close(fd);
-            return -1;
+            processor->fd = radar_serial_open(&processor->config);
+            break;
     }
-    
-    cfsetispeed(&tty, speed);
-    cfsetospeed(&tty, speed);
-    
-    if (tcsetattr(fd, TCSANOW, &tty) != 0) {
-        LOG_ERROR("Failed to set terminal attributes");
-        close(fd);
+    if (processor->fd < 0 && !processor->replay) {
         return -1;
     }
     
-    return fd;
-}
-
-int radar_processor_start(radar_processor_t *processor) {
-    if (!processor) return -1;
-    
-    processor->fd = setup_serial_port(processor->config.device_path, processor->config.baud_rate);
-    if (processor->fd < 0) {
-        return -1;
+    if (processor->config.capture_path[0] != '\0' && processor->config.transport != RADAR_TRANSPORT_REPLAY) {
+        processor->capture = mec_capture_open(processor->config.capture_path, 0);
+        if (!processor->capture) {
+            LOG_WARN("Radar %d: Capture disabled", processor->config.radar_id);
+        }
     }
     
     if (thread_create(&processor->thread_ctx, radar_processing_thread, processor) != 0) {
         LOG_ERROR("Failed to start radar processing thread");
-        close(processor->fd);
-        processor->fd = -1;
+        radar_processor_stop(processor);
         return -1;
     }
     
@@ -125,6 +104,14 @@ void radar_processor_stop(radar_processor_t *processor) {
         close(processor->fd);
         processor->fd = -1;
     }
+    if (processor->capture) {
+        mec_capture_close(processor->capture);
+        processor->capture = NULL;
+    }
+    if (processor->replay) {
+        mec_replay_close(processor->replay);
+        processor->replay = NULL;
+    }
     LOG_INFO("Stopped radar processor for radar %d", processor->config.radar_id);
 }
 
@@ -140,91 +127,217 @@ void* radar_processing_thread(void *arg) {
     radar_detection_t detection;
     target_track_t track;
     
+    if (processor->config.transport == RADAR_TRANSPORT_REPLAY) {
+        radar_replay_run(processor);
+        return NULL;
+    }
+    
     while (processor->thread_ctx.running) {
-        if (radar_read_data(processor, &detection) == 0) {
-            if (radar_convert_to_track(&detection, &processor->config, &track) == 0) {
-                thread_lock(&processor->thread_ctx);
-                track_list_add(processor->output_tracks, &track);
-                
-                // --- 新增：将结果推送至异步队列 ---
-                if (processor->config.target_queue) {
-                    mec_msg_t msg;
-                    msg.sensor_id = processor->config.radar_id;
-                    msg.tracks = processor->output_tracks; 
-                    msg.timestamp = detection.timestamp;
-                    mec_queue_push(processor->config.target_queue, &msg);
+        // 等待数据到达（100ms 超时以便检查退出标志），取代固定 10ms 轮询
+        struct pollfd pfd = { .fd = processor->fd, .events = POLLIN, .revents = 0 };
+        int ret = poll(&pfd, 1, 100);
+        if (ret <= 0) continue;
+        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            LOG_ERROR("Radar %d: Device error, stopping ingest", processor->config.radar_id);
+            break;
+        }
+        
+        // CAN 按扫描周期组包，每个完整周期单独发布
+        if (processor->config.transport == RADAR_TRANSPORT_CAN) {
+            radar_can_receive(processor);
+            continue;
+        }
+        
+        // 一次唤醒内解析出的所有目标打包成一条消息
+        track_list_t *batch = track_list_create(16);
+        if (!batch) continue;
+        
+        if (processor->config.transport == RADAR_TRANSPORT_UDP) {
+            radar_udp_receive(processor, batch);
+        } else {
+            processor->rx_ready = 1;
+            while (radar_read_data(processor, &detection) == 0) {
+                if (radar_convert_to_track(&detection, &processor->config, &track) == 0) {
+                    track_list_add(batch, &track);
                 }
-                
-                thread_unlock(&processor->thread_ctx);
             }
         }
-        
-        usleep(10000); // 10ms
+        radar_publish_batch(processor, batch);
+        track_list_release(batch);
     }
     
     return NULL;
 }
 
 /**
- * @brief 鲁棒的雷达数据读取逻辑（基于有限状态机 DFA）
- * 
- * 能够自动处理串口字节对齐、丢包和干扰，确保只有完整且校验通过的数据包才会进入算法层。
+ * @brief 将一批目标发布为一条队列消息，并更新最近一批的快照
+ *
+ * 每批使用独立的列表推送，队列只持有引用，生产者不再修改已入队的数据。
+ * 调用者仍持有 batch 的引用，需自行 release。
  */
-int radar_read_data(radar_processor_t *processor, radar_detection_t *detection) {
-    if (!processor || !detection || processor->fd < 0) return -1;
+void radar_publish_batch(radar_processor_t *processor, track_list_t *batch) {
+    if (!processor || !batch || batch->count == 0) return;
     
-    // 状态定义
-    typedef enum { STATE_IDLE, STATE_HEAD1, STATE_HEAD2, STATE_DATA, STATE_CHECK } parse_state_t;
-    static parse_state_t state = STATE_IDLE;
-    static unsigned char frame_buf[16];
-    static int frame_idx = 0;
+    thread_lock(&processor->thread_ctx);
+    track_list_clear(processor->output_tracks);
+    for (int i = 0; i < batch->count; i++) {
+        track_list_add(processor->output_tracks, &batch->tracks[i]);
+    }
+    thread_unlock(&processor->thread_ctx);
     
-    unsigned char ch;
-    // 每次从内核缓冲区读取一个字节进行状态机处理
-    while (read(processor->fd, &ch, 1) > 0) {
-        switch (state) {
-            case STATE_IDLE:
-                if (ch == 0xAA) state = STATE_HEAD1;
+    if (processor->config.target_queue) {
+        mec_msg_t msg;
+        msg.sensor_id = processor->config.radar_id;
+        msg.tracks = batch;
+        msg.timestamp = batch->tracks[0].timestamp;
+        mec_queue_push(processor->config.target_queue, &msg);
+    }
+}
+
+void radar_parser_reset(radar_parser_t *parser) {
+    if (!parser) return;
+    parser->state = RADAR_PARSE_IDLE;
+    parser->frame_idx = 0;
+    parser->checksum_errors = 0;
+}
+
+/**
+ * @brief 解码 14 字节数据段（大端）
+ *
+ * 不做任何拷贝，可直接作用于接收缓冲区。[10..13] 仅在 with_stamp 时作为发送端
+ * 时间戳解码，否则忽略（量产雷达不保证这些字节的含义）。
+ */
+int radar_decode_frame(const unsigned char *payload, int with_stamp, radar_detection_t *detection) {
+    if (!payload || !detection) return -1;
+    
+    detection->target_id = (payload[0] << 8) | payload[1];
+    detection->range = ((payload[2] << 8) | payload[3]) * 0.1;
+    detection->angle = ((payload[4] << 8) | payload[5]) * 0.1 - 180.0;
+    detection->velocity = ((payload[6] << 8) | payload[7]) * 0.1;
+    detection->rcs = ((payload[8] << 8) | payload[9]) * 0.1 - 50.0;
+    detection->sensor_stamp_us = 0;
+    if (with_stamp) {
+        detection->sensor_stamp_us = ((uint32_t)payload[10] << 24) | ((uint32_t)payload[11] << 16) |
+                                     ((uint32_t)payload[12] << 8) | payload[13];
+    }
+    return 0;
+}
+
+int radar_sensor_time(uint32_t stamp_us, const struct timeval *reference, struct timeval *out) {
+    if (stamp_us == 0 || !reference || !out) return -1;
+    int64_t ref_us = mec_time_from_timeval(reference) / MEC_NS_PER_US;
+    // 按 32 位回绕取与参照最近的时刻（约 ±35 分钟内无歧义）
+    int64_t sensor_us = ref_us + (int32_t)(stamp_us - (uint32_t)ref_us);
+    int64_t diff = ref_us - sensor_us;
+    if (diff > RADAR_SENSOR_TIME_WINDOW_US || diff < -RADAR_SENSOR_TIME_WINDOW_US) return -1;
+    mec_time_to_timeval(sensor_us * MEC_NS_PER_US, out);
+    return 0;
+}
+
+/**
+ * @brief 鲁棒的雷达字节流解析（基于有限状态机 DFA）
+ * 
+ * 能够自动处理串口字节对齐、丢包和干扰，确保只有完整且校验通过的数据包才会进入算法层。
+ * 解析状态保存在 parser 中，每个雷达实例互不干扰。
+ * 
+ * @param consumed 输出本次消耗的字节数
+ * @return 1:解析出一帧, 0:数据已耗尽但未形成完整帧
+ */
+int radar_parser_feed(radar_parser_t *parser, const unsigned char *data, int len,
+                      int *consumed, radar_detection_t *detection) {
+    int i = 0;
+    while (i < len) {
+        unsigned char ch = data[i++];
+        switch (parser->state) {
+            case RADAR_PARSE_IDLE:
+                if (ch == RADAR_FRAME_HEAD1) parser->state = RADAR_PARSE_HEAD;
                 break;
-            case STATE_HEAD1:
-                if (ch == 0x55) {
-                    state = STATE_DATA;
-                    frame_idx = 0;
-                } else {
-                    state = STATE_IDLE;
+            case RADAR_PARSE_HEAD:
+                if (ch == RADAR_FRAME_HEAD2) {
+                    parser->state = RADAR_PARSE_DATA;
+                    parser->frame_idx = 0;
+                } else if (ch != RADAR_FRAME_HEAD1) {
+                    parser->state = RADAR_PARSE_IDLE;
                 }
                 break;
-            case STATE_DATA:
-                frame_buf[frame_idx++] = ch;
-                if (frame_idx >= 14) { // 假设数据段为 14 字节
-                    state = STATE_CHECK;
+            case RADAR_PARSE_DATA:
+                parser->frame_buf[parser->frame_idx++] = ch;
+                if (parser->frame_idx >= RADAR_FRAME_DATA_LEN) {
+                    parser->state = RADAR_PARSE_CHECK;
                 }
                 break;
-            case STATE_CHECK:
-                // 简单的校验和检查 (Sum Check)
+            case RADAR_PARSE_CHECK: {
+                // 简单的校验和检查 (XOR)
                 unsigned char checksum = 0;
-                for (int i = 0; i < 14; i++) checksum ^= frame_buf[i];
+                for (int k = 0; k < RADAR_FRAME_DATA_LEN; k++) checksum ^= parser->frame_buf[k];
+                parser->state = RADAR_PARSE_IDLE;
                 
                 if (ch == checksum) {
-                    // 校验通过，解析数据
-                    detection->target_id = (frame_buf[0] << 8) | frame_buf[1];
-                    detection->range = ((frame_buf[2] << 8) | frame_buf[3]) * 0.1;
-                    detection->angle = ((frame_buf[4] << 8) | frame_buf[5]) * 0.1 - 180.0;
-                    detection->velocity = ((frame_buf[6] << 8) | frame_buf[7]) * 0.1;
-                    detection->rcs = ((frame_buf[8] << 8) | frame_buf[9]) * 0.1 - 50.0;
-                    gettimeofday(&detection->timestamp, NULL);
-                    
-                    state = STATE_IDLE;
-                    return 0; // 成功解析一帧
-                } else {
-                    LOG_WARN("Radar: Checksum error (Exp: 0x%02X, Got: 0x%02X)", checksum, ch);
-                    state = STATE_IDLE;
+                    radar_decode_frame(parser->frame_buf, parser->sensor_timestamps, detection);
+                    *consumed = i;
+                    return 1; // 成功解析一帧
                 }
+                parser->checksum_errors++;
+                LOG_WARN("Radar: Checksum error (Exp: 0x%02X, Got: 0x%02X)", checksum, ch);
                 break;
+            }
         }
     }
     
-    return -1;
+    *consumed = i;
+    return 0;
+}
+
+/**
+ * @brief 从串口缓冲区取出下一帧
+ * 
+ * 每次 read 批量取回内核缓冲区中的字节（批量大小由 VMIN/VTIME 控制），
+ * 之后从用户态缓冲区逐帧解析。帧时间戳按线路速率从 read 返回时刻回推到
+ * 该帧最后一个字节到达的时刻，消除批量读取带来的时间戳抖动。
+ * 
+ * @return 0:成功解析一帧, -1:暂无完整帧
+ */
+int radar_read_data(radar_processor_t *processor, radar_detection_t *detection) {
+    if (!processor || !detection || processor->fd < 0) return -1;
+    
+    while (1) {
+        if (processor->rx_pos >= processor->rx_len) {
+            // 只有在 poll 确认可读后才发起 read，否则阻塞 fd 会在空闲线路上挂起
+            if (!processor->rx_ready) return -1;
+            processor->rx_ready = 0;
+            
+            ssize_t n = read(processor->fd, processor->rx_buf, sizeof(processor->rx_buf));
+            if (n <= 0) return -1;
+            mec_clock_wall(&processor->rx_time);
+            processor->rx_pos = 0;
+            processor->rx_len = (int)n;
+            if (processor->capture) {
+                mec_capture_write(processor->capture, CAPTURE_REC_STREAM, processor->config.radar_id,
+                                  &processor->rx_time, processor->rx_buf, (size_t)n);
+            }
+        }
+        
+        int consumed = 0;
+        int got = radar_parser_feed(&processor->parser,
+                                    processor->rx_buf + processor->rx_pos,
+                                    processor->rx_len - processor->rx_pos,
+                                    &consumed, detection);
+        processor->rx_pos += consumed;
+        
+        if (got) {
+            // 该帧末字节之后还有 (rx_len - rx_pos) 个字节，按线路时间回推
+            long back_us = (long)((processor->rx_len - processor->rx_pos) * processor->byte_time_us);
+            long usec = processor->rx_time.tv_usec - back_us;
+            detection->timestamp.tv_sec = processor->rx_time.tv_sec + usec / 1000000;
+            usec %= 1000000;
+            if (usec < 0) {
+                usec += 1000000;
+                detection->timestamp.tv_sec--;
+            }
+            detection->timestamp.tv_usec = usec;
+            return 0;
+        }
+    }
 }
 
 int radar_convert_to_track(const radar_detection_t *detection, 
@@ -238,16 +351,23 @@ int radar_convert_to_track(const radar_detection_t *detection,
         return -1;
     }
     
+    // 雷达坐标系 -> 站点 ENU：按安装方位旋转后平移到安装位置
+    double yaw = config->mount_yaw * M_PI / 180.0;
+    double cy = cos(yaw), sy = sin(yaw);
+    
     track->id = detection->target_id;
     track->type = TARGET_VEHICLE; // Default, could be refined based on RCS
-    track->position.latitude = y;  // Simplified - in practice would convert to WGS84
-    track->position.longitude = x;
-    track->position.altitude = 0.0;
+    track->local.east = config->mount_east + x * cy - y * sy;
+    track->local.north = config->mount_north + x * sy + y * cy;
+    track->local.up = 0.0;
+    memset(&track->position, 0, sizeof(track->position)); // WGS84 仅在输出边界换算
     track->velocity = detection->velocity;
-    track->heading = atan2(y, x) * 180.0 / M_PI;
+    track->heading = atan2(y, x) * 180.0 / M_PI + config->mount_yaw;
     track->confidence = (detection->rcs > -10.0) ? 0.8 : 0.5; // Based on RCS
     track->sensor_id = config->radar_id;
     track->timestamp = detection->timestamp;
+    // 启用 sensor_timestamps 且帧内带发送端时间戳时以其为准，端到端时延从发送时刻算起
+    if (config->sensor_timestamps && detection->sensor_stamp_us) radar_sensor_time(detection->sensor_stamp_us, &detection->timestamp, &track->timestamp);
     
     return 0;
 }
@@ -260,4 +380,11 @@ int radar_polar_to_cartesian(double range, double angle, double *x, double *y) {
     *y = range * sin(angle_rad);
     
     return 0;
-}
\ No newline at end of file
+}
+
+radar_transport_t radar_transport_from_string(const char *name) {
+    if (name && strcasecmp(name, "udp") == 0) return RADAR_TRANSPORT_UDP;
+    if (name && strcasecmp(name, "can") == 0) return RADAR_TRANSPORT_CAN;
+    if (name && strcasecmp(name, "replay") == 0) return RADAR_TRANSPORT_REPLAY;
+    return RADAR_TRANSPORT_SERIAL;
+}
@@ -0,0 +1,87 @@
+#include "mec_radar.h"
+#include "mec_logging.h"
+#include <linux/can.h>
+
+/**
+ * @file radar_replay.c
+ * @brief 抓包回放接入
+ *
+ * 将 mmap 映射的抓包记录送入与实时接入完全相同的解析路径：
+ * 字节流记录进入串口状态机，数据报记录原地解码，CAN 记录进入周期组包。
+ * 回放速度为 0 时不做节拍等待，用于测量解析与融合的极限吞吐。
+ */
+
+static void replay_stream(radar_processor_t *processor, const uint8_t *data, int len,
+                          const struct timeval *timestamp, track_list_t *batch) {
+    radar_detection_t detection;
+    target_track_t track;
+    int pos = 0;
+
+    while (pos < len) {
+        int consumed = 0;
+        int got = radar_parser_feed(&processor->parser, data + pos, len - pos, &consumed, &detection);
+        pos += consumed;
+        if (!got) break;
+
+        detection.timestamp = *timestamp;
+        if (radar_convert_to_track(&detection, &processor->config, &track) == 0) {
+            track_list_add(batch, &track);
+        }
+    }
+}
+
+/**
+ * @brief 回放主循环（在雷达处理线程中运行）
+ * @return 回放的记录数
+ */
+int radar_replay_run(radar_processor_t *processor) {
+    if (!processor || !processor->replay) return -1;
+    mec_replay_t *replay = processor->replay;
+    long total = 0;
+
+    while (processor->thread_ctx.running) {
+        const mec_capture_record_t *rec;
+        const uint8_t *payload;
+        int ret = mec_replay_next(replay, &rec, &payload);
+
+        if (ret <= 0) {
+            LOG_INFO("Radar %d: Replay finished (%ld records)", processor->config.radar_id, replay->records);
+            if (!processor->config.replay_loop || replay->records == 0) break;
+            mec_replay_rewind(replay);
+            radar_parser_reset(&processor->parser);
+            continue;
+        }
+
+        struct timeval ts;
+        mec_replay_pace(replay, rec, &processor->thread_ctx, &ts);
+        if (!processor->thread_ctx.running) break;
+        total++;
+
+        switch (rec->type) {
+            case CAPTURE_REC_STREAM:
+            case CAPTURE_REC_DATAGRAM: {
+                track_list_t *batch = track_list_create(16);
+                if (!batch) break;
+                if (rec->type == CAPTURE_REC_STREAM) {
+                    replay_stream(processor, payload, (int)rec->length, &ts, batch);
+                } else {
+                    radar_decode_datagram(payload, (int)rec->length, &processor->config, &ts, batch);
+                }
+                radar_publish_batch(processor, batch);
+                track_list_release(batch);
+                break;
+            }
+            case CAPTURE_REC_CAN:
+                if (rec->length >= sizeof(struct can_frame) && processor->can_rx) {
+                    struct can_frame frame;
+                    memcpy(&frame, payload, sizeof(frame));
+                    radar_can_handle_frame(processor, &frame, &ts);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    return (int)total;
+}
@@ -0,0 +1,113 @@
+#include "mec_radar.h"
+#include "mec_logging.h"
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <asm/termbits.h>   // struct termios2 / BOTHER（不能与 <termios.h> 同时包含）
+#include <linux/serial.h>
+
+/**
+ * @file radar_serial.c
+ * @brief 高速串口配置
+ *
+ * 使用 termios2 + BOTHER 设置任意波特率（460800、921600 等非标准档位），
+ * 并在驱动支持时开启 ASYNC_LOW_LATENCY，缩短内核 tty 层的批量延迟。
+ */
+
+#define RADAR_DEFAULT_BAUD  115200
+#define RADAR_DEFAULT_VMIN  RADAR_FRAME_LEN
+#define RADAR_DEFAULT_VTIME 1
+
+// 尝试开启低延迟模式；pty、USB 转串口等驱动可能不支持，失败时仅提示
+static void serial_enable_low_latency(int fd, const char *device_path) {
+    struct serial_struct ser;
+    if (ioctl(fd, TIOCGSERIAL, &ser) != 0) {
+        LOG_INFO("Radar serial: ASYNC_LOW_LATENCY not supported on %s", device_path);
+        return;
+    }
+    ser.flags |= ASYNC_LOW_LATENCY;
+    if (ioctl(fd, TIOCSSERIAL, &ser) != 0) {
+        LOG_WARN("Radar serial: Failed to enable ASYNC_LOW_LATENCY on %s (errno %d)", device_path, errno);
+        return;
+    }
+    LOG_INFO("Radar serial: ASYNC_LOW_LATENCY enabled on %s", device_path);
+}
+
+int radar_serial_open(const radar_config_t *config) {
+    if (!config) return -1;
+
+    // 以非阻塞方式打开，避免在无载波检测的设备上卡住，随后切回阻塞模式，使 VMIN/VTIME 生效
+    int fd = open(config->device_path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        LOG_ERROR("Failed to open radar device: %s", config->device_path);
+        return -1;
+    }
+
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags & ~O_NONBLOCK) != 0) {
+        LOG_ERROR("Failed to switch radar device to blocking mode");
+        close(fd);
+        return -1;
+    }
+
+    struct termios2 tty;
+    if (ioctl(fd, TCGETS2, &tty) != 0) {
+        LOG_ERROR("Failed to get terminal attributes");
+        close(fd);
+        return -1;
+    }
+
+    int baud = config->baud_rate > 0 ? config->baud_rate : RADAR_DEFAULT_BAUD;
+    int vmin = config->vmin >= 0 ? config->vmin : RADAR_DEFAULT_VMIN;
+    int vtime = config->vtime >= 0 ? config->vtime : RADAR_DEFAULT_VTIME;
+    if (vmin > 255) vmin = 255;
+    if (vtime > 255) vtime = 255;
+
+    // Configure serial port: 8N1, raw mode
+    tty.c_cflag &= ~PARENB;   // No parity
+    tty.c_cflag &= ~CSTOPB;   // One stop bit
+    tty.c_cflag &= ~CSIZE;
+    tty.c_cflag |= CS8;       // 8 data bits
+    tty.c_cflag &= ~CRTSCTS;  // No flow control
+    tty.c_cflag |= CREAD | CLOCAL;
+
+    tty.c_lflag &= ~(ICANON | ECHO | ECHOE | ECHONL | ISIG | IEXTEN);
+    tty.c_iflag &= ~(IXON | IXOFF | IXANY);
+    tty.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL);
+    tty.c_oflag &= ~(OPOST | ONLCR);
+
+    // VMIN 决定单次 read 的批量大小，VTIME 为字节间超时；VMIN=0 时 VTIME 为整体超时，
+    // 两者均为 0 时 read 立即返回。VMIN>0 且 VTIME=0 时线路中断在半帧时 read 会一直阻塞
+    if (vmin > 0 && vtime == 0) {
+        LOG_WARN("Radar serial: %s VTIME=0 with VMIN=%d, reads block until VMIN bytes arrive",
+                 config->device_path, vmin);
+    }
+    tty.c_cc[VMIN] = (cc_t)vmin;
+    tty.c_cc[VTIME] = (cc_t)vtime;
+
+    // 任意波特率：输入/输出速率都使用 BOTHER
+    tty.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+    tty.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+    tty.c_ispeed = (speed_t)baud;
+    tty.c_ospeed = (speed_t)baud;
+
+    if (ioctl(fd, TCSETS2, &tty) != 0) {
+        LOG_ERROR("Failed to set terminal attributes (baud %d)", baud);
+        close(fd);
+        return -1;
+    }
+
+    // 回读确认驱动实际接受的速率（部分 UART 只能逼近）
+    if (ioctl(fd, TCGETS2, &tty) == 0 && tty.c_ospeed != (speed_t)baud) {
+        LOG_WARN("Radar serial: Requested %d baud, driver reports %u", baud, (unsigned)tty.c_ospeed);
+    }
+
+    if (config->low_latency) {
+        serial_enable_low_latency(fd, config->device_path);
+    }
+
+    ioctl(fd, TCFLSH, TCIFLUSH);
+
+    LOG_INFO("Radar serial: %s opened at %d baud (VMIN=%d, VTIME=%d)",
+             config->device_path, baud, vmin, vtime);
+    return fd;
+}
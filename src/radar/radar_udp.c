@@ -0,0 +1,179 @@
+#define _GNU_SOURCE  // recvmmsg
+#include "mec_radar.h"
+#include "mec_logging.h"
+#include "mec_clock.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/**
+ * @file radar_udp.c
+ * @brief 以太网/UDP 雷达接入
+ *
+ * 使用 recvmmsg 单次系统调用批量接收多个数据报，SO_TIMESTAMPNS 提供内核接收时间戳，
+ * 帧直接在接收缓冲区上解码，不做中间拷贝。
+ * 每个数据报承载一个或多个与串口相同的 0xAA55 帧。
+ */
+
+struct radar_udp_rx_t {
+    struct mmsghdr msgs[RADAR_UDP_BATCH];
+    struct iovec iovs[RADAR_UDP_BATCH];
+    unsigned char bufs[RADAR_UDP_BATCH][RADAR_UDP_MAX_DATAGRAM];
+    char ctrl[RADAR_UDP_BATCH][CMSG_SPACE(sizeof(struct timespec))];
+};
+
+int radar_udp_open(const radar_config_t *config) {
+    if (!config || config->udp_port <= 0 || config->udp_port > 65535) {
+        LOG_ERROR("Radar UDP: Invalid port configuration");
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        LOG_ERROR("Radar UDP: Socket creation failed (errno %d)", errno);
+        return -1;
+    }
+
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) != 0) {
+        LOG_WARN("Radar UDP: SO_TIMESTAMPNS not available, using user-space timestamps");
+    }
+    if (config->rcvbuf_bytes > 0) {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &config->rcvbuf_bytes, sizeof(config->rcvbuf_bytes));
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)config->udp_port);
+    const char *bind_addr = config->bind_addr[0] ? config->bind_addr : "0.0.0.0";
+    if (inet_pton(AF_INET, bind_addr, &addr.sin_addr) != 1) {
+        LOG_ERROR("Radar UDP: Invalid bind address %s", bind_addr);
+        close(fd);
+        return -1;
+    }
+
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        LOG_ERROR("Radar UDP: Bind failed for %s:%d (errno %d)", bind_addr, config->udp_port, errno);
+        close(fd);
+        return -1;
+    }
+
+    LOG_INFO("Radar UDP: Listening on %s:%d", bind_addr, config->udp_port);
+    return fd;
+}
+
+radar_udp_rx_t* radar_udp_rx_create(void) {
+    radar_udp_rx_t *rx = mec_calloc(1, sizeof(radar_udp_rx_t));
+    if (!rx) return NULL;
+
+    // 缓冲区与消息头只初始化一次，之后每次 recvmmsg 复用
+    for (int i = 0; i < RADAR_UDP_BATCH; i++) {
+        rx->iovs[i].iov_base = rx->bufs[i];
+        rx->iovs[i].iov_len = RADAR_UDP_MAX_DATAGRAM;
+        rx->msgs[i].msg_hdr.msg_iov = &rx->iovs[i];
+        rx->msgs[i].msg_hdr.msg_iovlen = 1;
+        rx->msgs[i].msg_hdr.msg_control = rx->ctrl[i];
+    }
+    return rx;
+}
+
+void radar_udp_rx_destroy(radar_udp_rx_t *rx) {
+    mec_free(rx);
+}
+
+/**
+ * @brief 在数据报缓冲区上原地解码所有帧
+ *
+ * 遇到无效字节时逐字节重新同步到下一个帧头。
+ * @return 解码出的目标数
+ */
+int radar_decode_datagram(const unsigned char *data, int len, const radar_config_t *config,
+                          const struct timeval *timestamp, track_list_t *batch) {
+    if (!data || !config || !timestamp || !batch) return 0;
+
+    int decoded = 0;
+    int pos = 0;
+    while (pos + RADAR_FRAME_LEN <= len) {
+        const unsigned char *f = data + pos;
+        if (f[0] != RADAR_FRAME_HEAD1 || f[1] != RADAR_FRAME_HEAD2) {
+            pos++;
+            continue;
+        }
+
+        unsigned char checksum = 0;
+        for (int k = 0; k < RADAR_FRAME_DATA_LEN; k++) checksum ^= f[2 + k];
+        if (checksum != f[RADAR_FRAME_LEN - 1]) {
+            LOG_WARN("Radar UDP: Checksum error (Exp: 0x%02X, Got: 0x%02X)", checksum, f[RADAR_FRAME_LEN - 1]);
+            pos++;
+            continue;
+        }
+
+        radar_detection_t detection;
+        target_track_t track;
+        radar_decode_frame(f + 2, config->sensor_timestamps, &detection);
+        detection.timestamp = *timestamp;
+        if (radar_convert_to_track(&detection, config, &track) == 0) {
+            track_list_add(batch, &track);
+            decoded++;
+        }
+        pos += RADAR_FRAME_LEN;
+    }
+    return decoded;
+}
+
+static void udp_message_timestamp(struct msghdr *hdr, struct timeval *tv) {
+    for (struct cmsghdr *c = CMSG_FIRSTHDR(hdr); c; c = CMSG_NXTHDR(hdr, c)) {
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+            struct timespec ts;
+            memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+            tv->tv_sec = ts.tv_sec;
+            tv->tv_usec = ts.tv_nsec / 1000;
+            return;
+        }
+    }
+    mec_clock_wall(tv);
+}
+
+/**
+ * @brief 批量接收并解码当前套接字中排队的所有数据报
+ * @return 本次解码的目标数, -1:接收出错
+ */
+int radar_udp_receive(radar_processor_t *processor, track_list_t *batch) {
+    if (!processor || !processor->udp_rx || !batch || processor->fd < 0) return -1;
+    radar_udp_rx_t *rx = processor->udp_rx;
+
+    int total = 0;
+    while (1) {
+        for (int i = 0; i < RADAR_UDP_BATCH; i++) {
+            rx->msgs[i].msg_hdr.msg_controllen = sizeof(rx->ctrl[i]);
+            rx->msgs[i].msg_hdr.msg_flags = 0;
+        }
+
+        int n = recvmmsg(processor->fd, rx->msgs, RADAR_UDP_BATCH, MSG_DONTWAIT, NULL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) break;
+            LOG_ERROR("Radar UDP: recvmmsg failed (errno %d)", errno);
+            return -1;
+        }
+
+        for (int i = 0; i < n; i++) {
+            struct timeval ts;
+            udp_message_timestamp(&rx->msgs[i].msg_hdr, &ts);
+            if (processor->capture) {
+                mec_capture_write(processor->capture, CAPTURE_REC_DATAGRAM, processor->config.radar_id,
+                                  &ts, rx->bufs[i], rx->msgs[i].msg_len);
+            }
+            if (rx->msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                LOG_WARN("Radar UDP: Datagram truncated (> %d bytes)", RADAR_UDP_MAX_DATAGRAM);
+            }
+            total += radar_decode_datagram(rx->bufs[i], (int)rx->msgs[i].msg_len,
+                                           &processor->config, &ts, batch);
+        }
+
+        // 未填满说明内核队列已取空
+        if (n < RADAR_UDP_BATCH) break;
+    }
+    return total;
+}
@@ -0,0 +1,303 @@
+#include "mec_camera_manager.h"
+#include "mec_logging.h"
+#include "mec_clock.h"
+
+/**
+ * @file camera_manager.c
+ * @brief 多路相机共享解码线程池实现
+ */
+
+typedef struct {
+    camera_stream_config_t config;
+    video_source_t *source;
+    int busy;                   // 正被某个工作线程处理
+    int64_t next_due_us;        // 下次读帧时刻 (单调时钟)
+    int64_t period_us;
+    int reconnect_ms;
+
+    // 工作线程不持锁时只累加 pending_*，重新持锁后并入下方统计；读统计同锁
+    long pending_decoded;
+    long pending_late;
+    long pending_reconnects;
+
+    int connected;
+    long frames_decoded;
+    long frames_late;
+    long reconnects;
+    long report_frames;         // 上次取统计时的解码帧数
+    int64_t report_time_us;
+} camera_stream_t;
+
+struct mec_camera_manager_t {
+    camera_stream_t streams[CAMERA_MAX_STREAMS];
+    int stream_count;
+    thread_context_t workers[CAMERA_MAX_WORKERS];
+    int worker_count;
+    int requested_workers;
+    int running;
+    pthread_mutex_t lock;       // 保护流的调度状态与统计
+    pthread_cond_t cond;        // 单调时钟
+};
+
+static int64_t mono_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void* camera_worker_thread(void *arg);
+
+mec_camera_manager_t* camera_manager_create(int workers) {
+    mec_camera_manager_t *manager = mec_calloc(1, sizeof(mec_camera_manager_t));
+    if (!manager) return NULL;
+
+    manager->requested_workers = workers > 0 ? workers : 1;
+    if (manager->requested_workers > CAMERA_MAX_WORKERS) manager->requested_workers = CAMERA_MAX_WORKERS;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&manager->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&manager->lock, NULL);
+    return manager;
+}
+
+void camera_manager_destroy(mec_camera_manager_t *manager) {
+    if (!manager) return;
+    camera_manager_stop(manager);
+    pthread_mutex_destroy(&manager->lock);
+    pthread_cond_destroy(&manager->cond);
+    mec_free(manager);
+}
+
+int camera_manager_add_stream(mec_camera_manager_t *manager, const camera_stream_config_t *config) {
+    if (!manager || !config || !config->processor || manager->running) return -1;
+    if (manager->stream_count >= CAMERA_MAX_STREAMS) return -1;
+
+    camera_stream_t *s = &manager->streams[manager->stream_count];
+    memset(s, 0, sizeof(*s));
+    s->config = *config;
+    s->reconnect_ms = CAMERA_RECONNECT_MIN_MS;
+    return manager->stream_count++;
+}
+
+int camera_manager_start(mec_camera_manager_t *manager) {
+    if (!manager || manager->stream_count == 0) return -1;
+
+    int64_t now = mono_us();
+    for (int i = 0; i < manager->stream_count; i++) {
+        manager->streams[i].next_due_us = now;
+        manager->streams[i].report_time_us = now;
+    }
+
+    manager->running = 1;
+    int workers = manager->requested_workers < manager->stream_count ? manager->requested_workers : manager->stream_count;
+    for (int i = 0; i < workers; i++) {
+        if (thread_create(&manager->workers[i], camera_worker_thread, manager) != 0) {
+            LOG_ERROR("Camera manager: Failed to start decode worker %d", i);
+            camera_manager_stop(manager);
+            return -1;
+        }
+        manager->worker_count++;
+    }
+
+    LOG_INFO("Camera manager: %d streams on %d decode workers", manager->stream_count, manager->worker_count);
+    return 0;
+}
+
+void camera_manager_stop(mec_camera_manager_t *manager) {
+    if (!manager) return;
+
+    pthread_mutex_lock(&manager->lock);
+    manager->running = 0;
+    pthread_cond_broadcast(&manager->cond);
+    pthread_mutex_unlock(&manager->lock);
+
+    for (int i = 0; i < manager->worker_count; i++) {
+        thread_destroy(&manager->workers[i]);
+    }
+    manager->worker_count = 0;
+
+    for (int i = 0; i < manager->stream_count; i++) {
+        video_source_close(manager->streams[i].source);
+        manager->streams[i].source = NULL;
+        manager->streams[i].connected = 0;
+    }
+}
+
+int camera_manager_stream_count(mec_camera_manager_t *manager) {
+    return manager ? manager->stream_count : 0;
+}
+
+/* --- 解码工作线程 --- */
+
+// 连接失败或断流：关闭源并按指数退避安排重连（调用时不持锁，只改本流状态）
+static void stream_schedule_reconnect(camera_stream_t *s, int64_t now) {
+    video_source_close(s->source);
+    s->source = NULL;
+    s->next_due_us = now + (int64_t)s->reconnect_ms * 1000;
+    s->reconnect_ms *= 2;
+    if (s->reconnect_ms > CAMERA_RECONNECT_MAX_MS) s->reconnect_ms = CAMERA_RECONNECT_MAX_MS;
+}
+
+static void stream_connect(camera_stream_t *s, int64_t now) {
+    s->source = video_source_open(s->config.url, s->config.width, s->config.height);
+    if (!s->source) {
+        LOG_WARN("Camera %d: Failed to open %s, retrying in %d ms",
+                 s->config.camera_id, s->config.url, s->reconnect_ms);
+        s->pending_reconnects++;
+        stream_schedule_reconnect(s, now);
+        return;
+    }
+
+    double fps = s->config.fps > 0 ? s->config.fps :
+                 (s->source->native_fps > 0 ? s->source->native_fps : CAMERA_DEFAULT_FPS);
+    s->period_us = (int64_t)(1000000.0 / fps);
+    s->next_due_us = now;
+    LOG_INFO("Camera %d: Connected to %s (%.1f fps, %s)", s->config.camera_id, s->config.url,
+             fps, s->source->live ? "live" : "paced");
+}
+
+// 实时流由源自身按帧率出帧，读完立即再读；文件/合成源按节拍读取
+static void stream_read_frame(camera_stream_t *s, int64_t now) {
+    int live = s->source->live;
+
+    // 落后超过一个周期：丢弃过期帧，保持与实时时间轴对齐（实时流读取即最新，无需追赶）
+    int64_t behind = now - s->next_due_us;
+    if (!live && behind > s->period_us) {
+        int missed = (int)(behind / s->period_us);
+        if (missed > CAMERA_MAX_CATCHUP) missed = CAMERA_MAX_CATCHUP;
+        for (int i = 0; i < missed; i++) {
+            if (video_source_skip(s->source) != 0) break;
+        }
+        s->pending_late += missed;
+        s->next_due_us += (int64_t)missed * s->period_us;
+    }
+
+    video_frame_t *frame = video_processor_acquire_frame(s->config.processor);
+    if (!frame) {
+        // 所有槽位都在检测中，本帧直接丢弃
+        video_source_skip(s->source);
+        s->pending_late++;
+        s->next_due_us = live ? now : s->next_due_us + s->period_us;
+        return;
+    }
+
+    // 时间戳取在 grab 之前，解码级时延包含抓取与解码耗时
+    mec_clock_wall(&frame->capture_time);
+    if (video_source_read(s->source, frame) != 0) {
+        video_processor_cancel_frame(s->config.processor, frame);
+        LOG_WARN("Camera %d: Stream %s ended or failed, reconnecting in %d ms",
+                 s->config.camera_id, s->config.url, s->reconnect_ms);
+        s->pending_reconnects++;
+        stream_schedule_reconnect(s, now);
+        return;
+    }
+
+    video_processor_submit_frame(s->config.processor, frame);
+    s->pending_decoded++;
+    s->reconnect_ms = CAMERA_RECONNECT_MIN_MS;
+    if (live) {
+        s->next_due_us = now;
+        return;
+    }
+    s->next_due_us += s->period_us;
+    if (s->next_due_us < now - s->period_us) s->next_due_us = now;
+}
+
+// 调用时持有 manager->lock
+static void stream_publish_stats(camera_stream_t *s) {
+    s->connected = s->source != NULL;
+    s->frames_decoded += s->pending_decoded;
+    s->frames_late += s->pending_late;
+    s->reconnects += s->pending_reconnects;
+    s->pending_decoded = s->pending_late = s->pending_reconnects = 0;
+}
+
+/**
+ * @brief 工作线程：取最早到期且空闲的流，未到期则睡到到期时刻
+ */
+static void* camera_worker_thread(void *arg) {
+    mec_camera_manager_t *manager = (mec_camera_manager_t*)arg;
+
+    pthread_mutex_lock(&manager->lock);
+    while (manager->running) {
+        camera_stream_t *next = NULL;
+        for (int i = 0; i < manager->stream_count; i++) {
+            camera_stream_t *s = &manager->streams[i];
+            if (s->busy) continue;
+            if (!next || s->next_due_us < next->next_due_us) next = s;
+        }
+        if (!next) {
+            pthread_cond_wait(&manager->cond, &manager->lock);
+            continue;
+        }
+
+        int64_t now = mono_us();
+        if (next->next_due_us > now) {
+            struct timespec ts;
+            ts.tv_sec = next->next_due_us / 1000000;
+            ts.tv_nsec = (next->next_due_us % 1000000) * 1000;
+            pthread_cond_timedwait(&manager->cond, &manager->lock, &ts);
+            continue;   // 醒来后重新挑选（可能有更早到期的流被释放）
+        }
+
+        next->busy = 1;
+        pthread_mutex_unlock(&manager->lock);
+
+        if (next->source) {
+            stream_read_frame(next, now);
+        } else {
+            stream_connect(next, now);
+        }
+
+        pthread_mutex_lock(&manager->lock);
+        stream_publish_stats(next);
+        next->busy = 0;
+        pthread_cond_broadcast(&manager->cond);
+    }
+    pthread_mutex_unlock(&manager->lock);
+    return NULL;
+}
+
+/* --- 统计 --- */
+
+int camera_manager_get_stats(mec_camera_manager_t *manager, int index, camera_stream_stats_t *stats) {
+    if (!manager || !stats || index < 0 || index >= manager->stream_count) return -1;
+
+    camera_stream_t *s = &manager->streams[index];
+    int64_t now = mono_us();
+
+    pthread_mutex_lock(&manager->lock);
+    stats->camera_id = s->config.camera_id;
+    stats->connected = s->connected;
+    stats->frames_decoded = s->frames_decoded;
+    stats->frames_late = s->frames_late;
+    stats->reconnects = s->reconnects;
+    double dt = (now - s->report_time_us) / 1000000.0;
+    stats->decode_fps = dt > 0 ? (s->frames_decoded - s->report_frames) / dt : 0.0;
+    s->report_frames = s->frames_decoded;
+    s->report_time_us = now;
+    pthread_mutex_unlock(&manager->lock);
+
+    stats->frames_overwritten = video_processor_frames_dropped(s->config.processor);
+    video_rate_get_metrics(&s->config.processor->rate, &stats->rate);
+    return 0;
+}
+
+void camera_manager_report(mec_camera_manager_t *manager) {
+    if (!manager) return;
+    for (int i = 0; i < manager->stream_count; i++) {
+        camera_stream_stats_t st;
+        if (camera_manager_get_stats(manager, i, &st) != 0) continue;
+        LOG_INFO("Camera %d: %s | decode %.1f fps | frames %ld | late %ld | overwritten %ld | reconnects %ld",
+                 st.camera_id, st.connected ? "up" : "DOWN", st.decode_fps, st.frames_decoded,
+                 st.frames_late, st.frames_overwritten, st.reconnects);
+        LOG_INFO("Camera %d rate: latency %.1f/%.0f ms | detect %.1f ms | interval %.0f ms | "
+                 "processed %ld | stale %ld | rate-skipped %ld | backoffs %ld",
+                 st.camera_id, st.rate.latency_ms, st.rate.budget_ms, st.rate.detect_ms, st.rate.interval_ms,
+                 st.rate.frames_processed, st.rate.frames_skipped_stale, st.rate.frames_skipped_rate,
+                 st.rate.backoffs);
+    }
+}
@@ -0,0 +1,294 @@
+#include "mec_detector.h"
+#include "mec_logging.h"
+#include "mec_clock.h"
+
+/**
+ * @file detect_batcher.c
+ * @brief 检测后端注册表与跨相机批处理器
+ */
+
+static const detector_backend_t *g_backends[] = {
+    &detector_backend_mock,
+#ifdef MEC_WITH_OPENCV
+    &detector_backend_opencv_dnn,
+#endif
+};
+
+const detector_backend_t* detector_find_backend(const char *name) {
+    if (!name) return NULL;
+    for (size_t i = 0; i < sizeof(g_backends) / sizeof(g_backends[0]); i++) {
+        if (strcmp(g_backends[i]->name, name) == 0) return g_backends[i];
+    }
+    return NULL;
+}
+
+/* --- 批处理器 --- */
+
+typedef struct detect_request {
+    const detector_image_t *images;
+    int count;
+    int next_image;             // 下一个待分派的窗口
+    int remaining;              // 尚未完成的窗口数，归零时请求完成
+    track_list_t *output;
+    int done;
+    int result;
+    struct detect_request *next;
+} detect_request_t;
+
+/**
+ * @brief 推理工作线程：各自持有一份后端状态与复用缓冲
+ */
+typedef struct {
+    mec_detect_batcher_t *batcher;
+    thread_context_t thread_ctx;        // 仅用于线程生命周期，同步使用批处理器的锁
+    void *state;
+    int initialized;
+    detector_image_t batch[DETECTOR_MAX_BATCH];
+    track_list_t *outputs[DETECTOR_MAX_BATCH];
+    detect_request_t *owners[DETECTOR_MAX_BATCH];
+} detect_worker_t;
+
+struct mec_detect_batcher_t {
+    detector_config_t config;
+    const detector_backend_t *backend;
+    thread_context_t thread_ctx;        // mutex/cond 保护请求链表；running 控制所有工作线程
+    pthread_cond_t done_cond;
+    detect_request_t *head;
+    detect_request_t *tail;
+    int pending_images;
+    int cond_ready;
+
+    detect_worker_t workers[DETECTOR_MAX_WORKERS];
+    int worker_count;
+
+    long batches;
+    long images;
+};
+
+static void* detect_worker_thread(void *arg);
+
+mec_detect_batcher_t* detect_batcher_create(const detector_config_t *config) {
+    if (!config) return NULL;
+
+    const detector_backend_t *backend = detector_find_backend(config->backend);
+    if (!backend) {
+        LOG_ERROR("Detector: Unknown backend '%s'", config->backend);
+        return NULL;
+    }
+
+    mec_detect_batcher_t *batcher = mec_calloc(1, sizeof(mec_detect_batcher_t));
+    if (!batcher) return NULL;
+
+    batcher->config = *config;
+    if (batcher->config.max_batch <= 0) batcher->config.max_batch = DETECTOR_DEFAULT_BATCH;
+    if (batcher->config.max_batch > DETECTOR_MAX_BATCH) batcher->config.max_batch = DETECTOR_MAX_BATCH;
+    if (batcher->config.batch_window_ms < 0) batcher->config.batch_window_ms = 0;
+    if (batcher->config.workers <= 0) batcher->config.workers = 1;
+    if (batcher->config.workers > DETECTOR_MAX_WORKERS) batcher->config.workers = DETECTOR_MAX_WORKERS;
+    batcher->backend = backend;
+
+    // 锁与条件变量先于工作线程就绪；running 置位后工作线程才开始取请求
+    pthread_mutex_init(&batcher->thread_ctx.mutex, NULL);
+    pthread_cond_init(&batcher->thread_ctx.cond, NULL);
+    pthread_cond_init(&batcher->done_cond, NULL);
+    batcher->cond_ready = 1;
+    batcher->thread_ctx.running = true;
+
+    for (int w = 0; w < batcher->config.workers; w++) {
+        detect_worker_t *worker = &batcher->workers[w];
+        worker->batcher = batcher;
+        for (int i = 0; i < DETECTOR_MAX_BATCH; i++) {
+            worker->outputs[i] = track_list_create(64);
+            if (!worker->outputs[i]) {
+                detect_batcher_destroy(batcher);
+                return NULL;
+            }
+        }
+        // 每个工作线程一份后端实例（模型与推理缓冲不在线程间共享）
+        if (backend->init(&worker->state, &batcher->config) != 0) {
+            LOG_ERROR("Detector: Backend '%s' failed to initialize", backend->name);
+            detect_batcher_destroy(batcher);
+            return NULL;
+        }
+        worker->initialized = 1;
+        if (thread_create(&worker->thread_ctx, detect_worker_thread, worker) != 0) {
+            LOG_ERROR("Detector: Failed to start inference worker %d", w);
+            detect_batcher_destroy(batcher);
+            return NULL;
+        }
+        batcher->worker_count++;   // 只统计已启动的线程，销毁时逐个 join
+    }
+
+    LOG_INFO("Detector: Backend '%s' ready (%d workers, max batch %d, window %d ms)",
+             backend->name, batcher->worker_count, batcher->config.max_batch, batcher->config.batch_window_ms);
+    return batcher;
+}
+
+void detect_batcher_destroy(mec_detect_batcher_t *batcher) {
+    if (!batcher) return;
+
+    if (batcher->cond_ready) {
+        thread_lock(&batcher->thread_ctx);
+        batcher->thread_ctx.running = false;
+        pthread_cond_broadcast(&batcher->thread_ctx.cond);
+        thread_unlock(&batcher->thread_ctx);
+    }
+    for (int w = 0; w < batcher->worker_count; w++) {
+        detect_worker_t *worker = &batcher->workers[w];
+        thread_destroy(&worker->thread_ctx);
+    }
+    for (int w = 0; w < DETECTOR_MAX_WORKERS; w++) {
+        detect_worker_t *worker = &batcher->workers[w];
+        if (worker->initialized) batcher->backend->destroy(worker->state);
+        for (int i = 0; i < DETECTOR_MAX_BATCH; i++) {
+            track_list_release(worker->outputs[i]);
+        }
+    }
+    if (batcher->cond_ready) {
+        pthread_cond_destroy(&batcher->done_cond);
+        pthread_cond_destroy(&batcher->thread_ctx.cond);
+        pthread_mutex_destroy(&batcher->thread_ctx.mutex);
+    }
+    if (batcher->batches > 0) {
+        LOG_INFO("Detector: %ld inference calls, %ld images (avg batch %.2f)",
+                 batcher->batches, batcher->images, (double)batcher->images / batcher->batches);
+    }
+    mec_free(batcher);
+}
+
+int detect_batcher_submit(mec_detect_batcher_t *batcher, const detector_image_t *images, int count,
+                          track_list_t *output) {
+    if (!batcher || !images || !output || count <= 0) return -1;
+
+    detect_request_t req;
+    memset(&req, 0, sizeof(req));
+    req.images = images;
+    req.count = count;
+    req.remaining = count;
+    req.output = output;
+
+    thread_lock(&batcher->thread_ctx);
+    if (!batcher->thread_ctx.running) {
+        thread_unlock(&batcher->thread_ctx);
+        return -1;
+    }
+    if (batcher->tail) batcher->tail->next = &req;
+    else batcher->head = &req;
+    batcher->tail = &req;
+    batcher->pending_images += count;
+    // 窗口多于一批时唤醒多个工作线程并行推理
+    if (count > batcher->config.max_batch) pthread_cond_broadcast(&batcher->thread_ctx.cond);
+    else thread_signal(&batcher->thread_ctx);
+
+    while (!req.done) {
+        pthread_cond_wait(&batcher->done_cond, &batcher->thread_ctx.mutex);
+    }
+    thread_unlock(&batcher->thread_ctx);
+    return req.result;
+}
+
+void detect_batcher_stats(mec_detect_batcher_t *batcher, long *batches, long *images) {
+    if (!batcher) return;
+    thread_lock(&batcher->thread_ctx);
+    if (batches) *batches = batcher->batches;
+    if (images) *images = batcher->images;
+    thread_unlock(&batcher->thread_ctx);
+}
+
+// 从请求链表头部取出最多 max_batch 个窗口（一个请求可以被拆给多个工作线程），调用方持锁
+static int detect_batcher_take(mec_detect_batcher_t *batcher, detect_worker_t *worker) {
+    int n = 0;
+    while (batcher->head && n < batcher->config.max_batch) {
+        detect_request_t *req = batcher->head;
+        while (req->next_image < req->count && n < batcher->config.max_batch) {
+            worker->batch[n] = req->images[req->next_image++];
+            worker->owners[n] = req;
+            n++;
+        }
+        if (req->next_image == req->count) {
+            batcher->head = req->next;
+            if (!batcher->head) batcher->tail = NULL;
+        }
+    }
+    batcher->pending_images -= n;
+    return n;
+}
+
+// 把一批推理结果换算回整帧坐标交给各请求，调用方持锁
+static void detect_batcher_complete(mec_detect_batcher_t *batcher, detect_worker_t *worker, int n, int ret) {
+    int finished = 0;
+    for (int i = 0; i < n; i++) {
+        detect_request_t *req = worker->owners[i];
+        if (ret != 0) {
+            req->result = -1;
+        } else {
+            const detector_image_t *img = &worker->batch[i];
+            const track_list_t *out = worker->outputs[i];
+            for (int k = 0; k < out->count; k++) {
+                target_track_t t = out->tracks[k];
+                t.position.longitude = (img->crop.x + t.position.longitude * img->crop.width) / img->width;
+                t.position.latitude = (img->crop.y + t.position.latitude * img->crop.height) / img->height;
+                track_list_add(req->output, &t);
+            }
+        }
+        if (--req->remaining == 0) {
+            req->done = 1;      // 此后请求方栈帧随时失效，不能再访问 req
+            finished = 1;
+        }
+    }
+    batcher->batches++;
+    batcher->images += n;
+    if (finished) pthread_cond_broadcast(&batcher->done_cond);
+}
+
+/**
+ * @brief 推理工作线程：第一个请求到达后再等一个窗口，凑满或超时即推理
+ */
+static void* detect_worker_thread(void *arg) {
+    detect_worker_t *worker = (detect_worker_t*)arg;
+    mec_detect_batcher_t *batcher = worker->batcher;
+    const int max_batch = batcher->config.max_batch;
+
+    thread_lock(&batcher->thread_ctx);
+    while (batcher->thread_ctx.running) {
+        if (!batcher->head) {
+            thread_wait(&batcher->thread_ctx);
+            continue;
+        }
+
+        if (batcher->pending_images < max_batch && batcher->config.batch_window_ms > 0) {
+            mec_time_ns_t deadline = mec_clock_now() + (mec_time_ns_t)batcher->config.batch_window_ms * MEC_NS_PER_MS;
+            while (batcher->thread_ctx.running && batcher->pending_images < max_batch) {
+                if (mec_clock_cond_timedwait(&batcher->thread_ctx.cond, &batcher->thread_ctx.mutex,
+                                             deadline) == ETIMEDOUT) break;
+            }
+        }
+
+        int n = detect_batcher_take(batcher, worker);
+        if (n == 0) continue;   // 等待期间已被其他工作线程取走
+        // 还有剩余窗口时叫醒另一个空闲工作线程
+        if (batcher->head) thread_signal(&batcher->thread_ctx);
+        thread_unlock(&batcher->thread_ctx);
+
+        for (int i = 0; i < n; i++) track_list_clear(worker->outputs[i]);
+        int ret = batcher->backend->infer(worker->state, worker->batch, n, worker->outputs);
+
+        thread_lock(&batcher->thread_ctx);
+        detect_batcher_complete(batcher, worker, n, ret);
+    }
+
+    // 停止时释放仍在等待的请求方；已分派给其他工作线程的窗口由它们完成
+    for (detect_request_t *req = batcher->head; req; ) {
+        detect_request_t *next = req->next;
+        req->result = -1;
+        req->remaining -= req->count - req->next_image;
+        req->next_image = req->count;
+        if (req->remaining == 0) req->done = 1;
+        req = next;
+    }
+    batcher->head = batcher->tail = NULL;
+    batcher->pending_images = 0;
+    pthread_cond_broadcast(&batcher->done_cond);
+    thread_unlock(&batcher->thread_ctx);
+    return NULL;
+}
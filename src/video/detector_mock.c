@@ -0,0 +1,46 @@
+#include "mec_detector.h"
+#include "mec_logging.h"
+
+/**
+ * @file detector_mock.c
+ * @brief 无模型的占位检测后端
+ *
+ * 每个窗口固定输出三个车辆目标，用于在没有推理环境时联调流水线。
+ */
+
+static int mock_init(void **state, const detector_config_t *config) {
+    (void)config;
+    *state = NULL;
+    return 0;
+}
+
+static void mock_destroy(void *state) {
+    (void)state;
+}
+
+static int mock_infer(void *state, const detector_image_t *images, int count, track_list_t **outputs) {
+    (void)state;
+    target_track_t track;
+    memset(&track, 0, sizeof(track));
+
+    for (int n = 0; n < count; n++) {
+        for (int i = 0; i < 3; i++) {
+            track.type = TARGET_VEHICLE;
+            track.position.latitude = 0.3 + i * 0.2;  // Normalized coordinates
+            track.position.longitude = 0.4 + i * 0.1;
+            track.velocity = 10.0 + i * 5.0;
+            track.heading = 45.0 + i * 30.0;
+            track.confidence = 0.8 + i * 0.05;
+            track.sensor_id = images[n].camera_id;
+            track_list_add(outputs[n], &track);
+        }
+    }
+    return 0;
+}
+
+const detector_backend_t detector_backend_mock = {
+    "mock",
+    mock_init,
+    mock_destroy,
+    mock_infer
+};
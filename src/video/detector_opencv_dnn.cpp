@@ -0,0 +1,206 @@
+extern "C" {
+#include "mec_detector.h"
+#include "mec_logging.h"
+}
+#include <opencv2/opencv.hpp>
+#include <opencv2/dnn.hpp>
+#include <algorithm>
+#include <new>
+#include <vector>
+
+/**
+ * @file detector_opencv_dnn.cpp
+ * @brief OpenCV DNN CPU 推理后端 (YOLOv5/YOLOv8 ONNX 导出格式)
+ *
+ * 每个批槽位的 letterbox 缓冲在初始化时按网络输入尺寸分配，resize 直接写入
+ * 缓冲中央的子视图；输入 blob 也跨调用复用，稳态下推理路径不再分配内存。
+ */
+
+namespace {
+
+struct letterbox_info {
+    float scale;
+    int pad_x;
+    int pad_y;
+};
+
+struct dnn_state {
+    cv::dnn::Net net;
+    cv::Size input_size;
+    float conf_threshold;
+    float nms_threshold;
+    std::vector<cv::Mat> letterbox;          // 每个批槽位一块，循环复用
+    std::vector<letterbox_info> info;
+    std::vector<cv::Mat> batch;              // 本次推理用到的 letterbox 视图
+    cv::Mat blob;
+    cv::Mat transposed;                      // YOLOv8 输出转置缓冲
+    std::vector<cv::Mat> outs;
+    std::vector<cv::String> out_names;
+    std::vector<cv::Rect> boxes;             // NMS 暂存
+    std::vector<float> scores;
+    std::vector<int> classes;
+    std::vector<int> keep;
+};
+
+// COCO 类别 -> 系统目标类型，其余类别丢弃
+int coco_to_target_type(int cls) {
+    switch (cls) {
+        case 0: return TARGET_PEDESTRIAN;             // person
+        case 1: case 3: return TARGET_NON_VEHICLE;    // bicycle, motorcycle
+        case 2: case 5: case 7: return TARGET_VEHICLE;// car, bus, truck
+        default: return -1;
+    }
+}
+
+int dnn_init(void **state, const detector_config_t *config) {
+    dnn_state *st = new (std::nothrow) dnn_state();
+    if (!st) return -1;
+
+    try {
+        st->net = cv::dnn::readNet(config->model_path);
+    } catch (const cv::Exception &e) {
+        LOG_ERROR("Detector: Failed to load model %s: %s", config->model_path, e.what());
+        delete st;
+        return -1;
+    }
+    if (st->net.empty()) {
+        LOG_ERROR("Detector: Model %s loaded as an empty network", config->model_path);
+        delete st;
+        return -1;
+    }
+    st->net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+    st->net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+    if (config->num_threads > 0) cv::setNumThreads(config->num_threads);
+
+    st->input_size = cv::Size(config->input_width > 0 ? config->input_width : 640,
+                              config->input_height > 0 ? config->input_height : 640);
+    st->conf_threshold = config->conf_threshold > 0 ? config->conf_threshold : 0.4f;
+    st->nms_threshold = config->nms_threshold > 0 ? config->nms_threshold : 0.45f;
+    st->out_names = st->net.getUnconnectedOutLayersNames();
+
+    int slots = config->max_batch > 0 ? config->max_batch : 1;
+    for (int i = 0; i < slots; i++) {
+        st->letterbox.emplace_back(st->input_size, CV_8UC3);
+    }
+    st->info.resize(slots);
+
+    LOG_INFO("Detector: OpenCV DNN model %s (%dx%d)", config->model_path,
+             st->input_size.width, st->input_size.height);
+    *state = st;
+    return 0;
+}
+
+void dnn_destroy(void *state) {
+    delete static_cast<dnn_state*>(state);
+}
+
+// 等比缩放到复用的 letterbox 缓冲中央，四周填充灰边
+void letterbox_into(const cv::Mat &src, cv::Mat &dst, letterbox_info &info) {
+    float scale = std::min((float)dst.cols / src.cols, (float)dst.rows / src.rows);
+    int w = std::max(1, (int)(src.cols * scale));
+    int h = std::max(1, (int)(src.rows * scale));
+    info.scale = scale;
+    info.pad_x = (dst.cols - w) / 2;
+    info.pad_y = (dst.rows - h) / 2;
+
+    dst.setTo(cv::Scalar(114, 114, 114));
+    cv::Mat inner = dst(cv::Rect(info.pad_x, info.pad_y, w, h));
+    cv::resize(src, inner, inner.size(), 0, 0, cv::INTER_LINEAR);
+}
+
+/**
+ * @brief 解析单张图的输出 [rows, 4 + (obj) + classes]
+ * YOLOv5 每行为 cx,cy,w,h,obj,cls...；YOLOv8 转置后为 cx,cy,w,h,cls...
+ */
+void parse_output(dnn_state *st, const cv::Mat &pred, bool has_objectness, const letterbox_info &info,
+                  const detector_image_t &img, track_list_t *output) {
+    st->boxes.clear();
+    st->scores.clear();
+    st->classes.clear();
+
+    const int cls_offset = has_objectness ? 5 : 4;
+    const int num_classes = pred.cols - cls_offset;
+    for (int r = 0; r < pred.rows; r++) {
+        const float *row = pred.ptr<float>(r);
+        float obj = has_objectness ? row[4] : 1.0f;
+        if (obj < st->conf_threshold) continue;
+
+        cv::Mat cls_scores(1, num_classes, CV_32F, (void*)(row + cls_offset));
+        cv::Point cls_id;
+        double cls_score;
+        cv::minMaxLoc(cls_scores, nullptr, &cls_score, nullptr, &cls_id);
+        float score = obj * (float)cls_score;
+        if (score < st->conf_threshold || coco_to_target_type(cls_id.x) < 0) continue;
+
+        float cx = row[0], cy = row[1], w = row[2], h = row[3];
+        st->boxes.emplace_back((int)(cx - w / 2), (int)(cy - h / 2), (int)w, (int)h);
+        st->scores.push_back(score);
+        st->classes.push_back(cls_id.x);
+    }
+
+    cv::dnn::NMSBoxes(st->boxes, st->scores, st->conf_threshold, st->nms_threshold, st->keep);
+
+    target_track_t track;
+    memset(&track, 0, sizeof(track));
+    for (int idx : st->keep) {
+        const cv::Rect &b = st->boxes[idx];
+        // 网络输入坐标 -> 检测窗口内归一化坐标，取检测框底边中点作为接地点
+        double x = ((b.x + b.width * 0.5) - info.pad_x) / info.scale / img.crop.width;
+        double y = ((b.y + b.height) - info.pad_y) / info.scale / img.crop.height;
+        track.type = (target_type_t)coco_to_target_type(st->classes[idx]);
+        track.position.longitude = std::min(std::max(x, 0.0), 1.0);
+        track.position.latitude = std::min(std::max(y, 0.0), 1.0);
+        track.confidence = st->scores[idx];
+        track.sensor_id = img.camera_id;
+        track_list_add(output, &track);
+    }
+}
+
+int dnn_infer(void *state, const detector_image_t *images, int count, track_list_t **outputs) {
+    dnn_state *st = static_cast<dnn_state*>(state);
+    if (!st || count <= 0 || count > (int)st->letterbox.size()) return -1;
+
+    try {
+        st->batch.assign(st->letterbox.begin(), st->letterbox.begin() + count);
+        for (int i = 0; i < count; i++) {
+            const detector_image_t &img = images[i];
+            cv::Mat frame(img.height, img.width, CV_8UC3, (void*)img.data, (size_t)img.stride);
+            letterbox_into(frame(cv::Rect(img.crop.x, img.crop.y, img.crop.width, img.crop.height)),
+                           st->letterbox[i], st->info[i]);
+        }
+
+        cv::dnn::blobFromImages(st->batch, st->blob, 1.0 / 255.0, cv::Size(), cv::Scalar(), true, false);
+        st->net.setInput(st->blob);
+        st->net.forward(st->outs, st->out_names);
+    } catch (const cv::Exception &e) {
+        LOG_ERROR("Detector: Inference failed: %s", e.what());
+        return -1;
+    }
+
+    // 输出形状: [N, rows, attrs] (YOLOv5) 或 [N, attrs, rows] (YOLOv8)
+    const cv::Mat &out = st->outs[0];
+    if (out.dims != 3 || out.size[0] != count) return -1;
+    int d1 = out.size[1], d2 = out.size[2];
+    bool transposed = d1 < d2;
+    bool has_objectness = !transposed;
+
+    for (int i = 0; i < count; i++) {
+        cv::Mat pred(d1, d2, CV_32F, (void*)out.ptr<float>(i));
+        if (transposed) {
+            cv::transpose(pred, st->transposed);
+            parse_output(st, st->transposed, has_objectness, st->info[i], images[i], outputs[i]);
+        } else {
+            parse_output(st, pred, has_objectness, st->info[i], images[i], outputs[i]);
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+extern "C" const detector_backend_t detector_backend_opencv_dnn = {
+    "opencv_dnn",
+    dnn_init,
+    dnn_destroy,
+    dnn_infer
+};
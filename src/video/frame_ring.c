@@ -0,0 +1,166 @@
+#include "mec_frame_ring.h"
+#include "mec_logging.h"
+#include "mec_clock.h"
+
+/**
+ * @file frame_ring.c
+ * @brief 最新帧优先的帧缓冲环实现
+ *
+ * 每个槽位有四种状态，任一时刻最多只有一个 READY 槽位（即"最新帧"）。
+ */
+
+typedef enum {
+    SLOT_FREE = 0,
+    SLOT_WRITING,
+    SLOT_READY,
+    SLOT_READING
+} slot_state_t;
+
+struct mec_frame_ring_t {
+    video_frame_t *frames;
+    slot_state_t *states;
+    uint8_t *pool;          // 所有槽位共用的一整块像素内存
+    int slots;
+    int latest;             // READY 槽位下标 (-1 表示无)
+    int closed;
+    long dropped;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+};
+
+mec_frame_ring_t* frame_ring_create(int slots, size_t frame_bytes) {
+    if (slots < 3 || frame_bytes == 0) return NULL;
+
+    mec_frame_ring_t *ring = mec_calloc(1, sizeof(mec_frame_ring_t));
+    if (!ring) return NULL;
+
+    ring->frames = mec_calloc((size_t)slots, sizeof(video_frame_t));
+    ring->states = mec_calloc((size_t)slots, sizeof(slot_state_t));
+    ring->pool = malloc((size_t)slots * frame_bytes);
+    if (!ring->frames || !ring->states || !ring->pool) {
+        free(ring->pool);
+        mec_free(ring->states);
+        mec_free(ring->frames);
+        mec_free(ring);
+        return NULL;
+    }
+
+    for (int i = 0; i < slots; i++) {
+        ring->frames[i].data = ring->pool + (size_t)i * frame_bytes;
+        ring->frames[i].capacity = frame_bytes;
+    }
+    ring->slots = slots;
+    ring->latest = -1;
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->cond, NULL);
+    return ring;
+}
+
+void frame_ring_destroy(mec_frame_ring_t *ring) {
+    if (!ring) return;
+    pthread_mutex_destroy(&ring->lock);
+    pthread_cond_destroy(&ring->cond);
+    free(ring->pool);
+    mec_free(ring->states);
+    mec_free(ring->frames);
+    mec_free(ring);
+}
+
+static inline int frame_index(mec_frame_ring_t *ring, const video_frame_t *frame) {
+    int idx = (int)(frame - ring->frames);
+    return (idx >= 0 && idx < ring->slots) ? idx : -1;
+}
+
+video_frame_t* frame_ring_acquire_write(mec_frame_ring_t *ring) {
+    if (!ring) return NULL;
+
+    video_frame_t *frame = NULL;
+    pthread_mutex_lock(&ring->lock);
+    for (int i = 0; i < ring->slots; i++) {
+        if (ring->states[i] == SLOT_FREE) {
+            ring->states[i] = SLOT_WRITING;
+            frame = &ring->frames[i];
+            break;
+        }
+    }
+    // 没有空闲槽位：覆盖尚未被取走的旧帧
+    if (!frame && ring->latest >= 0) {
+        ring->states[ring->latest] = SLOT_WRITING;
+        frame = &ring->frames[ring->latest];
+        ring->latest = -1;
+        ring->dropped++;
+    }
+    pthread_mutex_unlock(&ring->lock);
+    return frame;
+}
+
+void frame_ring_publish(mec_frame_ring_t *ring, video_frame_t *frame) {
+    if (!ring || !frame) return;
+    int idx = frame_index(ring, frame);
+    if (idx < 0) return;
+
+    pthread_mutex_lock(&ring->lock);
+    if (ring->latest >= 0) {
+        ring->states[ring->latest] = SLOT_FREE;
+        ring->dropped++;
+    }
+    ring->states[idx] = SLOT_READY;
+    ring->latest = idx;
+    pthread_cond_signal(&ring->cond);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+void frame_ring_cancel(mec_frame_ring_t *ring, video_frame_t *frame) {
+    if (!ring || !frame) return;
+    int idx = frame_index(ring, frame);
+    if (idx < 0) return;
+
+    pthread_mutex_lock(&ring->lock);
+    ring->states[idx] = SLOT_FREE;
+    pthread_mutex_unlock(&ring->lock);
+}
+
+video_frame_t* frame_ring_acquire_read(mec_frame_ring_t *ring, int timeout_ms) {
+    if (!ring) return NULL;
+
+    // 截止时间取自系统时钟，虚拟时钟模式下随回放时间到期
+    mec_time_ns_t deadline = timeout_ms > 0 ? mec_clock_now() + (mec_time_ns_t)timeout_ms * MEC_NS_PER_MS : 0;
+
+    video_frame_t *frame = NULL;
+    pthread_mutex_lock(&ring->lock);
+    while (ring->latest < 0 && !ring->closed) {
+        if (timeout_ms == 0) break;
+        if (timeout_ms < 0) {
+            pthread_cond_wait(&ring->cond, &ring->lock);
+        } else if (mec_clock_cond_timedwait(&ring->cond, &ring->lock, deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    if (ring->latest >= 0 && !ring->closed) {
+        ring->states[ring->latest] = SLOT_READING;
+        frame = &ring->frames[ring->latest];
+        ring->latest = -1;
+    }
+    pthread_mutex_unlock(&ring->lock);
+    return frame;
+}
+
+void frame_ring_release(mec_frame_ring_t *ring, video_frame_t *frame) {
+    frame_ring_cancel(ring, frame);
+}
+
+void frame_ring_close(mec_frame_ring_t *ring) {
+    if (!ring) return;
+    pthread_mutex_lock(&ring->lock);
+    ring->closed = 1;
+    pthread_cond_broadcast(&ring->cond);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+long frame_ring_dropped(mec_frame_ring_t *ring) {
+    if (!ring) return 0;
+    pthread_mutex_lock(&ring->lock);
+    long dropped = ring->dropped;
+    pthread_mutex_unlock(&ring->lock);
+    return dropped;
+}
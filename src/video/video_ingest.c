@@ -0,0 +1,35 @@
+#include "mec_video.h"
+
+/**
+ * @file video_ingest.c
+ * @brief 解码帧写入视频处理器（OpenCV 与 Mock 实现共用）
+ */
+
+video_frame_t* video_processor_acquire_frame(video_processor_t *processor) {
+    if (!processor || !processor->frame_ring) return NULL;
+    return frame_ring_acquire_write(processor->frame_ring);
+}
+
+void video_processor_submit_frame(video_processor_t *processor, video_frame_t *frame) {
+    if (!processor || !frame) return;
+
+    // 解码时延在发布前记录：发布后检测级可能立即取走并复用该槽位
+    frame->seq = processor->frame_seq++;
+    video_stats_record(&processor->stats, VIDEO_STAGE_DECODE, &frame->capture_time);
+    frame_ring_publish(processor->frame_ring, frame);
+
+    pthread_mutex_lock(&processor->stats.lock);
+    processor->stats.frames_decoded++;
+    processor->stats.frames_dropped = frame_ring_dropped(processor->frame_ring);
+    pthread_mutex_unlock(&processor->stats.lock);
+}
+
+void video_processor_cancel_frame(video_processor_t *processor, video_frame_t *frame) {
+    if (!processor || !frame) return;
+    frame_ring_cancel(processor->frame_ring, frame);
+}
+
+long video_processor_frames_dropped(video_processor_t *processor) {
+    if (!processor || !processor->frame_ring) return 0;
+    return frame_ring_dropped(processor->frame_ring);
+}
@@ -0,0 +1,246 @@
+#include "mec_video_motion.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @file video_motion.c
+ * @brief 帧差运动门控实现
+ */
+
+static void motion_gate_free(motion_gate_t *gate) {
+    free(gate->gray);
+    free(gate->background);
+    free(gate->active);
+    free(gate->visited);
+    free(gate->stack);
+    gate->gray = gate->background = gate->active = gate->visited = NULL;
+    gate->stack = NULL;
+    gate->frame_width = gate->frame_height = 0;
+}
+
+static int motion_gate_alloc(motion_gate_t *gate, int width, int height) {
+    motion_gate_free(gate);
+
+    int gw = (width + MOTION_SAMPLE_STEP - 1) / MOTION_SAMPLE_STEP;
+    int gh = (height + MOTION_SAMPLE_STEP - 1) / MOTION_SAMPLE_STEP;
+    gate->tiles_x = (gw + MOTION_TILE_SAMPLES - 1) / MOTION_TILE_SAMPLES;
+    gate->tiles_y = (gh + MOTION_TILE_SAMPLES - 1) / MOTION_TILE_SAMPLES;
+    gate->gray_width = gate->tiles_x * MOTION_TILE_SAMPLES;
+    gate->gray_height = gate->tiles_y * MOTION_TILE_SAMPLES;
+
+    size_t pixels = (size_t)gate->gray_width * gate->gray_height;
+    size_t tiles = (size_t)gate->tiles_x * gate->tiles_y;
+    // 补齐部分两幅图都保持为 0，差值恒为 0
+    gate->gray = calloc(pixels, 1);
+    gate->background = calloc(pixels, 1);
+    gate->active = calloc(tiles, 1);
+    gate->visited = calloc(tiles, 1);
+    gate->stack = malloc(tiles * sizeof(int));
+    if (!gate->gray || !gate->background || !gate->active || !gate->visited || !gate->stack) {
+        motion_gate_free(gate);
+        return -1;
+    }
+
+    gate->frame_width = width;
+    gate->frame_height = height;
+    gate->warmup = MOTION_WARMUP_FRAMES;
+    return 0;
+}
+
+void motion_gate_init(motion_gate_t *gate, int threshold) {
+    if (!gate) return;
+    memset(gate, 0, sizeof(*gate));
+    gate->threshold = threshold > 0 ? threshold : MOTION_DEFAULT_THRESHOLD;
+    if (gate->threshold > 255) gate->threshold = 255;
+}
+
+void motion_gate_destroy(motion_gate_t *gate) {
+    if (!gate) return;
+    motion_gate_free(gate);
+}
+
+static void sample_gray(motion_gate_t *gate, const video_frame_t *frame) {
+    int gw = (frame->width + MOTION_SAMPLE_STEP - 1) / MOTION_SAMPLE_STEP;
+    int gh = (frame->height + MOTION_SAMPLE_STEP - 1) / MOTION_SAMPLE_STEP;
+    for (int j = 0; j < gh; j++) {
+        const uint8_t *row = frame->data + (size_t)j * MOTION_SAMPLE_STEP * frame->stride;
+        uint8_t *out = gate->gray + (size_t)j * gate->gray_width;
+        if (frame->channels >= 3) {
+            for (int i = 0; i < gw; i++) {
+                const uint8_t *p = row + (size_t)i * MOTION_SAMPLE_STEP * frame->channels;
+                out[i] = (uint8_t)((p[0] + 2 * p[1] + p[2]) >> 2);
+            }
+        } else {
+            for (int i = 0; i < gw; i++) out[i] = row[(size_t)i * MOTION_SAMPLE_STEP * frame->channels];
+        }
+    }
+}
+
+/**
+ * @brief 统计一块内变化点数，并把背景向当前帧靠近 1/8
+ *
+ * 背景更新为三次逐次向上取整的平均（即 pavgb），标量路径按同样方式取整，
+ * 两条路径结果逐位一致。
+ */
+static int tile_update(motion_gate_t *gate, int tx, int ty) {
+    size_t base = (size_t)ty * MOTION_TILE_SAMPLES * gate->gray_width + (size_t)tx * MOTION_TILE_SAMPLES;
+#if defined(__SSE2__)
+    const __m128i thr = _mm_set1_epi8((char)gate->threshold);
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    for (int r = 0; r < MOTION_TILE_SAMPLES; r++) {
+        uint8_t *cur_p = gate->gray + base + (size_t)r * gate->gray_width;
+        uint8_t *bg_p = gate->background + base + (size_t)r * gate->gray_width;
+        __m128i cur = _mm_loadu_si128((const __m128i*)cur_p);
+        __m128i bg = _mm_loadu_si128((const __m128i*)bg_p);
+        __m128i diff = _mm_or_si128(_mm_subs_epu8(cur, bg), _mm_subs_epu8(bg, cur));
+        // 超过阈值的点记 1，psadbw 求和
+        __m128i changed = _mm_min_epu8(_mm_subs_epu8(diff, thr), one);
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(changed, zero));
+        // bg + (cur - bg) / 8：三次取平均
+        __m128i t = _mm_avg_epu8(bg, cur);
+        t = _mm_avg_epu8(bg, t);
+        t = _mm_avg_epu8(bg, t);
+        _mm_storeu_si128((__m128i*)bg_p, t);
+    }
+    return _mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+#else
+    int count = 0;
+    for (int r = 0; r < MOTION_TILE_SAMPLES; r++) {
+        uint8_t *cur_p = gate->gray + base + (size_t)r * gate->gray_width;
+        uint8_t *bg_p = gate->background + base + (size_t)r * gate->gray_width;
+        for (int c = 0; c < MOTION_TILE_SAMPLES; c++) {
+            int bg = bg_p[c];
+            int d = cur_p[c] - bg;
+            if (d > gate->threshold || -d > gate->threshold) count++;
+            int t = (bg + cur_p[c] + 1) >> 1;
+            t = (bg + t + 1) >> 1;
+            bg_p[c] = (uint8_t)((bg + t + 1) >> 1);
+        }
+    }
+    return count;
+#endif
+}
+
+// 活动块外扩一块后按 4 邻域连通，输出外接矩形；超过上限时合并为一个
+static void build_regions(motion_gate_t *gate) {
+    int tx_n = gate->tiles_x, ty_n = gate->tiles_y;
+    memset(gate->visited, 0, (size_t)tx_n * ty_n);
+    gate->region_count = 0;
+    int overflow = 0;
+    int ux0 = tx_n, uy0 = ty_n, ux1 = -1, uy1 = -1;
+
+    for (int start = 0; start < tx_n * ty_n; start++) {
+        if (!gate->active[start] || gate->visited[start]) continue;
+
+        int x0 = tx_n, y0 = ty_n, x1 = -1, y1 = -1;
+        int top = 0;
+        gate->stack[top++] = start;
+        gate->visited[start] = 1;
+        while (top > 0) {
+            int idx = gate->stack[--top];
+            int tx = idx % tx_n, ty = idx / tx_n;
+            if (tx < x0) x0 = tx;
+            if (tx > x1) x1 = tx;
+            if (ty < y0) y0 = ty;
+            if (ty > y1) y1 = ty;
+            // 相距不超过两块（外扩后相接）的活动块属于同一区域
+            for (int dy = -2; dy <= 2; dy++) {
+                for (int dx = -2; dx <= 2; dx++) {
+                    int nx = tx + dx, ny = ty + dy;
+                    if (nx < 0 || ny < 0 || nx >= tx_n || ny >= ty_n) continue;
+                    int n = ny * tx_n + nx;
+                    if (gate->active[n] && !gate->visited[n]) {
+                        gate->visited[n] = 1;
+                        gate->stack[top++] = n;
+                    }
+                }
+            }
+        }
+
+        // 外扩一块
+        x0 = x0 > 0 ? x0 - 1 : 0;
+        y0 = y0 > 0 ? y0 - 1 : 0;
+        x1 = x1 < tx_n - 1 ? x1 + 1 : tx_n - 1;
+        y1 = y1 < ty_n - 1 ? y1 + 1 : ty_n - 1;
+        if (x0 < ux0) ux0 = x0;
+        if (y0 < uy0) uy0 = y0;
+        if (x1 > ux1) ux1 = x1;
+        if (y1 > uy1) uy1 = y1;
+
+        if (gate->region_count < VIDEO_MAX_REGIONS) {
+            roi_rect_t *r = &gate->regions[gate->region_count++];
+            r->x = x0 * MOTION_TILE_PX;
+            r->y = y0 * MOTION_TILE_PX;
+            r->width = (x1 + 1) * MOTION_TILE_PX - r->x;
+            r->height = (y1 + 1) * MOTION_TILE_PX - r->y;
+        } else {
+            overflow = 1;
+        }
+    }
+
+    if (overflow) {
+        gate->region_count = 1;
+        gate->regions[0].x = ux0 * MOTION_TILE_PX;
+        gate->regions[0].y = uy0 * MOTION_TILE_PX;
+        gate->regions[0].width = (ux1 + 1) * MOTION_TILE_PX - gate->regions[0].x;
+        gate->regions[0].height = (uy1 + 1) * MOTION_TILE_PX - gate->regions[0].y;
+    }
+
+    // 裁到画面范围内
+    for (int i = 0; i < gate->region_count; i++) {
+        roi_rect_t *r = &gate->regions[i];
+        if (r->x + r->width > gate->frame_width) r->width = gate->frame_width - r->x;
+        if (r->y + r->height > gate->frame_height) r->height = gate->frame_height - r->y;
+    }
+}
+
+motion_result_t motion_gate_update(motion_gate_t *gate, const video_frame_t *frame) {
+    if (!gate || !frame || frame->width <= 0 || frame->height <= 0) return MOTION_FULL;
+
+    if (gate->frame_width != frame->width || gate->frame_height != frame->height) {
+        if (motion_gate_alloc(gate, frame->width, frame->height) != 0) return MOTION_FULL;
+    }
+
+    sample_gray(gate, frame);
+
+    if (gate->warmup == MOTION_WARMUP_FRAMES) {
+        // 首帧直接作为背景
+        memcpy(gate->background, gate->gray, (size_t)gate->gray_width * gate->gray_height);
+    }
+
+    gate->active_tiles = 0;
+    for (int ty = 0; ty < gate->tiles_y; ty++) {
+        for (int tx = 0; tx < gate->tiles_x; tx++) {
+            int changed = tile_update(gate, tx, ty);
+            int on = changed >= MOTION_MIN_CHANGED;
+            gate->active[ty * gate->tiles_x + tx] = (uint8_t)on;
+            gate->active_tiles += on;
+        }
+    }
+    gate->region_count = 0;
+
+    if (gate->warmup > 0) {
+        gate->warmup--;
+        return MOTION_FULL;
+    }
+    if (gate->active_tiles == 0) return MOTION_NONE;
+    if (gate->active_tiles > MOTION_FULL_RATIO * gate->tiles_x * gate->tiles_y) return MOTION_FULL;
+
+    build_regions(gate);
+    return MOTION_PARTIAL;
+}
+
+int motion_gate_point_active(const motion_gate_t *gate, double x, double y) {
+    if (!gate || !gate->active) return 1;
+    int px = (int)(x * gate->frame_width);
+    int py = (int)(y * gate->frame_height);
+    for (int i = 0; i < gate->region_count; i++) {
+        const roi_rect_t *r = &gate->regions[i];
+        if (px >= r->x && px < r->x + r->width && py >= r->y && py < r->y + r->height) return 1;
+    }
+    return 0;
+}
@@ -1,5 +1,10 @@
+extern "C" {
 #include "mec_video.h"
+#include "mec_geo.h"
+#include "mec_clock.h"
+}
 #include <opencv2/opencv.hpp>
+#include <algorithm>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -9,18 +14,39 @@ extern "C" {
 video_processor_t* video_processor_create(const video_config_t *config) {
     if (!config) return NULL;
     
-    video_processor_t *processor = (video_processor_t*)mec_malloc(sizeof(video_processor_t));
+    video_processor_t *processor = (video_processor_t*)mec_calloc(1, sizeof(video_processor_t));
     if (!processor) return NULL;
     
     processor->config = *config;
     processor->transform.calibrated = 0;
     processor->region_count = 0;
+    pthread_mutex_init(&processor->config_lock, NULL);
+    processor->tile_size_warned = -1;
     processor->output_tracks = track_list_create(100);
+    processor->last_detections = track_list_create(32);
+    
+    // 帧缓冲按配置分辨率预分配 (BGR24)，运行期不再申请
+    int width = config->width > 0 ? config->width : 1920;
+    int height = config->height > 0 ? config->height : 1080;
+    processor->frame_ring = frame_ring_create(VIDEO_RING_SLOTS, (size_t)width * height * 3);
+    processor->detect_queue = mec_queue_create(VIDEO_DETECT_QUEUE_SIZE);
     
-    if (!processor->output_tracks) {
+    if (!processor->output_tracks || !processor->last_detections || !processor->frame_ring ||
+        !processor->detect_queue) {
+        track_list_release(processor->output_tracks);
+        track_list_release(processor->last_detections);
+        frame_ring_destroy(processor->frame_ring);
+        mec_queue_destroy(processor->detect_queue);
+        pthread_mutex_destroy(&processor->config_lock);
         mec_free(processor);
         return NULL;
     }
+    video_stats_init(&processor->stats);
+    roi_set_init(&processor->roi, width, height);
+    video_tracker_init(&processor->tracker, config->camera_id, VIDEO_TRACKER_DEFAULT_GATE, VIDEO_TRACKER_DEFAULT_MAX_MISSES);
+    video_rate_init(&processor->rate, config->latency_budget_ms, config->max_detect_interval_ms);
+    propagator_init(&processor->propagator, config->propagate_patch_px, config->propagate_min_score);
+    motion_gate_init(&processor->motion, config->motion_threshold);
     
     LOG_INFO("Created video processor for camera %d", config->camera_id);
     return processor;
@@ -30,15 +56,27 @@ void video_processor_destroy(video_processor_t *processor) {
     if (!processor) return;
     
     video_processor_stop(processor);
+    mec_queue_destroy(processor->detect_queue);
+    frame_ring_destroy(processor->frame_ring);
+    undistort_map_destroy(processor->undistort);
+    roi_set_clear(&processor->roi);
+    video_stats_destroy(&processor->stats);
+    video_rate_destroy(&processor->rate);
+    motion_gate_destroy(&processor->motion);
+    track_list_release(processor->last_detections);
     track_list_release(processor->output_tracks);
+    pthread_mutex_destroy(&processor->config_lock);
     mec_free(processor);
 }
 
 int video_processor_start(video_processor_t *processor) {
     if (!processor) return -1;
     
-    if (thread_create(&processor->thread_ctx, video_processing_thread, processor) != 0) {
-        LOG_ERROR("Failed to start video processing thread");
+    // 下游先启动；解码由相机管理器负责，在所有处理器启动之后开始
+    if (thread_create(&processor->publish_ctx, video_publish_thread, processor) != 0 ||
+        thread_create(&processor->detect_ctx, video_detect_thread, processor) != 0) {
+        LOG_ERROR("Failed to start video processing threads");
+        video_processor_stop(processor);
         return -1;
     }
     
@@ -49,23 +87,55 @@ int video_processor_start(video_processor_t *processor) {
 void video_processor_stop(video_processor_t *processor) {
     if (!processor) return;
     
-    thread_destroy(&processor->thread_ctx);
+    // 按数据流方向依次停止：关闭帧缓冲环 -> 检测 -> 后处理（相机管理器应已先停止）
+    frame_ring_close(processor->frame_ring);
+    thread_destroy(&processor->detect_ctx);
+    thread_destroy(&processor->publish_ctx);
     LOG_INFO("Stopped video processor for camera %d", processor->config.camera_id);
 }
 
 int video_processor_set_transform(video_processor_t *processor, const perspective_transform_t *transform) {
     if (!processor || !transform) return -1;
     
+    // 查找表在锁外构建，后处理级只在锁内短暂交换指针
+    undistort_map_t *map = NULL;
+    if (transform->lens.enabled) {
+        int width = processor->config.width > 0 ? processor->config.width : 1920;
+        int height = processor->config.height > 0 ? processor->config.height : 1080;
+        map = undistort_map_create(&transform->lens, width, height, UNDISTORT_DEFAULT_STEP);
+        if (!map) {
+            LOG_ERROR("Invalid lens parameters for camera %d", processor->config.camera_id);
+            return -1;
+        }
+    }
+    
+    pthread_mutex_lock(&processor->config_lock);
+    undistort_map_t *old = processor->undistort;
     processor->transform = *transform;
+    processor->undistort = map;
+    pthread_mutex_unlock(&processor->config_lock);
+    undistort_map_destroy(old);
+    
     LOG_INFO("Set perspective transform for camera %d", processor->config.camera_id);
     return 0;
 }
 
 int video_processor_add_region(video_processor_t *processor, const detection_region_t *region) {
-    if (!processor || !region || processor->region_count >= 4) return -1;
+    if (!processor || !region || processor->region_count >= VIDEO_MAX_REGIONS) return -1;
+    
+    // 检测级在锁内读取掩码与裁剪窗口；处理器启动前后均可调用
+    pthread_mutex_lock(&processor->config_lock);
+    int ret = region->enabled ? roi_set_add_polygon(&processor->roi, region->points, region->point_count) : 0;
+    if (ret == 0) {
+        processor->regions[processor->region_count] = *region;
+        processor->region_count++;
+    }
+    pthread_mutex_unlock(&processor->config_lock);
     
-    processor->regions[processor->region_count] = *region;
-    processor->region_count++;
+    if (ret != 0) {
+        LOG_ERROR("Invalid detection region for camera %d", processor->config.camera_id);
+        return -1;
+    }
     LOG_INFO("Added detection region %d for camera %d", processor->region_count, processor->config.camera_id);
     return 0;
 }
@@ -75,152 +145,339 @@ track_list_t* video_processor_get_tracks(video_processor_t *processor) {
     return processor->output_tracks;
 }
 
-int transform_image_to_wgs84(const perspective_transform_t *transform, 
-                           const image_coord_t *image_coord, 
-                           wgs84_coord_t *wgs84_coord) {
-    if (!transform || !image_coord || !wgs84_coord || !transform->calibrated) {
+int transform_image_to_enu(const perspective_transform_t *transform,
+                           const image_coord_t *image_coord,
+                           enu_coord_t *enu_coord) {
+    if (!transform || !image_coord || !enu_coord || !transform->calibrated) {
         return -1;
     }
     
     double x = image_coord->x;
     double y = image_coord->y;
     
-    // Apply perspective transformation matrix
+    // Apply perspective transformation matrix (image plane -> site ENU ground plane)
     double w = transform->matrix[6] * x + transform->matrix[7] * y + transform->matrix[8];
     if (fabs(w) < 1e-10) return -1;
     
-    double world_x = (transform->matrix[0] * x + transform->matrix[1] * y + transform->matrix[2]) / w;
-    double world_y = (transform->matrix[3] * x + transform->matrix[4] * y + transform->matrix[5]) / w;
+    enu_coord->east = (transform->matrix[0] * x + transform->matrix[1] * y + transform->matrix[2]) / w;
+    enu_coord->north = (transform->matrix[3] * x + transform->matrix[4] * y + transform->matrix[5]) / w;
+    enu_coord->up = 0.0;
     
-    // Convert to WGS84 (simplified - in practice would need proper projection)
-    wgs84_coord->latitude = world_y;
-    wgs84_coord->longitude = world_x;
-    wgs84_coord->altitude = 0.0;
+    return 0;
+}
+
+int transform_image_to_wgs84(const perspective_transform_t *transform, 
+                           const image_coord_t *image_coord, 
+                           wgs84_coord_t *wgs84_coord) {
+    if (!wgs84_coord) return -1;
     
+    enu_coord_t enu;
+    if (transform_image_to_enu(transform, image_coord, &enu) != 0) return -1;
+    geo_enu_to_wgs84(geo_get_site(), &enu, wgs84_coord);
     return 0;
 }
 
-void* video_processing_thread(void *arg) {
-    video_processor_t *processor = (video_processor_t*)arg;
-    if (!processor) return NULL;
+/**
+ * @brief 按实际解码尺寸重新光栅化全部区域（调用时持有 config_lock）
+ *
+ * 掩码在添加区域时按配置分辨率光栅化；流的原生分辨率与配置不同时首帧重建一次，
+ * 区域顶点与标定一样以原生像素为准。
+ */
+static void roi_fit_locked(video_processor_t *processor, int width, int height) {
+    roi_set_clear(&processor->roi);
+    roi_set_init(&processor->roi, width, height);
+    for (int i = 0; i < processor->region_count; i++) {
+        const detection_region_t *region = &processor->regions[i];
+        if (region->enabled && roi_set_add_polygon(&processor->roi, region->points, region->point_count) != 0) {
+            LOG_WARN("Camera %d: Region %d does not fit a %dx%d frame, ignored",
+                     processor->config.camera_id, i + 1, width, height);
+        }
+    }
+    LOG_INFO("Camera %d: Rebuilt detection regions for %dx%d frames", processor->config.camera_id, width, height);
+}
+
+/**
+ * @brief 去畸变表与实际解码尺寸不符时重建（调用时持有 config_lock）
+ */
+static void undistort_fit_locked(video_processor_t *processor, int width, int height) {
+    undistort_map_t *map = processor->undistort;
+    if (!map || (map->width == width && map->height == height)) return;
+    undistort_map_t *fit = undistort_map_create(&processor->transform.lens, width, height, UNDISTORT_DEFAULT_STEP);
+    if (!fit) {
+        LOG_ERROR("Camera %d: Failed to rebuild undistort map for %dx%d frames",
+                  processor->config.camera_id, width, height);
+        return;
+    }
+    undistort_map_destroy(map);
+    processor->undistort = fit;
+    LOG_INFO("Camera %d: Rebuilt undistort map for %dx%d frames", processor->config.camera_id, width, height);
+}
+
+/**
+ * @brief 完整检测一帧：按 ROI 裁剪（大区域再切块）、提交批处理器、合并块间重复、按掩码过滤
+ * @param limits 只检测与这些矩形相交的部分（运动区域），NULL 表示不限制
+ */
+static int run_detector(video_processor_t *processor, const video_frame_t *frame,
+                        const roi_rect_t *limits, int limit_count, track_list_t *detections) {
+    // 只检测 ROI 外接矩形覆盖的像素；未配置区域时检测整帧
+    roi_rect_t base[VIDEO_MAX_REGIONS];
+    int base_count = 0;
     
-    cv::VideoCapture cap;
+    pthread_mutex_lock(&processor->config_lock);
+    if (processor->region_count > 0 &&
+        (processor->roi.frame_width != frame->width || processor->roi.frame_height != frame->height)) {
+        roi_fit_locked(processor, frame->width, frame->height);
+    }
+    const roi_set_t *roi = &processor->roi;
+    if (roi->mask_count > 0) {
+        for (int i = 0; i < roi->crop_count; i++) {
+            base[base_count++] = roi->crops[i];
+        }
+    } else {
+        base[0].x = 0;
+        base[0].y = 0;
+        base[0].width = frame->width;
+        base[0].height = frame->height;
+        base_count = 1;
+    }
     
-    // Try to open RTSP stream
-    if (!cap.open(processor->config.rtsp_url)) {
-        LOG_ERROR("Failed to open RTSP stream: %s", processor->config.rtsp_url);
-        return NULL;
+    roi_rect_t areas[VIDEO_MAX_REGIONS * VIDEO_MAX_REGIONS];
+    int area_count = 0;
+    for (int i = 0; i < base_count; i++) {
+        if (!limits) {
+            areas[area_count++] = base[i];
+            continue;
+        }
+        for (int k = 0; k < limit_count; k++) {
+            int x0 = std::max(base[i].x, limits[k].x);
+            int y0 = std::max(base[i].y, limits[k].y);
+            int x1 = std::min(base[i].x + base[i].width, limits[k].x + limits[k].width);
+            int y1 = std::min(base[i].y + base[i].height, limits[k].y + limits[k].height);
+            if (x1 <= x0 || y1 <= y0) continue;
+            areas[area_count].x = x0;
+            areas[area_count].y = y0;
+            areas[area_count].width = x1 - x0;
+            areas[area_count].height = y1 - y0;
+            area_count++;
+        }
     }
+    if (area_count == 0) {
+        pthread_mutex_unlock(&processor->config_lock);
+        return 0;   // 运动全部发生在检测区域之外
+    }
+    
+    // 大区域切成重叠块，跟随掩码丢弃路外的块
+    roi_rect_t tiles[VIDEO_MAX_TILES];
+    int tile_used = 0;
+    int count = video_tiles_layout(areas, area_count, roi, processor->config.tile_size,
+                                   processor->config.tile_overlap, tiles, VIDEO_MAX_TILES, &tile_used);
+    pthread_mutex_unlock(&processor->config_lock);
+    // 块数超限时块边长被自动放大：每路相机每个新的放大档位告警一次
+    if (tile_used != processor->config.tile_size && tile_used != processor->tile_size_warned) {
+        LOG_WARN("Camera %d: %dx%d frame needs more than %d tiles of %d px, using %d px tiles (0: untiled)",
+                 processor->config.camera_id, frame->width, frame->height, VIDEO_MAX_TILES,
+                 processor->config.tile_size, tile_used);
+        processor->tile_size_warned = tile_used;
+    }
+    if (count == 0) return 0;
+    
+    detector_image_t images[VIDEO_MAX_TILES];
+    for (int i = 0; i < count; i++) {
+        images[i].crop = tiles[i];
+        images[i].data = frame->data;
+        images[i].width = frame->width;
+        images[i].height = frame->height;
+        images[i].stride = frame->stride;
+        images[i].camera_id = processor->config.camera_id;
+    }
+    
+    // 与其他相机的请求合批推理，阻塞直到本帧结果返回
+    int ret = detect_batcher_submit(processor->config.detector, images, count, detections);
     
-    cv::Mat frame;
-    track_list_t *previous_tracks = track_list_create(100);
+    // 切块后相邻块重叠部分的目标会被检出两次
+    if (ret == 0 && processor->config.tile_size > 0 && count > 1) {
+        video_tiles_merge(detections, processor->config.tile_merge_px, frame->width, frame->height);
+    }
+    
+    // 按掩码剔除路外目标
+    pthread_mutex_lock(&processor->config_lock);
+    if (ret == 0) roi_filter_tracks(roi, detections);
+    pthread_mutex_unlock(&processor->config_lock);
+    return ret;
+}
+
+/**
+ * @brief 检测级：总是处理最新一帧，结果交给后处理级
+ */
+void* video_detect_thread(void *arg) {
+    video_processor_t *processor = (video_processor_t*)arg;
+    if (!processor) return NULL;
     
-    while (processor->thread_ctx.running) {
-        if (!cap.read(frame)) {
-            LOG_WARN("Failed to read frame from camera %d", processor->config.camera_id);
-            usleep(100000); // Wait 100ms before retry
+    while (processor->detect_ctx.running) {
+        video_frame_t *frame = frame_ring_acquire_read(processor->frame_ring, 100);
+        if (!frame) continue;
+        
+        // 过期帧或超出当前检测频率的帧直接归还，不进入检测
+        if (video_rate_decide(&processor->rate, &frame->capture_time,
+                              mec_queue_size(processor->detect_queue)) != VIDEO_RATE_PROCESS) {
+            frame_ring_release(processor->frame_ring, frame);
             continue;
         }
         
-        // Process frame
-        thread_lock(&processor->thread_ctx);
-        track_list_clear(processor->output_tracks);
-        
-        if (detect_targets(frame.data, frame.cols, frame.rows, processor->output_tracks) == 0) {
-            track_targets(previous_tracks, processor->output_tracks);
+        track_list_t *detections = track_list_create(32);
+        int ret = -1;
+        if (detections) {
+            mec_time_ns_t detect_start = mec_clock_real_ns();
+            
+            // 运动门控：画面静止时沿用上次结果；局部运动时只检测运动区域，
+            // 区域外的上次结果原样保留。超过 motion_refresh_ms 未整帧检测时强制整帧检测
+            motion_result_t motion = MOTION_FULL;
+            if (processor->config.motion_gate) {
+                motion = motion_gate_update(&processor->motion, frame);
+                if (!processor->has_full_detect ||
+                    mec_timeval_elapsed_ms(&processor->last_full_detect, &frame->capture_time) >=
+                    processor->config.motion_refresh_ms) {
+                    motion = MOTION_FULL;
+                }
+            }
+            
+            int held = 0, propagated = 0, redetect = 0;
+            if (motion == MOTION_NONE) {
+                for (int i = 0; i < processor->last_detections->count; i++) {
+                    track_list_add(detections, &processor->last_detections->tracks[i]);
+                }
+                held = 1;
+                ret = 0;
+            }
+            
+            // 关键帧间隔内用模板匹配传播上一关键帧的结果，匹配变差时提前重新检测
+            if (!held && processor->config.keyframe_hz > 0 && processor->has_keyframe &&
+                mec_timeval_elapsed_ms(&processor->last_keyframe, &frame->capture_time) <
+                1000.0 / processor->config.keyframe_hz) {
+                if (propagator_track(&processor->propagator, frame, detections) == 0) {
+                    propagated = 1;
+                    ret = 0;
+                } else {
+                    track_list_clear(detections);
+                    redetect = 1;
+                }
+            }
             
-            // Transform coordinates if calibrated
-            if (processor->transform.calibrated) {
-                for (int i = 0; i < processor->output_tracks->count; i++) {
-                    image_coord_t img_coord = {
-                        (int)(processor->output_tracks->tracks[i].position.longitude * frame.cols),
-                        (int)(processor->output_tracks->tracks[i].position.latitude * frame.rows)
-                    };
-                    
-                    wgs84_coord_t wgs84_coord;
-                    if (transform_image_to_wgs84(&processor->transform, &img_coord, &wgs84_coord) == 0) {
-                        processor->output_tracks->tracks[i].position = wgs84_coord;
+            if (!held && !propagated && processor->config.detector) {
+                if (motion == MOTION_PARTIAL) {
+                    ret = run_detector(processor, frame, processor->motion.regions,
+                                       processor->motion.region_count, detections);
+                    for (int i = 0; ret == 0 && i < processor->last_detections->count; i++) {
+                        const target_track_t *t = &processor->last_detections->tracks[i];
+                        if (!motion_gate_point_active(&processor->motion, t->position.longitude,
+                                                      t->position.latitude)) {
+                            track_list_add(detections, t);
+                        }
                     }
+                } else {
+                    ret = run_detector(processor, frame, NULL, 0, detections);
+                    if (ret == 0) {
+                        processor->last_full_detect = frame->capture_time;
+                        processor->has_full_detect = 1;
+                    }
+                }
+                if (ret == 0 && processor->config.keyframe_hz > 0) {
+                    propagator_reset(&processor->propagator, frame, detections);
+                    processor->last_keyframe = frame->capture_time;
+                    processor->has_keyframe = 1;
+                }
+            }
+            
+            if (ret == 0 && !held) {
+                track_list_clear(processor->last_detections);
+                for (int i = 0; i < detections->count; i++) {
+                    track_list_add(processor->last_detections, &detections->tracks[i]);
                 }
             }
+            
+            video_rate_record_detect(&processor->rate, mec_time_to_ms(mec_clock_real_ns() - detect_start));
+            
+            pthread_mutex_lock(&processor->stats.lock);
+            if (held) processor->stats.frames_static++;
+            else if (propagated) processor->stats.frames_propagated++;
+            else if (ret == 0) processor->stats.keyframes++;
+            if (ret == 0 && motion == MOTION_PARTIAL && !propagated) processor->stats.frames_partial++;
+            if (redetect) processor->stats.early_redetects++;
+            pthread_mutex_unlock(&processor->stats.lock);
         }
         
-        // Copy current tracks to previous
-        track_list_clear(previous_tracks);
-        for (int i = 0; i < processor->output_tracks->count; i++) {
-            track_list_add(previous_tracks, &processor->output_tracks->tracks[i]);
-        }
-
-        // --- 新增：将结果推送至异步队列 ---
-        if (processor->config.target_queue) {
+        if (ret == 0) {
+            // 航迹时间戳统一为帧抓取时刻，便于融合按时间对齐
+            for (int i = 0; i < detections->count; i++) {
+                detections->tracks[i].timestamp = frame->capture_time;
+                detections->tracks[i].sensor_id = processor->config.camera_id;
+            }
+            video_stats_record(&processor->stats, VIDEO_STAGE_DETECT, &frame->capture_time);
+            
             mec_msg_t msg;
             msg.sensor_id = processor->config.camera_id;
-            msg.tracks = processor->output_tracks; // 队列内部会执行深拷贝
-            gettimeofday(&msg.timestamp, NULL);
-            mec_queue_push(processor->config.target_queue, &msg);
+            msg.tracks = detections;
+            msg.timestamp = frame->capture_time;
+            msg.frame_width = frame->width;
+            msg.frame_height = frame->height;
+            mec_queue_push(processor->detect_queue, &msg);
         }
-        
-        thread_unlock(&processor->thread_ctx);
-        
-        usleep(33333); // ~30 FPS
+        track_list_release(detections);
+        frame_ring_release(processor->frame_ring, frame);
     }
-    
-    track_list_release(previous_tracks);
-    cap.release();
     return NULL;
 }
 
-int detect_targets(const void *frame_data, int width, int height, track_list_t *tracks) {
-    // Simplified target detection - in practice would use deep learning models
-    // This is a placeholder implementation
-    
-    static int target_id = 0;
-    target_track_t track;
-    
-    // Generate some dummy detections for demonstration
-    for (int i = 0; i < 3; i++) {
-        track.id = target_id++;
-        track.type = TARGET_VEHICLE;
-        track.position.latitude = 0.3 + i * 0.2;  // Normalized coordinates
-        track.position.longitude = 0.4 + i * 0.1;
-        track.position.altitude = 0.0;
-        track.velocity = 10.0 + i * 5.0;
-        track.heading = 45.0 + i * 30.0;
-        track.confidence = 0.8 + i * 0.05;
-        track.sensor_id = 1; // Video sensor
-        gettimeofday(&track.timestamp, NULL);
-        
-        track_list_add(tracks, &track);
-    }
+/**
+ * @brief 后处理级：跟踪、像素 -> 站点 ENU 变换、推送目标队列
+ */
+void* video_publish_thread(void *arg) {
+    video_processor_t *processor = (video_processor_t*)arg;
+    if (!processor) return NULL;
     
-    return 0;
-}
-
-int track_targets(track_list_t *previous_tracks, track_list_t *current_tracks) {
-    // Simplified tracking - in practice would use Kalman filter or other algorithms
-    // This is a placeholder that just maintains track IDs
+    long published = 0;
     
-    for (int i = 0; i < current_tracks->count; i++) {
-        int matched = 0;
-        for (int j = 0; j < previous_tracks->count; j++) {
-            double dx = current_tracks->tracks[i].position.longitude - previous_tracks->tracks[j].position.longitude;
-            double dy = current_tracks->tracks[i].position.latitude - previous_tracks->tracks[j].position.latitude;
-            double distance = sqrt(dx*dx + dy*dy);
-            
-            if (distance < 0.1) { // Threshold for matching
-                current_tracks->tracks[i].id = previous_tracks->tracks[j].id;
-                matched = 1;
-                break;
-            }
+    while (processor->publish_ctx.running) {
+        mec_msg_t msg;
+        if (mec_queue_pop(processor->detect_queue, &msg, 100) != 0) continue;
+        track_list_t *tracks = msg.tracks;
+        
+        // 图像坐标下跟踪，写回稳定的航迹 ID
+        video_tracker_update(&processor->tracker, tracks, &msg.timestamp);
+        
+        // 标定变换整帧一次完成，持配置锁期间标定参数不会被替换；归一化坐标按该帧
+        // 实际解码尺寸换算像素（原生分辨率可能与配置不同，标定以原生像素为准）
+        pthread_mutex_lock(&processor->config_lock);
+        if (processor->transform.calibrated) {
+            undistort_fit_locked(processor, msg.frame_width, msg.frame_height);
+            transform_tracks_to_enu(&processor->transform, processor->undistort, tracks,
+                                    msg.frame_width, msg.frame_height);
+        }
+        pthread_mutex_unlock(&processor->config_lock);
+        
+        thread_lock(&processor->publish_ctx);
+        track_list_clear(processor->output_tracks);
+        for (int i = 0; i < tracks->count; i++) {
+            track_list_add(processor->output_tracks, &tracks->tracks[i]);
         }
+        thread_unlock(&processor->publish_ctx);
         
-        if (!matched) {
-            static int new_id = 1000;
-            current_tracks->tracks[i].id = new_id++;
+        if (processor->config.target_queue) {
+            mec_queue_push(processor->config.target_queue, &msg); // 引用计数，无需拷贝
+        }
+        video_stats_record(&processor->stats, VIDEO_STAGE_PUBLISH, &msg.timestamp);
+        track_list_release(tracks);
+        
+        struct timeval now;
+        mec_clock_wall(&now);
+        video_rate_feedback(&processor->rate, mec_timeval_elapsed_ms(&msg.timestamp, &now));
+        
+        if (++published % VIDEO_STATS_REPORT_FRAMES == 0) {
+            video_stats_report(&processor->stats, processor->config.camera_id);
         }
     }
     
-    return 0;
+    return NULL;
 }
 
 } // extern "C"
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "mec_video.h"
 #include "mec_logging.h"
+#include "mec_clock.h"
+#include "mec_geo.h"
 #include <time.h>
 
 /**
@@ -12,14 +14,28 @@
 video_processor_t* video_processor_create(const video_config_t *config) {
     if (!config) return NULL;
     
-    video_processor_t *processor = (video_processor_t*)mec_malloc(sizeof(video_processor_t));
+    video_processor_t *processor = (video_processor_t*)mec_calloc(1, sizeof(video_processor_t));
     if (!processor) return NULL;
     
     processor->config = *config;
     processor->transform.calibrated = 0;
     processor->region_count = 0;
+    pthread_mutex_init(&processor->config_lock, NULL);
     // 使用零拷贝引用计数模型
     processor->output_tracks = track_list_create(10);
+    // 相机管理器照常向帧缓冲环解码，Mock 只消费帧、不做检测
+    int width = config->width > 0 ? config->width : 1920;
+    int height = config->height > 0 ? config->height : 1080;
+    processor->frame_ring = frame_ring_create(VIDEO_RING_SLOTS, (size_t)width * height * 3);
+    if (!processor->output_tracks || !processor->frame_ring) {
+        track_list_release(processor->output_tracks);
+        frame_ring_destroy(processor->frame_ring);
+        pthread_mutex_destroy(&processor->config_lock);
+        mec_free(processor);
+        return NULL;
+    }
+    video_stats_init(&processor->stats);
+    video_rate_init(&processor->rate, config->latency_budget_ms, config->max_detect_interval_ms);
     
     LOG_INFO("MOCK Video: Created (No OpenCV dependency)");
     return processor;
@@ -28,13 +44,17 @@ video_processor_t* video_processor_create(const video_config_t *config) {
 void video_processor_destroy(video_processor_t *processor) {
     if (!processor) return;
     video_processor_stop(processor);
+    frame_ring_destroy(processor->frame_ring);
+    video_stats_destroy(&processor->stats);
+    video_rate_destroy(&processor->rate);
     track_list_release(processor->output_tracks);
+    pthread_mutex_destroy(&processor->config_lock);
     mec_free(processor);
 }
 
 int video_processor_start(video_processor_t *processor) {
     if (!processor) return -1;
-    if (thread_create(&processor->thread_ctx, video_processing_thread, processor) != 0) {
+    if (thread_create(&processor->publish_ctx, video_publish_thread, processor) != 0) {
         LOG_ERROR("MOCK Video: Thread start failed");
         return -1;
     }
@@ -42,7 +62,9 @@ int video_processor_start(video_processor_t *processor) {
 }
 
 void video_processor_stop(video_processor_t *processor) {
-    if (processor) thread_destroy(&processor->thread_ctx);
+    if (!processor) return;
+    frame_ring_close(processor->frame_ring);
+    thread_destroy(&processor->publish_ctx);
 }
 
 // 获取航迹列表
@@ -51,49 +73,72 @@ track_list_t* video_processor_get_tracks(video_processor_t *processor) {
 }
 
 /**
- * @brief Mock 视频处理线程：模拟每秒产生 10 帧检测数据
+ * @brief Mock 处理线程：每收到一帧产生一条检测数据，无帧时按 10Hz 产生
  */
-void* video_processing_thread(void *arg) {
+void* video_publish_thread(void *arg) {
     video_processor_t *proc = (video_processor_t*)arg;
     int target_id_seed = 1000;
 
-    while (proc->thread_ctx.running) {
-        thread_lock(&proc->thread_ctx);
-        
-        track_list_clear(proc->output_tracks);
+    while (proc->publish_ctx.running) {
+        video_frame_t *frame = frame_ring_acquire_read(proc->frame_ring, 100);
+        if (frame && video_rate_decide(&proc->rate, &frame->capture_time, 0) != VIDEO_RATE_PROCESS) {
+            frame_ring_release(proc->frame_ring, frame);
+            continue;
+        }
         
         // 模拟检测到一个匀速移动的目标
         target_track_t t;
+        memset(&t, 0, sizeof(t));
         t.id = target_id_seed;
+        t.sensor_id = proc->config.camera_id;
         t.type = TARGET_VEHICLE;
         t.position.latitude = 39.9087;
         t.position.longitude = 116.3975;
+        t.position.altitude = 0.0;
+        geo_wgs84_to_enu(geo_get_site(), &t.position, &t.local);
         t.velocity = 15.0;
         t.heading = 90.0;
         t.confidence = 0.95;
-        gettimeofday(&t.timestamp, NULL);
+        if (frame) {
+            t.timestamp = frame->capture_time;
+            frame_ring_release(proc->frame_ring, frame);
+        } else {
+            mec_clock_wall(&t.timestamp);
+        }
         
+        track_list_t *tracks = track_list_create(1);
+        if (!tracks) continue;
+        track_list_add(tracks, &t);
+
+        thread_lock(&proc->publish_ctx);
+        track_list_clear(proc->output_tracks);
         track_list_add(proc->output_tracks, &t);
+        thread_unlock(&proc->publish_ctx);
 
         // 如果设置了目标队列，自动推送
         if (proc->config.target_queue) {
             mec_msg_t msg;
             msg.sensor_id = proc->config.camera_id;
-            msg.tracks = proc->output_tracks; // 引用计数模型下只需传递指针
+            msg.tracks = tracks; // 引用计数模型下只需传递指针
             msg.timestamp = t.timestamp;
             mec_queue_push(proc->config.target_queue, &msg);
         }
-
-        thread_unlock(&proc->thread_ctx);
+        track_list_release(tracks);
         
-        usleep(100000); // 10Hz
+        struct timeval now;
+        mec_clock_wall(&now);
+        video_rate_feedback(&proc->rate, mec_timeval_elapsed_ms(&t.timestamp, &now));
     }
     return NULL;
 }
 
 // 屏蔽其他 OpenCV 相关的具体实现函数，仅保留符号定义
+int transform_image_to_enu(const perspective_transform_t *t, const image_coord_t *i, enu_coord_t *e) {
+    (void)t;
+    (void)i;
+    (void)e;
+    return 0;
+}
 int transform_image_to_wgs84(const perspective_transform_t *t, const image_coord_t *i, wgs84_coord_t *w) { return 0; }
-int detect_targets(const void *f, int w, int h, track_list_t *tr) { return 0; }
-int track_targets(track_list_t *p, track_list_t *c) { return 0; }
 int video_processor_set_transform(video_processor_t *p, const perspective_transform_t *t) { return 0; }
 int video_processor_add_region(video_processor_t *p, const detection_region_t *r) { return 0; }
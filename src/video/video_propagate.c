@@ -0,0 +1,153 @@
+#include "mec_video_propagate.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @file video_propagate.c
+ * @brief 关键帧检测结果的模板匹配传播
+ */
+
+#define SEARCH_DIM (PROPAGATE_TEMPLATE + 2 * PROPAGATE_SEARCH)
+
+static inline uint8_t gray_at(const video_frame_t *frame, int x, int y) {
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x >= frame->width) x = frame->width - 1;
+    if (y >= frame->height) y = frame->height - 1;
+    const uint8_t *p = frame->data + (size_t)y * frame->stride + (size_t)x * frame->channels;
+    if (frame->channels < 3) return p[0];
+    return (uint8_t)((p[0] + 2 * p[1] + p[2]) >> 2);   // BGR 近似亮度
+}
+
+// 从 (x0, y0) 起按 step 抽稀采样 dim x dim 个灰度点
+static void sample_block(const video_frame_t *frame, int x0, int y0, int step, int dim, uint8_t *out) {
+    for (int j = 0; j < dim; j++) {
+        int y = y0 + j * step;
+        for (int i = 0; i < dim; i++) {
+            out[j * dim + i] = gray_at(frame, x0 + i * step, y);
+        }
+    }
+}
+
+static uint32_t sad_template(const uint8_t *tmpl, const uint8_t *win, int win_stride) {
+#if defined(__SSE2__)
+    __m128i acc = _mm_setzero_si128();
+    for (int r = 0; r < PROPAGATE_TEMPLATE; r++) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(tmpl + r * PROPAGATE_TEMPLATE));
+        __m128i b = _mm_loadu_si128((const __m128i*)(win + r * win_stride));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(a, b));
+    }
+    return (uint32_t)(_mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+#else
+    uint32_t sum = 0;
+    for (int r = 0; r < PROPAGATE_TEMPLATE; r++) {
+        for (int c = 0; c < PROPAGATE_TEMPLATE; c++) {
+            int d = tmpl[r * PROPAGATE_TEMPLATE + c] - win[r * win_stride + c];
+            sum += (uint32_t)(d < 0 ? -d : d);
+        }
+    }
+    return sum;
+#endif
+}
+
+// 模板左上角：接地点正上方、水平居中的 patch x patch 区域
+static void template_origin(const frame_propagator_t *prop, const target_track_t *t, int *x0, int *y0) {
+    int cx = (int)lround(t->position.longitude * prop->frame_width);
+    int cy = (int)lround(t->position.latitude * prop->frame_height);
+    *x0 = cx - PROPAGATE_TEMPLATE * prop->step / 2;
+    *y0 = cy - PROPAGATE_TEMPLATE * prop->step;
+}
+
+void propagator_init(frame_propagator_t *prop, int patch_px, double min_score) {
+    if (!prop) return;
+    memset(prop, 0, sizeof(*prop));
+    prop->patch_px = patch_px > 0 ? patch_px : PROPAGATE_DEFAULT_PATCH;
+    prop->min_score = min_score > 0 ? min_score : PROPAGATE_DEFAULT_MIN_SCORE;
+}
+
+void propagator_reset(frame_propagator_t *prop, const video_frame_t *frame, const track_list_t *detections) {
+    if (!prop || !frame || !detections) return;
+
+    prop->frame_width = frame->width;
+    prop->frame_height = frame->height;
+    prop->step = prop->patch_px / PROPAGATE_TEMPLATE;
+    if (prop->step < 1) prop->step = 1;
+
+    prop->count = 0;
+    for (int i = 0; i < detections->count && prop->count < PROPAGATE_MAX_TARGETS; i++) {
+        propagate_target_t *pt = &prop->targets[prop->count++];
+        pt->track = detections->tracks[i];
+        pt->key_confidence = detections->tracks[i].confidence;
+
+        int x0, y0;
+        template_origin(prop, &pt->track, &x0, &y0);
+        sample_block(frame, x0, y0, prop->step, PROPAGATE_TEMPLATE, pt->tmpl);
+    }
+}
+
+int propagator_track(frame_propagator_t *prop, const video_frame_t *frame, track_list_t *output) {
+    if (!prop || !frame || !output) return -1;
+    if (prop->step == 0 || frame->width != prop->frame_width || frame->height != prop->frame_height) return -1;
+
+    uint8_t window[SEARCH_DIM * SEARCH_DIM];
+    int step = prop->step;
+    int ok = 1;
+
+    for (int i = 0; i < prop->count; i++) {
+        propagate_target_t *pt = &prop->targets[i];
+        int x0, y0;
+        template_origin(prop, &pt->track, &x0, &y0);
+        sample_block(frame, x0 - PROPAGATE_SEARCH * step, y0 - PROPAGATE_SEARCH * step, step, SEARCH_DIM, window);
+
+        // 从零位移开始，相同 SAD 时保留位移更小的解
+        uint32_t best = sad_template(pt->tmpl, window + PROPAGATE_SEARCH * SEARCH_DIM + PROPAGATE_SEARCH, SEARCH_DIM);
+        int best_dx = 0, best_dy = 0;
+        for (int oy = 0; oy <= 2 * PROPAGATE_SEARCH; oy++) {
+            for (int ox = 0; ox <= 2 * PROPAGATE_SEARCH; ox++) {
+                uint32_t sad = sad_template(pt->tmpl, window + oy * SEARCH_DIM + ox, SEARCH_DIM);
+                if (sad < best) {
+                    best = sad;
+                    best_dx = ox - PROPAGATE_SEARCH;
+                    best_dy = oy - PROPAGATE_SEARCH;
+                }
+            }
+        }
+
+        // 最佳位置落在搜索窗边缘：真实位移可能超出窗口
+        int at_edge = abs(best_dx) == PROPAGATE_SEARCH || abs(best_dy) == PROPAGATE_SEARCH;
+
+        // 粗搜索只到采样步长精度，再在 ±(step-1) 像素内逐像素细化
+        int shift_x = best_dx * step, shift_y = best_dy * step;
+        if (step > 1) {
+            uint8_t patch[PROPAGATE_TEMPLATE * PROPAGATE_TEMPLATE];
+            int base_x = shift_x, base_y = shift_y;
+            for (int fy = -(step - 1); fy <= step - 1; fy++) {
+                for (int fx = -(step - 1); fx <= step - 1; fx++) {
+                    if (fx == 0 && fy == 0) continue;
+                    sample_block(frame, x0 + base_x + fx, y0 + base_y + fy, step, PROPAGATE_TEMPLATE, patch);
+                    uint32_t sad = sad_template(pt->tmpl, patch, PROPAGATE_TEMPLATE);
+                    if (sad < best) {
+                        best = sad;
+                        shift_x = base_x + fx;
+                        shift_y = base_y + fy;
+                    }
+                }
+            }
+        }
+
+        double mad = (double)best / (PROPAGATE_TEMPLATE * PROPAGATE_TEMPLATE);
+        double score = 1.0 - mad / PROPAGATE_MAD_LIMIT;
+        if (score < 0.0 || at_edge) score = 0.0;
+        if (score < prop->min_score) ok = 0;
+
+        double x = pt->track.position.longitude + (double)shift_x / prop->frame_width;
+        double y = pt->track.position.latitude + (double)shift_y / prop->frame_height;
+        pt->track.position.longitude = x < 0.0 ? 0.0 : (x > 1.0 ? 1.0 : x);
+        pt->track.position.latitude = y < 0.0 ? 0.0 : (y > 1.0 ? 1.0 : y);
+        pt->track.confidence = pt->key_confidence * score;
+        track_list_add(output, &pt->track);
+    }
+    return ok ? 0 : -1;
+}
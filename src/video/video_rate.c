@@ -0,0 +1,121 @@
+#include "mec_video_rate.h"
+#include "mec_clock.h"
+
+/**
+ * @file video_rate.c
+ * @brief 检测帧率自适应控制实现
+ */
+
+#define VIDEO_RATE_COOLDOWN 3   // 两次放大之间至少等待的反馈帧数，让新间隔先生效
+
+
+// 调用方持锁
+static void rate_backoff(video_rate_controller_t *rc) {
+    double next = rc->interval_ms * VIDEO_RATE_BACKOFF;
+    if (next < rc->detect_ms) next = rc->detect_ms;   // 首次放大：至少一个检测耗时
+    if (next < 1.0) next = 1.0;
+    if (next > rc->max_interval_ms) next = rc->max_interval_ms;
+    rc->interval_ms = next;
+    rc->cooldown = VIDEO_RATE_COOLDOWN;
+    rc->backoffs++;
+}
+
+void video_rate_init(video_rate_controller_t *rc, int budget_ms, int max_interval_ms) {
+    if (!rc) return;
+    memset(rc, 0, sizeof(*rc));
+    rc->budget_ms = budget_ms > 0 ? budget_ms : VIDEO_RATE_DEFAULT_BUDGET_MS;
+    rc->max_interval_ms = max_interval_ms > 0 ? max_interval_ms : VIDEO_RATE_DEFAULT_MAX_INTERVAL_MS;
+    pthread_mutex_init(&rc->lock, NULL);
+}
+
+void video_rate_destroy(video_rate_controller_t *rc) {
+    if (!rc) return;
+    pthread_mutex_destroy(&rc->lock);
+}
+
+video_rate_decision_t video_rate_decide(video_rate_controller_t *rc, const struct timeval *capture_time,
+                                        int queue_depth) {
+    if (!rc || !capture_time) return VIDEO_RATE_PROCESS;
+
+    struct timeval now;
+    mec_clock_wall(&now);
+    video_rate_decision_t decision = VIDEO_RATE_PROCESS;
+
+    pthread_mutex_lock(&rc->lock);
+    // 距上一个检测帧已超过间隔上限时无条件处理，保证最低检测频率
+    double since_last = rc->has_processed ? mec_timeval_elapsed_ms(&rc->last_processed, capture_time) : rc->max_interval_ms;
+    if (since_last < rc->max_interval_ms) {
+        if (queue_depth >= VIDEO_RATE_QUEUE_HIGH) {
+            // 后处理跟不上：不再往队列里加帧，并立即降低检测频率
+            if (rc->cooldown == 0) rate_backoff(rc);
+            decision = VIDEO_RATE_SKIP_RATE;
+        } else if (rc->detect_ms < rc->budget_ms &&
+                   mec_timeval_elapsed_ms(capture_time, &now) + rc->detect_ms > rc->budget_ms) {
+            // 等下一帧还来得及；检测本身已超预算时丢帧无济于事，交给限速处理
+            decision = VIDEO_RATE_SKIP_STALE;
+        } else if (since_last < rc->interval_ms) {
+            decision = VIDEO_RATE_SKIP_RATE;
+        }
+    }
+
+    if (decision == VIDEO_RATE_PROCESS) {
+        rc->last_processed = *capture_time;
+        rc->has_processed = 1;
+        rc->frames_processed++;
+    } else if (decision == VIDEO_RATE_SKIP_STALE) {
+        rc->frames_skipped_stale++;
+    } else {
+        rc->frames_skipped_rate++;
+    }
+    pthread_mutex_unlock(&rc->lock);
+    return decision;
+}
+
+void video_rate_record_detect(video_rate_controller_t *rc, double detect_ms) {
+    if (!rc) return;
+
+    pthread_mutex_lock(&rc->lock);
+    if (!rc->has_detect) {
+        rc->detect_ms = detect_ms;
+        rc->has_detect = 1;
+    } else {
+        rc->detect_ms += VIDEO_RATE_EWMA_ALPHA * (detect_ms - rc->detect_ms);
+    }
+    pthread_mutex_unlock(&rc->lock);
+}
+
+void video_rate_feedback(video_rate_controller_t *rc, double latency_ms) {
+    if (!rc) return;
+
+    pthread_mutex_lock(&rc->lock);
+    if (!rc->has_latency) {
+        rc->latency_ms = latency_ms;
+        rc->has_latency = 1;
+    } else {
+        rc->latency_ms += VIDEO_RATE_EWMA_ALPHA * (latency_ms - rc->latency_ms);
+    }
+
+    if (rc->cooldown > 0) rc->cooldown--;
+    if (rc->latency_ms > rc->budget_ms) {
+        if (rc->cooldown == 0) rate_backoff(rc);
+    } else if (rc->latency_ms < rc->budget_ms * VIDEO_RATE_RECOVER_RATIO && rc->interval_ms > 0.0) {
+        rc->interval_ms *= VIDEO_RATE_RECOVER_FACTOR;
+        if (rc->interval_ms < VIDEO_RATE_RECOVER_FLOOR_MS) rc->interval_ms = 0.0;
+    }
+    pthread_mutex_unlock(&rc->lock);
+}
+
+void video_rate_get_metrics(video_rate_controller_t *rc, video_rate_metrics_t *metrics) {
+    if (!rc || !metrics) return;
+
+    pthread_mutex_lock(&rc->lock);
+    metrics->interval_ms = rc->interval_ms;
+    metrics->latency_ms = rc->latency_ms;
+    metrics->detect_ms = rc->detect_ms;
+    metrics->budget_ms = rc->budget_ms;
+    metrics->frames_processed = rc->frames_processed;
+    metrics->frames_skipped_stale = rc->frames_skipped_stale;
+    metrics->frames_skipped_rate = rc->frames_skipped_rate;
+    metrics->backoffs = rc->backoffs;
+    pthread_mutex_unlock(&rc->lock);
+}
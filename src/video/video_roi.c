@@ -0,0 +1,152 @@
+#include "mec_video_roi.h"
+#include "mec_logging.h"
+
+/**
+ * @file video_roi.c
+ * @brief 多边形区域光栅化与检测过滤
+ */
+
+void roi_set_init(roi_set_t *set, int frame_width, int frame_height) {
+    if (!set) return;
+    memset(set, 0, sizeof(*set));
+    set->frame_width = frame_width;
+    set->frame_height = frame_height;
+}
+
+void roi_set_clear(roi_set_t *set) {
+    if (!set) return;
+    for (int i = 0; i < set->mask_count; i++) {
+        free(set->masks[i].bits);
+    }
+    roi_set_init(set, set->frame_width, set->frame_height);
+}
+
+static int rect_overlaps(const roi_rect_t *a, const roi_rect_t *b) {
+    return a->x < b->x + b->width && b->x < a->x + a->width &&
+           a->y < b->y + b->height && b->y < a->y + a->height;
+}
+
+static void rect_merge(roi_rect_t *a, const roi_rect_t *b) {
+    int x1 = a->x + a->width > b->x + b->width ? a->x + a->width : b->x + b->width;
+    int y1 = a->y + a->height > b->y + b->height ? a->y + a->height : b->y + b->height;
+    a->x = a->x < b->x ? a->x : b->x;
+    a->y = a->y < b->y ? a->y : b->y;
+    a->width = x1 - a->x;
+    a->height = y1 - a->y;
+}
+
+// 由各区域外接矩形重新生成裁剪窗口：重叠的矩形合并，避免同一目标被检测两次
+static void roi_rebuild_crops(roi_set_t *set) {
+    set->crop_count = 0;
+    for (int i = 0; i < set->mask_count; i++) {
+        set->crops[set->crop_count++] = set->masks[i].bbox;
+    }
+
+    int merged = 1;
+    while (merged) {
+        merged = 0;
+        for (int i = 0; i < set->crop_count && !merged; i++) {
+            for (int j = i + 1; j < set->crop_count; j++) {
+                if (rect_overlaps(&set->crops[i], &set->crops[j])) {
+                    rect_merge(&set->crops[i], &set->crops[j]);
+                    set->crops[j] = set->crops[--set->crop_count];
+                    merged = 1;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+static int compare_double(const void *a, const void *b) {
+    double da = *(const double*)a, db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+int roi_set_add_polygon(roi_set_t *set, const image_coord_t *points, int point_count) {
+    if (!set || !points || point_count < 3 || point_count > 10) return -1;
+    if (set->mask_count >= VIDEO_MAX_REGIONS) return -1;
+
+    // 外接矩形（裁剪到画面内）
+    int x0 = points[0].x, y0 = points[0].y, x1 = points[0].x, y1 = points[0].y;
+    for (int i = 1; i < point_count; i++) {
+        if (points[i].x < x0) x0 = points[i].x;
+        if (points[i].x > x1) x1 = points[i].x;
+        if (points[i].y < y0) y0 = points[i].y;
+        if (points[i].y > y1) y1 = points[i].y;
+    }
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > set->frame_width - 1) x1 = set->frame_width - 1;
+    if (y1 > set->frame_height - 1) y1 = set->frame_height - 1;
+    if (x1 < x0 || y1 < y0) return -1;
+
+    roi_mask_t *m = &set->masks[set->mask_count];
+    m->bbox.x = x0;
+    m->bbox.y = y0;
+    m->bbox.width = x1 - x0 + 1;
+    m->bbox.height = y1 - y0 + 1;
+    m->row_bytes = (m->bbox.width + 7) / 8;
+    m->bits = calloc((size_t)m->row_bytes * m->bbox.height, 1);
+    if (!m->bits) return -1;
+
+    // 扫描线填充（奇偶规则），在像素中心处采样
+    double xs[10];
+    for (int row = 0; row < m->bbox.height; row++) {
+        double sy = y0 + row + 0.5;
+        int n = 0;
+        for (int i = 0, j = point_count - 1; i < point_count; j = i++) {
+            double ay = points[j].y, by = points[i].y;
+            if ((ay <= sy) == (by <= sy)) continue;
+            double ax = points[j].x, bx = points[i].x;
+            xs[n++] = ax + (sy - ay) * (bx - ax) / (by - ay);
+        }
+        qsort(xs, n, sizeof(double), compare_double);
+
+        uint8_t *line = m->bits + (size_t)row * m->row_bytes;
+        for (int k = 0; k + 1 < n; k += 2) {
+            // 覆盖像素中心 x + 0.5 落在 [xs[k], xs[k+1]) 内的像素
+            int from = (int)ceil(xs[k] - 0.5) - x0;
+            int to = (int)ceil(xs[k + 1] - 0.5) - x0;
+            if (from < 0) from = 0;
+            if (to > m->bbox.width) to = m->bbox.width;
+            for (int px = from; px < to; px++) {
+                line[px >> 3] |= (uint8_t)(1u << (px & 7));
+            }
+        }
+    }
+
+    set->mask_count++;
+    roi_rebuild_crops(set);
+    LOG_INFO("Video: ROI %d rasterized (bbox %dx%d at %d,%d, crop coverage %.1f%%)",
+             set->mask_count, m->bbox.width, m->bbox.height, m->bbox.x, m->bbox.y,
+             roi_set_coverage(set) * 100.0);
+    return 0;
+}
+
+int roi_filter_tracks(const roi_set_t *set, track_list_t *tracks) {
+    if (!set || !tracks || set->mask_count == 0) return 0;
+
+    int kept = 0;
+    for (int i = 0; i < tracks->count; i++) {
+        const target_track_t *t = &tracks->tracks[i];
+        int x = (int)(t->position.longitude * set->frame_width);
+        int y = (int)(t->position.latitude * set->frame_height);
+        if (!roi_set_contains(set, x, y)) continue;
+        if (kept != i) tracks->tracks[kept] = tracks->tracks[i];
+        kept++;
+    }
+
+    int removed = tracks->count - kept;
+    tracks->count = kept;
+    return removed;
+}
+
+double roi_set_coverage(const roi_set_t *set) {
+    if (!set || set->mask_count == 0 || set->frame_width <= 0 || set->frame_height <= 0) return 1.0;
+    long area = 0;
+    for (int i = 0; i < set->crop_count; i++) {
+        area += (long)set->crops[i].width * set->crops[i].height;
+    }
+    return (double)area / ((double)set->frame_width * set->frame_height);
+}
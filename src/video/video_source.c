@@ -0,0 +1,94 @@
+#include "mec_video_source.h"
+#include "mec_logging.h"
+
+/**
+ * @file video_source.c
+ * @brief 视频源分发与合成测试源
+ */
+
+#define TEST_SOURCE_BLOCK 64    // 测试图案中移动方块的边长 (像素)
+
+typedef struct {
+    video_source_t base;
+    int width;
+    int height;
+    uint64_t frame_index;
+} test_source_t;
+
+/**
+ * @brief 灰色背景上一个水平往返移动的白色方块，每帧整体重画（槽位内容不保留）
+ */
+static int test_source_read(video_source_t *src, video_frame_t *frame) {
+    test_source_t *ts = (test_source_t*)src;
+    int stride = ts->width * 3;
+    size_t bytes = (size_t)stride * ts->height;
+    if (bytes > frame->capacity) return -1;
+
+    // 槽位是循环复用的，内容不确定，每帧整体重画背景
+    memset(frame->data, 96, bytes);
+
+    int span = ts->width - TEST_SOURCE_BLOCK;
+    int pos = span > 0 ? (int)(ts->frame_index % (uint64_t)(2 * span)) : 0;
+    if (pos > span) pos = 2 * span - pos;
+    int top = (ts->height - TEST_SOURCE_BLOCK) / 2;
+    for (int y = 0; y < TEST_SOURCE_BLOCK && top + y < ts->height; y++) {
+        if (top + y < 0) continue;
+        uint8_t *row = frame->data + (size_t)(top + y) * stride + (size_t)pos * 3;
+        memset(row, 255, (size_t)(ts->width - pos < TEST_SOURCE_BLOCK ? ts->width - pos : TEST_SOURCE_BLOCK) * 3);
+    }
+
+    frame->width = ts->width;
+    frame->height = ts->height;
+    frame->channels = 3;
+    frame->stride = stride;
+    ts->frame_index++;
+    return 0;
+}
+
+static int test_source_skip(video_source_t *src) {
+    ((test_source_t*)src)->frame_index++;
+    return 0;
+}
+
+static void test_source_close(video_source_t *src) {
+    mec_free(src);
+}
+
+static const video_source_ops_t test_source_ops = {
+    "test",
+    test_source_read,
+    test_source_skip,
+    test_source_close
+};
+
+static video_source_t* test_source_open(const char *spec, int width, int height) {
+    int w = width, h = height;
+    if (spec && *spec) sscanf(spec, "%dx%d", &w, &h);
+    if (w <= 0 || h <= 0) {
+        w = 1280;
+        h = 720;
+    }
+
+    test_source_t *ts = mec_calloc(1, sizeof(test_source_t));
+    if (!ts) return NULL;
+    ts->base.ops = &test_source_ops;
+    ts->base.live = 0;
+    ts->base.native_fps = 0.0;
+    ts->width = w;
+    ts->height = h;
+    return &ts->base;
+}
+
+video_source_t* video_source_open(const char *url, int width, int height) {
+    if (!url || !*url) return NULL;
+
+    if (strncmp(url, "test://", 7) == 0) {
+        return test_source_open(url + 7, width, height);
+    }
+#ifdef MEC_WITH_OPENCV
+    return video_source_opencv_open(url);
+#else
+    LOG_ERROR("Video source %s requires OpenCV (build with -DMEC_WITH_OPENCV=ON)", url);
+    return NULL;
+#endif
+}
@@ -0,0 +1,88 @@
+extern "C" {
+#include "mec_video_source.h"
+#include "mec_logging.h"
+}
+#include <opencv2/opencv.hpp>
+#include <new>
+
+/**
+ * @file video_source_opencv.cpp
+ * @brief 基于 cv::VideoCapture 的视频源（RTSP、本地视频文件）
+ */
+
+namespace {
+
+struct opencv_source {
+    video_source_t base;    // 必须为第一个成员
+    cv::VideoCapture cap;
+    cv::Mat decoded;        // 尺寸与槽位不符时的中转缓冲（复用）
+};
+
+int opencv_source_read(video_source_t *src, video_frame_t *frame) {
+    opencv_source *cs = reinterpret_cast<opencv_source*>(src);
+    if (!cs->cap.grab()) return -1;
+
+    // 先尝试直接解码进槽位；分辨率未知时用上一帧的尺寸
+    int rows = frame->height > 0 ? frame->height : cs->decoded.rows;
+    int cols = frame->width > 0 ? frame->width : cs->decoded.cols;
+    if (rows > 0 && cols > 0 && (size_t)rows * cols * 3 <= frame->capacity) {
+        cv::Mat target(rows, cols, CV_8UC3, frame->data);
+        if (!cs->cap.retrieve(target)) return -1;
+        if (target.data == frame->data) {
+            frame->width = cols;
+            frame->height = rows;
+            frame->channels = 3;
+            frame->stride = cols * 3;
+            return 0;
+        }
+        cs->decoded = target;   // 解码器另行分配了内存：尺寸与猜测不符
+    } else if (!cs->cap.retrieve(cs->decoded)) {
+        return -1;
+    }
+
+    size_t bytes = cs->decoded.total() * cs->decoded.elemSize();
+    if (!cs->decoded.isContinuous() || bytes > frame->capacity) {
+        LOG_WARN("Video source: Frame %dx%d exceeds preallocated buffer", cs->decoded.cols, cs->decoded.rows);
+        return -1;
+    }
+    memcpy(frame->data, cs->decoded.data, bytes);
+    frame->width = cs->decoded.cols;
+    frame->height = cs->decoded.rows;
+    frame->channels = cs->decoded.channels();
+    frame->stride = cs->decoded.cols * cs->decoded.channels();
+    return 0;
+}
+
+int opencv_source_skip(video_source_t *src) {
+    opencv_source *cs = reinterpret_cast<opencv_source*>(src);
+    return cs->cap.grab() ? 0 : -1;
+}
+
+void opencv_source_close(video_source_t *src) {
+    opencv_source *cs = reinterpret_cast<opencv_source*>(src);
+    cs->cap.release();
+    delete cs;
+}
+
+const video_source_ops_t opencv_source_ops = {
+    "opencv",
+    opencv_source_read,
+    opencv_source_skip,
+    opencv_source_close
+};
+
+} // namespace
+
+extern "C" video_source_t* video_source_opencv_open(const char *url) {
+    opencv_source *cs = new (std::nothrow) opencv_source();
+    if (!cs) return NULL;
+
+    if (!cs->cap.open(url)) {
+        delete cs;
+        return NULL;
+    }
+    cs->base.ops = &opencv_source_ops;
+    cs->base.live = strstr(url, "://") != NULL && strncmp(url, "file://", 7) != 0;
+    cs->base.native_fps = cs->cap.get(cv::CAP_PROP_FPS);
+    return &cs->base;
+}
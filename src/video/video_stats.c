@@ -0,0 +1,58 @@
+#include "mec_video.h"
+#include "mec_logging.h"
+#include "mec_clock.h"
+
+/**
+ * @file video_stats.c
+ * @brief 视频流水线分级时延统计
+ */
+
+static const char *stage_names[VIDEO_STAGE_COUNT] = { "decode", "detect", "publish" };
+
+void video_stats_init(video_pipeline_stats_t *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    pthread_mutex_init(&stats->lock, NULL);
+}
+
+void video_stats_destroy(video_pipeline_stats_t *stats) {
+    if (!stats) return;
+    pthread_mutex_destroy(&stats->lock);
+}
+
+void video_stats_record(video_pipeline_stats_t *stats, video_stage_t stage, const struct timeval *capture_time) {
+    if (!stats || !capture_time || stage < 0 || stage >= VIDEO_STAGE_COUNT) return;
+
+    struct timeval now;
+    mec_clock_wall(&now);
+    double ms = mec_timeval_elapsed_ms(capture_time, &now);
+
+    pthread_mutex_lock(&stats->lock);
+    video_stage_stat_t *s = &stats->stages[stage];
+    s->frames++;
+    s->total_ms += ms;
+    if (ms > s->max_ms) s->max_ms = ms;
+    pthread_mutex_unlock(&stats->lock);
+}
+
+void video_stats_report(video_pipeline_stats_t *stats, int camera_id) {
+    if (!stats) return;
+
+    pthread_mutex_lock(&stats->lock);
+    char line[256];
+    int len = 0;
+    for (int i = 0; i < VIDEO_STAGE_COUNT && len < (int)sizeof(line); i++) {
+        const video_stage_stat_t *s = &stats->stages[i];
+        len += snprintf(line + len, sizeof(line) - len, " | %s avg %.1f max %.1f ms",
+                        stage_names[i], s->frames ? s->total_ms / s->frames : 0.0, s->max_ms);
+    }
+    LOG_INFO("Camera %d pipeline: decoded %ld, dropped %ld, keyframes %ld, propagated %ld, redetects %ld, "
+             "static %ld, partial %ld%s",
+             camera_id, stats->frames_decoded, stats->frames_dropped, stats->keyframes,
+             stats->frames_propagated, stats->early_redetects, stats->frames_static,
+             stats->frames_partial, line);
+
+    // 峰值按报告周期统计
+    for (int i = 0; i < VIDEO_STAGE_COUNT; i++) stats->stages[i].max_ms = 0.0;
+    pthread_mutex_unlock(&stats->lock);
+}
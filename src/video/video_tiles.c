@@ -0,0 +1,183 @@
+#include "mec_video_tiles.h"
+
+/**
+ * @file video_tiles.c
+ * @brief 切块布局与跨块检测合并
+ */
+
+#define TILE_MASK_SAMPLE_PX 16   // 判断块内是否有 ROI 像素时的采样间隔
+#define MERGE_BUCKETS 256        // 合并用网格哈希桶数 (2 的幂)
+
+// 块内是否至少有一个 ROI 掩码像素（按采样间隔检查）
+static int tile_has_roi(const roi_set_t *roi, const roi_rect_t *tile) {
+    if (!roi || roi->mask_count == 0) return 1;
+    for (int y = tile->y; y < tile->y + tile->height; y += TILE_MASK_SAMPLE_PX) {
+        for (int x = tile->x; x < tile->x + tile->width; x += TILE_MASK_SAMPLE_PX) {
+            if (roi_set_contains(roi, x, y)) return 1;
+        }
+    }
+    return 0;
+}
+
+// 沿一个方向均匀排布：首尾两块贴边，中间按相同步长分布；超过 max_pos 块返回 -1
+static int tile_positions(int start, int length, int tile, int overlap, int *pos, int max_pos) {
+    if (length <= tile) {
+        pos[0] = start;
+        return 1;
+    }
+    int n = (length - overlap + (tile - overlap) - 1) / (tile - overlap);
+    if (n < 2) n = 2;
+    if (n > max_pos) return -1;
+    for (int i = 0; i < n; i++) {
+        pos[i] = start + (int)((long)i * (length - tile) / (n - 1));
+    }
+    return n;
+}
+
+// 按给定块边长切一遍；块数超过 max_tiles 时返回 -1
+static int layout_pass(const roi_rect_t *areas, int area_count, const roi_set_t *roi,
+                       int tile_size, int overlap, roi_rect_t *tiles, int max_tiles) {
+    if (overlap < 0) overlap = 0;
+    if (overlap > tile_size / 2) overlap = tile_size / 2;   // 保证步长至少半块
+
+    int count = 0;
+    for (int a = 0; a < area_count; a++) {
+        const roi_rect_t *area = &areas[a];
+        if (area->width <= tile_size && area->height <= tile_size) {
+            if (count >= max_tiles) return -1;
+            tiles[count++] = *area;
+            continue;
+        }
+
+        int xs[VIDEO_MAX_TILES], ys[VIDEO_MAX_TILES];
+        int nx = tile_positions(area->x, area->width, tile_size, overlap, xs, VIDEO_MAX_TILES);
+        int ny = tile_positions(area->y, area->height, tile_size, overlap, ys, VIDEO_MAX_TILES);
+        if (nx < 0 || ny < 0) return -1;
+        int tw = area->width < tile_size ? area->width : tile_size;
+        int th = area->height < tile_size ? area->height : tile_size;
+
+        for (int j = 0; j < ny; j++) {
+            for (int i = 0; i < nx; i++) {
+                roi_rect_t t = { xs[i], ys[j], tw, th };
+                if (!tile_has_roi(roi, &t)) continue;
+                if (count >= max_tiles) return -1;
+                tiles[count++] = t;
+            }
+        }
+    }
+    return count;
+}
+
+int video_tiles_layout(const roi_rect_t *areas, int area_count, const roi_set_t *roi,
+                       int tile_size, int overlap, roi_rect_t *tiles, int max_tiles, int *tile_used) {
+    if (tile_used) *tile_used = tile_size;
+    if (!areas || !tiles || max_tiles <= 0) return 0;
+
+    if (tile_size > 0) {
+        int largest = 0;
+        for (int a = 0; a < area_count; a++) {
+            if (areas[a].width > largest) largest = areas[a].width;
+            if (areas[a].height > largest) largest = areas[a].height;
+        }
+        // 块数超限时逐步放大块边长，直到整幅区域都能覆盖；大到不必切块时按原样输出
+        int size = tile_size;
+        for (; size < largest; size += size / 4 + 1) {
+            int count = layout_pass(areas, area_count, roi, size, overlap, tiles, max_tiles);
+            if (count >= 0) {
+                if (tile_used) *tile_used = size;
+                return count;
+            }
+        }
+        if (tile_used && size != tile_size) *tile_used = 0;
+    }
+
+    int count = area_count < max_tiles ? area_count : max_tiles;
+    for (int a = 0; a < count; a++) tiles[a] = areas[a];
+    return count;
+}
+
+typedef struct {
+    double confidence;
+    int index;
+} merge_order_t;
+
+static int compare_confidence_desc(const void *a, const void *b) {
+    const merge_order_t *x = (const merge_order_t*)a;
+    const merge_order_t *y = (const merge_order_t*)b;
+    if (x->confidence != y->confidence) return x->confidence < y->confidence ? 1 : -1;
+    return x->index - y->index;
+}
+
+static inline unsigned merge_bucket(int cx, int cy) {
+    return ((unsigned)cx * 73856093u ^ (unsigned)cy * 19349663u) & (MERGE_BUCKETS - 1);
+}
+
+int video_tiles_merge(track_list_t *tracks, double radius_px, int width, int height) {
+    if (!tracks || tracks->count < 2 || radius_px <= 0.0 || width <= 0 || height <= 0) return 0;
+
+    int n = tracks->count;
+    merge_order_t *order = malloc((size_t)n * sizeof(merge_order_t));
+    int *next = malloc((size_t)n * sizeof(int));
+    uint8_t *keep = calloc((size_t)n, 1);
+    if (!order || !next || !keep) {
+        free(order);
+        free(next);
+        free(keep);
+        return 0;
+    }
+
+    for (int i = 0; i < n; i++) {
+        order[i].confidence = tracks->tracks[i].confidence;
+        order[i].index = i;
+    }
+    qsort(order, (size_t)n, sizeof(merge_order_t), compare_confidence_desc);
+
+    // 网格边长等于合并半径：候选点只需与相邻 3x3 格中已保留的目标比较
+    int heads[MERGE_BUCKETS];
+    for (int b = 0; b < MERGE_BUCKETS; b++) heads[b] = -1;
+    double r2 = radius_px * radius_px;
+
+    for (int k = 0; k < n; k++) {
+        int i = order[k].index;
+        const target_track_t *t = &tracks->tracks[i];
+        double px = t->position.longitude * width;
+        double py = t->position.latitude * height;
+        int cx = (int)floor(px / radius_px);
+        int cy = (int)floor(py / radius_px);
+
+        int duplicate = 0;
+        for (int dy = -1; dy <= 1 && !duplicate; dy++) {
+            for (int dx = -1; dx <= 1 && !duplicate; dx++) {
+                for (int j = heads[merge_bucket(cx + dx, cy + dy)]; j >= 0; j = next[j]) {
+                    const target_track_t *kept = &tracks->tracks[j];
+                    if (kept->type != t->type) continue;
+                    double ex = kept->position.longitude * width - px;
+                    double ey = kept->position.latitude * height - py;
+                    if (ex * ex + ey * ey <= r2) {
+                        duplicate = 1;
+                        break;
+                    }
+                }
+            }
+        }
+        if (duplicate) continue;
+
+        keep[i] = 1;
+        unsigned b = merge_bucket(cx, cy);
+        next[i] = heads[b];
+        heads[b] = i;
+    }
+
+    // 按原顺序压缩
+    int out = 0;
+    for (int i = 0; i < n; i++) {
+        if (keep[i]) tracks->tracks[out++] = tracks->tracks[i];
+    }
+    int merged = n - out;
+    tracks->count = out;
+
+    free(order);
+    free(next);
+    free(keep);
+    return merged;
+}
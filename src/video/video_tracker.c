@@ -0,0 +1,153 @@
+#include "mec_video_tracker.h"
+#include "mec_logging.h"
+#include "mec_clock.h"
+
+/**
+ * @file video_tracker.c
+ * @brief 网格索引 + 匀速预测的单相机跟踪器实现
+ */
+
+#define TRACKER_MAX_PAIRS (VIDEO_TRACKER_MAX_TRACKS * 8)
+#define TRACKER_VELOCITY_GAIN 0.5   // 速度平滑系数
+
+typedef struct {
+    double dist_sq;
+    int det;
+    int track;
+} tracker_pair_t;
+
+void video_tracker_init(video_tracker_t *tracker, int camera_id, double gate, int max_misses) {
+    if (!tracker) return;
+    memset(tracker, 0, sizeof(*tracker));
+    tracker->id_base = camera_id * VIDEO_TRACKER_ID_SPAN;
+    tracker->gate = gate > 0.0 ? gate : VIDEO_TRACKER_DEFAULT_GATE;
+    tracker->max_misses = max_misses > 0 ? max_misses : VIDEO_TRACKER_DEFAULT_MAX_MISSES;
+
+    // 网格边长不小于门限，保证 3x3 邻域覆盖全部候选
+    int dim = (int)(1.0 / tracker->gate);
+    if (dim < 1) dim = 1;
+    if (dim > VIDEO_TRACKER_MAX_GRID) dim = VIDEO_TRACKER_MAX_GRID;
+    tracker->grid_dim = dim;
+}
+
+static inline int grid_coord(const video_tracker_t *tracker, double v) {
+    int c = (int)(v * tracker->grid_dim);
+    if (c < 0) return 0;
+    if (c >= tracker->grid_dim) return tracker->grid_dim - 1;
+    return c;
+}
+
+static int compare_pair(const void *a, const void *b) {
+    double da = ((const tracker_pair_t*)a)->dist_sq;
+    double db = ((const tracker_pair_t*)b)->dist_sq;
+    return (da > db) - (da < db);
+}
+
+int video_tracker_update(video_tracker_t *tracker, track_list_t *detections, const struct timeval *timestamp) {
+    if (!tracker || !detections || !timestamp) return -1;
+
+    double dt = 0.0;
+    if (tracker->has_time) {
+        dt = mec_timeval_elapsed_ms(&tracker->last_time, timestamp) / 1000.0;
+        if (dt < 0.0) dt = 0.0;
+    }
+    tracker->last_time = *timestamp;
+    tracker->has_time = 1;
+
+    // 1. 匀速外推并重建网格索引
+    int dim = tracker->grid_dim;
+    for (int c = 0; c < dim * dim; c++) tracker->cell_head[c] = -1;
+    for (int i = 0; i < tracker->count; i++) {
+        video_track_state_t *t = &tracker->tracks[i];
+        t->px = t->x + t->vx * dt;
+        t->py = t->y + t->vy * dt;
+        int cell = grid_coord(tracker, t->py) * dim + grid_coord(tracker, t->px);
+        tracker->cell_next[i] = tracker->cell_head[cell];
+        tracker->cell_head[cell] = (int16_t)i;
+    }
+
+    // 2. 只在相邻网格内收集门限内的候选对
+    tracker_pair_t pairs[TRACKER_MAX_PAIRS];
+    int pair_count = 0;
+    double gate_sq = tracker->gate * tracker->gate;
+
+    for (int d = 0; d < detections->count; d++) {
+        double x = detections->tracks[d].position.longitude;
+        double y = detections->tracks[d].position.latitude;
+        int gx = grid_coord(tracker, x);
+        int gy = grid_coord(tracker, y);
+
+        for (int cy = gy - 1; cy <= gy + 1; cy++) {
+            if (cy < 0 || cy >= dim) continue;
+            for (int cx = gx - 1; cx <= gx + 1; cx++) {
+                if (cx < 0 || cx >= dim) continue;
+                for (int i = tracker->cell_head[cy * dim + cx]; i >= 0; i = tracker->cell_next[i]) {
+                    double ex = x - tracker->tracks[i].px;
+                    double ey = y - tracker->tracks[i].py;
+                    double dist_sq = ex * ex + ey * ey;
+                    if (dist_sq >= gate_sq || pair_count >= TRACKER_MAX_PAIRS) continue;
+                    pairs[pair_count].dist_sq = dist_sq;
+                    pairs[pair_count].det = d;
+                    pairs[pair_count].track = i;
+                    pair_count++;
+                }
+            }
+        }
+    }
+
+    // 3. 由近到远贪心分配
+    qsort(pairs, pair_count, sizeof(tracker_pair_t), compare_pair);
+
+    uint8_t det_matched[detections->count > 0 ? detections->count : 1];
+    uint8_t track_matched[VIDEO_TRACKER_MAX_TRACKS];
+    memset(det_matched, 0, sizeof(det_matched));
+    memset(track_matched, 0, sizeof(track_matched));
+
+    for (int p = 0; p < pair_count; p++) {
+        int d = pairs[p].det, i = pairs[p].track;
+        if (det_matched[d] || track_matched[i]) continue;
+        det_matched[d] = 1;
+        track_matched[i] = 1;
+
+        video_track_state_t *t = &tracker->tracks[i];
+        target_track_t *det = &detections->tracks[d];
+        double x = det->position.longitude, y = det->position.latitude;
+        if (dt > 0.0) {
+            t->vx += TRACKER_VELOCITY_GAIN * ((x - t->x) / dt - t->vx);
+            t->vy += TRACKER_VELOCITY_GAIN * ((y - t->y) / dt - t->vy);
+        }
+        t->x = x;
+        t->y = y;
+        t->hits++;
+        t->misses = 0;
+        det->id = t->id;
+    }
+
+    // 4. 删除连续丢失的航迹（倒序交换删除，不影响尚未处理的下标）
+    for (int i = tracker->count - 1; i >= 0; i--) {
+        if (track_matched[i]) continue;
+        if (++tracker->tracks[i].misses > tracker->max_misses) {
+            tracker->tracks[i] = tracker->tracks[--tracker->count];
+        }
+    }
+
+    // 5. 未匹配的检测建立新航迹
+    int created = 0;
+    for (int d = 0; d < detections->count; d++) {
+        if (det_matched[d]) continue;
+        target_track_t *det = &detections->tracks[d];
+        det->id = tracker->id_base + tracker->next_id;
+        tracker->next_id = (tracker->next_id + 1) % VIDEO_TRACKER_ID_SPAN;
+
+        if (tracker->count < VIDEO_TRACKER_MAX_TRACKS) {
+            video_track_state_t *t = &tracker->tracks[tracker->count++];
+            memset(t, 0, sizeof(*t));
+            t->id = det->id;
+            t->x = det->position.longitude;
+            t->y = det->position.latitude;
+            t->hits = 1;
+        }
+        created++;
+    }
+    return created;
+}
@@ -0,0 +1,182 @@
+#include "mec_video.h"
+#include "mec_logging.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @file video_transform.c
+ * @brief 去畸变查找表与批量单应变换实现
+ */
+
+#define UNDISTORT_ITERATIONS 10
+
+// 归一化平面上求解畸变模型的逆：已知畸变后坐标 (xd, yd)，迭代求原始坐标
+static void undistort_normalized(const lens_distortion_t *lens, double xd, double yd, double *xu, double *yu) {
+    double x = xd, y = yd;
+    for (int i = 0; i < UNDISTORT_ITERATIONS; i++) {
+        double r2 = x * x + y * y;
+        double radial = 1.0 + r2 * (lens->k1 + r2 * (lens->k2 + r2 * lens->k3));
+        double dx = 2.0 * lens->p1 * x * y + lens->p2 * (r2 + 2.0 * x * x);
+        double dy = lens->p1 * (r2 + 2.0 * y * y) + 2.0 * lens->p2 * x * y;
+        x = (xd - dx) / radial;
+        y = (yd - dy) / radial;
+    }
+    *xu = x;
+    *yu = y;
+}
+
+undistort_map_t* undistort_map_create(const lens_distortion_t *lens, int width, int height, int step) {
+    if (!lens || width <= 0 || height <= 0 || lens->fx <= 0.0 || lens->fy <= 0.0) return NULL;
+    if (step <= 0) step = UNDISTORT_DEFAULT_STEP;
+
+    undistort_map_t *map = mec_calloc(1, sizeof(undistort_map_t));
+    if (!map) return NULL;
+
+    map->width = width;
+    map->height = height;
+    map->step = step;
+    map->grid_w = (width + step - 1) / step + 1;    // 最后一列节点覆盖右边界
+    map->grid_h = (height + step - 1) / step + 1;
+    size_t nodes = (size_t)map->grid_w * map->grid_h;
+    map->map_x = malloc(nodes * sizeof(float));
+    map->map_y = malloc(nodes * sizeof(float));
+    if (!map->map_x || !map->map_y) {
+        undistort_map_destroy(map);
+        return NULL;
+    }
+
+    for (int gy = 0; gy < map->grid_h; gy++) {
+        for (int gx = 0; gx < map->grid_w; gx++) {
+            double xd = (gx * step - lens->cx) / lens->fx;
+            double yd = (gy * step - lens->cy) / lens->fy;
+            double xu, yu;
+            undistort_normalized(lens, xd, yd, &xu, &yu);
+            size_t idx = (size_t)gy * map->grid_w + gx;
+            map->map_x[idx] = (float)(xu * lens->fx + lens->cx);
+            map->map_y[idx] = (float)(yu * lens->fy + lens->cy);
+        }
+    }
+
+    LOG_INFO("Video: Built %dx%d undistortion table (%d px grid)", map->grid_w, map->grid_h, step);
+    return map;
+}
+
+void undistort_map_destroy(undistort_map_t *map) {
+    if (!map) return;
+    free(map->map_x);
+    free(map->map_y);
+    mec_free(map);
+}
+
+void undistort_map_apply(const undistort_map_t *map, float *x, float *y, int count) {
+    if (!map || !x || !y) return;
+
+    const float inv_step = 1.0f / (float)map->step;
+    const int gw = map->grid_w;
+    const int max_gx = map->grid_w - 2;
+    const int max_gy = map->grid_h - 2;
+
+    for (int i = 0; i < count; i++) {
+        float fx = x[i] * inv_step;
+        float fy = y[i] * inv_step;
+        int gx = (int)fx;
+        int gy = (int)fy;
+        // 画面外的点按边缘网格外推
+        if (gx < 0) gx = 0; else if (gx > max_gx) gx = max_gx;
+        if (gy < 0) gy = 0; else if (gy > max_gy) gy = max_gy;
+        float tx = fx - (float)gx;
+        float ty = fy - (float)gy;
+
+        size_t i00 = (size_t)gy * gw + gx;
+        size_t i10 = i00 + 1;
+        size_t i01 = i00 + gw;
+        size_t i11 = i01 + 1;
+
+        float top_x = map->map_x[i00] + tx * (map->map_x[i10] - map->map_x[i00]);
+        float bot_x = map->map_x[i01] + tx * (map->map_x[i11] - map->map_x[i01]);
+        float top_y = map->map_y[i00] + tx * (map->map_y[i10] - map->map_y[i00]);
+        float bot_y = map->map_y[i01] + tx * (map->map_y[i11] - map->map_y[i01]);
+        x[i] = top_x + ty * (bot_x - top_x);
+        y[i] = top_y + ty * (bot_y - top_y);
+    }
+}
+
+void homography_apply_batch(const double matrix[9], const float *x, const float *y,
+                            double *east, double *north, int count) {
+    if (!matrix || !x || !y || !east || !north) return;
+
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128d h0 = _mm_set1_pd(matrix[0]), h1 = _mm_set1_pd(matrix[1]), h2 = _mm_set1_pd(matrix[2]);
+    const __m128d h3 = _mm_set1_pd(matrix[3]), h4 = _mm_set1_pd(matrix[4]), h5 = _mm_set1_pd(matrix[5]);
+    const __m128d h6 = _mm_set1_pd(matrix[6]), h7 = _mm_set1_pd(matrix[7]), h8 = _mm_set1_pd(matrix[8]);
+    const __m128d eps = _mm_set1_pd(1e-10);
+    const __m128d sign = _mm_set1_pd(-0.0);
+    const __m128d nan = _mm_set1_pd(NAN);
+
+    for (; i + 2 <= count; i += 2) {
+        __m128d px = _mm_set_pd((double)x[i + 1], (double)x[i]);
+        __m128d py = _mm_set_pd((double)y[i + 1], (double)y[i]);
+
+        __m128d w = _mm_add_pd(_mm_add_pd(_mm_mul_pd(h6, px), _mm_mul_pd(h7, py)), h8);
+        __m128d u = _mm_add_pd(_mm_add_pd(_mm_mul_pd(h0, px), _mm_mul_pd(h1, py)), h2);
+        __m128d v = _mm_add_pd(_mm_add_pd(_mm_mul_pd(h3, px), _mm_mul_pd(h4, py)), h5);
+
+        // |w| < eps 的点无有效地面交点，输出 NAN
+        __m128d valid = _mm_cmpge_pd(_mm_andnot_pd(sign, w), eps);
+        __m128d e = _mm_div_pd(u, w);
+        __m128d n = _mm_div_pd(v, w);
+        e = _mm_or_pd(_mm_and_pd(valid, e), _mm_andnot_pd(valid, nan));
+        n = _mm_or_pd(_mm_and_pd(valid, n), _mm_andnot_pd(valid, nan));
+
+        _mm_storeu_pd(&east[i], e);
+        _mm_storeu_pd(&north[i], n);
+    }
+#endif
+    for (; i < count; i++) {
+        double px = x[i], py = y[i];
+        double w = matrix[6] * px + matrix[7] * py + matrix[8];
+        if (fabs(w) < 1e-10) {
+            east[i] = NAN;
+            north[i] = NAN;
+            continue;
+        }
+        east[i] = (matrix[0] * px + matrix[1] * py + matrix[2]) / w;
+        north[i] = (matrix[3] * px + matrix[4] * py + matrix[5]) / w;
+    }
+}
+
+int transform_tracks_to_enu(const perspective_transform_t *transform, const undistort_map_t *undistort,
+                            track_list_t *tracks, int width, int height) {
+    if (!transform || !tracks || !transform->calibrated) return -1;
+
+    float px[VIDEO_TRANSFORM_CHUNK], py[VIDEO_TRANSFORM_CHUNK];
+    double east[VIDEO_TRANSFORM_CHUNK], north[VIDEO_TRANSFORM_CHUNK];
+    int converted = 0;  // 写入位置：变换失败（落在地平线外）的目标就地剔除
+
+    for (int base = 0; base < tracks->count; base += VIDEO_TRANSFORM_CHUNK) {
+        int n = tracks->count - base;
+        if (n > VIDEO_TRANSFORM_CHUNK) n = VIDEO_TRANSFORM_CHUNK;
+        target_track_t *chunk = &tracks->tracks[base];
+
+        // 检测器输出归一化坐标，这里保留亚像素精度
+        for (int i = 0; i < n; i++) {
+            px[i] = (float)(chunk[i].position.longitude * width);
+            py[i] = (float)(chunk[i].position.latitude * height);
+        }
+        if (undistort) undistort_map_apply(undistort, px, py, n);
+        homography_apply_batch(transform->matrix, px, py, east, north, n);
+
+        for (int i = 0; i < n; i++) {
+            if (isnan(east[i])) continue;
+            target_track_t *out = &tracks->tracks[converted++];
+            if (out != &chunk[i]) *out = chunk[i];
+            out->local.east = east[i];
+            out->local.north = north[i];
+            out->local.up = 0.0;
+        }
+    }
+    tracks->count = converted;
+    return converted;
+}
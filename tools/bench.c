@@ -0,0 +1,520 @@
+#include "mec_fusion.h"
+#include "mec_queue.h"
+#include "mec_v2x.h"
+#include "mec_config.h"
+#include "mec_clock.h"
+#include "mec_logging.h"
+#include "tool_common.h"
+#include <signal.h>
+#include <time.h>
+
+/**
+ * @file bench.c
+ * @brief 端到端时延与吞吐基准
+ *
+ * 在进程内搭起与 mec_system 相同的链路：
+ *   生产者线程 (每传感器一个) -> mec_queue -> 融合 -> 输出快照 -> V2X RSM 编码
+ * 生产者按绝对节拍生成 N 个匀速目标的一帧观测，消费者每处理一帧即执行一拍融合
+ * (fusion_processor_step) 并编码输出，因此测得的是处理链路本身的时延；
+ * 运行时融合线程 20Hz 节拍带来的 0~50 ms 等待不计入。
+ *
+ * 时延 = 编码完成时刻 - 观测时间戳，包含排队等待；另统计单帧处理耗时 (service)。
+ * 目标数、传感器数与频率可各给一组取值，逐一组合运行，结果以 JSON 输出。
+ *
+ * 用法: mec_bench [-c CONFIG] [--targets LIST] [--sensors LIST] [--rate LIST]
+ *                 [--duration S] [--warmup S] [--queue N] [--json PATH]
+ *       LIST 为逗号分隔的取值，如 --targets 50,200,500
+ */
+
+#define BENCH_MAX_VALUES 16
+#define BENCH_MAX_SENSORS 31          // 融合传感器掩码位数
+#define BENCH_LANE_SPACING 10.0       // 目标间距 (m)，大于默认关联门限
+
+typedef struct {
+    int values[BENCH_MAX_VALUES];
+    int count;
+} bench_int_list_t;
+
+typedef struct {
+    double values[BENCH_MAX_VALUES];
+    int count;
+} bench_double_list_t;
+
+typedef struct {
+    double p50, p99, p999, max, mean;
+} bench_summary_t;
+
+// 单次组合运行的参数与结果
+typedef struct {
+    int targets;
+    int sensors;
+    double rate_hz;
+
+    long offered;               // 生产者生成的帧数（测量窗口内）
+    long dropped;               // 队列满被丢弃的帧数（测量窗口内）
+    long processed;             // 消费者处理的帧数（测量窗口内）
+    long processed_targets;
+    long completed;             // 测量窗口结束前处理完的帧数，用于计算吞吐
+    long encode_failures;
+    int max_queue_depth;
+    int fused_tracks;           // 结束时的融合航迹数
+    double window_s;
+    bench_summary_t latency;
+    bench_summary_t service;
+} bench_result_t;
+
+typedef struct bench_run bench_run_t;
+
+typedef struct {
+    bench_run_t *run;
+    int sensor_id;
+    pthread_t thread;
+    uint64_t rng;
+    long offered;
+    long dropped;
+} bench_producer_t;
+
+struct bench_run {
+    bench_result_t *result;
+    mec_queue_t *queue;
+    fusion_processor_t *fusion;
+    mec_time_ns_t start;        // 单调时间起点
+    mec_time_ns_t measure_from; // 预热结束
+    mec_time_ns_t stop_at;
+    struct timeval measure_wall; // 预热结束对应的墙钟，时间戳不早于此的帧计入统计
+    volatile int producing;
+    tool_samples_t latency;
+    tool_samples_t service;
+};
+
+static volatile sig_atomic_t running = 1;
+
+static void signal_handler(int sig) {
+    (void)sig;
+    running = 0;
+}
+
+/* --- 统计 --- */
+
+static void summarize(tool_samples_t *s, bench_summary_t *out) {
+    memset(out, 0, sizeof(*out));
+    if (s->count == 0) return;
+    qsort(s->data, s->count, sizeof(double), tool_compare_double);
+    double sum = 0.0;
+    for (size_t i = 0; i < s->count; i++) sum += s->data[i];
+    out->p50 = tool_percentile(s->data, s->count, 0.50);
+    out->p99 = tool_percentile(s->data, s->count, 0.99);
+    out->p999 = tool_percentile(s->data, s->count, 0.999);
+    out->max = s->data[s->count - 1];
+    out->mean = sum / (double)s->count;
+}
+
+/* --- 场景 --- */
+
+static uint64_t xorshift64(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+static double noise(uint64_t *state, double amplitude) {
+    return ((double)(xorshift64(state) >> 11) / 9007199254740992.0 * 2.0 - 1.0) * amplitude;
+}
+
+// 目标 i 在 t 秒时的位置：按车道网格排列，沿各自车道往返匀速行驶
+static void target_at(int i, double t, target_track_t *out) {
+    const int lanes = 20;
+    const double span = 200.0;
+    int pedestrian = i % 10 == 0;
+    double velocity = pedestrian ? 1.5 : 4.0 + (i % 5) * 2.0;
+    double d = fmod(velocity * t + (i / lanes) * BENCH_LANE_SPACING * 3.0, 2.0 * span);
+    int forward = d < span;
+    out->id = i + 1;
+    out->type = pedestrian ? TARGET_PEDESTRIAN : TARGET_VEHICLE;
+    out->local.east = -span / 2.0 + (forward ? d : 2.0 * span - d);
+    out->local.north = (i % lanes) * BENCH_LANE_SPACING + (i / lanes) * 0.5;
+    out->local.up = 0.0;
+    out->velocity = velocity;
+    out->heading = forward ? 0.0 : 180.0;
+    out->confidence = 0.9;
+}
+
+/* --- 流水线线程 --- */
+
+static void* producer_thread(void *arg) {
+    bench_producer_t *p = (bench_producer_t*)arg;
+    bench_run_t *run = p->run;
+    const int targets = run->result->targets;
+    const mec_time_ns_t period = (mec_time_ns_t)(MEC_NS_PER_SEC / run->result->rate_hz);
+    // 各传感器在周期内错开，避免所有帧同时到达
+    mec_time_ns_t next = run->start + period * (p->sensor_id - 1) / run->result->sensors;
+
+    while (run->producing && running) {
+        mec_time_ns_t now = mec_clock_now();
+        if (now < next) {
+            struct timespec ts = { (time_t)((next - now) / MEC_NS_PER_SEC), (long)((next - now) % MEC_NS_PER_SEC) };
+            nanosleep(&ts, NULL);
+            continue;
+        }
+        next += period;
+
+        track_list_t *frame = track_list_create(targets > 0 ? targets : 1);
+        if (!frame) continue;
+        struct timeval stamp;
+        mec_clock_wall(&stamp);
+        double t = mec_time_to_ms(now - run->start) / 1000.0;
+        for (int i = 0; i < targets; i++) {
+            target_track_t track;
+            memset(&track, 0, sizeof(track));
+            target_at(i, t, &track);
+            track.local.east += noise(&p->rng, 0.1);
+            track.local.north += noise(&p->rng, 0.1);
+            track.sensor_id = p->sensor_id;
+            track.timestamp = stamp;
+            track_list_add(frame, &track);
+        }
+
+        mec_msg_t msg;
+        msg.sensor_id = p->sensor_id;
+        msg.tracks = frame;
+        msg.timestamp = stamp;
+        int measured = now >= run->measure_from;
+        if (mec_queue_push(run->queue, &msg) != 0 && measured) p->dropped++;
+        if (measured) p->offered++;
+        track_list_release(frame);   // 队列持有自己的引用
+    }
+    return NULL;
+}
+
+static void* consumer_thread(void *arg) {
+    bench_run_t *run = (bench_run_t*)arg;
+    bench_result_t *res = run->result;
+    track_list_t *fused = track_list_create(run->fusion->track_capacity);
+    v2x_encoder_t *v2x_enc = v2x_encoder_create(0xBE7C, V2X_DEFAULT_MTU, run->fusion->track_capacity);
+    if (!fused || !v2x_enc) {
+        LOG_ERROR("Bench: Consumer allocation failed");
+        track_list_release(fused);
+        v2x_encoder_destroy(v2x_enc);
+        return NULL;
+    }
+
+    // 生产者停止后继续排空队列，积压帧的时延同样计入
+    for (;;) {
+        mec_msg_t msg;
+        if (mec_queue_pop(run->queue, &msg, 100) != 0) {
+            if (!run->producing) break;
+            continue;
+        }
+        int depth = mec_queue_size(run->queue) + 1;
+        mec_time_ns_t t0 = mec_clock_real_ns();
+
+        fusion_processor_add_tracks(run->fusion, msg.tracks, msg.sensor_id);
+        fusion_processor_step(run->fusion);
+        fusion_processor_snapshot(run->fusion, fused);
+        const struct iovec *v2x_iov;
+        int segments = v2x_encode_rsm_segments(v2x_enc, fused, &v2x_iov);
+
+        struct timeval done;
+        mec_clock_wall(&done);
+        mec_time_ns_t t1 = mec_clock_real_ns();
+        if (mec_time_from_timeval(&msg.timestamp) >= mec_time_from_timeval(&run->measure_wall)) {
+            tool_samples_push(&run->latency, mec_time_to_ms(mec_time_from_timeval(&done) -
+                                                       mec_time_from_timeval(&msg.timestamp)));
+            tool_samples_push(&run->service, mec_time_to_ms(t1 - t0));
+            res->processed++;
+            res->processed_targets += msg.tracks->count;
+            if (mec_clock_now() <= run->stop_at) res->completed++;
+            if (segments < 0) res->encode_failures++;
+            if (depth > res->max_queue_depth) res->max_queue_depth = depth;
+        }
+        track_list_release(msg.tracks);
+    }
+
+    v2x_encoder_destroy(v2x_enc);
+    track_list_release(fused);
+    return NULL;
+}
+
+/* --- 单次运行 --- */
+
+static int run_once(const fusion_config_t *base_cfg, int queue_capacity,
+                    double duration_s, double warmup_s, bench_result_t *res) {
+    bench_run_t run;
+    memset(&run, 0, sizeof(run));
+    run.result = res;
+
+    fusion_config_t cfg = *base_cfg;
+    if (cfg.max_tracks < res->targets + res->targets / 2) cfg.max_tracks = res->targets + res->targets / 2;
+    run.fusion = fusion_processor_create(&cfg);
+    run.queue = mec_queue_create(queue_capacity);
+    if (!run.fusion || !run.queue) {
+        fusion_processor_destroy(run.fusion);
+        if (run.queue) mec_queue_destroy(run.queue);
+        return -1;
+    }
+
+    bench_producer_t producers[BENCH_MAX_SENSORS];
+    memset(producers, 0, sizeof(producers));
+
+    run.start = mec_clock_now();
+    run.measure_from = run.start + (mec_time_ns_t)(warmup_s * MEC_NS_PER_SEC);
+    run.stop_at = run.measure_from + (mec_time_ns_t)(duration_s * MEC_NS_PER_SEC);
+    struct timeval wall;
+    mec_clock_wall(&wall);
+    mec_time_to_timeval(mec_time_from_timeval(&wall) + (run.measure_from - run.start), &run.measure_wall);
+    run.producing = 1;
+
+    int ret = 0;
+    pthread_t consumer;
+    if (pthread_create(&consumer, NULL, consumer_thread, &run) != 0) {
+        ret = -1;
+    }
+    int started = 0;
+    for (; ret == 0 && started < res->sensors; started++) {
+        bench_producer_t *p = &producers[started];
+        p->run = &run;
+        p->sensor_id = started + 1;
+        p->rng = 0x9E3779B97F4A7C15ULL * (uint64_t)(started + 1);
+        if (pthread_create(&p->thread, NULL, producer_thread, p) != 0) {
+            ret = -1;
+            break;
+        }
+    }
+
+    while (running && ret == 0 && mec_clock_now() < run.stop_at) {
+        usleep(10000);
+    }
+    run.producing = 0;
+    for (int i = 0; i < started; i++) {
+        pthread_join(producers[i].thread, NULL);
+        res->offered += producers[i].offered;
+        res->dropped += producers[i].dropped;
+    }
+    if (ret == 0 || started > 0) {
+        pthread_join(consumer, NULL);
+    }
+
+    res->window_s = duration_s;
+    res->fused_tracks = run.fusion->track_count;
+    summarize(&run.latency, &res->latency);
+    summarize(&run.service, &res->service);
+    tool_samples_free(&run.latency);
+    tool_samples_free(&run.service);
+
+    mec_queue_destroy(run.queue);
+    fusion_processor_destroy(run.fusion);
+    return ret;
+}
+
+/* --- 输出 --- */
+
+// 跟得上：无丢帧，且窗口结束时每路传感器至多还有一帧在途
+static int sustained(const bench_result_t *r) {
+    return r->offered > 0 && r->dropped == 0 && r->completed >= r->offered - r->sensors;
+}
+
+static void write_summary_json(FILE *fp, const char *name, const bench_summary_t *s) {
+    fprintf(fp, "\"%s\": {\"p50\": %.4f, \"p99\": %.4f, \"p99_9\": %.4f, \"max\": %.4f, \"mean\": %.4f}",
+            name, s->p50, s->p99, s->p999, s->max, s->mean);
+}
+
+static void write_json(FILE *fp, const bench_result_t *results, int count,
+                       double duration_s, double warmup_s, int queue_capacity) {
+    time_t now = time(NULL);
+    struct tm tm_utc;
+    char stamp[32];
+    gmtime_r(&now, &tm_utc);
+    strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", &tm_utc);
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"benchmark\": \"mec_bench\",\n");
+    fprintf(fp, "  \"schema\": 1,\n");
+    fprintf(fp, "  \"timestamp\": \"%s\",\n", stamp);
+    fprintf(fp, "  \"cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+    fprintf(fp, "  \"duration_s\": %.3f,\n", duration_s);
+    fprintf(fp, "  \"warmup_s\": %.3f,\n", warmup_s);
+    fprintf(fp, "  \"queue_capacity\": %d,\n", queue_capacity);
+    fprintf(fp, "  \"runs\": [");
+    for (int i = 0; i < count; i++) {
+        const bench_result_t *r = &results[i];
+        double window = r->window_s > 0 ? r->window_s : 1.0;
+        fprintf(fp, "%s\n    {\"targets\": %d, \"sensors\": %d, \"rate_hz\": %.3f,\n",
+                i ? "," : "", r->targets, r->sensors, r->rate_hz);
+        fprintf(fp, "     \"offered_fps\": %.3f, \"throughput_fps\": %.3f, \"throughput_targets_per_s\": %.1f,\n",
+                r->offered / window, r->completed / window, r->processed_targets / window);
+        fprintf(fp, "     \"frames_offered\": %ld, \"frames_processed\": %ld, \"frames_dropped\": %ld,"
+                    " \"encode_failures\": %ld,\n",
+                r->offered, r->processed, r->dropped, r->encode_failures);
+        fprintf(fp, "     \"max_queue_depth\": %d, \"fused_tracks\": %d, \"sustained\": %s,\n",
+                r->max_queue_depth, r->fused_tracks, sustained(r) ? "true" : "false");
+        fprintf(fp, "     ");
+        write_summary_json(fp, "latency_ms", &r->latency);
+        fprintf(fp, ",\n     ");
+        write_summary_json(fp, "service_ms", &r->service);
+        fprintf(fp, "}");
+    }
+    fprintf(fp, "\n  ]\n}\n");
+}
+
+/* --- 参数 --- */
+
+static int parse_int_list(const char *text, bench_int_list_t *out) {
+    out->count = 0;
+    const char *p = text;
+    while (*p) {
+        char *end;
+        long v = strtol(p, &end, 10);
+        if (end == p || v < 0 || out->count >= BENCH_MAX_VALUES) return -1;
+        out->values[out->count++] = (int)v;
+        if (*end == ',') end++;
+        else if (*end != '\0') return -1;
+        p = end;
+    }
+    return out->count > 0 ? 0 : -1;
+}
+
+static int parse_double_list(const char *text, bench_double_list_t *out) {
+    out->count = 0;
+    const char *p = text;
+    while (*p) {
+        char *end;
+        double v = strtod(p, &end);
+        if (end == p || v <= 0.0 || out->count >= BENCH_MAX_VALUES) return -1;
+        out->values[out->count++] = v;
+        if (*end == ',') end++;
+        else if (*end != '\0') return -1;
+        p = end;
+    }
+    return out->count > 0 ? 0 : -1;
+}
+
+static void load_fusion_config(config_t *config, fusion_config_t *cfg) {
+    double d;
+    int v;
+    cfg->association_threshold = 5.0;
+    cfg->position_weight = 1.0;
+    cfg->velocity_weight = 0.1;
+    cfg->confidence_threshold = 0.3;
+    cfg->max_track_age = 50;
+    cfg->max_tracks = FUSION_DEFAULT_MAX_TRACKS;
+    if (!config) return;
+    if (config_get_double(config, "fusion.association_threshold", &d, 5.0) == MEC_OK) cfg->association_threshold = d;
+    if (config_get_double(config, "fusion.position_weight", &d, 1.0) == MEC_OK) cfg->position_weight = d;
+    if (config_get_double(config, "fusion.velocity_weight", &d, 0.1) == MEC_OK) cfg->velocity_weight = d;
+    if (config_get_double(config, "fusion.confidence_threshold", &d, 0.3) == MEC_OK) cfg->confidence_threshold = d;
+    if (config_get_int(config, "fusion.max_track_age", &v, 50) == MEC_OK) cfg->max_track_age = v;
+    if (config_get_int(config, "fusion.max_tracks", &v, FUSION_DEFAULT_MAX_TRACKS) == MEC_OK) cfg->max_tracks = v;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-c CONFIG] [--targets LIST] [--sensors LIST] [--rate LIST]\n"
+            "       [--duration S] [--warmup S] [--queue N] [--json PATH]\n"
+            "  LIST: comma separated values, e.g. --targets 50,200,500\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    const char *config_path = NULL;
+    const char *json_path = NULL;
+    bench_int_list_t targets = { {50, 200}, 2 };
+    bench_int_list_t sensors = { {1, 4}, 2 };
+    bench_double_list_t rates = { {10.0, 20.0}, 2 };
+    double duration_s = 5.0, warmup_s = 1.0;
+    int queue_capacity = 50;   // 与 mec_system 的消息队列一致
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!val) {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+        int bad = 0;
+        if (strcmp(arg, "-c") == 0) config_path = val;
+        else if (strcmp(arg, "--targets") == 0) bad = parse_int_list(val, &targets) != 0;
+        else if (strcmp(arg, "--sensors") == 0) bad = parse_int_list(val, &sensors) != 0;
+        else if (strcmp(arg, "--rate") == 0) bad = parse_double_list(val, &rates) != 0;
+        else if (strcmp(arg, "--duration") == 0) duration_s = atof(val);
+        else if (strcmp(arg, "--warmup") == 0) warmup_s = atof(val);
+        else if (strcmp(arg, "--queue") == 0) queue_capacity = atoi(val);
+        else if (strcmp(arg, "--json") == 0) json_path = val;
+        else bad = 1;
+        if (bad) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    for (int i = 0; i < sensors.count; i++) {
+        if (sensors.values[i] < 1 || sensors.values[i] > BENCH_MAX_SENSORS) {
+            fprintf(stderr, "Sensor count must be 1..%d\n", BENCH_MAX_SENSORS);
+            return 1;
+        }
+    }
+    if (duration_s <= 0.0 || warmup_s < 0.0 || queue_capacity < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // 日志写文件，保持标准输出只有 JSON
+    log_init("/tmp/mec_bench.log", LOG_WARN);
+    mec_memory_init();
+
+    fusion_config_t fusion_cfg;
+    config_t *config = NULL;
+    if (config_path && config_load(&config, config_path) != MEC_OK) {
+        fprintf(stderr, "Cannot load config %s\n", config_path);
+        return 1;
+    }
+    load_fusion_config(config, &fusion_cfg);
+    if (config) config_free(config);
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    int total = targets.count * sensors.count * rates.count;
+    bench_result_t *results = calloc(total, sizeof(bench_result_t));
+    if (!results) return 1;
+
+    int done = 0, failed = 0;
+    for (int a = 0; a < targets.count && running; a++) {
+        for (int b = 0; b < sensors.count && running; b++) {
+            for (int c = 0; c < rates.count && running; c++) {
+                bench_result_t *r = &results[done];
+                r->targets = targets.values[a];
+                r->sensors = sensors.values[b];
+                r->rate_hz = rates.values[c];
+                if (run_once(&fusion_cfg, queue_capacity, duration_s, warmup_s, r) != 0) {
+                    fprintf(stderr, "Run %d targets / %d sensors / %.1f Hz failed\n",
+                            r->targets, r->sensors, r->rate_hz);
+                    failed = 1;
+                    continue;
+                }
+                done++;
+                fprintf(stderr, "%5d targets %2d sensors %6.1f Hz: %8.1f fps  latency p50 %.3f p99 %.3f p99.9 %.3f ms%s\n",
+                        r->targets, r->sensors, r->rate_hz, r->completed / r->window_s,
+                        r->latency.p50, r->latency.p99, r->latency.p999,
+                        sustained(r) ? "" : "  (not sustained)");
+            }
+        }
+    }
+
+    FILE *fp = stdout;
+    if (json_path) {
+        fp = fopen(json_path, "w");
+        if (!fp) {
+            fprintf(stderr, "Cannot write %s: %s\n", json_path, strerror(errno));
+            free(results);
+            return 1;
+        }
+    }
+    write_json(fp, results, done, duration_s, warmup_s, queue_capacity);
+    if (fp != stdout) fclose(fp);
+
+    free(results);
+    mec_memory_cleanup();
+    log_cleanup();
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,679 @@
+#include "mec_fusion.h"
+#include "mec_scenario.h"
+#include "mec_config.h"
+#include "mec_geo.h"
+#include "mec_clock.h"
+#include "mec_logging.h"
+#include "tool_common.h"
+#include <time.h>
+
+/**
+ * @file fusion_eval.c
+ * @brief 融合精度与时延回归门禁
+ *
+ * 把传感器场景 (mec_scenario_gen -o) 按场景时间喂给融合处理器，融合按 FUSION_TICK_MS
+ * 的场景时间节拍执行一拍 (fusion_processor_step)，并在真值文件 (mec_scenario_gen --truth)
+ * 的每个时刻把融合输出与真值比对：
+ *   OSPA        截断距离 c、阶数 p 的最优子模式指派距离，逐帧平均
+ *   MOTA/MOTP   逐帧带门限的最优指派，统计漏检、虚警与 ID 切换
+ *   IDF1        全程真值 ID 与航迹 ID 的全局最优一一对应
+ * 同时记录每拍（量测接入 + 预测输出）的真实耗时与线程 CPU 时间。
+ *
+ * 场景时间由虚拟时钟驱动，结果与机器快慢无关；时延指标按真实时间测量。
+ * 可把本次结果写成基线，或与已有基线比较：精度下降或时延上升超出 [eval] 中的
+ * 容差即判为回归，退出码为 2。
+ *
+ * 用法: mec_fusion_eval [-c CONFIG] --scenario PATH --truth PATH
+ *                       [--baseline PATH] [--write-baseline PATH]
+ */
+
+#define EVAL_UNMATCHED_COST 1e9     // 门限外配对的代价，保证先最大化匹配数
+
+typedef struct {
+    double match_distance;      // MOTA/IDF1 匹配门限 (m)
+    double ospa_cutoff;         // OSPA 截断距离 c (m)
+    double ospa_order;          // OSPA 阶数 p
+    double ospa_tolerance;      // 允许 OSPA 增加的绝对值 (m)
+    double mota_tolerance;      // 允许 MOTA 下降的绝对值
+    double idf1_tolerance;      // 允许 IDF1 下降的绝对值
+    double latency_tolerance;   // 允许单拍耗时中位数与 CPU 时间上升的比例
+    double latency_p99_tolerance;
+} eval_config_t;
+
+typedef struct {
+    int id;
+    double east;
+    double north;
+} eval_object_t;
+
+/* --- 整数键哈希表：ID 切换记录与 IDF1 共现计数 --- */
+
+typedef struct {
+    uint64_t *keys;             // 0 表示空槽（真值与融合航迹 ID 均从 1 开始）
+    long *values;
+    size_t capacity;            // 2 的幂
+    size_t count;
+} eval_map_t;
+
+static uint64_t pair_key(int a, int b) {
+    return ((uint64_t)(uint32_t)a << 32) | (uint32_t)b;
+}
+
+static size_t map_slot(const eval_map_t *m, uint64_t key) {
+    return (size_t)((key * 0x9E3779B97F4A7C15ull) >> 17) & (m->capacity - 1);
+}
+
+static int map_grow(eval_map_t *m) {
+    size_t cap = m->capacity ? m->capacity * 2 : 1024;
+    uint64_t *keys = calloc(cap, sizeof(uint64_t));
+    long *values = calloc(cap, sizeof(long));
+    if (!keys || !values) {
+        free(keys);
+        free(values);
+        return -1;
+    }
+    eval_map_t grown = { keys, values, cap, 0 };
+    for (size_t i = 0; i < m->capacity; i++) {
+        if (!m->keys[i]) continue;
+        size_t s = map_slot(&grown, m->keys[i]);
+        while (grown.keys[s]) s = (s + 1) & (cap - 1);
+        grown.keys[s] = m->keys[i];
+        grown.values[s] = m->values[i];
+        grown.count++;
+    }
+    free(m->keys);
+    free(m->values);
+    *m = grown;
+    return 0;
+}
+
+// 返回 key 对应的值槽，不存在时插入并置 0；键须非 0
+static long* map_slot_for(eval_map_t *m, uint64_t key) {
+    if ((m->count + 1) * 2 > m->capacity && map_grow(m) != 0) return NULL;
+    size_t s = map_slot(m, key);
+    while (m->keys[s] && m->keys[s] != key) s = (s + 1) & (m->capacity - 1);
+    if (!m->keys[s]) {
+        m->keys[s] = key;
+        m->values[s] = 0;
+        m->count++;
+    }
+    return &m->values[s];
+}
+
+static void map_free(eval_map_t *m) {
+    free(m->keys);
+    free(m->values);
+    memset(m, 0, sizeof(*m));
+}
+
+/* --- 分量分解的最优指派 --- */
+
+static int uf_find(int *parent, int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+/**
+ * @brief 在门限图的各连通分量上分别求最优指派
+ *
+ * 门限外的配对与不配对等价（OSPA 的截断）或必须排除（MOTA），因此只有门限内
+ * 有边相连的行列才需要一起求解，大矩阵拆成许多小块。
+ * @param max_cardinality 1: 门限外代价取 EVAL_UNMATCHED_COST，先保证匹配数最多
+ * @param match 输出：每行匹配到的列（仅门限内配对），否则 -1
+ */
+static int gated_assign(const double *dist, int rows, int cols, double gate, double order,
+                        int max_cardinality, int *match) {
+    for (int r = 0; r < rows; r++) match[r] = -1;
+    if (rows == 0 || cols == 0) return 0;
+
+    int n = rows + cols;
+    int *parent = malloc(n * sizeof(int));
+    int *comp_rows = malloc(rows * sizeof(int));
+    int *comp_cols = malloc(cols * sizeof(int));
+    double *cost = malloc((size_t)rows * cols * sizeof(double));
+    int *sub = malloc(rows * sizeof(int));
+    char *done = calloc(n, 1);
+    int ret = 0;
+    if (!parent || !comp_rows || !comp_cols || !cost || !sub || !done) {
+        ret = -1;
+        goto out;
+    }
+    for (int i = 0; i < n; i++) parent[i] = i;
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            if (dist[r * cols + c] < gate) {
+                int a = uf_find(parent, r), b = uf_find(parent, rows + c);
+                if (a != b) parent[a] = b;
+            }
+        }
+    }
+
+    for (int r0 = 0; r0 < rows; r0++) {
+        int root = uf_find(parent, r0);
+        if (done[root]) continue;
+        done[root] = 1;
+        int nr = 0, nc = 0;
+        for (int r = r0; r < rows; r++) {
+            if (uf_find(parent, r) == root) comp_rows[nr++] = r;
+        }
+        for (int c = 0; c < cols; c++) {
+            if (uf_find(parent, rows + c) == root) comp_cols[nc++] = c;
+        }
+        if (nc == 0) continue;   // 孤立行
+        for (int i = 0; i < nr; i++) {
+            for (int j = 0; j < nc; j++) {
+                double d = dist[comp_rows[i] * cols + comp_cols[j]];
+                if (d < gate) cost[i * nc + j] = pow(d, order);
+                else cost[i * nc + j] = max_cardinality ? EVAL_UNMATCHED_COST : pow(gate, order);
+            }
+        }
+        if (tool_assign_min_cost(cost, nr, nc, sub) != 0) {
+            ret = -1;
+            goto out;
+        }
+        for (int i = 0; i < nr; i++) {
+            if (sub[i] >= 0 && dist[comp_rows[i] * cols + comp_cols[sub[i]]] < gate) {
+                match[comp_rows[i]] = comp_cols[sub[i]];
+            }
+        }
+    }
+out:
+    free(parent);
+    free(comp_rows);
+    free(comp_cols);
+    free(cost);
+    free(sub);
+    free(done);
+    return ret;
+}
+
+/* --- 精度累计 --- */
+
+typedef struct {
+    long frames;
+    long gt_total;
+    long pred_total;
+    long matches;
+    long misses;
+    long false_positives;
+    long id_switches;
+    double match_distance_sum;
+    double ospa_sum;
+    int peak_truth;
+    int peak_tracks;
+    eval_map_t last_match;      // 真值 ID -> 上次匹配的航迹 ID
+    eval_map_t pairs;           // (真值 ID, 航迹 ID) -> 门限内共现帧数
+} eval_accuracy_t;
+
+static int evaluate_frame(const eval_config_t *cfg, eval_accuracy_t *acc,
+                          const eval_object_t *gt, int ng, const eval_object_t *pred, int np) {
+    acc->frames++;
+    acc->gt_total += ng;
+    acc->pred_total += np;
+    if (ng > acc->peak_truth) acc->peak_truth = ng;
+    if (np > acc->peak_tracks) acc->peak_tracks = np;
+
+    double *dist = malloc(((size_t)ng * np + 1) * sizeof(double));
+    int *match = malloc((ng + 1) * sizeof(int));
+    if (!dist || !match) {
+        free(dist);
+        free(match);
+        return -1;
+    }
+    for (int i = 0; i < ng; i++) {
+        for (int j = 0; j < np; j++) {
+            dist[i * np + j] = hypot(gt[i].east - pred[j].east, gt[i].north - pred[j].north);
+        }
+    }
+
+    // OSPA：较小集合的每个元素都参与指派，截断距离外的配对与未配对代价相同
+    int n = ng > np ? ng : np;
+    double ospa = 0.0;
+    if (n > 0) {
+        double c_p = pow(cfg->ospa_cutoff, cfg->ospa_order);
+        if (gated_assign(dist, ng, np, cfg->ospa_cutoff, cfg->ospa_order, 0, match) != 0) goto fail;
+        double sum = 0.0;
+        int assigned = 0;
+        for (int i = 0; i < ng; i++) {
+            if (match[i] >= 0) {
+                sum += pow(dist[i * np + match[i]], cfg->ospa_order);
+                assigned++;
+            }
+        }
+        sum += c_p * (n - assigned);
+        ospa = pow(sum / n, 1.0 / cfg->ospa_order);
+    }
+    acc->ospa_sum += ospa;
+
+    // CLEAR MOT：门限内最大匹配，再比对每个真值上次匹配的航迹 ID
+    if (gated_assign(dist, ng, np, cfg->match_distance, 1.0, 1, match) != 0) goto fail;
+    int matched = 0;
+    for (int i = 0; i < ng; i++) {
+        if (match[i] < 0) continue;
+        matched++;
+        acc->match_distance_sum += dist[i * np + match[i]];
+        long *last = map_slot_for(&acc->last_match, pair_key(gt[i].id, 0) | 1);
+        if (!last) goto fail;
+        if (*last && *last != pred[match[i]].id) acc->id_switches++;
+        *last = pred[match[i]].id;
+    }
+    acc->matches += matched;
+    acc->misses += ng - matched;
+    acc->false_positives += np - matched;
+
+    // IDF1：门限内的每个 (真值, 航迹) 共现帧都计数，最后做全局一一对应
+    for (int i = 0; i < ng; i++) {
+        for (int j = 0; j < np; j++) {
+            if (dist[i * np + j] < cfg->match_distance) {
+                long *count = map_slot_for(&acc->pairs, pair_key(gt[i].id, pred[j].id));
+                if (!count) goto fail;
+                (*count)++;
+            }
+        }
+    }
+    free(dist);
+    free(match);
+    return 0;
+fail:
+    free(dist);
+    free(match);
+    return -1;
+}
+
+static int id_index(int *ids, int *count, int id) {
+    for (int i = 0; i < *count; i++) {
+        if (ids[i] == id) return i;
+    }
+    ids[*count] = id;
+    return (*count)++;
+}
+
+// 全局 ID 匹配的真正例数：在共现图的各连通分量上最大化匹配帧数
+static long idf1_true_positives(const eval_map_t *pairs) {
+    size_t np = pairs->count;
+    if (np == 0) return 0;
+    int *gt_ids = malloc(np * sizeof(int)), *tr_ids = malloc(np * sizeof(int));
+    int *pr = malloc(np * sizeof(int)), *pc = malloc(np * sizeof(int));
+    long *pv = malloc(np * sizeof(long));
+    long idtp = -1;
+    if (!gt_ids || !tr_ids || !pr || !pc || !pv) goto out;
+
+    // ID 数量远小于配对数，线性查找足够
+    int ng = 0, nt = 0;
+    size_t k = 0;
+    for (size_t i = 0; i < pairs->capacity; i++) {
+        if (!pairs->keys[i]) continue;
+        pr[k] = id_index(gt_ids, &ng, (int)(pairs->keys[i] >> 32));
+        pc[k] = id_index(tr_ids, &nt, (int)(uint32_t)pairs->keys[i]);
+        pv[k] = pairs->values[i];
+        k++;
+    }
+
+    double *dist = malloc((size_t)ng * nt * sizeof(double));
+    int *match = malloc(ng * sizeof(int));
+    long max_count = 0;
+    for (size_t i = 0; i < k; i++) if (pv[i] > max_count) max_count = pv[i];
+    if (dist && match) {
+        // 代价 = 最大计数 + 1 - 共现帧数，无共现的配对置于门限外
+        double gate = (double)max_count + 1.0;
+        for (size_t i = 0; i < (size_t)ng * nt; i++) dist[i] = gate;
+        for (size_t i = 0; i < k; i++) dist[pr[i] * nt + pc[i]] = gate - (double)pv[i];
+        if (gated_assign(dist, ng, nt, gate, 1.0, 0, match) == 0) {
+            idtp = 0;
+            for (int r = 0; r < ng; r++) {
+                if (match[r] >= 0) idtp += (long)(gate - dist[r * nt + match[r]] + 0.5);
+            }
+        }
+    }
+    free(dist);
+    free(match);
+out:
+    free(gt_ids);
+    free(tr_ids);
+    free(pr);
+    free(pc);
+    free(pv);
+    return idtp;
+}
+
+/* --- 时延统计 --- */
+
+static mec_time_ns_t thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (mec_time_ns_t)ts.tv_sec * MEC_NS_PER_SEC + ts.tv_nsec;
+}
+
+/* --- 回放 --- */
+
+typedef struct {
+    double ospa;
+    double mota;
+    double motp;
+    double idf1;
+    long id_switches;
+    double cycle_p50_us;
+    double cycle_p99_us;
+    double cpu_per_cycle_us;
+    long cycles;
+    long frames;
+} eval_result_t;
+
+// 按传感器拆分一组记录并投喂融合，时间戳取当前（虚拟）墙钟
+static void feed_group(fusion_processor_t *fusion, const scenario_group_t *g) {
+    struct timeval now;
+    mec_clock_wall(&now);
+    int first = 0;
+    while (first < g->count) {
+        int sensor_id = g->sensor_id[first];
+        int end = first;
+        while (end < g->count && g->sensor_id[end] == sensor_id) end++;
+        track_list_t *frame = track_list_create(end - first);
+        if (frame) {
+            for (int i = first; i < end; i++) {
+                target_track_t t;
+                memset(&t, 0, sizeof(t));
+                t.id = g->id[i];
+                t.type = (target_type_t)g->type[i];
+                t.position.latitude = g->latitude[i];
+                t.position.longitude = g->longitude[i];
+                t.velocity = g->velocity[i];
+                t.heading = g->heading[i];
+                t.confidence = g->confidence[i];
+                t.sensor_id = sensor_id;
+                t.timestamp = now;
+                track_list_add(frame, &t);
+            }
+            geo_tracks_to_enu(geo_get_site(), frame->tracks, frame->count);
+            if (sensor_id >= 1 && sensor_id <= 31) fusion_processor_add_tracks(fusion, frame, sensor_id);
+            track_list_release(frame);
+        }
+        first = end;
+    }
+}
+
+static int replay(const eval_config_t *cfg, const fusion_config_t *fusion_cfg,
+                  mec_scenario_t *sc, mec_scenario_t *truth, eval_result_t *res) {
+    fusion_processor_t *fusion = fusion_processor_create(fusion_cfg);
+    track_list_t *output = fusion ? track_list_create(fusion->track_capacity) : NULL;
+    eval_object_t *gt = NULL, *pred = NULL;
+    size_t gt_cap = 0;
+    eval_accuracy_t acc;
+    tool_samples_t cycle_us = { NULL, 0, 0 };
+    memset(&acc, 0, sizeof(acc));
+    int ret = -1;
+    if (!fusion || !output) goto out;
+    pred = malloc(fusion->track_capacity * sizeof(eval_object_t));
+    if (!pred) goto out;
+
+    mec_clock_set_virtual(1);
+    mec_time_ns_t base = mec_clock_now();
+    const geo_site_t *site = geo_get_site();
+
+    scenario_group_t g, tg;
+    int have_group = scenario_next(sc, &g) == 0;
+    int64_t next_tick = 0;
+    mec_time_ns_t cycle_real = 0, cycle_cpu = 0, cpu_total = 0;
+    long cycles = 0;
+
+    while (scenario_next(truth, &tg) == 0) {
+        // 推进到真值时刻：同一时刻先接入量测，再执行融合节拍
+        for (;;) {
+            int group_due = have_group && g.time_ms <= tg.time_ms && g.time_ms <= next_tick;
+            if (group_due) {
+                mec_clock_advance_to(base + g.time_ms * MEC_NS_PER_MS);
+                mec_time_ns_t r0 = mec_clock_real_ns(), c0 = thread_cpu_ns();
+                feed_group(fusion, &g);
+                cycle_real += mec_clock_real_ns() - r0;
+                cycle_cpu += thread_cpu_ns() - c0;
+                have_group = scenario_next(sc, &g) == 0;
+            } else if (next_tick <= tg.time_ms) {
+                mec_clock_advance_to(base + next_tick * MEC_NS_PER_MS);
+                mec_time_ns_t r0 = mec_clock_real_ns(), c0 = thread_cpu_ns();
+                fusion_processor_step(fusion);
+                fusion_processor_snapshot(fusion, output);
+                cycle_real += mec_clock_real_ns() - r0;
+                cycle_cpu += thread_cpu_ns() - c0;
+                tool_samples_push(&cycle_us, (double)cycle_real / MEC_NS_PER_US);
+                cpu_total += cycle_cpu;
+                cycles++;
+                cycle_real = cycle_cpu = 0;
+                next_tick += FUSION_TICK_MS;
+            } else {
+                break;
+            }
+        }
+
+        if ((size_t)tg.count > gt_cap) {
+            gt_cap = (size_t)tg.count * 2;
+            eval_object_t *grown = realloc(gt, gt_cap * sizeof(eval_object_t));
+            if (!grown) goto out;
+            gt = grown;
+        }
+        for (int i = 0; i < tg.count; i++) {
+            wgs84_coord_t pos = { tg.latitude[i], tg.longitude[i], 0.0 };
+            enu_coord_t local;
+            geo_wgs84_to_enu(site, &pos, &local);
+            gt[i].id = tg.id[i];
+            gt[i].east = local.east;
+            gt[i].north = local.north;
+        }
+        for (int j = 0; j < output->count; j++) {
+            pred[j].id = output->tracks[j].id;
+            pred[j].east = output->tracks[j].local.east;
+            pred[j].north = output->tracks[j].local.north;
+        }
+        if (evaluate_frame(cfg, &acc, gt, tg.count, pred, output->count) != 0) goto out;
+    }
+
+    long idtp = idf1_true_positives(&acc.pairs);
+    if (idtp < 0) goto out;
+    res->frames = acc.frames;
+    res->cycles = cycles;
+    res->ospa = acc.frames ? acc.ospa_sum / acc.frames : 0.0;
+    res->mota = acc.gt_total ? 1.0 - (double)(acc.misses + acc.false_positives + acc.id_switches) / acc.gt_total : 0.0;
+    res->motp = acc.matches ? acc.match_distance_sum / acc.matches : 0.0;
+    res->idf1 = (acc.gt_total + acc.pred_total) ? 2.0 * idtp / (double)(acc.gt_total + acc.pred_total) : 0.0;
+    res->id_switches = acc.id_switches;
+    qsort(cycle_us.data, cycle_us.count, sizeof(double), tool_compare_double);
+    res->cycle_p50_us = tool_percentile(cycle_us.data, cycle_us.count, 0.50);
+    res->cycle_p99_us = tool_percentile(cycle_us.data, cycle_us.count, 0.99);
+    res->cpu_per_cycle_us = cycles ? (double)cpu_total / MEC_NS_PER_US / cycles : 0.0;
+    fprintf(stderr, "Replayed %ld truth frames, %ld fusion cycles (peak %d truth / %d tracks, capacity %d); "
+                    "misses %ld, false positives %ld\n",
+            acc.frames, cycles, acc.peak_truth, acc.peak_tracks, fusion->track_capacity,
+            acc.misses, acc.false_positives);
+    ret = 0;
+out:
+    mec_clock_set_virtual(0);
+    map_free(&acc.last_match);
+    map_free(&acc.pairs);
+    tool_samples_free(&cycle_us);
+    free(gt);
+    free(pred);
+    track_list_release(output);
+    fusion_processor_destroy(fusion);
+    return ret;
+}
+
+/* --- 基线 --- */
+
+static int write_result(FILE *fp, const eval_result_t *r) {
+    fprintf(fp, "ospa = %.4f\n", r->ospa);
+    fprintf(fp, "mota = %.4f\n", r->mota);
+    fprintf(fp, "motp = %.4f\n", r->motp);
+    fprintf(fp, "idf1 = %.4f\n", r->idf1);
+    fprintf(fp, "id_switches = %ld\n", r->id_switches);
+    fprintf(fp, "cycle_p50_us = %.2f\n", r->cycle_p50_us);
+    fprintf(fp, "cycle_p99_us = %.2f\n", r->cycle_p99_us);
+    fprintf(fp, "cpu_per_cycle_us = %.2f\n", r->cpu_per_cycle_us);
+    return ferror(fp) ? -1 : 0;
+}
+
+static int write_baseline(const char *path, const eval_result_t *r, const char *scenario) {
+    FILE *fp = fopen(path, "w");
+    if (!fp) return -1;
+    fprintf(fp, "# mec_fusion_eval baseline for %s\n[baseline]\n", scenario);
+    int ret = write_result(fp, r);
+    if (fclose(fp) != 0) ret = -1;
+    return ret;
+}
+
+// 与基线比较；返回 1 表示回归
+static int compare_baseline(const eval_config_t *cfg, const eval_result_t *r, config_t *base) {
+    eval_result_t b;
+    config_get_double(base, "baseline.ospa", &b.ospa, r->ospa);
+    config_get_double(base, "baseline.mota", &b.mota, r->mota);
+    config_get_double(base, "baseline.idf1", &b.idf1, r->idf1);
+    config_get_double(base, "baseline.cycle_p50_us", &b.cycle_p50_us, r->cycle_p50_us);
+    config_get_double(base, "baseline.cycle_p99_us", &b.cycle_p99_us, r->cycle_p99_us);
+    config_get_double(base, "baseline.cpu_per_cycle_us", &b.cpu_per_cycle_us, r->cpu_per_cycle_us);
+
+    int accuracy_worse = 0, latency_worse = 0;
+    struct {
+        const char *name;
+        double now, base, limit;
+        int higher_is_worse;
+        int *flag;
+    } checks[] = {
+        { "ospa", r->ospa, b.ospa, b.ospa + cfg->ospa_tolerance, 1, &accuracy_worse },
+        { "mota", r->mota, b.mota, b.mota - cfg->mota_tolerance, 0, &accuracy_worse },
+        { "idf1", r->idf1, b.idf1, b.idf1 - cfg->idf1_tolerance, 0, &accuracy_worse },
+        { "cycle_p50_us", r->cycle_p50_us, b.cycle_p50_us, b.cycle_p50_us * (1.0 + cfg->latency_tolerance), 1, &latency_worse },
+        { "cycle_p99_us", r->cycle_p99_us, b.cycle_p99_us, b.cycle_p99_us * (1.0 + cfg->latency_p99_tolerance), 1, &latency_worse },
+        { "cpu_per_cycle_us", r->cpu_per_cycle_us, b.cpu_per_cycle_us, b.cpu_per_cycle_us * (1.0 + cfg->latency_tolerance), 1, &latency_worse },
+    };
+    for (size_t i = 0; i < sizeof(checks) / sizeof(checks[0]); i++) {
+        int bad = checks[i].higher_is_worse ? checks[i].now > checks[i].limit : checks[i].now < checks[i].limit;
+        if (bad) *checks[i].flag = 1;
+        printf("%-18s %12.4f  baseline %12.4f  limit %12.4f  %s\n", checks[i].name, checks[i].now,
+               checks[i].base, checks[i].limit, bad ? "REGRESSED" : "ok");
+    }
+
+    int faster = r->cpu_per_cycle_us < b.cpu_per_cycle_us;
+    if (accuracy_worse && faster) printf("FAIL: accuracy traded for speed beyond tolerance\n");
+    else if (accuracy_worse) printf("FAIL: accuracy regression\n");
+    else if (latency_worse) printf("FAIL: latency regression\n");
+    else printf("PASS\n");
+    return accuracy_worse || latency_worse;
+}
+
+static void load_config(config_t *config, eval_config_t *cfg, fusion_config_t *fusion_cfg) {
+    config_get_double(config, "eval.match_distance", &cfg->match_distance, 2.0);
+    config_get_double(config, "eval.ospa_cutoff", &cfg->ospa_cutoff, 10.0);
+    config_get_double(config, "eval.ospa_order", &cfg->ospa_order, 1.0);
+    config_get_double(config, "eval.ospa_tolerance", &cfg->ospa_tolerance, 0.05);
+    config_get_double(config, "eval.mota_tolerance", &cfg->mota_tolerance, 0.01);
+    config_get_double(config, "eval.idf1_tolerance", &cfg->idf1_tolerance, 0.01);
+    config_get_double(config, "eval.latency_tolerance", &cfg->latency_tolerance, 0.25);
+    config_get_double(config, "eval.latency_p99_tolerance", &cfg->latency_p99_tolerance, 0.5);
+
+    config_get_double(config, "fusion.association_threshold", &fusion_cfg->association_threshold, 5.0);
+    config_get_double(config, "fusion.position_weight", &fusion_cfg->position_weight, 1.0);
+    config_get_double(config, "fusion.velocity_weight", &fusion_cfg->velocity_weight, 0.1);
+    config_get_double(config, "fusion.confidence_threshold", &fusion_cfg->confidence_threshold, 0.3);
+    config_get_int(config, "fusion.max_track_age", &fusion_cfg->max_track_age, 50);
+    config_get_int(config, "fusion.max_tracks", &fusion_cfg->max_tracks, FUSION_DEFAULT_MAX_TRACKS);
+
+    double lat, lon, alt;
+    config_get_double(config, "site.latitude", &lat, GEO_DEFAULT_SITE_LAT);
+    config_get_double(config, "site.longitude", &lon, GEO_DEFAULT_SITE_LON);
+    config_get_double(config, "site.altitude", &alt, 0.0);
+    geo_site_t site;
+    if (geo_site_init(&site, lat, lon, alt) == 0) geo_set_site(&site);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-c CONFIG] --scenario PATH --truth PATH [--baseline PATH] [--write-baseline PATH]\n",
+            prog);
+}
+
+int main(int argc, char *argv[]) {
+    const char *config_path = "config/mec.conf";
+    const char *scenario_path = NULL, *truth_path = NULL;
+    const char *baseline_path = NULL, *write_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!val) {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+        if (strcmp(arg, "-c") == 0) config_path = val;
+        else if (strcmp(arg, "--scenario") == 0) scenario_path = val;
+        else if (strcmp(arg, "--truth") == 0) truth_path = val;
+        else if (strcmp(arg, "--baseline") == 0) baseline_path = val;
+        else if (strcmp(arg, "--write-baseline") == 0) write_path = val;
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!scenario_path || !truth_path) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    log_init("/tmp/mec_fusion_eval.log", LOG_WARN);
+    mec_memory_init();
+
+    config_t *config = NULL;
+    if (config_load(&config, config_path) != MEC_OK) {
+        fprintf(stderr, "Cannot load config %s\n", config_path);
+        return 1;
+    }
+    eval_config_t cfg;
+    fusion_config_t fusion_cfg;
+    memset(&fusion_cfg, 0, sizeof(fusion_cfg));
+    load_config(config, &cfg, &fusion_cfg);
+    config_free(config);
+
+    mec_scenario_t sc, truth;
+    if (scenario_open(&sc, scenario_path) != 0) {
+        fprintf(stderr, "Cannot open scenario %s\n", scenario_path);
+        return 1;
+    }
+    if (scenario_open(&truth, truth_path) != 0) {
+        fprintf(stderr, "Cannot open truth %s\n", truth_path);
+        scenario_close(&sc);
+        return 1;
+    }
+
+    eval_result_t result;
+    memset(&result, 0, sizeof(result));
+    int ret = replay(&cfg, &fusion_cfg, &sc, &truth, &result);
+    scenario_close(&sc);
+    scenario_close(&truth);
+    if (ret != 0) {
+        fprintf(stderr, "Replay failed\n");
+        return 1;
+    }
+
+    write_result(stdout, &result);
+    int status = 0;
+    if (write_path) {
+        if (write_baseline(write_path, &result, scenario_path) != 0) {
+            fprintf(stderr, "Cannot write baseline %s\n", write_path);
+            status = 1;
+        }
+    }
+    if (baseline_path) {
+        config_t *base = NULL;
+        if (config_load(&base, baseline_path) != MEC_OK) {
+            fprintf(stderr, "Cannot load baseline %s\n", baseline_path);
+            status = 1;
+        } else {
+            if (compare_baseline(&cfg, &result, base)) status = 2;
+            config_free(base);
+        }
+    }
+
+    mec_memory_cleanup();
+    log_cleanup();
+    return status;
+}
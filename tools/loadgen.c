@@ -0,0 +1,515 @@
+#define _GNU_SOURCE  // posix_openpt / ptsname
+#include "mec_radar.h"
+#include "mec_shm_ring.h"
+#include "mec_geo.h"
+#include "mec_clock.h"
+#include "mec_logging.h"
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+/**
+ * @file loadgen.c
+ * @brief 实时传感器负载发生器
+ *
+ * 与文件模拟器不同，经由真实的接入路径向 mec_system 施加负载：
+ *   --pty N      N 路串口雷达：创建 pty 对，从主端写 0xAA55 帧，mec_system 打开从端
+ *                (--pty-link 为从端建立固定路径的符号链接，便于写进配置)
+ *   --udp H:P    UDP 雷达：第 i 路发往端口 P+i，每个扫描周期组成一个或多个数据报
+ *   --can IF     SocketCAN 雷达（如 vcan0）：第 i 路使用 ID base + 0x10*i
+ *   --camera N   模拟相机检测：经接入套接字附加共享内存环写入检测结果（只写 WGS84，
+ *                站点 ENU 由接入桥补算；--site 应与 mec_system 的 [site] 一致）
+ * 每路一个线程，按绝对时间节拍发送。雷达帧在数据段 [10..13]（CAN 在头帧 [3..6]）、
+ * 相机检测在槽时间戳中携带发送时刻，mec_system 据此统计端到端时延（雷达需在配置中
+ * 设置 sensor_timestamps = 1，否则按接收时刻计）。
+ *
+ * 用法: mec_loadgen [--pty N] [--pty-link PREFIX] [--baud B] [--udp HOST:PORT] [--udp-count N]
+ *                   [--can IF] [--can-count N] [--can-base ID] [--camera N] [--socket PATH]
+ *                   [--camera-sensor ID] [--site LAT,LON] [--rate HZ] [--targets N] [--duration S]
+ */
+
+#define LG_MAX_EMITTERS 64
+#define LG_REPORT_SEC 5
+
+typedef enum {
+    LG_PTY = 0,
+    LG_UDP,
+    LG_CAN,
+    LG_CAMERA
+} lg_kind_t;
+
+static const char *kind_name[] = { "pty", "udp", "can", "camera" };
+
+typedef struct {
+    lg_kind_t kind;
+    int index;
+    int fd;
+    char name[128];             // pty 从端路径 / UDP 目的地址 / CAN 接口
+    char link[128];             // pty 符号链接，退出时删除
+    struct sockaddr_in addr;
+    int can_base;
+    int sensor_id;              // 相机检测的传感器 ID
+    shm_ring_t ring;
+    pthread_t thread;
+    long scans;
+    long frames;                // 雷达帧 / CAN 帧 / 检测目标数
+    long bytes;
+    long errors;                // 写失败（对端未打开、缓冲区满、环满）
+} lg_emitter_t;
+
+typedef struct {
+    double rate_hz;
+    int targets;
+    double duration_s;
+    int baud;                   // >0 时 pty 按线路速率逐帧发送
+} lg_options_t;
+
+static volatile sig_atomic_t running = 1;
+static lg_options_t g_opt = { 10.0, 32, 0.0, 0 };
+
+static void signal_handler(int sig) {
+    (void)sig;
+    running = 0;
+}
+
+static uint32_t stamp_now_us(void) {
+    struct timeval now;
+    mec_clock_wall(&now);
+    uint32_t stamp = (uint32_t)(mec_time_from_timeval(&now) / MEC_NS_PER_US);
+    return stamp ? stamp : 1;   // 0 表示不带时间戳
+}
+
+static void timespec_add_ns(struct timespec *ts, long ns) {
+    ts->tv_nsec += ns;
+    while (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+/* --- 目标与编码 --- */
+
+typedef struct {
+    int id;
+    double range;               // m
+    double angle;               // 度
+    double velocity;            // m/s
+    double rcs;
+} lg_target_t;
+
+// 第 i 个目标在 t 时刻：沿径向往返运动，角度缓慢扫过视场
+static void target_at(int emitter, int i, double t, lg_target_t *out) {
+    double phase = emitter * 0.37 + i * 1.3;
+    out->id = i + 1;
+    out->velocity = 5.0 + (i % 7) * 2.0;
+    double span = 150.0;
+    double d = fmod(out->velocity * t + phase * 40.0, 2.0 * span);
+    out->range = 10.0 + (d < span ? d : 2.0 * span - d);
+    out->angle = -45.0 + fmod(i * 11.0 + 3.0 * t + phase, 90.0);
+    out->rcs = 5.0 + (i % 10);
+}
+
+static void put_u16(unsigned char *p, int v) {
+    if (v < 0) v = 0;
+    if (v > 0xFFFF) v = 0xFFFF;
+    p[0] = (unsigned char)(v >> 8);
+    p[1] = (unsigned char)v;
+}
+
+static void put_u32(unsigned char *p, uint32_t v) {
+    p[0] = (unsigned char)(v >> 24);
+    p[1] = (unsigned char)(v >> 16);
+    p[2] = (unsigned char)(v >> 8);
+    p[3] = (unsigned char)v;
+}
+
+// 编码一个 0xAA55 帧，格式见 radar_decode_frame
+static void encode_frame(unsigned char *f, const lg_target_t *t, uint32_t stamp_us) {
+    unsigned char *d = f + 2;
+    f[0] = RADAR_FRAME_HEAD1;
+    f[1] = RADAR_FRAME_HEAD2;
+    put_u16(d + 0, t->id);
+    put_u16(d + 2, (int)lround(t->range * 10.0));
+    put_u16(d + 4, (int)lround((t->angle + 180.0) * 10.0));
+    put_u16(d + 6, (int)lround(t->velocity * 10.0));
+    put_u16(d + 8, (int)lround((t->rcs + 50.0) * 10.0));
+    put_u32(d + 10, stamp_us);
+    unsigned char checksum = 0;
+    for (int k = 0; k < RADAR_FRAME_DATA_LEN; k++) checksum ^= d[k];
+    f[RADAR_FRAME_LEN - 1] = checksum;
+}
+
+/* --- 各接入方式的打开与发送 --- */
+
+static int open_pty(lg_emitter_t *em, const char *link_prefix) {
+    em->fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (em->fd < 0 || grantpt(em->fd) != 0 || unlockpt(em->fd) != 0) {
+        fprintf(stderr, "pty %d: cannot allocate (%s)\n", em->index, strerror(errno));
+        return -1;
+    }
+    const char *slave = ptsname(em->fd);
+    if (!slave) return -1;
+    snprintf(em->name, sizeof(em->name), "%s", slave);
+    if (link_prefix) {
+        snprintf(em->link, sizeof(em->link), "%s%d", link_prefix, em->index + 1);
+        unlink(em->link);
+        if (symlink(slave, em->link) != 0) {
+            fprintf(stderr, "pty %d: cannot link %s (%s)\n", em->index, em->link, strerror(errno));
+            em->link[0] = '\0';
+        }
+    }
+    return 0;
+}
+
+static int open_udp(lg_emitter_t *em, const char *host, int port) {
+    em->fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (em->fd < 0) return -1;
+    memset(&em->addr, 0, sizeof(em->addr));
+    em->addr.sin_family = AF_INET;
+    em->addr.sin_port = htons((uint16_t)(port + em->index));
+    if (inet_pton(AF_INET, host, &em->addr.sin_addr) != 1) {
+        fprintf(stderr, "udp: invalid address %s\n", host);
+        return -1;
+    }
+    snprintf(em->name, sizeof(em->name), "%s:%d", host, port + em->index);
+    return 0;
+}
+
+static int open_can(lg_emitter_t *em, const char *ifname, int base) {
+    em->fd = socket(PF_CAN, SOCK_RAW | SOCK_CLOEXEC, CAN_RAW);
+    if (em->fd < 0) {
+        fprintf(stderr, "can: socket failed (%s)\n", strerror(errno));
+        return -1;
+    }
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    snprintf(ifr.ifr_name, IFNAMSIZ, "%s", ifname);
+    if (ioctl(em->fd, SIOCGIFINDEX, &ifr) != 0) {
+        fprintf(stderr, "can: interface %s not found\n", ifname);
+        return -1;
+    }
+    struct sockaddr_can addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(em->fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "can: bind to %s failed (%s)\n", ifname, strerror(errno));
+        return -1;
+    }
+    em->can_base = base + 0x10 * em->index;
+    snprintf(em->name, sizeof(em->name), "%s/0x%03X", ifname, em->can_base);
+    return 0;
+}
+
+static void send_pty(lg_emitter_t *em, double t) {
+    unsigned char buf[RADAR_FRAME_LEN * 256];
+    int per_write = (int)(sizeof(buf) / RADAR_FRAME_LEN);
+    struct timespec line;
+    clock_gettime(CLOCK_MONOTONIC, &line);
+    long frame_ns = g_opt.baud > 0 ? (long)(RADAR_FRAME_LEN * 10 * 1e9 / g_opt.baud) : 0;
+
+    // 按线路速率发送时逐帧写入，否则一次写出整批
+    int step = frame_ns > 0 ? 1 : per_write;
+    for (int first = 0; first < g_opt.targets && running; first += step) {
+        int n = g_opt.targets - first < step ? g_opt.targets - first : step;
+        uint32_t stamp = stamp_now_us();
+        for (int i = 0; i < n; i++) {
+            lg_target_t tgt;
+            target_at(em->index, first + i, t, &tgt);
+            encode_frame(buf + i * RADAR_FRAME_LEN, &tgt, stamp);
+        }
+        ssize_t w = write(em->fd, buf, (size_t)n * RADAR_FRAME_LEN);
+        if (w == (ssize_t)n * RADAR_FRAME_LEN) {
+            em->frames += n;
+            em->bytes += w;
+        } else {
+            em->errors++;   // 从端未打开或 tty 缓冲区已满
+        }
+        if (frame_ns > 0) {
+            timespec_add_ns(&line, frame_ns);
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &line, NULL);
+        }
+    }
+}
+
+static void send_udp(lg_emitter_t *em, double t) {
+    unsigned char buf[RADAR_UDP_MAX_DATAGRAM];
+    int per_datagram = RADAR_UDP_MAX_DATAGRAM / RADAR_FRAME_LEN;
+    for (int first = 0; first < g_opt.targets; first += per_datagram) {
+        int n = g_opt.targets - first < per_datagram ? g_opt.targets - first : per_datagram;
+        uint32_t stamp = stamp_now_us();
+        for (int i = 0; i < n; i++) {
+            lg_target_t tgt;
+            target_at(em->index, first + i, t, &tgt);
+            encode_frame(buf + i * RADAR_FRAME_LEN, &tgt, stamp);
+        }
+        ssize_t w = sendto(em->fd, buf, (size_t)n * RADAR_FRAME_LEN, 0,
+                           (struct sockaddr*)&em->addr, sizeof(em->addr));
+        if (w > 0) {
+            em->frames += n;
+            em->bytes += w;
+        } else {
+            em->errors++;
+        }
+    }
+}
+
+static void send_can(lg_emitter_t *em, double t) {
+    // 头帧声明目标数（8 位），超出的目标不发送
+    int n = g_opt.targets > 255 ? 255 : g_opt.targets;
+    struct can_frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.can_id = (canid_t)em->can_base;
+    frame.can_dlc = 7;
+    frame.data[0] = (unsigned char)n;
+    put_u16(frame.data + 1, (int)(em->scans & 0xFFFF));
+    put_u32(frame.data + 3, stamp_now_us());
+    if (write(em->fd, &frame, sizeof(frame)) != sizeof(frame)) {
+        em->errors++;
+        return;
+    }
+    em->bytes += sizeof(frame);
+
+    for (int i = 0; i < n; i++) {
+        lg_target_t tgt;
+        target_at(em->index, i, t, &tgt);
+        memset(&frame, 0, sizeof(frame));
+        frame.can_id = (canid_t)(em->can_base + 1);
+        frame.can_dlc = 8;
+        frame.data[0] = (unsigned char)tgt.id;
+        put_u16(frame.data + 1, (int)lround(tgt.range * 10.0));
+        put_u16(frame.data + 3, (int)lround((tgt.angle + 180.0) * 10.0));
+        put_u16(frame.data + 5, (int)lround(tgt.velocity * 10.0));
+        int rcs = (int)lround((tgt.rcs + 64.0) * 2.0);
+        frame.data[7] = (unsigned char)(rcs < 0 ? 0 : (rcs > 255 ? 255 : rcs));
+        if (write(em->fd, &frame, sizeof(frame)) != sizeof(frame)) {
+            em->errors++;   // 发送队列满 (ENOBUFS)
+            continue;
+        }
+        em->frames++;
+        em->bytes += sizeof(frame);
+    }
+}
+
+static void send_camera(lg_emitter_t *em, double t) {
+    int capacity = 0;
+    target_track_t *slot = shm_ring_begin(&em->ring, &capacity);
+    if (!slot) {
+        em->errors++;
+        return;
+    }
+    struct timeval now;
+    mec_clock_wall(&now);
+    const geo_site_t *site = geo_get_site();
+    int n = g_opt.targets < capacity ? g_opt.targets : capacity;
+    for (int i = 0; i < n; i++) {
+        lg_target_t tgt;
+        target_at(em->index + 100, i, t, &tgt);
+        double a = tgt.angle * M_PI / 180.0;
+        target_track_t *tr = &slot[i];
+        memset(tr, 0, sizeof(*tr));
+        tr->id = i + 1;
+        tr->type = (i % 5 == 4) ? TARGET_PEDESTRIAN : TARGET_VEHICLE;
+        tr->local.east = tgt.range * cos(a);
+        tr->local.north = tgt.range * sin(a);
+        geo_enu_to_wgs84(site, &tr->local, &tr->position);
+        tr->velocity = tgt.velocity;
+        tr->heading = tgt.angle;
+        tr->confidence = 0.8;
+        tr->timestamp = now;
+        tr->sensor_id = em->sensor_id;
+    }
+    if (shm_ring_commit(&em->ring, em->sensor_id, n, &now) == 0) {
+        em->frames += n;
+        em->bytes += (long)n * (long)sizeof(target_track_t);
+    } else {
+        em->errors++;
+    }
+}
+
+static void* emitter_thread(void *arg) {
+    lg_emitter_t *em = (lg_emitter_t*)arg;
+    const long period_ns = (long)(1e9 / g_opt.rate_hz);
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    mec_time_ns_t start = mec_clock_now();
+
+    while (running) {
+        double t = mec_time_to_ms(mec_clock_now() - start) / 1000.0;
+        if (g_opt.duration_s > 0.0 && t >= g_opt.duration_s) break;
+        switch (em->kind) {
+            case LG_PTY: send_pty(em, t); break;
+            case LG_UDP: send_udp(em, t); break;
+            case LG_CAN: send_can(em, t); break;
+            case LG_CAMERA: send_camera(em, t); break;
+        }
+        em->scans++;
+        timespec_add_ns(&next, period_ns);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+    return NULL;
+}
+
+static void report(const lg_emitter_t *emitters, int count, double elapsed_s) {
+    for (int i = 0; i < count; i++) {
+        const lg_emitter_t *em = &emitters[i];
+        printf("  %-6s %-24s %8ld scans %.1f/s  %10ld frames  %12ld bytes  %6ld errors\n",
+               kind_name[em->kind], em->name, em->scans, elapsed_s > 0 ? em->scans / elapsed_s : 0.0,
+               em->frames, em->bytes, em->errors);
+    }
+    fflush(stdout);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [--pty N] [--pty-link PREFIX] [--baud B] [--udp HOST:PORT] [--udp-count N]\n"
+            "       [--can IF] [--can-count N] [--can-base ID] [--camera N] [--socket PATH]\n"
+            "       [--camera-sensor ID] [--site LAT,LON] [--rate HZ] [--targets N] [--duration S]\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    int pty_count = 0, udp_count = 1, can_count = 1, camera_count = 0;
+    const char *pty_link = NULL;
+    const char *udp_target = NULL;
+    const char *can_ifname = NULL;
+    int can_base = RADAR_CAN_DEFAULT_BASE;
+    const char *socket_path = "/tmp/mec_ingest.sock";
+    int camera_sensor = 10;
+    double site_lat = GEO_DEFAULT_SITE_LAT, site_lon = GEO_DEFAULT_SITE_LON;
+    int site_ok = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!val) {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+        if (strcmp(arg, "--pty") == 0) pty_count = atoi(val);
+        else if (strcmp(arg, "--pty-link") == 0) pty_link = val;
+        else if (strcmp(arg, "--baud") == 0) g_opt.baud = atoi(val);
+        else if (strcmp(arg, "--udp") == 0) udp_target = val;
+        else if (strcmp(arg, "--udp-count") == 0) udp_count = atoi(val);
+        else if (strcmp(arg, "--can") == 0) can_ifname = val;
+        else if (strcmp(arg, "--can-count") == 0) can_count = atoi(val);
+        else if (strcmp(arg, "--can-base") == 0) can_base = (int)strtol(val, NULL, 0);
+        else if (strcmp(arg, "--camera") == 0) camera_count = atoi(val);
+        else if (strcmp(arg, "--socket") == 0) socket_path = val;
+        else if (strcmp(arg, "--camera-sensor") == 0) camera_sensor = atoi(val);
+        else if (strcmp(arg, "--site") == 0) site_ok = sscanf(val, "%lf,%lf", &site_lat, &site_lon) == 2;
+        else if (strcmp(arg, "--rate") == 0) g_opt.rate_hz = atof(val);
+        else if (strcmp(arg, "--targets") == 0) g_opt.targets = atoi(val);
+        else if (strcmp(arg, "--duration") == 0) g_opt.duration_s = atof(val);
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    geo_site_t site_origin;
+    if (g_opt.rate_hz <= 0.0 || g_opt.targets < 0 || camera_sensor < 1 || !site_ok ||
+        geo_site_init(&site_origin, site_lat, site_lon, 0.0) != 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    geo_set_site(&site_origin);   // 发送线程启动前设置
+
+    static lg_emitter_t emitters[LG_MAX_EMITTERS];
+    int count = 0, failed = 0;
+    char host[64] = "127.0.0.1";
+    int port = 5000;
+    if (udp_target) {
+        const char *colon = strrchr(udp_target, ':');
+        if (!colon) {
+            usage(argv[0]);
+            return 1;
+        }
+        snprintf(host, sizeof(host), "%.*s", (int)(colon - udp_target), udp_target);
+        port = atoi(colon + 1);
+    }
+
+    // 逐类创建各路发送端
+    struct { lg_kind_t kind; int n; } plan[] = {
+        { LG_PTY, pty_count }, { LG_UDP, udp_target ? udp_count : 0 },
+        { LG_CAN, can_ifname ? can_count : 0 }, { LG_CAMERA, camera_count }
+    };
+    for (size_t p = 0; p < sizeof(plan) / sizeof(plan[0]) && !failed; p++) {
+        for (int i = 0; i < plan[p].n && !failed; i++) {
+            if (count >= LG_MAX_EMITTERS) {
+                fprintf(stderr, "At most %d emitters\n", LG_MAX_EMITTERS);
+                failed = 1;
+                break;
+            }
+            lg_emitter_t *em = &emitters[count++];
+            em->kind = plan[p].kind;
+            em->index = i;
+            em->fd = -1;
+            switch (em->kind) {
+                case LG_PTY: failed = open_pty(em, pty_link) != 0; break;
+                case LG_UDP: failed = open_udp(em, host, port) != 0; break;
+                case LG_CAN: failed = open_can(em, can_ifname, can_base) != 0; break;
+                case LG_CAMERA:
+                    em->sensor_id = camera_sensor + i;
+                    snprintf(em->name, sizeof(em->name), "sensor %d", em->sensor_id);
+                    failed = shm_ring_connect(&em->ring, socket_path) != 0;
+                    break;
+            }
+        }
+    }
+    if (count == 0 && !failed) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (!failed) {
+        printf("Emitting %d targets at %.1f Hz on %d sensors:\n", g_opt.targets, g_opt.rate_hz, count);
+        for (int i = 0; i < count; i++) {
+            printf("  %-6s %s%s%s\n", kind_name[emitters[i].kind], emitters[i].name,
+                   emitters[i].link[0] ? " -> " : "", emitters[i].link);
+        }
+        fflush(stdout);
+
+        int started = 0;
+        for (; started < count; started++) {
+            if (pthread_create(&emitters[started].thread, NULL, emitter_thread, &emitters[started]) != 0) {
+                running = 0;
+                break;
+            }
+        }
+        mec_time_ns_t start = mec_clock_now();
+        mec_time_ns_t last_report = start;
+        while (running) {
+            double elapsed = mec_time_to_ms(mec_clock_now() - start) / 1000.0;
+            if (g_opt.duration_s > 0.0 && elapsed >= g_opt.duration_s) break;
+            usleep(100000);
+            if (mec_clock_now() - last_report >= LG_REPORT_SEC * MEC_NS_PER_SEC) {
+                last_report = mec_clock_now();
+                printf("[%.0f s]\n", elapsed);
+                report(emitters, count, elapsed);
+            }
+        }
+        running = 0;
+        for (int i = 0; i < started; i++) pthread_join(emitters[i].thread, NULL);
+        printf("Total:\n");
+        report(emitters, count, mec_time_to_ms(mec_clock_now() - start) / 1000.0);
+    }
+
+    for (int i = 0; i < count; i++) {
+        lg_emitter_t *em = &emitters[i];
+        if (em->kind == LG_CAMERA) shm_ring_close(&em->ring);
+        else if (em->fd >= 0) close(em->fd);
+        if (em->link[0]) unlink(em->link);
+    }
+    return failed ? 1 : 0;
+}
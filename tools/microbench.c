@@ -0,0 +1,655 @@
+#define _GNU_SOURCE  // pthread_setaffinity_np / sched_getcpu
+#include "mec_fusion.h"
+#include "mec_radar.h"
+#include "mec_queue.h"
+#include "mec_v2x.h"
+#include "mec_geo.h"
+#include "mec_clock.h"
+#include "mec_logging.h"
+#include "tool_common.h"
+#include <sched.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * @file microbench.c
+ * @brief 热点内核微基准
+ *
+ * 每个用例由 setup / prepare / batch / teardown 组成：prepare 在每批之前执行且不计时
+ * （如重置滤波状态、向管道写入待解析的字节），batch 执行固定次数的操作并计时。
+ * 先跑若干批预热，再采样 --repeat 批，报告每次操作耗时的中位数与最小值以及周期数。
+ *
+ * 周期数优先取 perf_event 的 CPU 周期计数（仅计本线程用户态），不可用时退回 TSC
+ * (x86) 或通用定时器 (aarch64)。两者都按固定参考频率计数、与核心主频无关，
+ * 输出标为 ticks 而非 cycles，并给出计数频率（TSC 为启动时实测值）。主线程绑定到 --cpu 指定的核（默认当前核），
+ * 队列争用用例的生产者线程绑定到其余核。
+ *
+ * 日志级别设为 ERROR：内存池耗尽、队列满等告警不计入被测路径。
+ *
+ * 用法: mec_microbench [--filter SUBSTR] [--repeat N] [--warmup N] [--cpu N] [--json PATH] [--list]
+ */
+
+#define MB_MAX_CASES 64
+#define MB_TRACKS 256               // 滤波类用例每批处理的航迹数
+#define MB_QUEUE_BATCH 256
+#define MB_RADAR_FRAMES (RADAR_RX_BUF_SIZE / RADAR_FRAME_LEN)   // 与一次串口 read 能取回的整帧数相同
+
+typedef struct mb_case mb_case_t;
+
+struct mb_case {
+    const char *name;
+    long ops;                       // 每批操作数
+    int param[2];
+    int (*setup)(mb_case_t *c);
+    void (*prepare)(mb_case_t *c);
+    void (*batch)(mb_case_t *c);
+    void (*teardown)(mb_case_t *c);
+    void *state;
+    char label[64];
+};
+
+typedef struct {
+    const char *name;
+    long ops;
+    int samples;
+    double ns_median, ns_min, ns_p90;
+    double cycles_median;           // -1 表示无周期计数
+} mb_result_t;
+
+static int g_cpu = -1;
+static int g_perf_fd = -1;
+static const char *g_cycle_unit = "cycles";    // 计数单位：cycles 或 ticks (aarch64 通用定时器)
+static double g_tick_hz = 0.0;                  // 参考计数器频率，仅 ticks 时有效
+static volatile long g_sink;        // 防止被测结果被优化掉
+
+/* --- 周期计数 --- */
+
+static const char* cycles_open(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    g_perf_fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (g_perf_fd >= 0) return "perf";
+#if defined(__x86_64__) || defined(__i386__)
+    // TSC 频率无可移植的查询接口，按 20ms 真实时间实测
+    mec_time_ns_t t0 = mec_clock_real_ns();
+    uint64_t c0 = __rdtsc();
+    while (mec_clock_real_ns() - t0 < 20 * MEC_NS_PER_MS) {}
+    uint64_t c1 = __rdtsc();
+    mec_time_ns_t t1 = mec_clock_real_ns();
+    g_cycle_unit = "ticks";
+    g_tick_hz = (double)(c1 - c0) * MEC_NS_PER_SEC / (double)(t1 - t0);
+    return "tsc";
+#elif defined(__aarch64__)
+    uint64_t freq;
+    __asm__ volatile("mrs %0, cntfrq_el0" : "=r"(freq));
+    g_cycle_unit = "ticks";
+    g_tick_hz = (double)freq;
+    return "cntvct";
+#else
+    return "none";
+#endif
+}
+
+static int64_t cycles_now(void) {
+    if (g_perf_fd >= 0) {
+        uint64_t v = 0;
+        if (read(g_perf_fd, &v, sizeof(v)) == (ssize_t)sizeof(v)) return (int64_t)v;
+        return -1;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    return (int64_t)__rdtsc();
+#elif defined(__aarch64__)
+    uint64_t v;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(v));
+    return (int64_t)v;
+#else
+    return -1;
+#endif
+}
+
+static int pin_thread(pthread_t thread, int cpu) {
+    if (cpu < 0) return -1;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(thread, sizeof(set), &set);
+}
+
+/* --- 公共数据 --- */
+
+static void make_track(int i, target_track_t *t) {
+    memset(t, 0, sizeof(*t));
+    t->id = i + 1;
+    t->type = TARGET_VEHICLE;
+    t->local.east = (i % 16) * 12.0;
+    t->local.north = (i / 16) * 12.0;
+    t->velocity = 10.0;
+    t->heading = (i * 37) % 360;
+    t->confidence = 0.9;
+    mec_clock_wall(&t->timestamp);
+}
+
+static track_list_t* make_list(int count) {
+    track_list_t *list = track_list_create(count > 0 ? count : 1);
+    if (!list) return NULL;
+    for (int i = 0; i < count; i++) {
+        target_track_t t;
+        make_track(i, &t);
+        track_list_add(list, &t);
+    }
+    geo_tracks_to_wgs84(geo_get_site(), list->tracks, list->count);
+    return list;
+}
+
+/* --- 卡尔曼滤波与距离 --- */
+
+typedef struct {
+    fused_track_t init[MB_TRACKS];
+    fused_track_t work[MB_TRACKS];
+    target_track_t meas[MB_TRACKS];
+} mb_filter_t;
+
+static int filter_setup(mb_case_t *c) {
+    mb_filter_t *f = calloc(1, sizeof(mb_filter_t));
+    if (!f) return -1;
+    for (int i = 0; i < MB_TRACKS; i++) {
+        target_track_t t;
+        make_track(i, &t);
+        f->init[i].global_id = i + 1;
+        f->init[i].last_update = t.timestamp;
+        initialize_kalman_filter(&f->init[i].filter_state, &t);
+        f->meas[i] = t;
+        f->meas[i].local.east += 0.3;
+        f->meas[i].local.north -= 0.2;
+    }
+    c->state = f;
+    return 0;
+}
+
+static void filter_prepare(mb_case_t *c) {
+    mb_filter_t *f = c->state;
+    memcpy(f->work, f->init, sizeof(f->work));
+}
+
+static void filter_teardown(mb_case_t *c) {
+    free(c->state);
+}
+
+static void predict_batch(mb_case_t *c) {
+    mb_filter_t *f = c->state;
+    for (int i = 0; i < MB_TRACKS; i++) predict_track_state(&f->work[i], 0.05);
+}
+
+static void update_batch(mb_case_t *c) {
+    mb_filter_t *f = c->state;
+    for (int i = 0; i < MB_TRACKS; i++) update_kalman_filter(&f->work[i].filter_state, &f->meas[i]);
+}
+
+static void distance_batch(mb_case_t *c) {
+    mb_filter_t *f = c->state;
+    double sum = 0.0;
+    for (int i = 0; i < MB_TRACKS; i++) sum += calculate_track_distance(&f->work[i], &f->meas[i]);
+    g_sink += (long)sum;
+}
+
+/* --- 关联 (fusion_processor_add_tracks) --- */
+
+// param[0] = 融合航迹数 N，param[1] = 每帧量测数 M；state 中记录是否强制缓存未命中
+typedef struct {
+    fusion_processor_t *fusion;
+    track_list_t *frame;
+    int search;                 // 1: 每批换用新的上游 ID，迫使走全量关联搜索
+    int round;
+} mb_assoc_t;
+
+static int assoc_setup(mb_case_t *c, int search) {
+    mb_assoc_t *a = calloc(1, sizeof(mb_assoc_t));
+    if (!a) return -1;
+    fusion_config_t cfg = { 5.0, 1.0, 0.1, 0.3, 1 << 30, c->param[0] };
+    a->fusion = fusion_processor_create(&cfg);
+    track_list_t *seed = make_list(c->param[0]);
+    a->frame = make_list(c->param[1]);
+    if (!a->fusion || !seed || !a->frame) {
+        track_list_release(seed);
+        track_list_release(a->frame);
+        fusion_processor_destroy(a->fusion);
+        free(a);
+        return -1;
+    }
+    fusion_processor_add_tracks(a->fusion, seed, 1);
+    track_list_release(seed);
+    a->search = search;
+    c->state = a;
+    return 0;
+}
+
+static int assoc_search_setup(mb_case_t *c) { return assoc_setup(c, 1); }
+static int assoc_cached_setup(mb_case_t *c) { return assoc_setup(c, 0); }
+
+static void assoc_prepare(mb_case_t *c) {
+    mb_assoc_t *a = c->state;
+    if (!a->search) return;
+    a->round++;
+    for (int i = 0; i < a->frame->count; i++) a->frame->tracks[i].id = a->round * 100000 + i + 1;
+}
+
+static void assoc_batch(mb_case_t *c) {
+    mb_assoc_t *a = c->state;
+    fusion_processor_add_tracks(a->fusion, a->frame, 2);
+}
+
+static void assoc_teardown(mb_case_t *c) {
+    mb_assoc_t *a = c->state;
+    track_list_release(a->frame);
+    fusion_processor_destroy(a->fusion);
+    free(a);
+}
+
+/* --- 消息队列 --- */
+
+// param[0] = 生产者线程数；0 表示单线程交替 push/pop
+typedef struct {
+    mec_queue_t *queue;
+    track_list_t *list;
+    pthread_t producers[8];
+    int producer_count;
+    volatile int stop;
+} mb_queue_t;
+
+static void* queue_producer(void *arg) {
+    mb_queue_t *q = arg;
+    mec_msg_t msg = { 1, q->list, { 0, 0 }, 0, 0 };
+    while (!q->stop) {
+        if (mec_queue_push(q->queue, &msg) != 0) sched_yield();
+    }
+    return NULL;
+}
+
+static int queue_setup(mb_case_t *c) {
+    mb_queue_t *q = calloc(1, sizeof(mb_queue_t));
+    if (!q) return -1;
+    q->queue = mec_queue_create(64);
+    q->list = make_list(8);
+    if (!q->queue || !q->list) {
+        if (q->queue) mec_queue_destroy(q->queue);
+        track_list_release(q->list);
+        free(q);
+        return -1;
+    }
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    for (int i = 0; i < c->param[0] && i < 8; i++) {
+        if (pthread_create(&q->producers[i], NULL, queue_producer, q) != 0) break;
+        q->producer_count++;
+        if (ncpu > 1) pin_thread(q->producers[i], (int)((g_cpu + 1 + i) % ncpu));
+    }
+    c->state = q;
+    return 0;
+}
+
+static void queue_batch(mb_case_t *c) {
+    mb_queue_t *q = c->state;
+    mec_msg_t msg = { 1, q->list, { 0, 0 }, 0, 0 };
+    for (int i = 0; i < MB_QUEUE_BATCH; i++) {
+        if (q->producer_count == 0) mec_queue_push(q->queue, &msg);
+        mec_msg_t out;
+        if (mec_queue_pop(q->queue, &out, -1) == 0) track_list_release(out.tracks);
+    }
+}
+
+static void queue_teardown(mb_case_t *c) {
+    mb_queue_t *q = c->state;
+    q->stop = 1;
+    for (int i = 0; i < q->producer_count; i++) pthread_join(q->producers[i], NULL);
+    mec_queue_destroy(q->queue);
+    track_list_release(q->list);
+    free(q);
+}
+
+/* --- 内存池与航迹列表 --- */
+
+// param[0] = 分配大小；每批分 8 轮，每轮连续分配 32 块后逆序释放
+static void malloc_batch(mb_case_t *c) {
+    void *blocks[32];
+    for (int round = 0; round < 8; round++) {
+        for (int i = 0; i < 32; i++) {
+            blocks[i] = mec_malloc((size_t)c->param[0]);
+            if (blocks[i]) *(volatile char*)blocks[i] = (char)i;
+        }
+        for (int i = 31; i >= 0; i--) mec_free(blocks[i]);
+    }
+}
+
+static void track_list_batch(mb_case_t *c) {
+    track_list_t *list = track_list_create(4);
+    if (!list) return;
+    target_track_t t;
+    make_track(0, &t);
+    for (int i = 0; i < c->param[0]; i++) {
+        t.id = i + 1;
+        track_list_add(list, &t);
+    }
+    g_sink += list->count;
+    track_list_release(list);
+}
+
+/* --- 雷达字节流解析 --- */
+
+typedef struct {
+    radar_parser_t parser;
+    unsigned char bytes[MB_RADAR_FRAMES * RADAR_FRAME_LEN];
+} mb_radar_t;
+
+static void put_u16(unsigned char *p, int v) {
+    p[0] = (unsigned char)(v >> 8);
+    p[1] = (unsigned char)v;
+}
+
+static int radar_setup(mb_case_t *c) {
+    mb_radar_t *r = calloc(1, sizeof(mb_radar_t));
+    if (!r) return -1;
+    radar_parser_reset(&r->parser);
+
+    // 与 mec_loadgen 相同的 0xAA55 帧，格式见 radar_decode_frame
+    for (int i = 0; i < MB_RADAR_FRAMES; i++) {
+        unsigned char *f = r->bytes + i * RADAR_FRAME_LEN;
+        unsigned char *d = f + 2;
+        f[0] = RADAR_FRAME_HEAD1;
+        f[1] = RADAR_FRAME_HEAD2;
+        put_u16(d + 0, i + 1);
+        put_u16(d + 2, 500 + i * 10);
+        put_u16(d + 4, 1800 + (i % 90) * 5);
+        put_u16(d + 6, 100 + i);
+        put_u16(d + 8, 600);
+        memset(d + 10, 0, 4);
+        unsigned char checksum = 0;
+        for (int k = 0; k < RADAR_FRAME_DATA_LEN; k++) checksum ^= d[k];
+        f[RADAR_FRAME_LEN - 1] = checksum;
+    }
+    c->state = r;
+    return 0;
+}
+
+static void radar_batch(mb_case_t *c) {
+    mb_radar_t *r = c->state;
+    radar_detection_t det;
+    long frames = 0;
+    int pos = 0, len = (int)sizeof(r->bytes);
+    while (pos < len) {
+        int consumed = 0;
+        int got = radar_parser_feed(&r->parser, r->bytes + pos, len - pos, &consumed, &det);
+        pos += consumed;
+        if (!got) break;
+        frames++;
+    }
+    g_sink += frames;
+}
+
+static void radar_teardown(mb_case_t *c) {
+    free(c->state);
+}
+
+/* --- V2X 编码 --- */
+
+typedef struct {
+    track_list_t *list;
+    v2x_encoder_t *enc;
+    uint8_t buf[8192];
+} mb_v2x_t;
+
+static int v2x_setup(mb_case_t *c) {
+    mb_v2x_t *v = calloc(1, sizeof(mb_v2x_t));
+    if (!v) return -1;
+    v->list = make_list(c->param[0]);
+    v->enc = v2x_encoder_create(0xABCD, V2X_DEFAULT_MTU, c->param[0]);
+    if (!v->list || !v->enc) {
+        track_list_release(v->list);
+        v2x_encoder_destroy(v->enc);
+        free(v);
+        return -1;
+    }
+    c->state = v;
+    return 0;
+}
+
+static void v2x_batch(mb_case_t *c) {
+    mb_v2x_t *v = c->state;
+    for (long i = 0; i < c->ops; i++) {
+        int len = sizeof(v->buf);
+        v2x_encode_rsm(v->list, 0xABCD, v->buf, &len);
+        g_sink += len;
+    }
+}
+
+static void v2x_segments_batch(mb_case_t *c) {
+    mb_v2x_t *v = c->state;
+    const struct iovec *iov;
+    for (long i = 0; i < c->ops; i++) {
+        g_sink += v2x_encode_rsm_segments(v->enc, v->list, &iov);
+    }
+}
+
+static void v2x_teardown(mb_case_t *c) {
+    mb_v2x_t *v = c->state;
+    track_list_release(v->list);
+    v2x_encoder_destroy(v->enc);
+    free(v);
+}
+
+/* --- 用例表 --- */
+
+static mb_case_t g_cases[] = {
+    { "kalman_predict", MB_TRACKS, {0, 0}, filter_setup, filter_prepare, predict_batch, filter_teardown, NULL, "" },
+    { "kalman_update", MB_TRACKS, {0, 0}, filter_setup, filter_prepare, update_batch, filter_teardown, NULL, "" },
+    { "track_distance", MB_TRACKS, {0, 0}, filter_setup, filter_prepare, distance_batch, filter_teardown, NULL, "" },
+    { "assoc_search", 16, {16, 16}, assoc_search_setup, assoc_prepare, assoc_batch, assoc_teardown, NULL, "" },
+    { "assoc_search", 64, {64, 64}, assoc_search_setup, assoc_prepare, assoc_batch, assoc_teardown, NULL, "" },
+    { "assoc_search", 256, {256, 256}, assoc_search_setup, assoc_prepare, assoc_batch, assoc_teardown, NULL, "" },
+    { "assoc_search", 32, {1000, 32}, assoc_search_setup, assoc_prepare, assoc_batch, assoc_teardown, NULL, "" },
+    { "assoc_cached", 64, {64, 64}, assoc_cached_setup, NULL, assoc_batch, assoc_teardown, NULL, "" },
+    { "assoc_cached", 256, {256, 256}, assoc_cached_setup, NULL, assoc_batch, assoc_teardown, NULL, "" },
+    { "queue_push_pop", MB_QUEUE_BATCH, {0, 0}, queue_setup, NULL, queue_batch, queue_teardown, NULL, "" },
+    { "queue_contended", MB_QUEUE_BATCH, {1, 0}, queue_setup, NULL, queue_batch, queue_teardown, NULL, "" },
+    { "queue_contended", MB_QUEUE_BATCH, {4, 0}, queue_setup, NULL, queue_batch, queue_teardown, NULL, "" },
+    { "mec_malloc_free", 256, {64, 0}, NULL, NULL, malloc_batch, NULL, NULL, "" },
+    { "mec_malloc_free", 256, {1024, 0}, NULL, NULL, malloc_batch, NULL, NULL, "" },
+    { "mec_malloc_free", 256, {16384, 0}, NULL, NULL, malloc_batch, NULL, NULL, "" },
+    { "track_list_add", 1024, {1024, 0}, NULL, NULL, track_list_batch, NULL, NULL, "" },
+    { "radar_parser_feed", MB_RADAR_FRAMES, {0, 0}, radar_setup, NULL, radar_batch, radar_teardown, NULL, "" },
+    { "v2x_encode_rsm", 64, {16, 0}, v2x_setup, NULL, v2x_batch, v2x_teardown, NULL, "" },
+    { "v2x_encode_rsm", 64, {200, 0}, v2x_setup, NULL, v2x_batch, v2x_teardown, NULL, "" },
+    { "v2x_encode_segments", 64, {16, 0}, v2x_setup, NULL, v2x_segments_batch, v2x_teardown, NULL, "" },
+    { "v2x_encode_segments", 64, {200, 0}, v2x_setup, NULL, v2x_segments_batch, v2x_teardown, NULL, "" },
+    { "v2x_encode_segments", 16, {1000, 0}, v2x_setup, NULL, v2x_segments_batch, v2x_teardown, NULL, "" },
+};
+
+#define MB_CASE_COUNT ((int)(sizeof(g_cases) / sizeof(g_cases[0])))
+
+// 用例显示名：带参数的用例附上规模，如 assoc_search/256x256、queue_contended/4p
+static void case_label(mb_case_t *c) {
+    if (strncmp(c->name, "assoc", 5) == 0) {
+        snprintf(c->label, sizeof(c->label), "%s/%dx%d", c->name, c->param[0], c->param[1]);
+    } else if (strncmp(c->name, "queue_contended", 15) == 0) {
+        snprintf(c->label, sizeof(c->label), "%s/%dp", c->name, c->param[0]);
+    } else if (strcmp(c->name, "mec_malloc_free") == 0 || strncmp(c->name, "v2x_", 4) == 0) {
+        snprintf(c->label, sizeof(c->label), "%s/%d", c->name, c->param[0]);
+    } else {
+        snprintf(c->label, sizeof(c->label), "%s", c->name);
+    }
+}
+
+/* --- 运行 --- */
+
+static int run_case(mb_case_t *c, int warmup, int repeat, mb_result_t *res) {
+    if (c->setup && c->setup(c) != 0) return -1;
+    double *ns = malloc(repeat * sizeof(double));
+    double *cyc = malloc(repeat * sizeof(double));
+    if (!ns || !cyc) {
+        free(ns);
+        free(cyc);
+        if (c->teardown) c->teardown(c);
+        return -1;
+    }
+
+    for (int i = 0; i < warmup; i++) {
+        if (c->prepare) c->prepare(c);
+        c->batch(c);
+    }
+    int have_cycles = 1;
+    for (int i = 0; i < repeat; i++) {
+        if (c->prepare) c->prepare(c);
+        int64_t c0 = cycles_now();
+        mec_time_ns_t t0 = mec_clock_real_ns();
+        c->batch(c);
+        mec_time_ns_t t1 = mec_clock_real_ns();
+        int64_t c1 = cycles_now();
+        ns[i] = (double)(t1 - t0) / (double)c->ops;
+        if (c0 < 0 || c1 < 0) have_cycles = 0;
+        cyc[i] = (double)(c1 - c0) / (double)c->ops;
+    }
+    if (c->teardown) c->teardown(c);
+
+    qsort(ns, repeat, sizeof(double), tool_compare_double);
+    qsort(cyc, repeat, sizeof(double), tool_compare_double);
+    res->name = c->label;
+    res->ops = c->ops;
+    res->samples = repeat;
+    res->ns_min = ns[0];
+    res->ns_median = ns[repeat / 2];
+    res->ns_p90 = ns[(repeat * 9) / 10 < repeat ? (repeat * 9) / 10 : repeat - 1];
+    res->cycles_median = have_cycles ? cyc[repeat / 2] : -1.0;
+    free(ns);
+    free(cyc);
+    return 0;
+}
+
+static void write_json(FILE *fp, const mb_result_t *results, int count, const char *cycle_source,
+                       int warmup, int repeat) {
+    time_t now = time(NULL);
+    struct tm tm_utc;
+    char stamp[32];
+    gmtime_r(&now, &tm_utc);
+    strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", &tm_utc);
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"benchmark\": \"mec_microbench\",\n");
+    fprintf(fp, "  \"schema\": 1,\n");
+    fprintf(fp, "  \"timestamp\": \"%s\",\n", stamp);
+    fprintf(fp, "  \"cpu\": %d,\n", g_cpu);
+    fprintf(fp, "  \"cycle_source\": \"%s\",\n", cycle_source);
+    fprintf(fp, "  \"cycle_unit\": \"%s\",\n", g_cycle_unit);
+    if (g_tick_hz > 0.0) fprintf(fp, "  \"tick_hz\": %.0f,\n", g_tick_hz);
+    fprintf(fp, "  \"warmup\": %d,\n", warmup);
+    fprintf(fp, "  \"repeat\": %d,\n", repeat);
+    fprintf(fp, "  \"cases\": [");
+    for (int i = 0; i < count; i++) {
+        const mb_result_t *r = &results[i];
+        fprintf(fp, "%s\n    {\"name\": \"%s\", \"ops_per_batch\": %ld, \"ns_per_op_median\": %.3f,"
+                    " \"ns_per_op_min\": %.3f, \"ns_per_op_p90\": %.3f, \"%s_per_op_median\": ",
+                i ? "," : "", r->name, r->ops, r->ns_median, r->ns_min, r->ns_p90, g_cycle_unit);
+        if (r->cycles_median >= 0) fprintf(fp, "%.1f}", r->cycles_median);
+        else fprintf(fp, "null}");
+    }
+    fprintf(fp, "\n  ]\n}\n");
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--filter SUBSTR] [--repeat N] [--warmup N] [--cpu N] [--json PATH] [--list]\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    const char *filter = NULL;
+    const char *json_path = NULL;
+    int repeat = 50, warmup = 5, list_only = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--list") == 0) {
+            list_only = 1;
+            continue;
+        }
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!val) {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+        if (strcmp(arg, "--filter") == 0) filter = val;
+        else if (strcmp(arg, "--repeat") == 0) repeat = atoi(val);
+        else if (strcmp(arg, "--warmup") == 0) warmup = atoi(val);
+        else if (strcmp(arg, "--cpu") == 0) g_cpu = atoi(val);
+        else if (strcmp(arg, "--json") == 0) json_path = val;
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (repeat < 1 || warmup < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    for (int i = 0; i < MB_CASE_COUNT; i++) case_label(&g_cases[i]);
+    if (list_only) {
+        for (int i = 0; i < MB_CASE_COUNT; i++) printf("%s\n", g_cases[i].label);
+        return 0;
+    }
+
+    log_init("/tmp/mec_microbench.log", LOG_ERROR);
+    mec_memory_init();
+
+    if (g_cpu < 0) g_cpu = sched_getcpu();
+    if (pin_thread(pthread_self(), g_cpu) != 0) {
+        fprintf(stderr, "Cannot pin to CPU %d, running unpinned\n", g_cpu);
+    }
+    const char *cycle_source = cycles_open();
+
+    static mb_result_t results[MB_MAX_CASES];
+    int done = 0, failed = 0;
+    char unit_col[16];
+    snprintf(unit_col, sizeof(unit_col), "%s/op", g_cycle_unit);
+    printf("%-28s %8s %12s %12s %12s %12s\n", "case", "ops", "ns/op(med)", "ns/op(min)", "ns/op(p90)", unit_col);
+    for (int i = 0; i < MB_CASE_COUNT && done < MB_MAX_CASES; i++) {
+        mb_case_t *c = &g_cases[i];
+        if (filter && !strstr(c->label, filter)) continue;
+        mb_result_t *r = &results[done];
+        if (run_case(c, warmup, repeat, r) != 0) {
+            fprintf(stderr, "%s: setup failed\n", c->label);
+            failed = 1;
+            continue;
+        }
+        done++;
+        printf("%-28s %8ld %12.1f %12.1f %12.1f ", r->name, r->ops, r->ns_median, r->ns_min, r->ns_p90);
+        if (r->cycles_median >= 0) printf("%12.1f\n", r->cycles_median);
+        else printf("%12s\n", "-");
+        fflush(stdout);
+    }
+    printf("%s: %s", g_cycle_unit, cycle_source);
+    if (g_tick_hz > 0.0) printf(" (%.1f MHz)", g_tick_hz / 1e6);
+    printf(", cpu %d, %d samples after %d warmup batches\n", g_cpu, repeat, warmup);
+
+    if (json_path) {
+        FILE *fp = fopen(json_path, "w");
+        if (!fp) {
+            fprintf(stderr, "Cannot write %s: %s\n", json_path, strerror(errno));
+            failed = 1;
+        } else {
+            write_json(fp, results, done, cycle_source, warmup, repeat);
+            fclose(fp);
+        }
+    }
+
+    if (g_perf_fd >= 0) close(g_perf_fd);
+    mec_memory_cleanup();
+    log_cleanup();
+    return failed ? 1 : 0;
+}
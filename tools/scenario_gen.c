@@ -0,0 +1,594 @@
+#include "mec_scenario.h"
+#include "mec_geo.h"
+#include "mec_logging.h"
+
+/**
+ * @file scenario_gen.c
+ * @brief 合成大规模交通场景
+ *
+ * 在站点原点处的十字路口上生成机动车、非机动车与行人的真值轨迹，再按每个传感器
+ * 的刷新率、覆盖范围、噪声、漏检、延迟与虚警采样成模拟器格式的场景。随机数由
+ * seed 决定：同一配置与 seed 总是生成逐字节相同的场景，优化前后可以重放同一压力场景。
+ * 真值与每个传感器各用一路随机数，调整某个传感器的参数不会改变真值与其他传感器。
+ *
+ * 用法: mec_scenario_gen [-c CONFIG] -o OUTPUT [--truth PATH] [--seed N] [--duration S]
+ *
+ * OUTPUT / PATH 以 .msc 结尾时写列式二进制场景，否则写文本场景。真值文件的
+ * sensor_id 为 0，供精度评估使用，不能直接回放。
+ */
+
+#define GEN_MAX_SENSORS 31          // 融合按 1 << (sensor_id - 1) 记录来源
+#define GEN_MAX_PATH_POINTS 16
+#define GEN_TURN_SAMPLES 8
+#define GEN_CLUTTER_ID_BASE 90000   // 传感器内虚警目标的 ID 区间
+#define GEN_SENSOR_ID_STRIDE 100000 // 各传感器目标 ID 的默认间隔
+
+typedef struct {
+    uint64_t s;
+} gen_rng_t;
+
+static void rng_seed(gen_rng_t *r, uint64_t seed) {
+    // splitmix64 打散种子，避免 xorshift 的全零状态
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    r->s = (z ^ (z >> 31)) | 1;
+}
+
+static uint64_t rng_next(gen_rng_t *r) {
+    r->s ^= r->s >> 12;
+    r->s ^= r->s << 25;
+    r->s ^= r->s >> 27;
+    return r->s * 2685821657736338717ULL;
+}
+
+static double rng_uniform(gen_rng_t *r) {
+    return (double)(rng_next(r) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double rng_range(gen_rng_t *r, double lo, double hi) {
+    return lo + (hi - lo) * rng_uniform(r);
+}
+
+static double rng_gauss(gen_rng_t *r) {
+    double u1 = rng_uniform(r);
+    double u2 = rng_uniform(r);
+    if (u1 < 1e-300) u1 = 1e-300;
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static int rng_poisson(gen_rng_t *r, double lambda) {
+    if (lambda <= 0.0) return 0;
+    double limit = exp(-lambda), p = 1.0;
+    int k = 0;
+    do {
+        k++;
+        p *= rng_uniform(r);
+    } while (p > limit && k < 1000);
+    return k - 1;
+}
+
+typedef enum {
+    MOTION_CV = 0,              // 匀速
+    MOTION_CA                   // 速度围绕期望值随机游走（加减速）
+} motion_model_t;
+
+typedef struct {
+    uint64_t seed;
+    double duration_s;
+    int step_ms;                // 真值推进步长
+    int truth_period_ms;        // 真值输出周期
+
+    double arm_length;          // 路口每个方向的道路长度 (m)
+    int lanes;                  // 每个行驶方向的车道数
+    double lane_width;
+    double sidewalk_offset;     // 人行道中心距路缘
+
+    int counts[4];              // 按 target_type_t 的目标数
+    double speed_mean[4];
+    double speed_std[4];
+    double turn_ratio;
+    motion_model_t motion;
+    double accel_std;           // CA 模型的速度扰动 (m/s^2)
+    double wander_std;          // 行人横向游走 (m/sqrt(s))
+} gen_config_t;
+
+typedef struct {
+    int sensor_id;
+    double rate_hz;
+    int offset_ms;
+    double mount_east;
+    double mount_north;
+    double range;
+    int type_mask;              // 1 << target_type_t，可探测的目标类型
+    int id_base;
+    double position_noise;      // 位置噪声标准差 (m)
+    double velocity_noise;
+    double heading_noise;       // 度
+    double confidence;
+    double dropout;             // 每帧每目标的漏检概率
+    int latency_ms;             // 数据相对真值时刻的固定延迟
+    int latency_jitter_ms;      // 附加的均匀随机延迟上限
+    double clutter;             // 每帧虚警目标数的均值
+    long next_frame;            // 下一帧序号
+    long clutter_seq;
+    gen_rng_t rng;
+} gen_sensor_t;
+
+typedef struct {
+    double e[GEN_MAX_PATH_POINTS];
+    double n[GEN_MAX_PATH_POINTS];
+    double s[GEN_MAX_PATH_POINTS];  // 各点处的累计弧长
+    int count;
+} gen_path_t;
+
+typedef struct {
+    int id;
+    target_type_t type;
+    gen_path_t path;
+    double s;                   // 沿路径已行驶距离
+    double speed;
+    double speed_desired;
+    double lateral;             // 行人横向偏移
+    double east, north, heading;
+} gen_target_t;
+
+typedef struct {
+    scenario_record_t *records;
+    size_t count;
+    size_t capacity;
+} record_buf_t;
+
+static int record_push(record_buf_t *buf, const scenario_record_t *r) {
+    if (buf->count == buf->capacity) {
+        size_t next = buf->capacity ? buf->capacity * 2 : 65536;
+        scenario_record_t *grown = realloc(buf->records, next * sizeof(scenario_record_t));
+        if (!grown) return -1;
+        buf->records = grown;
+        buf->capacity = next;
+    }
+    buf->records[buf->count] = *r;
+    buf->records[buf->count].order = buf->count;
+    buf->count++;
+    return 0;
+}
+
+/* --- 道路几何 --- */
+
+// 路口四个方向: 0 东, 1 北, 2 西, 3 南
+static const double arm_dir[4][2] = { {1, 0}, {0, 1}, {-1, 0}, {0, -1} };
+
+static void path_add(gen_path_t *p, double e, double n) {
+    if (p->count >= GEN_MAX_PATH_POINTS) return;
+    p->e[p->count] = e;
+    p->n[p->count] = n;
+    p->s[p->count] = p->count ? p->s[p->count - 1] + hypot(e - p->e[p->count - 1], n - p->n[p->count - 1]) : 0.0;
+    p->count++;
+}
+
+static double path_length(const gen_path_t *p) {
+    return p->count ? p->s[p->count - 1] : 0.0;
+}
+
+// 路径上弧长 s 处的位置与切向航向（度，东向为 0、逆时针为正）
+static void path_eval(const gen_path_t *p, double s, double *e, double *n, double *heading) {
+    int i = 1;
+    while (i < p->count - 1 && p->s[i] < s) i++;
+    double seg = p->s[i] - p->s[i - 1];
+    double t = seg > 0.0 ? (s - p->s[i - 1]) / seg : 0.0;
+    if (t < 0.0) t = 0.0;
+    if (t > 1.0) t = 1.0;
+    double de = p->e[i] - p->e[i - 1], dn = p->n[i] - p->n[i - 1];
+    *e = p->e[i - 1] + t * de;
+    *n = p->n[i - 1] + t * dn;
+    *heading = atan2(dn, de) * 180.0 / M_PI;
+}
+
+/**
+ * @brief 车辆路径：从 entry 方向驶入、exit 方向驶出（靠右行驶）
+ * @param offset 距道路中心线的横向距离
+ */
+static void vehicle_path(const gen_config_t *cfg, int entry, int exit, double offset, gen_path_t *p) {
+    double half = cfg->lanes * cfg->lane_width;
+    // 驶入方向 u = -dir[entry]，右侧法向 (u.n, -u.e)
+    double ue = -arm_dir[entry][0], un = -arm_dir[entry][1];
+    double re = un, rn = -ue;
+    double xe = arm_dir[exit][0], xn = arm_dir[exit][1];
+    double re2 = xn, rn2 = -xe;
+
+    memset(p, 0, sizeof(*p));
+    path_add(p, arm_dir[entry][0] * cfg->arm_length + re * offset, arm_dir[entry][1] * cfg->arm_length + rn * offset);
+    double ae = arm_dir[entry][0] * half + re * offset, an = arm_dir[entry][1] * half + rn * offset;
+    double be = xe * half + re2 * offset, bn = xn * half + rn2 * offset;
+    path_add(p, ae, an);
+
+    // 转弯段: 以两条车道中心线的交点为控制点的二次贝塞尔曲线；直行时控制点取中点
+    double ce = (ae + be) / 2.0, cn = (an + bn) / 2.0;
+    if (exit != (entry + 2) % 4) {
+        ce = fabs(ue) > 0.5 ? be : ae;
+        cn = fabs(ue) > 0.5 ? an : bn;
+    }
+    for (int k = 1; k < GEN_TURN_SAMPLES; k++) {
+        double t = (double)k / GEN_TURN_SAMPLES;
+        path_add(p, (1 - t) * (1 - t) * ae + 2 * t * (1 - t) * ce + t * t * be,
+                    (1 - t) * (1 - t) * an + 2 * t * (1 - t) * cn + t * t * bn);
+    }
+    path_add(p, be, bn);
+    path_add(p, xe * cfg->arm_length + re2 * offset, xn * cfg->arm_length + rn2 * offset);
+}
+
+/**
+ * @brief 行人路径：沿人行道走到路口一角，可能经人行横道穿过一条路，再沿人行道离开
+ */
+static void pedestrian_path(const gen_config_t *cfg, gen_rng_t *rng, gen_path_t *p) {
+    double c = cfg->lanes * cfg->lane_width + cfg->sidewalk_offset;
+    double L = cfg->arm_length;
+    int sx = rng_uniform(rng) < 0.5 ? -1 : 1;
+    int sy = rng_uniform(rng) < 0.5 ? -1 : 1;
+
+    memset(p, 0, sizeof(*p));
+    if (rng_uniform(rng) < 0.5) path_add(p, sx * L, sy * c);
+    else path_add(p, sx * c, sy * L);
+    path_add(p, sx * c, sy * c);
+
+    double roll = rng_uniform(rng);
+    if (roll < 0.35) sx = -sx;              // 横穿南北向道路
+    else if (roll < 0.7) sy = -sy;          // 横穿东西向道路
+    if (roll < 0.7) path_add(p, sx * c, sy * c);
+
+    if (rng_uniform(rng) < 0.5) path_add(p, sx * L, sy * c);
+    else path_add(p, sx * c, sy * L);
+}
+
+/* --- 真值 --- */
+
+static void target_spawn(const gen_config_t *cfg, gen_rng_t *rng, gen_target_t *t, target_type_t type, int id) {
+    memset(t, 0, sizeof(*t));
+    t->id = id;
+    t->type = type;
+    if (type == TARGET_PEDESTRIAN) {
+        pedestrian_path(cfg, rng, &t->path);
+    } else {
+        int entry = (int)(rng_uniform(rng) * 4) & 3;
+        int exit = (entry + 2) % 4;
+        if (rng_uniform(rng) < cfg->turn_ratio) exit = rng_uniform(rng) < 0.5 ? (entry + 1) % 4 : (entry + 3) % 4;
+        double offset;
+        if (type == TARGET_VEHICLE) {
+            int lane = (int)(rng_uniform(rng) * cfg->lanes);
+            if (lane >= cfg->lanes) lane = cfg->lanes - 1;
+            offset = (lane + 0.5) * cfg->lane_width;
+        } else {
+            offset = cfg->lanes * cfg->lane_width - 0.8;    // 非机动车靠路缘
+        }
+        vehicle_path(cfg, entry, exit, offset, &t->path);
+    }
+    double speed = cfg->speed_mean[type] + cfg->speed_std[type] * rng_gauss(rng);
+    double floor = cfg->speed_mean[type] * 0.3;
+    t->speed_desired = speed > floor ? speed : floor;
+    t->speed = t->speed_desired;
+}
+
+static void target_locate(gen_target_t *t) {
+    path_eval(&t->path, t->s, &t->east, &t->north, &t->heading);
+    if (t->lateral != 0.0) {
+        double a = t->heading * M_PI / 180.0;
+        t->east += -sin(a) * t->lateral;
+        t->north += cos(a) * t->lateral;
+    }
+}
+
+// 推进 dt 秒；走完路径返回 1
+static int target_step(const gen_config_t *cfg, gen_rng_t *rng, gen_target_t *t, double dt) {
+    if (cfg->motion == MOTION_CA) {
+        t->speed += 0.5 * (t->speed_desired - t->speed) * dt + cfg->accel_std * sqrt(dt) * rng_gauss(rng);
+        if (t->speed < 0.0) t->speed = 0.0;
+    }
+    if (t->type == TARGET_PEDESTRIAN && cfg->wander_std > 0.0) {
+        t->lateral += cfg->wander_std * sqrt(dt) * rng_gauss(rng);
+        if (t->lateral > 1.0) t->lateral = 1.0;
+        if (t->lateral < -1.0) t->lateral = -1.0;
+    }
+    t->s += t->speed * dt;
+    if (t->s >= path_length(&t->path)) return 1;
+    target_locate(t);
+    return 0;
+}
+
+/* --- 传感器采样 --- */
+
+static void emit_record(record_buf_t *buf, const geo_site_t *site, int64_t time_ms, int sensor_id, int id,
+                        target_type_t type, double east, double north, double velocity, double heading,
+                        double confidence, int *failed) {
+    enu_coord_t local = { east, north, 0.0 };
+    wgs84_coord_t pos;
+    geo_enu_to_wgs84(site, &local, &pos);
+    scenario_record_t r;
+    memset(&r, 0, sizeof(r));
+    r.time_ms = time_ms;
+    r.sensor_id = sensor_id;
+    r.id = id;
+    r.type = type;
+    r.latitude = pos.latitude;
+    r.longitude = pos.longitude;
+    r.velocity = velocity;
+    r.heading = fmod(heading + 360.0, 360.0);
+    r.confidence = confidence;
+    if (record_push(buf, &r) != 0) *failed = 1;
+}
+
+static void sensor_frame(gen_sensor_t *sn, const gen_target_t *targets, int count, int64_t now_ms,
+                         const geo_site_t *site, record_buf_t *buf, int *failed) {
+    gen_rng_t *rng = &sn->rng;
+    int64_t time_ms = now_ms + sn->latency_ms;
+    if (sn->latency_jitter_ms > 0) time_ms += (int64_t)(rng_uniform(rng) * (sn->latency_jitter_ms + 1));
+
+    for (int i = 0; i < count; i++) {
+        const gen_target_t *t = &targets[i];
+        if (!(sn->type_mask & (1 << t->type))) continue;
+        if (hypot(t->east - sn->mount_east, t->north - sn->mount_north) > sn->range) continue;
+        if (rng_uniform(rng) < sn->dropout) continue;
+
+        double v = t->speed + sn->velocity_noise * rng_gauss(rng);
+        double conf = sn->confidence + 0.05 * rng_gauss(rng);
+        emit_record(buf, site, time_ms, sn->sensor_id, sn->id_base + t->id, t->type,
+                    t->east + sn->position_noise * rng_gauss(rng),
+                    t->north + sn->position_noise * rng_gauss(rng),
+                    v > 0.0 ? v : 0.0, t->heading + sn->heading_noise * rng_gauss(rng),
+                    conf < 0.05 ? 0.05 : (conf > 1.0 ? 1.0 : conf), failed);
+    }
+
+    // 虚警：覆盖范围内均匀分布、低速、低置信度
+    int clutter = rng_poisson(rng, sn->clutter);
+    for (int k = 0; k < clutter; k++) {
+        double r = sn->range * sqrt(rng_uniform(rng));
+        double a = rng_range(rng, 0.0, 2.0 * M_PI);
+        int type = (int)(rng_uniform(rng) * 4) & 3;
+        if (!(sn->type_mask & (1 << type))) type = TARGET_OBSTACLE;
+        int id = sn->id_base + GEN_CLUTTER_ID_BASE + (int)(sn->clutter_seq++ % 10000);
+        emit_record(buf, site, time_ms, sn->sensor_id, id, (target_type_t)type,
+                    sn->mount_east + r * cos(a), sn->mount_north + r * sin(a),
+                    rng_range(rng, 0.0, 2.0), rng_range(rng, 0.0, 360.0), rng_range(rng, 0.2, 0.5), failed);
+    }
+}
+
+/* --- 配置 --- */
+
+static const char *type_key[4] = { "vehicle", "non_vehicle", "pedestrian", "obstacle" };
+
+// [sensor.N] 段中的键优先，找不到时回退到公共 [sensor] 段
+static double sensor_cfg_double(config_t *config, int index, const char *key, double default_value) {
+    char full_key[MEC_CONFIG_KEY_LEN];
+    double fallback, value;
+    snprintf(full_key, sizeof(full_key), "sensor.%s", key);
+    config_get_double(config, full_key, &fallback, default_value);
+    snprintf(full_key, sizeof(full_key), "sensor.%d.%s", index, key);
+    config_get_double(config, full_key, &value, fallback);
+    return value;
+}
+
+static int sensor_cfg_int(config_t *config, int index, const char *key, int default_value) {
+    char full_key[MEC_CONFIG_KEY_LEN];
+    int fallback, value;
+    snprintf(full_key, sizeof(full_key), "sensor.%s", key);
+    config_get_int(config, full_key, &fallback, default_value);
+    snprintf(full_key, sizeof(full_key), "sensor.%d.%s", index, key);
+    config_get_int(config, full_key, &value, fallback);
+    return value;
+}
+
+static void load_config(config_t *config, gen_config_t *cfg, gen_sensor_t *sensors, int *sensor_count,
+                        geo_site_t *site) {
+    int seed;
+    char value[64];
+    config_get_int(config, "scene.seed", &seed, 1);
+    cfg->seed = (uint64_t)seed;
+    config_get_double(config, "scene.duration_s", &cfg->duration_s, 60.0);
+    config_get_int(config, "scene.step_ms", &cfg->step_ms, 10);
+    config_get_int(config, "scene.truth_period_ms", &cfg->truth_period_ms, 100);
+
+    double lat, lon, alt;
+    config_get_double(config, "site.latitude", &lat, GEO_DEFAULT_SITE_LAT);
+    config_get_double(config, "site.longitude", &lon, GEO_DEFAULT_SITE_LON);
+    config_get_double(config, "site.altitude", &alt, 0.0);
+    if (geo_site_init(site, lat, lon, alt) != 0) geo_site_init(site, GEO_DEFAULT_SITE_LAT, GEO_DEFAULT_SITE_LON, 0.0);
+
+    config_get_double(config, "road.arm_length", &cfg->arm_length, 150.0);
+    config_get_int(config, "road.lanes", &cfg->lanes, 2);
+    config_get_double(config, "road.lane_width", &cfg->lane_width, 3.5);
+    config_get_double(config, "road.sidewalk_offset", &cfg->sidewalk_offset, 2.0);
+
+    static const int default_count[4] = { 200, 40, 100, 0 };
+    static const double default_speed[4] = { 12.0, 4.5, 1.3, 0.0 };
+    static const double default_std[4] = { 2.5, 1.0, 0.3, 0.0 };
+    for (int i = 0; i < 4; i++) {
+        char key[MEC_CONFIG_KEY_LEN];
+        snprintf(key, sizeof(key), "traffic.%ss", type_key[i]);
+        config_get_int(config, key, &cfg->counts[i], default_count[i]);
+        snprintf(key, sizeof(key), "traffic.%s_speed", type_key[i]);
+        config_get_double(config, key, &cfg->speed_mean[i], default_speed[i]);
+        snprintf(key, sizeof(key), "traffic.%s_speed_std", type_key[i]);
+        config_get_double(config, key, &cfg->speed_std[i], default_std[i]);
+    }
+    config_get_double(config, "traffic.turn_ratio", &cfg->turn_ratio, 0.3);
+    config_get_string(config, "traffic.motion", value, sizeof(value), "ca");
+    cfg->motion = strcmp(value, "cv") == 0 ? MOTION_CV : MOTION_CA;
+    config_get_double(config, "traffic.accel_std", &cfg->accel_std, 0.8);
+    config_get_double(config, "traffic.wander_std", &cfg->wander_std, 0.2);
+
+    int count;
+    config_get_int(config, "sensor.count", &count, 2);
+    if (count < 0) count = 0;
+    if (count > GEN_MAX_SENSORS) count = GEN_MAX_SENSORS;
+    for (int i = 0; i < count; i++) {
+        gen_sensor_t *sn = &sensors[i];
+        int index = i + 1;
+        memset(sn, 0, sizeof(*sn));
+        sn->sensor_id = index;
+        sn->rate_hz = sensor_cfg_double(config, index, "rate_hz", 10.0);
+        sn->offset_ms = sensor_cfg_int(config, index, "offset_ms", 0);
+        sn->mount_east = sensor_cfg_double(config, index, "mount_east", 0.0);
+        sn->mount_north = sensor_cfg_double(config, index, "mount_north", 0.0);
+        sn->range = sensor_cfg_double(config, index, "range", 200.0);
+        sn->type_mask = sensor_cfg_int(config, index, "type_mask", 0xF);
+        sn->id_base = sensor_cfg_int(config, index, "id_base", index * GEN_SENSOR_ID_STRIDE);
+        sn->position_noise = sensor_cfg_double(config, index, "position_noise", 0.5);
+        sn->velocity_noise = sensor_cfg_double(config, index, "velocity_noise", 0.3);
+        sn->heading_noise = sensor_cfg_double(config, index, "heading_noise", 2.0);
+        sn->confidence = sensor_cfg_double(config, index, "confidence", 0.85);
+        sn->dropout = sensor_cfg_double(config, index, "dropout", 0.05);
+        sn->latency_ms = sensor_cfg_int(config, index, "latency_ms", 50);
+        sn->latency_jitter_ms = sensor_cfg_int(config, index, "latency_jitter_ms", 10);
+        sn->clutter = sensor_cfg_double(config, index, "clutter", 1.0);
+        if (sn->rate_hz <= 0.0) sn->rate_hz = 10.0;
+    }
+    *sensor_count = count;
+}
+
+/* --- 输出 --- */
+
+static int has_suffix(const char *s, const char *suffix) {
+    size_t n = strlen(s), m = strlen(suffix);
+    return n >= m && strcmp(s + n - m, suffix) == 0;
+}
+
+static int write_output(record_buf_t *buf, const char *path, uint64_t seed) {
+    mec_scenario_t sc;
+    if (scenario_build(&sc, buf->records, buf->count) != 0) {
+        fprintf(stderr, "Cannot build scenario (%zu records)\n", buf->count);
+        return -1;
+    }
+    int ret = 0;
+    if (has_suffix(path, SCENARIO_FILE_EXT)) {
+        ret = scenario_write(&sc, path);
+    } else {
+        FILE *fp = fopen(path, "w");
+        if (!fp) {
+            scenario_close(&sc);
+            return -1;
+        }
+        fprintf(fp, "# mec_scenario_gen seed=%llu\n", (unsigned long long)seed);
+        fprintf(fp, "# rel_time_ms sensor_id id type latitude longitude velocity heading confidence\n");
+        scenario_group_t g;
+        while (scenario_next(&sc, &g) == 0) {
+            for (int i = 0; i < g.count; i++) {
+                fprintf(fp, "%lld %d %d %d %.9f %.9f %.3f %.2f %.3f\n", (long long)g.time_ms, g.sensor_id[i],
+                        g.id[i], g.type[i], g.latitude[i], g.longitude[i], g.velocity[i], g.heading[i],
+                        g.confidence[i]);
+            }
+        }
+        if (fclose(fp) != 0) ret = -1;
+    }
+    if (ret == 0) {
+        printf("%s: %llu records in %llu groups, %.1f s\n", path, (unsigned long long)sc.record_count,
+               (unsigned long long)sc.group_count, scenario_duration_ms(&sc) / 1000.0);
+    }
+    scenario_close(&sc);
+    return ret;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-c CONFIG] -o OUTPUT [--truth PATH] [--seed N] [--duration S]\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    const char *config_path = "config/scenario_gen.conf";
+    const char *out_path = NULL;
+    const char *truth_path = NULL;
+    long long seed_override = -1;
+    double duration_override = -1.0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            config_path = argv[++i];
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (strcmp(argv[i], "--truth") == 0 && i + 1 < argc) {
+            truth_path = argv[++i];
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed_override = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            duration_override = atof(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!out_path) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    config_t *config = NULL;
+    if (config_load(&config, config_path) != MEC_OK) {
+        fprintf(stderr, "Cannot load %s\n", config_path);
+        return 1;
+    }
+    gen_config_t cfg;
+    gen_sensor_t sensors[GEN_MAX_SENSORS];
+    int sensor_count = 0;
+    geo_site_t site;
+    memset(&cfg, 0, sizeof(cfg));
+    load_config(config, &cfg, sensors, &sensor_count, &site);
+    config_free(config);
+    if (seed_override >= 0) cfg.seed = (uint64_t)seed_override;
+    if (duration_override > 0.0) cfg.duration_s = duration_override;
+    if (cfg.step_ms <= 0) cfg.step_ms = 10;
+    if (cfg.lanes < 1) cfg.lanes = 1;
+
+    gen_rng_t truth_rng;
+    rng_seed(&truth_rng, cfg.seed);
+    for (int i = 0; i < sensor_count; i++) {
+        rng_seed(&sensors[i].rng, cfg.seed * 1000003ULL + (uint64_t)sensors[i].sensor_id);
+    }
+
+    // 初始目标沿各自路径随机分布，场景一开始就是满负荷
+    int target_count = cfg.counts[0] + cfg.counts[1] + cfg.counts[2] + cfg.counts[3];
+    gen_target_t *targets = calloc(target_count > 0 ? target_count : 1, sizeof(gen_target_t));
+    if (!targets) return 1;
+    int next_id = 1;
+    for (int type = 0, k = 0; type < 4; type++) {
+        for (int i = 0; i < cfg.counts[type]; i++, k++) {
+            target_spawn(&cfg, &truth_rng, &targets[k], (target_type_t)type, next_id++);
+            targets[k].s = rng_uniform(&truth_rng) * path_length(&targets[k].path);
+            target_locate(&targets[k]);
+        }
+    }
+
+    record_buf_t out = { NULL, 0, 0 }, truth = { NULL, 0, 0 };
+    int failed = 0;
+    int64_t end_ms = (int64_t)(cfg.duration_s * 1000.0);
+    double dt = cfg.step_ms / 1000.0;
+    for (int64_t now = 0; now <= end_ms && !failed; now += cfg.step_ms) {
+        for (int i = 0; i < sensor_count; i++) {
+            gen_sensor_t *sn = &sensors[i];
+            int64_t due = sn->offset_ms + (int64_t)(sn->next_frame * 1000.0 / sn->rate_hz);
+            if (now >= due) {
+                sensor_frame(sn, targets, target_count, now, &site, &out, &failed);
+                sn->next_frame++;
+            }
+        }
+        if (truth_path && cfg.truth_period_ms > 0 && now % cfg.truth_period_ms == 0) {
+            for (int i = 0; i < target_count; i++) {
+                const gen_target_t *t = &targets[i];
+                emit_record(&truth, &site, now, 0, t->id, t->type, t->east, t->north, t->speed, t->heading,
+                            1.0, &failed);
+            }
+        }
+        // 走完路径的目标以新 ID 从路口外重新驶入，总数保持不变
+        for (int i = 0; i < target_count; i++) {
+            if (target_step(&cfg, &truth_rng, &targets[i], dt)) {
+                target_spawn(&cfg, &truth_rng, &targets[i], targets[i].type, next_id++);
+                target_locate(&targets[i]);
+            }
+        }
+    }
+    free(targets);
+
+    int ret = failed ? -1 : 0;
+    if (failed) fprintf(stderr, "Out of memory after %zu records\n", out.count);
+    if (ret == 0) ret = write_output(&out, out_path, cfg.seed);
+    if (ret == 0 && truth_path) ret = write_output(&truth, truth_path, cfg.seed);
+    free(out.records);
+    free(truth.records);
+    return ret == 0 ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+#include "tool_common.h"
+#include <float.h>
+#include <stdlib.h>
+
+/**
+ * @file tool_assign.c
+ * @brief 最小代价二分指派（匈牙利算法，势函数形式）
+ *
+ * 行数不超过列数时直接求解，否则转置后求解再映射回来。复杂度 O(n^2 m)，
+ * 用于评估工具 (mec_fusion_eval) 的逐帧匹配与全局 ID 匹配。
+ */
+
+// rows <= cols，cost 按行主序；a[r] 输出第 r 行指派到的列
+static int assign_wide(const double *cost, int rows, int cols, int *a) {
+    // 下标从 1 开始，0 号列为哨兵
+    double *u = calloc(rows + 1, sizeof(double));
+    double *v = calloc(cols + 1, sizeof(double));
+    double *minv = malloc((cols + 1) * sizeof(double));
+    int *p = calloc(cols + 1, sizeof(int));
+    int *way = calloc(cols + 1, sizeof(int));
+    char *used = malloc(cols + 1);
+    if (!u || !v || !minv || !p || !way || !used) {
+        free(u); free(v); free(minv); free(p); free(way); free(used);
+        return -1;
+    }
+
+    for (int i = 1; i <= rows; i++) {
+        p[0] = i;
+        int j0 = 0;
+        for (int j = 0; j <= cols; j++) {
+            minv[j] = DBL_MAX;
+            used[j] = 0;
+        }
+        do {
+            used[j0] = 1;
+            int i0 = p[j0], j1 = 0;
+            double delta = DBL_MAX;
+            for (int j = 1; j <= cols; j++) {
+                if (used[j]) continue;
+                double cur = cost[(i0 - 1) * cols + (j - 1)] - u[i0] - v[j];
+                if (cur < minv[j]) {
+                    minv[j] = cur;
+                    way[j] = j0;
+                }
+                if (minv[j] < delta) {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+            for (int j = 0; j <= cols; j++) {
+                if (used[j]) {
+                    u[p[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    minv[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (p[j0] != 0);
+        do {
+            int j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        } while (j0);
+    }
+
+    for (int j = 1; j <= cols; j++) {
+        if (p[j]) a[p[j] - 1] = j - 1;
+    }
+    free(u); free(v); free(minv); free(p); free(way); free(used);
+    return 0;
+}
+
+int tool_assign_min_cost(const double *cost, int rows, int cols, int *row_to_col) {
+    if (!cost || !row_to_col || rows < 0 || cols < 0) return -1;
+    for (int r = 0; r < rows; r++) row_to_col[r] = -1;
+    if (rows == 0 || cols == 0) return 0;
+    if (rows <= cols) return assign_wide(cost, rows, cols, row_to_col);
+
+    // 行多于列：转置求解，每列指派到一行，其余行不指派
+    double *t = malloc((size_t)rows * cols * sizeof(double));
+    int *col_to_row = malloc(cols * sizeof(int));
+    if (!t || !col_to_row) {
+        free(t);
+        free(col_to_row);
+        return -1;
+    }
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) t[c * rows + r] = cost[r * cols + c];
+    }
+    int ret = assign_wide(t, cols, rows, col_to_row);
+    if (ret == 0) {
+        for (int c = 0; c < cols; c++) row_to_col[col_to_row[c]] = c;
+    }
+    free(t);
+    free(col_to_row);
+    return ret;
+}
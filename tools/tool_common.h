@@ -0,0 +1,42 @@
+#ifndef MEC_TOOL_COMMON_H
+#define MEC_TOOL_COMMON_H
+
+#include <stddef.h>
+
+/**
+ * @file tool_common.h
+ * @brief 基准与评估工具共用的统计与指派辅助函数（不链接进 mec_system）
+ */
+
+// 可增长的样本数组，零初始化即可使用
+typedef struct {
+    double *data;
+    size_t count;
+    size_t capacity;
+} tool_samples_t;
+
+/**
+ * @brief 追加一个样本，容量不足时倍增
+ * @return 0:成功, -1:内存不足
+ */
+int tool_samples_push(tool_samples_t *s, double v);
+void tool_samples_free(tool_samples_t *s);
+
+// qsort 比较函数：double 升序
+int tool_compare_double(const void *a, const void *b);
+
+/**
+ * @brief 最近秩百分位：不插值，p99.9 在样本不足 1000 时即为最大值
+ * @param sorted 升序样本
+ */
+double tool_percentile(const double *sorted, size_t n, double p);
+
+/**
+ * @brief 最小代价二分指派（匈牙利算法）
+ * @param cost rows x cols 代价矩阵，行主序
+ * @param row_to_col 输出：每行指派到的列，行多于列时未指派的行为 -1
+ * @return 0:成功, -1:参数错误或内存不足
+ */
+int tool_assign_min_cost(const double *cost, int rows, int cols, int *row_to_col);
+
+#endif // MEC_TOOL_COMMON_H
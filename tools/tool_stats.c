@@ -0,0 +1,40 @@
+#include "tool_common.h"
+#include <math.h>
+#include <stdlib.h>
+
+/**
+ * @file tool_stats.c
+ * @brief 工具共用的样本收集与百分位统计
+ */
+
+int tool_samples_push(tool_samples_t *s, double v) {
+    if (s->count == s->capacity) {
+        size_t cap = s->capacity ? s->capacity * 2 : 4096;
+        double *data = realloc(s->data, cap * sizeof(double));
+        if (!data) return -1;
+        s->data = data;
+        s->capacity = cap;
+    }
+    s->data[s->count++] = v;
+    return 0;
+}
+
+void tool_samples_free(tool_samples_t *s) {
+    free(s->data);
+    s->data = NULL;
+    s->count = 0;
+    s->capacity = 0;
+}
+
+int tool_compare_double(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+double tool_percentile(const double *sorted, size_t n, double p) {
+    if (n == 0) return 0.0;
+    size_t rank = (size_t)ceil(p * (double)n);
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+    return sorted[rank - 1];
+}